@@ -134,6 +134,8 @@ if(NOT MSVC)
 	check_symbol_exists("memset_s"       "string.h" HAVE_MEMSET_S)
 	# BSDs, older glibc, musl
 	check_symbol_exists("explicit_bzero" "string.h" HAVE_EXPLICIT_BZERO)
+	check_symbol_exists("mmap"           "sys/mman.h" HAVE_MMAP)
+	check_symbol_exists("posix_madvise"  "sys/mman.h" HAVE_POSIX_MADVISE)
 endif()
 check_function_exists("getifaddrs"       HAVE_GETIFADDRS)
 check_function_exists("issetugid"        HAVE_ISSETUGID)
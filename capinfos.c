@@ -149,6 +149,9 @@ static bool cap_file_hashes    = true;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
+/* Number of records to read with each wtap_read_batch() call */
+#define READ_BATCH_RECS 64
+
 
 static char file_sha256[HASH_STR_SIZE];
 static char file_sha1[HASH_STR_SIZE];
@@ -1097,13 +1100,15 @@ process_cap_file(const char *filename, bool need_separator)
     int                   err;
     char                 *err_info;
     int64_t               size;
-    int64_t               data_offset;
+    int64_t               data_offsets[READ_BATCH_RECS];
 
     uint32_t              packet = 0;
     int64_t               bytes  = 0;
     uint32_t              snaplen_min_inferred = 0xffffffff;
     uint32_t              snaplen_max_inferred =          0;
-    wtap_rec              rec;
+    wtap_rec              recs[READ_BATCH_RECS];
+    wtap_rec             *rec;
+    unsigned              n_recs, j;
     capture_info          cf_info;
     bool                  have_times = true;
     nstime_t              earliest_packet_time;
@@ -1169,117 +1174,129 @@ process_cap_file(const char *filename, bool need_separator)
     wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
     wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
 
-    /* Tally up data that we need to parse through the file to find */
-    wtap_rec_init(&rec, DEFAULT_INIT_BUFFER_SIZE_2048);
-    while (wtap_read(cf_info.wth, &rec, &err, &err_info, &data_offset))  {
-        if (rec.presence_flags & WTAP_HAS_TS) {
-            prev_time = cur_time;
-            cur_time = rec.ts;
-            if (packet == 0) {
-                earliest_packet_time = rec.ts;
-                earliest_packet_time_tsprec = rec.tsprec;
-                latest_packet_time  = rec.ts;
-                latest_packet_time_tsprec = rec.tsprec;
-                prev_time  = rec.ts;
-            }
-            if (nstime_cmp(&cur_time, &prev_time) < 0) {
-                order = NOT_IN_ORDER;
-            }
-            if (nstime_cmp(&cur_time, &earliest_packet_time) < 0) {
-                earliest_packet_time = cur_time;
-                earliest_packet_time_tsprec = rec.tsprec;
-            }
-            if (nstime_cmp(&cur_time, &latest_packet_time) > 0) {
-                latest_packet_time = cur_time;
-                latest_packet_time_tsprec = rec.tsprec;
-            }
-        } else {
-            have_times = false; /* at least one packet has no time stamp */
-            if (order != NOT_IN_ORDER)
-                order = ORDER_UNKNOWN;
-        }
+    /* We never look at the packet data, so don't have it read if the
+       file type can skip it. */
+    wtap_set_headers_only(cf_info.wth, true);
 
-        if (rec.rec_type == REC_TYPE_PACKET) {
-            bytes += rec.rec_header.packet_header.len;
-            packet++;
-            /* packet comments */
-            if (pkt_comments && wtap_block_count_option(rec.block, OPT_COMMENT) > 0) {
-                char *cmt_buff;
-                for (i = 0; wtap_block_get_nth_string_option_value(rec.block, OPT_COMMENT, i, &cmt_buff) == WTAP_OPTTYPE_SUCCESS; i++) {
-                    pc = g_new0(pkt_cmt, 1);
-
-                    pc->recno = packet;
-                    pc->cmt = g_strdup(cmt_buff);
-                    pc->next = NULL;
-
-                    if (prev == NULL)
-                        cf_info.pkt_cmts = pc;
-                    else
-                        prev->next = pc;
-
-                    prev = pc;
+    /* Tally up data that we need to parse through the file to find */
+    for (j = 0; j < READ_BATCH_RECS; j++)
+        wtap_rec_init(&recs[j], DEFAULT_INIT_BUFFER_SIZE_2048);
+    while ((n_recs = wtap_read_batch(cf_info.wth, recs, READ_BATCH_RECS, 0,
+                                     &err, &err_info, data_offsets)) != 0) {
+        for (j = 0; j < n_recs; j++) {
+            rec = &recs[j];
+            if (rec->presence_flags & WTAP_HAS_TS) {
+                prev_time = cur_time;
+                cur_time = rec->ts;
+                if (packet == 0) {
+                    earliest_packet_time = rec->ts;
+                    earliest_packet_time_tsprec = rec->tsprec;
+                    latest_packet_time  = rec->ts;
+                    latest_packet_time_tsprec = rec->tsprec;
+                    prev_time  = rec->ts;
+                }
+                if (nstime_cmp(&cur_time, &prev_time) < 0) {
+                    order = NOT_IN_ORDER;
+                }
+                if (nstime_cmp(&cur_time, &earliest_packet_time) < 0) {
+                    earliest_packet_time = cur_time;
+                    earliest_packet_time_tsprec = rec->tsprec;
+                }
+                if (nstime_cmp(&cur_time, &latest_packet_time) > 0) {
+                    latest_packet_time = cur_time;
+                    latest_packet_time_tsprec = rec->tsprec;
                 }
-            }
-
-            /* If caplen < len for a rcd, then presumably           */
-            /* 'Limit packet capture length' was done for this rcd. */
-            /* Keep track as to the min/max actual snapshot lengths */
-            /*  seen for this file.                                 */
-            if (rec.rec_header.packet_header.caplen < rec.rec_header.packet_header.len) {
-                if (rec.rec_header.packet_header.caplen < snaplen_min_inferred)
-                    snaplen_min_inferred = rec.rec_header.packet_header.caplen;
-                if (rec.rec_header.packet_header.caplen > snaplen_max_inferred)
-                    snaplen_max_inferred = rec.rec_header.packet_header.caplen;
-            }
-
-            if ((rec.rec_header.packet_header.pkt_encap > 0) &&
-                    (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
-                fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
-                        rec.rec_header.packet_header.pkt_encap, packet, filename);
+                have_times = false; /* at least one packet has no time stamp */
+                if (order != NOT_IN_ORDER)
+                    order = ORDER_UNKNOWN;
             }
 
-            /* Packet interface_id info */
-            if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
-                    /*
-                     * OK, re-fetch the number of interfaces, as there might have
-                     * been an interface that was in the middle of packets, and
-                     * grow the array to be big enough for the new number of
-                     * interfaces.
-                     */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
-
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-
-                    g_free(idb_info);
-                    idb_info = NULL;
+            if (rec->rec_type == REC_TYPE_PACKET) {
+                bytes += rec->rec_header.packet_header.len;
+                packet++;
+                /* packet comments */
+                if (pkt_comments && wtap_block_count_option(rec->block, OPT_COMMENT) > 0) {
+                    char *cmt_buff;
+                    for (i = 0; wtap_block_get_nth_string_option_value(rec->block, OPT_COMMENT, i, &cmt_buff) == WTAP_OPTTYPE_SUCCESS; i++) {
+                        pc = g_new0(pkt_cmt, 1);
+
+                        pc->recno = packet;
+                        pc->cmt = g_strdup(cmt_buff);
+                        pc->next = NULL;
+
+                        if (prev == NULL)
+                            cf_info.pkt_cmts = pc;
+                        else
+                            prev->next = pc;
+
+                        prev = pc;
+                    }
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t,
-                            rec.rec_header.packet_header.interface_id) += 1;
+
+                /* If caplen < len for a rcd, then presumably           */
+                /* 'Limit packet capture length' was done for this rcd. */
+                /* Keep track as to the min/max actual snapshot lengths */
+                /*  seen for this file.                                 */
+                if (rec->rec_header.packet_header.caplen < rec->rec_header.packet_header.len) {
+                    if (rec->rec_header.packet_header.caplen < snaplen_min_inferred)
+                        snaplen_min_inferred = rec->rec_header.packet_header.caplen;
+                    if (rec->rec_header.packet_header.caplen > snaplen_max_inferred)
+                        snaplen_max_inferred = rec->rec_header.packet_header.caplen;
                 }
-                else {
-                    cf_info.pkt_interface_id_unknown += 1;
+
+                if ((rec->rec_header.packet_header.pkt_encap > 0) &&
+                        (rec->rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
+                    cf_info.encap_counts[rec->rec_header.packet_header.pkt_encap] += 1;
+                } else {
+                    fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
+                            rec->rec_header.packet_header.pkt_encap, packet, filename);
                 }
-            }
-            else {
-                /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t, 0) += 1;
+
+                /* Packet interface_id info */
+                if (rec->presence_flags & WTAP_HAS_INTERFACE_ID) {
+                    /* cf_info.num_interfaces is size, not index, so it's one more than max index */
+                    if (rec->rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                        /*
+                         * OK, re-fetch the number of interfaces, as there might have
+                         * been an interface that was in the middle of packets, and
+                         * grow the array to be big enough for the new number of
+                         * interfaces.
+                         */
+                        idb_info = wtap_file_get_idb_info(cf_info.wth);
+
+                        cf_info.num_interfaces = idb_info->interface_data->len;
+                        g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+
+                        g_free(idb_info);
+                        idb_info = NULL;
+                    }
+                    if (rec->rec_header.packet_header.interface_id < cf_info.num_interfaces) {
+                        g_array_index(cf_info.interface_packet_counts, uint32_t,
+                                rec->rec_header.packet_header.interface_id) += 1;
+                    }
+                    else {
+                        cf_info.pkt_interface_id_unknown += 1;
+                    }
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    /* it's for interface_id 0 */
+                    if (cf_info.num_interfaces != 0) {
+                        g_array_index(cf_info.interface_packet_counts, uint32_t, 0) += 1;
+                    }
+                    else {
+                        cf_info.pkt_interface_id_unknown += 1;
+                    }
                 }
             }
-        }
 
-        wtap_rec_reset(&rec);
+            wtap_rec_reset(rec);
+        }
+        if (err != 0)
+            break;
     } /* while */
-    wtap_rec_cleanup(&rec);
+    for (j = 0; j < READ_BATCH_RECS; j++)
+        wtap_rec_cleanup(&recs[j]);
 
     /*
      * Get IDB info strings.
@@ -1545,6 +1562,8 @@ main(int argc, char *argv[])
 
     application_file_extensions(&file_extensions, &num_extensions);
     wtap_init(true, application_configuration_environment_prefix(), file_extensions, num_extensions);
+    /* We read each file once, so it can be read through a memory mapping. */
+    wtap_set_file_mapping(true);
 
     /* Process the options */
     while ((opt = ws_getopt_long(argc, argv, optstring, long_options, NULL)) !=-1) {
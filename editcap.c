@@ -50,6 +50,7 @@
 
 #include <wsutil/clopts_common.h>
 #include <wsutil/cmdarg_err.h>
+#include <wsutil/crc32.h>
 #include <wsutil/filesystem.h>
 #include <app/application_flavor.h>
 #include <wsutil/file_util.h>
@@ -61,6 +62,7 @@
 #include <wsutil/version_info.h>
 #include <wsutil/pint.h>
 #include <wsutil/strtoi.h>
+#include <wsutil/time_util.h>
 #include <wsutil/ws_assert.h>
 #include <wsutil/wslog.h>
 #include <wsutil/report_message.h>
@@ -187,10 +189,12 @@ static void handle_chopping(chop_t chop, wtap_rec *rec, bool adjlen);
 static char *
 abs_time_to_str_with_sec_resolution(const nstime_t *abs_time)
 {
+    struct tm  tm;
     struct tm *tmp;
     char      *buf = (char *)g_malloc(16);
 
-    tmp = localtime(&abs_time->secs);
+    /* This is called from the threads of --split-threads. */
+    tmp = ws_localtime_r(&abs_time->secs, &tm);
 
     if (!(tmp && strftime(buf, 16, "%Y%m%d%H%M%S", tmp))) {
         buf[0] = '\0';
@@ -201,7 +205,7 @@ abs_time_to_str_with_sec_resolution(const nstime_t *abs_time)
 
 static char *
 fileset_get_filename_by_pattern(unsigned idx, const nstime_t *ts,
-                                char *fprefix, char *fsuffix)
+                                const char *fprefix, const char *fsuffix)
 {
     char  filenum[5+1];
     char *timestr;
@@ -1072,6 +1076,306 @@ sctp_split_and_write(wtap_dumper *pdh, wtap_rec *rec, int *write_err,
     return data_chunks_written;
 }
 
+/*
+ * The endpoints of a packet's flow, for --flow-shards.
+ */
+typedef struct {
+    const uint8_t *src;
+    const uint8_t *dst;
+    unsigned       addr_len;
+    uint8_t        proto;
+    uint16_t       sport;
+    uint16_t       dport;
+} flow_key_t;
+
+/* How many tunnels, VLAN tags or MPLS label stacks we look inside. */
+#define FLOW_MAX_DEPTH 8
+
+static bool flow_parse_ip(const uint8_t *buf, unsigned len, unsigned depth,
+                          flow_key_t *key);
+
+static bool
+flow_parse_ethertype(uint16_t ethertype, const uint8_t *buf, unsigned len,
+                     unsigned depth, flow_key_t *key)
+{
+    if (depth > FLOW_MAX_DEPTH)
+        return false;
+
+    switch (ethertype) {
+
+    case ETHERTYPE_VLAN:
+    case ETHERTYPE_IEEE_802_1AD:
+    case ETHERTYPE_QINQ_OLD:
+        if (len < 4)
+            return false;
+        return flow_parse_ethertype(pntohu16(buf + 2), buf + 4, len - 4,
+                                    depth + 1, key);
+
+    case ETHERTYPE_MPLS:
+    case ETHERTYPE_MPLS_MULTI:
+        /* Skip the label stack, up to the label with the bottom of stack bit. */
+        do {
+            if (len < 4)
+                return false;
+            buf += 4;
+            len -= 4;
+        } while (!(buf[-2] & 0x01));
+        if (len < 1)
+            return false;
+        /*
+         * There's no protocol field; guess from the first nibble, as
+         * the MPLS dissector does. 0 is a pseudowire control word,
+         * presumably followed by Ethernet.
+         */
+        switch (buf[0] >> 4) {
+
+        case 4:
+        case 6:
+            return flow_parse_ip(buf, len, depth + 1, key);
+
+        case 0:
+            if (len < 4 + 14)
+                return false;
+            return flow_parse_ethertype(pntohu16(buf + 4 + 12), buf + 4 + 14,
+                                        len - 4 - 14, depth + 1, key);
+
+        default:
+            return false;
+        }
+
+    case ETHERTYPE_IP:
+    case ETHERTYPE_IPv6:
+        return flow_parse_ip(buf, len, depth + 1, key);
+
+    case ETHERTYPE_ETHBRIDGE:
+        if (len < 14)
+            return false;
+        return flow_parse_ethertype(pntohu16(buf + 12), buf + 14, len - 14,
+                                    depth + 1, key);
+
+    default:
+        return false;
+    }
+}
+
+static bool
+flow_parse_ip(const uint8_t *buf, unsigned len, unsigned depth, flow_key_t *key)
+{
+    unsigned hdr_len;
+    uint8_t  proto;
+    bool     fragment;
+
+    if (len < 1)
+        return false;
+
+    switch (buf[0] >> 4) {
+
+    case 4:
+        hdr_len = (buf[0] & 0x0F) * 4;
+        if (hdr_len < 20 || len < hdr_len)
+            return false;
+        proto = buf[9];
+        /* More fragments, or a fragment offset */
+        fragment = (pntohu16(buf + 6) & 0x3FFF) != 0;
+        key->src = buf + 12;
+        key->dst = buf + 16;
+        key->addr_len = 4;
+        break;
+
+    case 6:
+        if (len < 40)
+            return false;
+        proto = buf[6];
+        fragment = false;
+        key->src = buf + 8;
+        key->dst = buf + 24;
+        key->addr_len = 16;
+        hdr_len = 40;
+        /* Skip the extension headers that can precede the payload. */
+        for (;;) {
+            unsigned ext_len;
+
+            if (proto != 0 && proto != 43 && proto != 44 && proto != 51 &&
+                proto != 60)
+                break;
+            if (len < hdr_len + 8)
+                return false;
+            if (proto == 44) {
+                /* Fragment; an offset or more fragments */
+                ext_len = 8;
+                fragment = (pntohu16(buf + hdr_len + 2) & 0xFFF9) != 0;
+            } else if (proto == 51) {
+                /* Authentication Header; the length is in 4 octet units */
+                ext_len = (buf[hdr_len + 1] + 2) * 4;
+            } else {
+                ext_len = (buf[hdr_len + 1] + 1) * 8;
+            }
+            proto = buf[hdr_len];
+            hdr_len += ext_len;
+            if (len < hdr_len)
+                return false;
+            if (fragment)
+                break;
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    key->proto = proto;
+    key->sport = 0;
+    key->dport = 0;
+
+    /*
+     * Only the first fragment has the transport header, so all of the
+     * fragments of a datagram are keyed by the addresses and protocol.
+     */
+    if (fragment)
+        return true;
+
+    buf += hdr_len;
+    len -= hdr_len;
+    switch (proto) {
+
+    case 6:   /* TCP */
+    case 17:  /* UDP */
+    case 33:  /* DCCP */
+    case 132: /* SCTP */
+    case 136: /* UDP-Lite */
+        if (len >= 4) {
+            key->sport = pntohu16(buf);
+            key->dport = pntohu16(buf + 2);
+        }
+        break;
+
+    case 4:   /* IPv4 in IP */
+    case 41:  /* IPv6 in IP */
+        /* Key by the inner packet if we can, otherwise by the tunnel. */
+        if (depth < FLOW_MAX_DEPTH) {
+            flow_key_t inner;
+
+            if (flow_parse_ip(buf, len, depth + 1, &inner))
+                *key = inner;
+        }
+        break;
+
+    case 47:  /* GRE */
+        /* Version 0 only; version 1 (PPTP) carries PPP. */
+        if (len >= 4 && (buf[1] & 0x07) == 0) {
+            unsigned   gre_len = 4;
+            flow_key_t inner;
+
+            if (buf[0] & 0x80)  /* Checksum present */
+                gre_len += 4;
+            if (buf[0] & 0x20)  /* Key present */
+                gre_len += 4;
+            if (buf[0] & 0x10)  /* Sequence number present */
+                gre_len += 4;
+            if (len >= gre_len &&
+                flow_parse_ethertype(pntohu16(buf + 2), buf + gre_len,
+                                     len - gre_len, depth + 1, &inner))
+                *key = inner;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return true;
+}
+
+/*
+ * Return the output file of --flow-shards to which a record goes.
+ *
+ * IP packets are assigned by a hash of the addresses, protocol and (for
+ * protocols with ports) ports that is the same for both directions, so
+ * that all of a flow ends up in the same file; the packets in tunnels are
+ * assigned by the inner packet. Everything else goes to the first file.
+ */
+static unsigned
+flow_shard(const wtap_rec *rec, unsigned num_shards)
+{
+    const uint8_t *buf;
+    unsigned       len;
+    flow_key_t     key;
+    bool           found;
+    uint8_t        hash_data[16 + 16 + 2 + 2 + 1];
+    unsigned       hash_len;
+    const uint8_t *addr_lo, *addr_hi;
+    uint16_t       port_lo, port_hi;
+    int            cmp;
+
+    if (num_shards == 1 || rec->rec_type != REC_TYPE_PACKET)
+        return 0;
+
+    buf = ws_buffer_start_ptr(&rec->data);
+    len = rec->rec_header.packet_header.caplen;
+
+    switch (rec->rec_header.packet_header.pkt_encap) {
+
+    case WTAP_ENCAP_ETHERNET:
+        found = len >= 14 &&
+                flow_parse_ethertype(pntohu16(buf + 12), buf + 14, len - 14, 0, &key);
+        break;
+
+    case WTAP_ENCAP_SLL:
+        found = len >= sizeof(struct sll_header) &&
+                flow_parse_ethertype(pntohu16(buf + offsetof(struct sll_header, sll_protocol)),
+                                     buf + sizeof(struct sll_header),
+                                     len - (unsigned)sizeof(struct sll_header), 0, &key);
+        break;
+
+    case WTAP_ENCAP_SLL2:
+        found = len >= sizeof(struct sll2_header) &&
+                flow_parse_ethertype(pntohu16(buf + offsetof(struct sll2_header, sll2_protocol)),
+                                     buf + sizeof(struct sll2_header),
+                                     len - (unsigned)sizeof(struct sll2_header), 0, &key);
+        break;
+
+    case WTAP_ENCAP_NULL:
+    case WTAP_ENCAP_LOOP:
+        /* A 4 byte address family in an unknown byte order */
+        found = len >= 4 && flow_parse_ip(buf + 4, len - 4, 0, &key);
+        break;
+
+    case WTAP_ENCAP_RAW_IP:
+    case WTAP_ENCAP_RAW_IP4:
+    case WTAP_ENCAP_RAW_IP6:
+        found = flow_parse_ip(buf, len, 0, &key);
+        break;
+
+    default:
+        found = false;
+        break;
+    }
+    if (!found)
+        return 0;
+
+    /* Put the endpoints in a fixed order, so both directions hash the same. */
+    cmp = memcmp(key.src, key.dst, key.addr_len);
+    if (cmp < 0 || (cmp == 0 && key.sport <= key.dport)) {
+        addr_lo = key.src;
+        addr_hi = key.dst;
+        port_lo = key.sport;
+        port_hi = key.dport;
+    } else {
+        addr_lo = key.dst;
+        addr_hi = key.src;
+        port_lo = key.dport;
+        port_hi = key.sport;
+    }
+    memcpy(hash_data, addr_lo, key.addr_len);
+    memcpy(hash_data + key.addr_len, addr_hi, key.addr_len);
+    hash_len = 2 * key.addr_len;
+    phtonu16(hash_data + hash_len, port_lo);
+    phtonu16(hash_data + hash_len + 2, port_hi);
+    hash_data[hash_len + 4] = key.proto;
+    hash_len += 5;
+
+    return crc32c_calculate_no_swap(hash_data, (int)hash_len, CRC32C_PRELOAD) % num_shards;
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1177,6 +1481,9 @@ print_usage(FILE *output)
     fprintf(output, "  -i <seconds per file>  split the packet output to different files based on\n");
     fprintf(output, "                         uniform time intervals with a maximum of\n");
     fprintf(output, "                         <seconds per file> each.\n");
+    fprintf(output, "  --flow-shards <files>  split the packet output to <files> files, writing all\n");
+    fprintf(output, "                         of the packets of each IP flow, in both directions,\n");
+    fprintf(output, "                         to the same file.\n");
     fprintf(output, "  -F <capture type>      set the output file type; default is pcapng.\n");
     fprintf(output, "                         An empty \"-F\" option will list the file types.\n");
     fprintf(output, "  -T <encap type>        set the output file encapsulation type; default is the\n");
@@ -1201,6 +1508,10 @@ print_usage(FILE *output)
     fprintf(output, "                         comments added by \"--capture-comment\" in the same\n");
     fprintf(output, "                         command line.\n");
     fprintf(output, "  --compress <type>      Compress the output file using the type compression format.\n");
+    fprintf(output, "  --split-threads <threads>\n");
+    fprintf(output, "                         write the files of -c or -i from <threads> threads.\n");
+    fprintf(output, "                         Incompatible with options besides -A, -B, -c, -F,\n");
+    fprintf(output, "                         -i, -V, and --compress.\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h, --help             display this help and exit.\n");
@@ -1404,8 +1715,8 @@ editcap_dump_open(const char *filename, const wtap_dump_params *params,
 }
 
 static bool
-process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
-                 int *err, char **err_info)
+process_new_idbs(wtap *wth, wtap_dumper **pdhs, unsigned num_pdhs,
+                 GArray *idbs_seen, int *err, char **err_info)
 {
     wtap_block_t if_data;
 
@@ -1417,7 +1728,7 @@ process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
          * That mean that the abstract interface provided by libwiretap
          * involves WTAP_BLOCK_IF_ID_AND_INFO blocks.
          */
-        if (pdh != NULL && wtap_file_type_subtype_supports_block(wtap_dump_file_type_subtype(pdh),
+        if (wtap_file_type_subtype_supports_block(out_file_type_subtype,
                                                   WTAP_BLOCK_IF_ID_AND_INFO) != BLOCK_NOT_SUPPORTED) {
             wtap_block_t if_data_copy;
 
@@ -1439,12 +1750,18 @@ process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
             }
 
             /*
-             * Add this possibly-modified IDB to the file to which
-             * we're currently writing.
+             * Add this possibly-modified IDB to the files to which
+             * we're currently writing. That's more than one file with
+             * --flow-shards, and, with --split-threads, none if this
+             * thread isn't writing the current file.
              */
-            if (!wtap_dump_add_idb(pdh, if_data_copy, err, err_info)) {
-                wtap_block_unref(if_data_copy);
-                return false;
+            for (unsigned i = 0; i < num_pdhs; i++) {
+                if (pdhs[i] == NULL)
+                    continue;
+                if (!wtap_dump_add_idb(pdhs[i], if_data_copy, err, err_info)) {
+                    wtap_block_unref(if_data_copy);
+                    return false;
+                }
             }
 
             /*
@@ -1465,6 +1782,402 @@ process_new_idbs(wtap *wth, wtap_dumper *pdh, GArray *idbs_seen,
     return true;
 }
 
+/*
+ * Open all of the output files of --flow-shards.
+ */
+static bool
+flow_shards_open(wtap_dumper **pdhs, char **filenames, unsigned num_shards,
+                 const char *fprefix, const char *fsuffix,
+                 const wtap_dump_params *params, GArray *idbs_seen,
+                 ws_compression_type compression_type)
+{
+    int   err;
+    char *err_info;
+
+    for (unsigned k = 0; k < num_shards; k++) {
+        filenames[k] = fileset_get_filename_by_pattern(k, NULL, fprefix, fsuffix);
+        ws_assert(filenames[k]);
+
+        /* Each of the files releases the DSBs from the command line
+         * when it's closed.
+         */
+        if (k > 0)
+            wtap_block_array_ref(params->dsbs_initial);
+        pdhs[k] = editcap_dump_open(filenames[k], params, idbs_seen, &err,
+                                    &err_info, compression_type);
+        if (pdhs[k] == NULL) {
+            report_cfile_dump_open_failure(filenames[k], err, err_info,
+                                           out_file_type_subtype);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * State of one of the threads writing the output files when splitting
+ * with --split-threads.
+ *
+ * Every thread reads the whole input file with its own wtap, so that all
+ * of them see the same interfaces, name resolution records etc. and make
+ * the same decisions about which file each record goes to, but each one
+ * only writes the files whose number, modulo the number of threads, is
+ * its own thread number.
+ */
+typedef struct {
+    GThread            *thread;
+    wtap               *wth;
+    const char         *in_filename;
+    const char         *out_filename;
+    const char         *fprefix;
+    const char         *fsuffix;
+    ws_compression_type compression_type;
+    uint64_t            split_packet_count;
+    nstime_t            secs_per_block;
+    unsigned            thread_num;
+    unsigned            num_threads;
+    uint64_t            written_count;  /* records written by this thread */
+    int                 ret;
+} split_thread_t;
+
+/* Keeps the threads' error messages from being interleaved. */
+static GMutex split_report_mutex;
+
+static bool
+split_thread_owns_file(const split_thread_t *st, unsigned file_num)
+{
+    return file_num % st->num_threads == st->thread_num;
+}
+
+/*
+ * Ask for the data of the records we read to be skipped or not; returns
+ * true if it will be skipped.
+ */
+static bool
+split_thread_skip_data(const split_thread_t *st, bool skip)
+{
+    return wtap_set_headers_only(st->wth, skip) && skip;
+}
+
+/*
+ * Close the current output file, if this thread is writing it, and go on
+ * to the next one, opening it if this thread is to write it.
+ */
+static bool
+split_thread_next_file(split_thread_t *st, wtap_dump_params *params,
+                       GArray *idbs_seen, wtap_dumper **pdh, char **filename,
+                       unsigned *file_num, const nstime_t *ts)
+{
+    int   err;
+    char *err_info;
+
+    if (*pdh != NULL) {
+        /* We presumably want to write the DSBs from files given
+         * on the command line to every file.
+         */
+        wtap_block_array_ref(params->dsbs_initial);
+        if (!wtap_dump_close(*pdh, NULL, &err, &err_info)) {
+            *pdh = NULL;
+            g_mutex_lock(&split_report_mutex);
+            report_cfile_close_failure(*filename, err, err_info);
+            g_mutex_unlock(&split_report_mutex);
+            st->ret = WRITE_ERROR;
+            return false;
+        }
+        *pdh = NULL;
+    }
+
+    g_free(*filename);
+    *filename = fileset_get_filename_by_pattern(*file_num, ts, st->fprefix, st->fsuffix);
+    ws_assert(*filename);
+    if (!split_thread_owns_file(st, (*file_num)++))
+        return true;
+
+    if (verbose && *file_num > 1)
+        fprintf(stderr, "Continuing writing in file %s\n", *filename);
+
+    *pdh = editcap_dump_open(*filename, params, idbs_seen, &err, &err_info,
+                             st->compression_type);
+    if (*pdh == NULL) {
+        g_mutex_lock(&split_report_mutex);
+        report_cfile_dump_open_failure(*filename, err, err_info,
+                                       out_file_type_subtype);
+        g_mutex_unlock(&split_report_mutex);
+        st->ret = WS_EXIT_INVALID_FILE;
+        return false;
+    }
+    return true;
+}
+
+static void *
+split_thread_main(void *data)
+{
+    split_thread_t   *st = (split_thread_t *)data;
+    wtap_dump_params  params = WTAP_DUMP_PARAMS_INIT;
+    GArray           *idbs_seen;
+    wtap_dumper      *pdh = NULL;
+    char             *filename = NULL;
+    char             *shb_user_appl;
+    wtap_rec          rec;
+    int64_t           data_offset;
+    uint64_t          read_count = 0;
+    uint64_t          written_count = 0;
+    unsigned          file_num = 0;
+    nstime_t          block_next = NSTIME_INIT_UNSET;
+    const nstime_t   *ts;
+    bool              ts_okay;
+    bool              skipped_data;
+    int               err;
+    char             *err_info;
+
+    wtap_rec_init(&rec, DEFAULT_INIT_BUFFER_SIZE_2048);
+    wtap_dump_params_init_no_idbs(&params, st->wth);
+
+    /* If we don't have an application name add one */
+    if (wtap_block_get_string_option_value(g_array_index(params.shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, &shb_user_appl) != WTAP_OPTTYPE_SUCCESS) {
+        wtap_block_add_string_option_format(g_array_index(params.shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, "%s", get_appname_and_version());
+    }
+
+    idbs_seen = g_array_new(FALSE, FALSE, sizeof(wtap_block_t));
+
+    /*
+     * We only need the data of the records that go to the files we write.
+     * Which file a record goes to isn't known until its header has been
+     * read, so assume that it's the file the previous record went to, and
+     * go back for the data if that turns out to be wrong; that only
+     * happens around the start of a file.
+     */
+    skipped_data = split_thread_skip_data(st, !split_thread_owns_file(st, 0));
+
+    while (wtap_read(st->wth, &rec, &err, &err_info, &data_offset)) {
+        read_count++;
+        ts = (rec.presence_flags & WTAP_HAS_TS) ? &rec.ts : NULL;
+
+        if (read_count == 1) {
+            if (!split_thread_next_file(st, &params, idbs_seen, &pdh,
+                                        &filename, &file_num, ts))
+                goto done;
+        }
+
+        /*
+         * Process whatever IDBs we haven't seen yet.
+         */
+        if (!process_new_idbs(st->wth, &pdh, 1, idbs_seen, &err, &err_info)) {
+            g_mutex_lock(&split_report_mutex);
+            report_cfile_write_failure(st->in_filename, filename,
+                                       err, err_info, read_count,
+                                       out_file_type_subtype);
+            g_mutex_unlock(&split_report_mutex);
+            st->ret = DUMP_ERROR;
+            goto done;
+        }
+
+        /*
+         * Go on to the next file at the same records as editcap does
+         * when it's splitting in one thread.
+         */
+        if (ts != NULL && !nstime_is_unset(&st->secs_per_block)) {
+            if (nstime_is_unset(&block_next)) {
+                block_next = rec.ts;
+                nstime_add(&block_next, &st->secs_per_block);
+            }
+            while (nstime_cmp(&rec.ts, &block_next) > 0) {
+                /* Use the interval start time for the filename. */
+                if (!split_thread_next_file(st, &params, idbs_seen, &pdh,
+                                            &filename, &file_num, &block_next))
+                    goto done;
+                nstime_add(&block_next, &st->secs_per_block);
+            }
+        }
+
+        if (st->split_packet_count != 0 && written_count > 0 &&
+            (written_count % st->split_packet_count) == 0) {
+            if (!split_thread_next_file(st, &params, idbs_seen, &pdh,
+                                        &filename, &file_num, ts))
+                goto done;
+        }
+
+        if (check_startstop) {
+            ts_okay = false;
+            if (ts != NULL) {
+                if (have_starttime && have_stoptime) {
+                    ts_okay = nstime_cmp(ts, &starttime) >= 0 &&
+                              nstime_cmp(ts, &stoptime) < 0;
+                } else if (have_starttime) {
+                    ts_okay = nstime_cmp(ts, &starttime) >= 0;
+                } else if (have_stoptime) {
+                    ts_okay = nstime_cmp(ts, &stoptime) < 0;
+                }
+            }
+        } else {
+            ts_okay = true;
+        }
+
+        if (ts_okay) {
+            if (pdh != NULL) {
+                if (skipped_data) {
+                    /* The record starts one of our files; get its data. */
+                    wtap_rec_reset(&rec);
+                    if (!wtap_seek_read(st->wth, data_offset, &rec, &err, &err_info))
+                        break;
+                }
+                if (!wtap_dump(pdh, &rec, &err, &err_info)) {
+                    g_mutex_lock(&split_report_mutex);
+                    report_cfile_write_failure(st->in_filename, filename,
+                                               err, err_info, read_count,
+                                               out_file_type_subtype);
+                    g_mutex_unlock(&split_report_mutex);
+                    st->ret = DUMP_ERROR;
+                    goto done;
+                }
+                st->written_count++;
+            }
+            written_count++;
+        }
+
+        skipped_data = split_thread_skip_data(st, pdh == NULL);
+        wtap_rec_reset(&rec);
+    }
+
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the
+         * line. */
+        g_mutex_lock(&split_report_mutex);
+        report_cfile_read_failure(st->in_filename, err, err_info);
+        g_mutex_unlock(&split_report_mutex);
+    }
+
+    if (read_count == 0 && st->thread_num == 0) {
+        /* No valid packets found, open the outfile so we can write an
+         * empty header */
+        filename = g_strdup(st->out_filename);
+        pdh = editcap_dump_open(filename, &params, idbs_seen, &err,
+                                &err_info, st->compression_type);
+        if (pdh == NULL) {
+            g_mutex_lock(&split_report_mutex);
+            report_cfile_dump_open_failure(filename, err, err_info,
+                                           out_file_type_subtype);
+            g_mutex_unlock(&split_report_mutex);
+            st->ret = WS_EXIT_INVALID_FILE;
+            goto done;
+        }
+    }
+
+    if (pdh != NULL) {
+        /*
+         * Process whatever IDBs we haven't seen yet.
+         */
+        if (!process_new_idbs(st->wth, &pdh, 1, idbs_seen, &err, &err_info)) {
+            g_mutex_lock(&split_report_mutex);
+            report_cfile_write_failure(st->in_filename, filename,
+                                       err, err_info, read_count,
+                                       out_file_type_subtype);
+            g_mutex_unlock(&split_report_mutex);
+            st->ret = DUMP_ERROR;
+            goto done;
+        }
+
+        if (!wtap_dump_close(pdh, NULL, &err, &err_info)) {
+            pdh = NULL;
+            g_mutex_lock(&split_report_mutex);
+            report_cfile_close_failure(filename, err, err_info);
+            g_mutex_unlock(&split_report_mutex);
+            st->ret = WRITE_ERROR;
+            goto done;
+        }
+        pdh = NULL;
+    }
+
+done:
+    if (pdh != NULL) {
+        /*
+         * Close the dump file, but don't report an error, as we've
+         * already reported one.
+         */
+        wtap_dump_close(pdh, NULL, &err, &err_info);
+        g_free(err_info);
+    }
+    g_free(filename);
+    for (unsigned b = 0; b < idbs_seen->len; b++) {
+        wtap_block_t if_data = g_array_index(idbs_seen, wtap_block_t, b);
+        wtap_block_unref(if_data);
+    }
+    g_array_free(idbs_seen, TRUE);
+    g_free(params.idb_inf);
+    wtap_dump_params_cleanup(&params);
+    wtap_rec_cleanup(&rec);
+    return NULL;
+}
+
+/*
+ * Split the input file with -c or -i, writing the output files from
+ * num_threads threads.
+ */
+static int
+split_in_threads(const char *in_filename, const char *out_filename,
+                 unsigned num_threads, const char *fprefix,
+                 const char *fsuffix, ws_compression_type compression_type,
+                 uint64_t split_packet_count, nstime_t secs_per_block)
+{
+    split_thread_t *threads;
+    uint64_t        written_count = 0;
+    int             ret = EXIT_SUCCESS;
+    int             err;
+    char           *err_info;
+    unsigned        n;
+
+    threads = g_new0(split_thread_t, num_threads);
+
+    /*
+     * Open the input file once for each thread, with random access, so
+     * that a thread can go back for the data of a record it read without
+     * it.
+     */
+    for (n = 0; n < num_threads; n++) {
+        split_thread_t *st = &threads[n];
+
+        st->wth = wtap_open_offline(in_filename, WTAP_TYPE_AUTO, &err, &err_info,
+                                    true, application_configuration_environment_prefix());
+        if (st->wth == NULL) {
+            report_cfile_open_failure(in_filename, err, err_info);
+            ret = WS_EXIT_INVALID_FILE;
+            goto done;
+        }
+        st->in_filename = in_filename;
+        st->out_filename = out_filename;
+        st->fprefix = fprefix;
+        st->fsuffix = fsuffix;
+        st->compression_type = compression_type;
+        st->split_packet_count = split_packet_count;
+        st->secs_per_block = secs_per_block;
+        st->thread_num = n;
+        st->num_threads = num_threads;
+        st->ret = EXIT_SUCCESS;
+    }
+
+    for (n = 0; n < num_threads; n++) {
+        threads[n].thread = g_thread_new("editcap split", split_thread_main, &threads[n]);
+    }
+
+    for (n = 0; n < num_threads; n++) {
+        g_thread_join(threads[n].thread);
+        written_count += threads[n].written_count;
+        if (ret == EXIT_SUCCESS)
+            ret = threads[n].ret;
+    }
+
+    if (verbose)
+        fprintf(stderr, "Total selected: %" PRIu64 "\n", written_count);
+
+done:
+    for (n = 0; n < num_threads; n++) {
+        if (threads[n].wth != NULL)
+            wtap_close(threads[n].wth);
+    }
+    g_free(threads);
+    return ret;
+}
+
 static int
 extract_secrets(wtap *wth, char* filename, int *err, char **err_info)
 {
@@ -1565,6 +2278,8 @@ main(int argc, char *argv[])
 #define LONGOPT_COMPRESS                 LONGOPT_BASE_APPLICATION+12
 #define LONGOPT_SCTP_SPLIT               LONGOPT_BASE_APPLICATION+13
 #define LONGOPT_DISCARD_NAME_RESOLUTION  LONGOPT_BASE_APPLICATION+14
+#define LONGOPT_SPLIT_THREADS            LONGOPT_BASE_APPLICATION+15
+#define LONGOPT_FLOW_SHARDS              LONGOPT_BASE_APPLICATION+16
 
     static const struct ws_option long_options[] = {
         {"novlan", ws_no_argument, NULL, LONGOPT_NO_VLAN},
@@ -1583,6 +2298,8 @@ main(int argc, char *argv[])
         {"extract-secrets", ws_no_argument, NULL, LONGOPT_EXTRACT_SECRETS},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
         {"sctp-split", ws_no_argument, NULL, LONGOPT_SCTP_SPLIT},
+        {"split-threads", ws_required_argument, NULL, LONGOPT_SPLIT_THREADS},
+        {"flow-shards", ws_required_argument, NULL, LONGOPT_FLOW_SHARDS},
         LONGOPT_WSLOG
         {0, 0, 0, 0 }
     };
@@ -1622,6 +2339,13 @@ main(int argc, char *argv[])
     bool                         edit_option_specified = false;
     ws_compression_type compression_type   = WS_FILE_UNKNOWN_COMPRESSION;
     bool                         sctp_split = false;
+    int                          split_threads = 1;
+    bool                         split_threads_ok = true;
+    int                          flow_shards = 0;
+    wtap_dumper                **shard_pdhs = NULL;
+    char                       **shard_filenames = NULL;
+    wtap_dumper                **out_pdhs = &pdh;
+    unsigned                     num_out_pdhs = 1;
     const struct file_extension_info* file_extensions;
     unsigned num_extensions;
 
@@ -1673,6 +2397,25 @@ main(int argc, char *argv[])
         if (opt != LONGOPT_EXTRACT_SECRETS && opt != 'V') {
             edit_option_specified = true;
         }
+        /*
+         * The threads of --split-threads only select and split records;
+         * they don't edit them.
+         */
+        switch (opt) {
+        case 'A':
+        case 'B':
+        case 'c':
+        case 'F':
+        case 'i':
+        case 'V':
+        case LONGOPT_COMPRESS:
+        case LONGOPT_SPLIT_THREADS:
+            break;
+        default:
+            if (!ws_log_is_wslog_arg(opt))
+                split_threads_ok = false;
+            break;
+        }
         switch (opt) {
         case LONGOPT_NO_VLAN:
         {
@@ -1824,6 +2567,26 @@ main(int argc, char *argv[])
             sctp_split = true;
             break;
 
+        case LONGOPT_SPLIT_THREADS:
+            if (!get_positive_int(ws_optarg, "number of split threads", &split_threads)) {
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+
+        case LONGOPT_FLOW_SHARDS:
+            if (!get_positive_int(ws_optarg, "number of flow shards", &flow_shards)) {
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+            }
+            if (flow_shards > RINGBUFFER_MAX_NUM_FILES) {
+                cmdarg_err("The number of flow shards must be at most %d",
+                        RINGBUFFER_MAX_NUM_FILES);
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+
         case 'a':
         {
             uint64_t frame_number;
@@ -2156,7 +2919,7 @@ main(int argc, char *argv[])
       out_file_type_subtype = wtap_pcapng_file_type_subtype();
     }
 
-    if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block)) {
+    if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block) || flow_shards != 0) {
         if (!fileset_extract_prefix_suffix(argv[ws_optind+1], &fprefix, &fsuffix, &compression_type)) {
             ret = CANT_EXTRACT_PREFIX;
             goto clean_exit;
@@ -2213,6 +2976,33 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (flow_shards != 0) {
+        if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block)) {
+            cmdarg_err("can't split on flows and on packet count or time interval");
+            cmdarg_err_cont("at the same time");
+            ret = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+        shard_pdhs = g_new0(wtap_dumper *, flow_shards);
+        shard_filenames = g_new0(char *, flow_shards + 1);
+        out_pdhs = shard_pdhs;
+        num_out_pdhs = (unsigned)flow_shards;
+    }
+
+    if (split_threads > 1) {
+        if (split_packet_count == 0 && nstime_is_unset(&secs_per_block)) {
+            cmdarg_err("--split-threads requires -c or -i");
+            ret = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+        if (!split_threads_ok || (argc - ws_optind) > 2) {
+            cmdarg_err("--split-threads can't be used with options other than");
+            cmdarg_err_cont("-A, -B, -c, -F, -i, -V, and --compress, or with packet selections");
+            ret = WS_EXIT_INVALID_OPTION;
+            goto clean_exit;
+        }
+    }
+
     wth = wtap_open_offline(argv[ws_optind], WTAP_TYPE_AUTO, &read_err, &read_err_info, false, application_configuration_environment_prefix());
 
     if (!wth) {
@@ -2270,6 +3060,14 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    if (split_threads > 1) {
+        ret = split_in_threads(argv[ws_optind], argv[ws_optind+1],
+                               (unsigned)split_threads, fprefix, fsuffix,
+                               compression_type, split_packet_count,
+                               secs_per_block);
+        goto clean_exit;
+    }
+
     wtap_dump_params_init_no_idbs(&params, wth);
 
     /*
@@ -2409,22 +3207,34 @@ main(int argc, char *argv[])
 
         /* Extra actions for the first packet */
         if (read_count == 1) {
-            if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block)) {
-                filename = fileset_get_filename_by_pattern(block_cnt++,
-                                                           (read_rec.presence_flags & WTAP_HAS_TS) ? &read_rec.ts : NULL,
-                                                           fprefix, fsuffix);
-            } else {
-                filename = g_strdup(argv[ws_optind+1]);
-            }
-            ws_assert(filename);
-
             /* If we don't have an application name add one */
             if (wtap_block_get_string_option_value(g_array_index(params.shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, &shb_user_appl) != WTAP_OPTTYPE_SUCCESS) {
                 wtap_block_add_string_option_format(g_array_index(params.shb_hdrs, wtap_block_t, 0), OPT_SHB_USERAPPL, "%s", get_appname_and_version());
             }
 
-            pdh = editcap_dump_open(filename, &params, idbs_seen, &write_err,
-                                    &write_err_info, compression_type);
+            if (flow_shards != 0) {
+                if (!flow_shards_open(shard_pdhs, shard_filenames, num_out_pdhs,
+                                      fprefix, fsuffix, &params, idbs_seen,
+                                      compression_type)) {
+                    ret = WS_EXIT_INVALID_FILE;
+                    goto clean_exit;
+                }
+                /* The file is chosen for each record as it's written. */
+                pdh = shard_pdhs[0];
+                filename = shard_filenames[0];
+            } else {
+                if (split_packet_count != 0 || !nstime_is_unset(&secs_per_block)) {
+                    filename = fileset_get_filename_by_pattern(block_cnt++,
+                                                               (read_rec.presence_flags & WTAP_HAS_TS) ? &read_rec.ts : NULL,
+                                                               fprefix, fsuffix);
+                } else {
+                    filename = g_strdup(argv[ws_optind+1]);
+                }
+                ws_assert(filename);
+
+                pdh = editcap_dump_open(filename, &params, idbs_seen, &write_err,
+                                        &write_err_info, compression_type);
+            }
 
             if (pdh == NULL) {
                 report_cfile_dump_open_failure(filename,
@@ -2438,7 +3248,7 @@ main(int argc, char *argv[])
         /*
          * Process whatever IDBs we haven't seen yet.
          */
-        if (!process_new_idbs(wth, pdh, idbs_seen, &write_err, &write_err_info)) {
+        if (!process_new_idbs(wth, out_pdhs, num_out_pdhs, idbs_seen, &write_err, &write_err_info)) {
             report_cfile_write_failure(argv[ws_optind], filename,
                                        write_err, write_err_info,
                                        read_count,
@@ -2564,6 +3374,14 @@ main(int argc, char *argv[])
                         || (selected(count) && keep_em))) {
             /* Write the record, possibly after modifying it. */
 
+            if (flow_shards != 0) {
+                /* Choose the file by the record as it was read. */
+                unsigned shard = flow_shard(&read_rec, num_out_pdhs);
+
+                pdh = shard_pdhs[shard];
+                filename = shard_filenames[shard];
+            }
+
             if (verbose && !dup_detect && !dup_detect_by_time)
                 fprintf(stderr, "Packet: %" PRIu64 "\n", count);
 
@@ -2804,7 +3622,8 @@ main(int argc, char *argv[])
                  * Discard any secrets we've read since the last packet
                  * we wrote.
                  */
-                wtap_dump_discard_decryption_secrets(pdh);
+                for (unsigned k = 0; k < num_out_pdhs; k++)
+                    wtap_dump_discard_decryption_secrets(out_pdhs[k]);
             }
 
             /* Attempt to dump out current frame to the output file */
@@ -2864,7 +3683,18 @@ main(int argc, char *argv[])
         report_cfile_read_failure(argv[ws_optind], read_err, read_err_info);
     }
 
-    if (!pdh) {
+    if (!pdh && flow_shards != 0) {
+        /* No valid packets found, open all of the outfiles so we can
+         * write empty headers */
+        if (!flow_shards_open(shard_pdhs, shard_filenames, num_out_pdhs,
+                              fprefix, fsuffix, &params, idbs_seen,
+                              compression_type)) {
+            ret = WS_EXIT_INVALID_FILE;
+            goto clean_exit;
+        }
+        pdh = shard_pdhs[0];
+        filename = shard_filenames[0];
+    } else if (!pdh) {
         /* No valid packets found, open the outfile so we can write an
          * empty header */
         g_free (filename);
@@ -2884,7 +3714,7 @@ main(int argc, char *argv[])
     /*
      * Process whatever IDBs we haven't seen yet.
      */
-    if (!process_new_idbs(wth, pdh, idbs_seen, &write_err, &write_err_info)) {
+    if (!process_new_idbs(wth, out_pdhs, num_out_pdhs, idbs_seen, &write_err, &write_err_info)) {
         report_cfile_write_failure(argv[ws_optind], filename,
                                    write_err, write_err_info,
                                    read_count,
@@ -2900,7 +3730,20 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
-    if (!wtap_dump_close(pdh, NULL, &write_err, &write_err_info)) {
+    if (flow_shards != 0) {
+        for (unsigned k = 0; k < num_out_pdhs; k++) {
+            wtap_dumper *shard_pdh = shard_pdhs[k];
+
+            shard_pdhs[k] = NULL;
+            if (!wtap_dump_close(shard_pdh, NULL, &write_err, &write_err_info)) {
+                report_cfile_close_failure(shard_filenames[k], write_err,
+                                           write_err_info);
+                ret = WRITE_ERROR;
+            }
+        }
+        if (ret != EXIT_SUCCESS)
+            goto clean_exit;
+    } else if (!wtap_dump_close(pdh, NULL, &write_err, &write_err_info)) {
         report_cfile_close_failure(filename, write_err, write_err_info);
         ret = WRITE_ERROR;
         goto clean_exit;
@@ -2922,6 +3765,22 @@ clean_exit:
     g_free(fprefix);
     g_free(fsuffix);
 
+    if (shard_pdhs != NULL) {
+        /*
+         * Close the files of --flow-shards that were left open by an
+         * error, without reporting errors; pdh has already been closed.
+         */
+        for (unsigned k = 0; k < num_out_pdhs; k++) {
+            if (shard_pdhs[k] != NULL && shard_pdhs[k] != pdh) {
+                wtap_dump_close(shard_pdhs[k], NULL, &write_err, &write_err_info);
+                g_free(write_err_info);
+            }
+        }
+        g_free(shard_pdhs);
+        /* filename is one of these */
+        g_strfreev(shard_filenames);
+        filename = NULL;
+    }
     if (filename) {
         g_free(filename);
     }
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 #include <wsutil/strtoi.h>
 #include <wsutil/ws_assert.h>
@@ -87,6 +88,7 @@
 
 #include <wsutil/report_message.h>
 #include <wsutil/file_util.h>
+#include <wsutil/tempfile.h>
 #include <wsutil/pint.h>
 #include <wsutil/inet_cidr.h>
 
@@ -108,6 +110,7 @@
 #define ENAME_SS7PCS    "ss7pcs"
 #define ENAME_ENTERPRISES "enterprises"
 #define ENAME_TACS      "tacs"
+#define ENAME_DNS_CACHE "dns_cache"
 
 #define HASHETHSIZE      2048
 #define HASHHOSTSIZE     2048
@@ -271,10 +274,14 @@ static wmem_map_t *serv_port_custom_hashtable;
 static GHashTable *enterprises_hashtable;
 
 static subnet_length_entry_t subnet_length_entries[SUBNETLENGTHSIZE]; /* Ordered array of entries */
-static bool have_subnet_entry;
+/* Mask lengths that have entries, longest first, so that a lookup only
+ * probes the lengths that are actually used in the subnets files. */
+static uint8_t subnet_lengths[SUBNETLENGTHSIZE];
+static unsigned num_subnet_lengths;
 
 static subnet_length_entry_v6_t subnet_length_entries_v6[SUBNETLENGTHSIZE_V6]; /* IPv6 subnet entries */
-static bool have_subnet_entry_v6;
+static uint8_t subnet_lengths_v6[SUBNETLENGTHSIZE_V6];
+static unsigned num_subnet_lengths_v6;
 
 static bool new_resolved_objects;
 
@@ -350,6 +357,7 @@ e_addr_resolve gbl_resolv_flags = {
  */
 static unsigned name_resolve_concurrency = 500;
 static bool resolve_synchronously;
+static unsigned dns_cache_lifetime;     /* hours; 0 disables the cache */
 
 /*
  *  Global variables (can be changed in GUI sections)
@@ -396,6 +404,9 @@ typedef struct _async_hostent {
 static void
 c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he);
 
+static void
+dns_cache_add(int family, const void *addr, const char *name);
+
 /*
  * Submitted synchronous queries trigger a callback (c_ares_ghba_sync_cb()).
  * The callback processes the response, sets completed to true if
@@ -496,6 +507,7 @@ c_ares_ghba_sync_cb(void *arg, int status, int timeouts _U_, struct hostent *he)
     char **p;
 
     if (status == ARES_SUCCESS) {
+        dns_cache_add(sdd->family, &sdd->addr, he->h_name);
         for (p = he->h_addr_list; *p != NULL; p++) {
             switch(sdd->family) {
                 case AF_INET:
@@ -510,6 +522,8 @@ c_ares_ghba_sync_cb(void *arg, int status, int timeouts _U_, struct hostent *he)
             }
         }
 
+    } else if (status == ARES_ENOTFOUND) {
+        dns_cache_add(sdd->family, &sdd->addr, NULL);
     }
 
     /*
@@ -1325,6 +1339,225 @@ fill_dummy_ip6(hashipv6_t* volatile tp)
     }
 }
 
+/*
+ * Persistent cache of the names returned by the external resolver, and of
+ * the addresses it couldn't resolve, so that reopening the same captures
+ * doesn't send the same queries again. It is kept in the personal
+ * configuration directory, one "<address> <expiry time> [<name>]" line
+ * per address, and is only used if the dns_cache_lifetime preference is
+ * non-zero.
+ *
+ * Entries expire dns_cache_lifetime hours after the lookup, whatever the
+ * TTL of the DNS records was: ares_gethostbyaddr() doesn't return TTLs,
+ * and also answers from the hosts file, which ares_query() for PTR
+ * records wouldn't.
+ */
+typedef struct _dns_cache_entry {
+    time_t  expires;
+    char    name[MAXDNSNAMELEN]; /* empty if the lookup failed */
+} dns_cache_entry_t;
+
+// Maps unsigned -> dns_cache_entry_t*
+static wmem_map_t *dns_cache_ipv4;
+// Maps ws_in6_addr* -> dns_cache_entry_t*
+static wmem_map_t *dns_cache_ipv6;
+static char *dns_cache_path;
+static const char *dns_cache_app_env_var_prefix;
+static bool dns_cache_loaded;
+static bool dns_cache_changed;
+
+static void
+dns_cache_set_entry(int family, const void *addr, const char *name, time_t expires)
+{
+    dns_cache_entry_t *entry;
+
+    if (family == AF_INET) {
+        uint32_t ip4 = *(const uint32_t *)addr;
+
+        entry = (dns_cache_entry_t *)wmem_map_lookup(dns_cache_ipv4, GUINT_TO_POINTER(ip4));
+        if (entry == NULL) {
+            entry = wmem_new(addr_resolv_scope, dns_cache_entry_t);
+            wmem_map_insert(dns_cache_ipv4, GUINT_TO_POINTER(ip4), entry);
+        }
+    } else {
+        entry = (dns_cache_entry_t *)wmem_map_lookup(dns_cache_ipv6, addr);
+        if (entry == NULL) {
+            ws_in6_addr *addr_key;
+
+            addr_key = wmem_new(addr_resolv_scope, ws_in6_addr);
+            memcpy(addr_key, addr, sizeof(ws_in6_addr));
+            entry = wmem_new(addr_resolv_scope, dns_cache_entry_t);
+            wmem_map_insert(dns_cache_ipv6, addr_key, entry);
+        }
+    }
+    entry->expires = expires;
+    (void) g_strlcpy(entry->name, name ? name : "", MAXDNSNAMELEN);
+}
+
+static void
+dns_cache_load(void)
+{
+    FILE *cf;
+    char line[MAX_LINELEN];
+    char *cp, *expires_str, *name;
+    int64_t expires;
+    time_t now;
+    union {
+        uint32_t     ip4;
+        ws_in6_addr  ip6;
+    } addr;
+    int family;
+
+    dns_cache_loaded = true;
+
+    if (dns_cache_path == NULL || (cf = ws_fopen(dns_cache_path, "r")) == NULL)
+        return;
+
+    now = time(NULL);
+    while (fgetline(line, sizeof(line), cf) >= 0) {
+        if ((cp = strchr(line, '#')))
+            *cp = '\0';
+
+        if ((cp = strtok(line, " \t")) == NULL)
+            continue;
+        if ((expires_str = strtok(NULL, " \t")) == NULL)
+            continue;
+        if (!ws_strtoi64(expires_str, NULL, &expires) || expires <= now)
+            continue;
+        name = strtok(NULL, " \t");
+
+        if (ws_inet_pton4(cp, &addr.ip4)) {
+            family = AF_INET;
+        } else if (ws_inet_pton6(cp, &addr.ip6)) {
+            family = AF_INET6;
+        } else {
+            continue;
+        }
+        dns_cache_set_entry(family, &addr, name, (time_t)expires);
+    }
+    fclose(cf);
+}
+
+/*
+ * Remember the result of an external resolver lookup; name is NULL
+ * if the address has no name.
+ */
+static void
+dns_cache_add(int family, const void *addr, const char *name)
+{
+    if (dns_cache_lifetime == 0)
+        return;
+
+    if (!dns_cache_loaded)
+        dns_cache_load();
+
+    dns_cache_set_entry(family, addr, name, time(NULL) + (time_t)dns_cache_lifetime * 3600);
+    dns_cache_changed = true;
+}
+
+/*
+ * Look an address up in the cache; returns the entry if it has one that
+ * hasn't expired, whether or not the address has a name.
+ */
+static const dns_cache_entry_t *
+dns_cache_lookup(int family, const void *addr)
+{
+    dns_cache_entry_t *entry;
+
+    if (dns_cache_lifetime == 0)
+        return NULL;
+
+    if (!dns_cache_loaded)
+        dns_cache_load();
+
+    if (family == AF_INET)
+        entry = (dns_cache_entry_t *)wmem_map_lookup(dns_cache_ipv4, GUINT_TO_POINTER(*(const uint32_t *)addr));
+    else
+        entry = (dns_cache_entry_t *)wmem_map_lookup(dns_cache_ipv6, addr);
+
+    if (entry == NULL || entry->expires <= time(NULL))
+        return NULL;
+    return entry;
+}
+
+static void
+dns_cache_write_ipv4(void *key, void *value, void *user_data)
+{
+    const dns_cache_entry_t *entry = (const dns_cache_entry_t *)value;
+    FILE *cf = (FILE *)user_data;
+    uint32_t addr = GPOINTER_TO_UINT(key);
+    char addr_str[WS_INET_ADDRSTRLEN];
+
+    ip_addr_to_str_buf(&addr, addr_str, sizeof(addr_str));
+    fprintf(cf, "%s %" PRId64 " %s\n", addr_str, (int64_t)entry->expires, entry->name);
+}
+
+static void
+dns_cache_write_ipv6(void *key, void *value, void *user_data)
+{
+    const dns_cache_entry_t *entry = (const dns_cache_entry_t *)value;
+    FILE *cf = (FILE *)user_data;
+    char addr_str[WS_INET6_ADDRSTRLEN];
+
+    ip6_to_str_buf((const ws_in6_addr *)key, addr_str, sizeof(addr_str));
+    fprintf(cf, "%s %" PRId64 " %s\n", addr_str, (int64_t)entry->expires, entry->name);
+}
+
+static void
+dns_cache_save(void)
+{
+    char *pf_dir_path = NULL;
+    char *cache_dir;
+    char *tmp_path = NULL;
+    int fd;
+    FILE *cf;
+
+    if (!dns_cache_changed || dns_cache_path == NULL)
+        return;
+
+    if (create_persconffile_dir(dns_cache_app_env_var_prefix, &pf_dir_path) == -1) {
+        g_free(pf_dir_path);
+        return;
+    }
+
+    /*
+     * Write a new file next to the cache and rename it over the cache, so
+     * that other processes saving at the same time don't interleave their
+     * writes, and readers never see a partial file.
+     */
+    cache_dir = g_path_get_dirname(dns_cache_path);
+    fd = create_tempfile(cache_dir, &tmp_path, ENAME_DNS_CACHE, NULL, NULL);
+    g_free(cache_dir);
+    if (fd == -1) {
+        ws_warning("Can't create a temporary file to save the DNS cache in");
+        g_free(pf_dir_path);
+        return;
+    }
+    if ((cf = ws_fdopen(fd, "w")) == NULL) {
+        ws_warning("Can't open %s: %s", tmp_path, g_strerror(errno));
+        ws_close(fd);
+        ws_unlink(tmp_path);
+        g_free(tmp_path);
+        g_free(pf_dir_path);
+        return;
+    }
+    fputs("# Host names cached by the \"dns_cache_lifetime\" preference.\n"
+          "# <address> <expiry time> [<name>]\n", cf);
+    /* Entries that have expired since they were loaded are dropped by the next load. */
+    wmem_map_foreach(dns_cache_ipv4, dns_cache_write_ipv4, cf);
+    wmem_map_foreach(dns_cache_ipv6, dns_cache_write_ipv6, cf);
+    if (fclose(cf) != 0) {
+        ws_warning("Can't write %s: %s", tmp_path, g_strerror(errno));
+        ws_unlink(tmp_path);
+    } else if (ws_rename(tmp_path, dns_cache_path) != 0) {
+        ws_warning("Can't rename %s to %s: %s", tmp_path, dns_cache_path, g_strerror(errno));
+        ws_unlink(tmp_path);
+    }
+    g_free(tmp_path);
+    g_free(pf_dir_path);
+    dns_cache_changed = false;
+}
+
 static void
 c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
     async_dns_queue_msg_t *caqm = (async_dns_queue_msg_t *)arg;
@@ -1335,6 +1568,7 @@ c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
     async_dns_in_flight--;
 
     if (status == ARES_SUCCESS) {
+        dns_cache_add(caqm->family, &caqm->addr, he->h_name);
         for (p = he->h_addr_list; *p != NULL; p++) {
             switch(caqm->family) {
                 case AF_INET:
@@ -1348,6 +1582,8 @@ c_ares_ghba_cb(void *arg, int status, int timeouts _U_, struct hostent *he) {
                     break;
             }
         }
+    } else if (status == ARES_ENOTFOUND) {
+        dns_cache_add(caqm->family, &caqm->addr, NULL);
     }
     wmem_free(addr_resolv_scope, caqm);
 }
@@ -1391,8 +1627,19 @@ host_lookup(const unsigned addr)
         return tp;
 
     if (gbl_resolv_flags.use_external_net_name_resolver) {
+        const dns_cache_entry_t *cache_entry;
+
         tp->flags |= TRIED_RESOLVE_ADDRESS;
 
+        if ((cache_entry = dns_cache_lookup(AF_INET, &addr)) != NULL) {
+            /* We looked this up recently; don't ask again. */
+            if (cache_entry->name[0] != '\0') {
+                (void) g_strlcpy(tp->name, cache_entry->name, MAXDNSNAMELEN);
+                tp->flags |= NAME_RESOLVED;
+            }
+            return tp;
+        }
+
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
             if (resolve_synchronously || name_resolve_concurrency == 0) {
@@ -1466,8 +1713,19 @@ host_lookup6(const ws_in6_addr *addr)
         return tp;
 
     if (gbl_resolv_flags.use_external_net_name_resolver) {
+        const dns_cache_entry_t *cache_entry;
+
         tp->flags |= TRIED_RESOLVE_ADDRESS;
 
+        if ((cache_entry = dns_cache_lookup(AF_INET6, addr)) != NULL) {
+            /* We looked this up recently; don't ask again. */
+            if (cache_entry->name[0] != '\0') {
+                (void) g_strlcpy(tp->name, cache_entry->name, MAXDNSNAMELEN);
+                tp->flags |= NAME_RESOLVED;
+            }
+            return tp;
+        }
+
         if (async_dns_initialized) {
             /* c-ares is initialized, so we can use it */
             if (resolve_synchronously || name_resolve_concurrency == 0) {
@@ -3156,40 +3414,34 @@ static subnet_entry_t
 subnet_lookup(const uint32_t addr)
 {
     subnet_entry_t subnet_entry;
-    uint32_t i;
+    unsigned n;
 
-    /* Search mask lengths linearly, longest first */
+    /* Search the mask lengths that are in use, longest first */
 
-    i = SUBNETLENGTHSIZE;
-    while(have_subnet_entry && i > 0) {
+    for (n = 0; n < num_subnet_lengths; n++) {
         uint32_t masked_addr;
         subnet_length_entry_t* length_entry;
+        sub_net_hashipv4_t * tp;
+        uint32_t hash_idx;
+        uint32_t i = subnet_lengths[n] - 1;
 
-        /* Note that we run from 31 (length 32)  to 0 (length 1)  */
-        --i;
         ws_assert(i < SUBNETLENGTHSIZE);
 
-
         length_entry = &subnet_length_entries[i];
 
-        if (NULL != length_entry->subnet_addresses) {
-            sub_net_hashipv4_t * tp;
-            uint32_t hash_idx;
+        masked_addr = addr & length_entry->mask;
+        hash_idx = HASH_IPV4_ADDRESS(masked_addr);
 
-            masked_addr = addr & length_entry->mask;
-            hash_idx = HASH_IPV4_ADDRESS(masked_addr);
-
-            tp = length_entry->subnet_addresses[hash_idx];
-            while(tp != NULL && tp->addr != masked_addr) {
-                tp = tp->next;
-            }
+        tp = length_entry->subnet_addresses[hash_idx];
+        while(tp != NULL && tp->addr != masked_addr) {
+            tp = tp->next;
+        }
 
-            if (NULL != tp) {
-                subnet_entry.mask = length_entry->mask;
-                subnet_entry.mask_length = i + 1; /* Length is offset + 1 */
-                subnet_entry.name = tp->name;
-                return subnet_entry;
-            }
+        if (NULL != tp) {
+            subnet_entry.mask = length_entry->mask;
+            subnet_entry.mask_length = i + 1; /* Length is offset + 1 */
+            subnet_entry.name = tp->name;
+            return subnet_entry;
         }
     }
 
@@ -3200,6 +3452,22 @@ subnet_lookup(const uint32_t addr)
     return subnet_entry;
 }
 
+/* Add a mask length to a list of lengths in use, keeping it sorted
+ * longest first.
+ */
+static void
+subnet_length_add(uint8_t *lengths, unsigned *num_lengths, uint8_t mask_length)
+{
+    unsigned i = *num_lengths;
+
+    while (i > 0 && lengths[i - 1] < mask_length) {
+        lengths[i] = lengths[i - 1];
+        i--;
+    }
+    lengths[i] = mask_length;
+    (*num_lengths)++;
+}
+
 /* Add a subnet-definition - name pair to the set.
  * The definition is taken by masking the address passed in with the mask of the
  * given length.
@@ -3221,6 +3489,7 @@ subnet_entry_set(uint32_t subnet_addr, const uint8_t mask_length, const char* na
 
     if (NULL == entry->subnet_addresses) {
         entry->subnet_addresses = (sub_net_hashipv4_t**)wmem_alloc0(addr_resolv_scope, sizeof(sub_net_hashipv4_t*) * HASHHOSTSIZE);
+        subnet_length_add(subnet_lengths, &num_subnet_lengths, mask_length);
     }
 
     if (NULL != (tp = entry->subnet_addresses[hash_idx])) {
@@ -3244,7 +3513,6 @@ subnet_entry_set(uint32_t subnet_addr, const uint8_t mask_length, const char* na
     tp->next = NULL;
     tp->addr = subnet_addr;
     (void) g_strlcpy(tp->name, name, MAXNAMELEN); /* This is longer than subnet names can actually be */
-    have_subnet_entry = true;
 }
 
 static void
@@ -3318,9 +3586,11 @@ subnet6_entry_set(const ws_in6_addr *subnet_addr, const uint32_t mask_length,
 
     hash_idx = ipv6_oat_hash(masked) & (HASHHOSTSIZE - 1);
 
-    if (entry->subnet_addresses == NULL)
+    if (entry->subnet_addresses == NULL) {
         entry->subnet_addresses = (sub_net_hashipv6_t **)wmem_alloc0(
             addr_resolv_scope, sizeof(sub_net_hashipv6_t *) * HASHHOSTSIZE);
+        subnet_length_add(subnet_lengths_v6, &num_subnet_lengths_v6, (uint8_t)mask_length);
+    }
 
     if ((tp = entry->subnet_addresses[hash_idx]) != NULL) {
         sub_net_hashipv6_t *new_tp;
@@ -3342,27 +3612,22 @@ subnet6_entry_set(const ws_in6_addr *subnet_addr, const uint32_t mask_length,
     tp->next = NULL;
     memcpy(tp->addr, masked, 16);
     (void)g_strlcpy(tp->name, name, MAXNAMELEN);
-    have_subnet_entry_v6 = true;
 }
 
 static subnet_entry_v6_t
 subnet6_lookup(const ws_in6_addr *addr)
 {
     subnet_entry_v6_t result;
-    uint32_t i = SUBNETLENGTHSIZE_V6;
 
-    while (have_subnet_entry_v6 && i > 0) {
+    for (unsigned n = 0; n < num_subnet_lengths_v6; n++) {
         subnet_length_entry_v6_t *length_entry;
         uint8_t masked[16];
         size_t hash_idx;
         sub_net_hashipv6_t *tp;
+        uint32_t i = subnet_lengths_v6[n] - 1;
 
-        --i;
         length_entry = &subnet_length_entries_v6[i];
 
-        if (length_entry->subnet_addresses == NULL)
-            continue;
-
         for (int b = 0; b < 16; b++)
             masked[b] = addr->bytes[b] & length_entry->mask[b];
 
@@ -3756,6 +4021,17 @@ addr_resolve_pref_init(module_t *nameres)
             10,
             &name_resolve_concurrency);
 
+    prefs_register_uint_preference(nameres, "dns_cache_lifetime",
+            "Cache resolved names for (hours)",
+            "Save the names returned by your system's name resolver,"
+            " and the addresses it couldn't resolve, in the \"dns_cache\""
+            " file in your personal configuration directory, and use them"
+            " instead of asking again for this many hours,"
+            " regardless of the TTLs of the DNS records."
+            " 0 disables the cache.",
+            10,
+            &dns_cache_lifetime);
+
     prefs_register_obsolete_preference(nameres, "hosts_file_handling");
 
     prefs_register_bool_preference(nameres, "vlan_name",
@@ -4021,6 +4297,17 @@ host_name_lookup_init(const char* app_env_var_prefix)
     ws_assert(async_dns_queue_head == NULL);
     async_dns_queue_head = wmem_list_new(addr_resolv_scope);
 
+    /*
+     * The resolver cache isn't profile-specific; it's only read once
+     * a lookup needs it, as the preferences might not have been read yet.
+     */
+    dns_cache_ipv4 = wmem_map_new(addr_resolv_scope, g_direct_hash, g_direct_equal);
+    dns_cache_ipv6 = wmem_map_new(addr_resolv_scope, ipv6_oat_hash, ipv6_equal);
+    dns_cache_path = get_persconffile_path(ENAME_DNS_CACHE, false, app_env_var_prefix);
+    dns_cache_app_env_var_prefix = app_env_var_prefix;
+    dns_cache_loaded = false;
+    dns_cache_changed = false;
+
     /*
      * The manually resolved lists are the only address resolution maps
      * that are not reset by addr_resolv_cleanup(), because they are
@@ -4098,6 +4385,12 @@ host_name_lookup_cleanup(void)
 
     _host_name_lookup_cleanup();
 
+    dns_cache_save();
+    dns_cache_ipv4 = NULL;
+    dns_cache_ipv6 = NULL;
+    g_free(dns_cache_path);
+    dns_cache_path = NULL;
+
     ipxnet_hash_table = NULL;
     ipv4_hash_table = NULL;
     ipv6_hash_table = NULL;
@@ -4117,7 +4410,7 @@ host_name_lookup_cleanup(void)
         }
     }
 
-    have_subnet_entry = false;
+    num_subnet_lengths = 0;
 
     for(i = 0; i < SUBNETLENGTHSIZE_V6; ++i) {
         sub_net_hashipv6_t *entry6, *next_entry6;
@@ -4133,7 +4426,7 @@ host_name_lookup_cleanup(void)
             subnet_length_entries_v6[i].subnet_addresses = NULL;
         }
     }
-    have_subnet_entry_v6 = false;
+    num_subnet_lengths_v6 = 0;
 
     new_resolved_objects = false;
 }
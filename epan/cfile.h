@@ -128,6 +128,7 @@ typedef struct _capture_file {
     search_charset_t            scs_type;             /* Character set for text search */
     search_direction            dir;                  /* Direction in which to do searches */
     bool                        search_in_progress;   /* true if user just clicked OK in the Find dialog or hit <control>N/B */
+    struct find_index          *find_index;           /* Index of the packet bytes for searches, or NULL */
     /* packet provider */
     struct packet_provider_data provider;
     /* frames */
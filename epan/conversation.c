@@ -134,6 +134,12 @@ uint32_t conversation_addr_port_endpoints_port2(struct conversation_addr_port_en
  */
 static wmem_map_t *conversation_hashtable_element_list;
 
+/*
+ * The same hash tables, keyed by conversation_element_list_signature()
+ * so that they can be looked up without building the name.
+ */
+static wmem_map_t *conversation_hashtable_element_signature;
+
 /*
  * Hash table for conversations based on addresses only
  */
@@ -208,6 +214,53 @@ static wmem_map_t *conversation_hashtable_deinterlacer = NULL;
  */
 static wmem_map_t *conversation_hashtable_err_pkts = NULL;
 
+/*
+ * Flat, direction-normalized index of the IPv4 and IPv6 conversations
+ * in conversation_hashtable_exact_addr_port, which is what most lookups
+ * end up in. Both directions of a flow share one slot of an open
+ * addressing table, so an exact lookup in find_conversation() is a
+ * single probe without allocating or hashing element lists.
+ */
+typedef struct conversation_flow_key {
+    uint8_t  addr1[16];
+    uint8_t  addr2[16];
+    uint32_t port1;
+    uint32_t port2;
+    uint32_t ctype;
+    uint32_t addr_type;     /* AT_NONE marks an empty slot */
+} conversation_flow_key_t;
+
+typedef struct conversation_flow_entry {
+    conversation_flow_key_t key;    /* endpoint 1 is the lower one */
+    unsigned hash;
+    conversation_t *chain_head[2];  /* from endpoint 1 to 2, and back */
+} conversation_flow_entry_t;
+
+static struct {
+    conversation_flow_entry_t *entries;
+    unsigned capacity;
+    unsigned count;
+} conversation_flow_table;
+
+/*
+ * Incremented whenever a conversation is added to or removed from a
+ * hash table, which invalidates conversation_find_memo.
+ */
+static uint64_t conversation_generation;
+
+/*
+ * The last IPv4/IPv6 find_conversation() result. The transport layer and
+ * the protocols on top of it usually look up the same flow in a row.
+ */
+static struct {
+    bool valid;
+    uint64_t generation;
+    uint32_t frame_num;
+    unsigned options;
+    conversation_flow_key_t key;
+    conversation_t *conversation;
+} conversation_find_memo;
+
 static uint32_t new_index;
 
 /*
@@ -258,6 +311,31 @@ conversation_element_list_name(wmem_allocator_t *allocator, conversation_element
     return wmem_strbuf_finalize(conv_hash_group);
 }
 
+/*
+ * Pack the element types into an integer which identifies the element
+ * list the same way conversation_element_list_name() does.
+ */
+static unsigned
+conversation_element_list_signature(conversation_element_t *elements)
+{
+    unsigned signature = 0;
+    size_t element_count = conversation_element_count(elements);
+    for (size_t i = 0; i < element_count; i++) {
+        /* 9 types in 4 bits, and at most 8 elements */
+        signature = (signature << 4) | (elements[i].type + 1);
+    }
+    return signature;
+}
+
+static void
+conversation_add_element_list_map(conversation_element_t *elements, wmem_map_t *el_list_map)
+{
+    wmem_map_insert(conversation_hashtable_element_list,
+                    conversation_element_list_name(wmem_epan_scope(), elements), el_list_map);
+    wmem_map_insert(conversation_hashtable_element_signature,
+                    GUINT_TO_POINTER(conversation_element_list_signature(elements)), el_list_map);
+}
+
 #if 0 // debugging
 static char* conversation_element_list_values(conversation_element_t *elements) {
     char *sep = "";
@@ -582,6 +660,163 @@ conversation_match_element_list(const void *v1, const void *v2)
     return TRUE;
 }
 
+/*
+ * Fill in a flow key for an IPv4 or IPv6 address/port pair. Returns false
+ * if the addresses aren't both IPv4 or both IPv6.
+ */
+static bool
+conversation_flow_key_init(conversation_flow_key_t *key, const address *addr1, const uint32_t port1,
+                           const address *addr2, const uint32_t port2, const conversation_type ctype)
+{
+    if ((addr1->type != AT_IPv4 && addr1->type != AT_IPv6) || addr1->type != addr2->type ||
+            addr1->len != addr2->len || addr1->len > (int)sizeof(key->addr1)) {
+        return false;
+    }
+
+    /* Zero the padding too, as the keys are hashed and compared as bytes. */
+    memset(key, 0, sizeof(*key));
+    memcpy(key->addr1, addr1->data, addr1->len);
+    memcpy(key->addr2, addr2->data, addr2->len);
+    key->port1 = port1;
+    key->port2 = port2;
+    key->ctype = ctype;
+    key->addr_type = addr1->type;
+    return true;
+}
+
+/*
+ * Put the lower endpoint first. Returns the direction of the original
+ * key in conversation_flow_entry_t.chain_head.
+ */
+static unsigned
+conversation_flow_key_normalize(conversation_flow_key_t *key)
+{
+    int cmp = memcmp(key->addr1, key->addr2, sizeof(key->addr1));
+
+    if (cmp > 0 || (cmp == 0 && key->port1 > key->port2)) {
+        uint8_t addr[sizeof(key->addr1)];
+        uint32_t port;
+
+        memcpy(addr, key->addr1, sizeof(addr));
+        memcpy(key->addr1, key->addr2, sizeof(addr));
+        memcpy(key->addr2, addr, sizeof(addr));
+        port = key->port1;
+        key->port1 = key->port2;
+        key->port2 = port;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Find the slot of a normalized key; it is empty if the key isn't there.
+ */
+static conversation_flow_entry_t *
+conversation_flow_table_slot(const conversation_flow_key_t *key, unsigned hash)
+{
+    unsigned mask = conversation_flow_table.capacity - 1;
+    unsigned idx = hash & mask;
+
+    for (;;) {
+        conversation_flow_entry_t *entry = &conversation_flow_table.entries[idx];
+        if (entry->key.addr_type == AT_NONE ||
+                (entry->hash == hash && memcmp(&entry->key, key, sizeof(*key)) == 0)) {
+            return entry;
+        }
+        idx = (idx + 1) & mask;
+    }
+}
+
+static void
+conversation_flow_table_grow(void)
+{
+    conversation_flow_entry_t *old_entries = conversation_flow_table.entries;
+    unsigned old_capacity = conversation_flow_table.capacity;
+
+    conversation_flow_table.capacity = old_capacity ? old_capacity * 2 : 256;
+    conversation_flow_table.entries = wmem_alloc0_array(wmem_file_scope(), conversation_flow_entry_t,
+                                                        conversation_flow_table.capacity);
+    for (unsigned i = 0; i < old_capacity; i++) {
+        if (old_entries[i].key.addr_type != AT_NONE) {
+            *conversation_flow_table_slot(&old_entries[i].key, old_entries[i].hash) = old_entries[i];
+        }
+    }
+    wmem_free(wmem_file_scope(), old_entries);
+}
+
+/*
+ * Look up the slot of an address/port pair. *dir is set to the index in
+ * chain_head that corresponds to the direction from addr1 to addr2.
+ */
+static conversation_flow_entry_t *
+conversation_flow_table_find(const conversation_flow_key_t *flow_key, unsigned *dir)
+{
+    conversation_flow_key_t key = *flow_key;
+    conversation_flow_entry_t *entry;
+
+    if (conversation_flow_table.count == 0) {
+        return NULL;
+    }
+
+    *dir = conversation_flow_key_normalize(&key);
+    entry = conversation_flow_table_slot(&key, wmem_strong_hash((const uint8_t *)&key, sizeof(key)));
+    return entry->key.addr_type != AT_NONE ? entry : NULL;
+}
+
+/*
+ * Record the new chain head of a key in conversation_hashtable_exact_addr_port.
+ * Slots are never removed; a flow without conversations just has NULL heads.
+ */
+static void
+conversation_flow_table_update(conversation_element_t *conv_key, conversation_t *chain_head)
+{
+    conversation_flow_key_t key;
+    conversation_flow_entry_t *entry;
+    unsigned hash, dir;
+
+    if (!conversation_flow_key_init(&key, &conv_key[ADDR1_IDX].addr_val, conv_key[PORT1_IDX].port_val,
+                                    &conv_key[ADDR2_IDX].addr_val, conv_key[PORT2_IDX].port_val,
+                                    conv_key[ENDP_EXACT_IDX].conversation_type_val)) {
+        return;
+    }
+
+    dir = conversation_flow_key_normalize(&key);
+    hash = wmem_strong_hash((const uint8_t *)&key, sizeof(key));
+
+    /* Keep the load factor below 3/4. */
+    if ((conversation_flow_table.count + 1) * 4 > conversation_flow_table.capacity * 3) {
+        conversation_flow_table_grow();
+    }
+
+    entry = conversation_flow_table_slot(&key, hash);
+    if (entry->key.addr_type == AT_NONE) {
+        entry->key = key;
+        entry->hash = hash;
+        conversation_flow_table.count++;
+    }
+
+    if (memcmp(key.addr1, key.addr2, sizeof(key.addr1)) == 0 && key.port1 == key.port2) {
+        /* Both directions are the same key. */
+        entry->chain_head[0] = entry->chain_head[1] = chain_head;
+    } else {
+        entry->chain_head[dir] = chain_head;
+    }
+}
+
+static bool
+conversation_flow_table_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
+                                 void *user_data _U_)
+{
+    /* The entries are in file scope. */
+    conversation_flow_table.entries = NULL;
+    conversation_flow_table.capacity = 0;
+    conversation_flow_table.count = 0;
+    conversation_find_memo.valid = false;
+    conversation_generation++;
+
+    return true;
+}
+
 /**
  * Create a new hash tables for conversations.
  */
@@ -597,6 +832,8 @@ conversation_init(void)
      * above.
      */
     conversation_hashtable_element_list = wmem_map_new(wmem_epan_scope(), wmem_str_hash, g_str_equal);
+    conversation_hashtable_element_signature = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
+    wmem_register_callback(wmem_file_scope(), conversation_flow_table_reset_cb, NULL);
 
     conversation_element_t exact_elements[EXACT_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -605,24 +842,20 @@ conversation_init(void)
         { CE_PORT, .port_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *exact_map_key = conversation_element_list_name(wmem_epan_scope(), exact_elements);
     conversation_hashtable_exact_addr_port = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), exact_map_key),
-                    conversation_hashtable_exact_addr_port);
+    conversation_add_element_list_map(exact_elements, conversation_hashtable_exact_addr_port);
 
     conversation_element_t addrs_elements[ADDRS_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *addrs_map_key = conversation_element_list_name(wmem_epan_scope(), addrs_elements);
     conversation_hashtable_exact_addr = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), addrs_map_key),
-                    conversation_hashtable_exact_addr);
+    conversation_add_element_list_map(addrs_elements, conversation_hashtable_exact_addr);
 
     conversation_element_t no_addr2_elements[NO_ADDR2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -630,12 +863,10 @@ conversation_init(void)
         { CE_PORT, .port_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_addr2_map_key = conversation_element_list_name(wmem_epan_scope(), no_addr2_elements);
     conversation_hashtable_no_addr2 = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                        conversation_hash_element_list,
                                                        conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_addr2_map_key),
-                    conversation_hashtable_no_addr2);
+    conversation_add_element_list_map(no_addr2_elements, conversation_hashtable_no_addr2);
 
     conversation_element_t no_port2_elements[NO_PORT2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -643,35 +874,29 @@ conversation_init(void)
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_port2_map_key = conversation_element_list_name(wmem_epan_scope(), no_port2_elements);
     conversation_hashtable_no_port2 = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                        conversation_hash_element_list,
                                                        conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_port2_map_key),
-                    conversation_hashtable_no_port2);
+    conversation_add_element_list_map(no_port2_elements, conversation_hashtable_no_port2);
 
     conversation_element_t no_addr2_or_port2_elements[NO_ADDR2_PORT2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
         { CE_PORT, .port_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_addr2_or_port2_map_key = conversation_element_list_name(wmem_epan_scope(), no_addr2_or_port2_elements);
     conversation_hashtable_no_addr2_or_port2 = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_addr2_or_port2_map_key),
-                    conversation_hashtable_no_addr2_or_port2);
+    conversation_add_element_list_map(no_addr2_or_port2_elements, conversation_hashtable_no_addr2_or_port2);
 
     conversation_element_t id_elements[2] = {
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *id_map_key = conversation_element_list_name(wmem_epan_scope(), id_elements);
     conversation_hashtable_id = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                        conversation_hash_element_list,
                                                        conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), id_map_key),
-                    conversation_hashtable_id);
+    conversation_add_element_list_map(id_elements, conversation_hashtable_id);
 
     /*
      * Initialize the "deinterlacer" table, which is used as the basis for the
@@ -695,12 +920,10 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *deinterlacer_map_key = conversation_element_list_name(wmem_epan_scope(), deinterlacer_elements);
     conversation_hashtable_deinterlacer = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), deinterlacer_map_key),
-                    conversation_hashtable_deinterlacer);
+    conversation_add_element_list_map(deinterlacer_elements, conversation_hashtable_deinterlacer);
 
     /*
      * Initialize the "_anc" tables, which are very similar to their standard counterparts
@@ -719,12 +942,10 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *exact_anc_map_key = conversation_element_list_name(wmem_epan_scope(), exact_elements_anc);
     conversation_hashtable_exact_addr_port_anc = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), exact_anc_map_key),
-                    conversation_hashtable_exact_addr_port_anc);
+    conversation_add_element_list_map(exact_elements_anc, conversation_hashtable_exact_addr_port_anc);
 
     conversation_element_t addrs_elements_anc[ADDRS_IDX_COUNT+1] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -732,12 +953,10 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *addrs_anc_map_key = conversation_element_list_name(wmem_epan_scope(), addrs_elements_anc);
     conversation_hashtable_exact_addr_anc = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), addrs_anc_map_key),
-                    conversation_hashtable_exact_addr_anc);
+    conversation_add_element_list_map(addrs_elements_anc, conversation_hashtable_exact_addr_anc);
 
     conversation_element_t no_addr2_elements_anc[DEINTD_NO_PORT2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -746,12 +965,10 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_addr2_anc_map_key = conversation_element_list_name(wmem_epan_scope(), no_addr2_elements_anc);
     conversation_hashtable_no_addr2_anc = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_addr2_anc_map_key),
-                    conversation_hashtable_no_addr2_anc);
+    conversation_add_element_list_map(no_addr2_elements_anc, conversation_hashtable_no_addr2_anc);
 
     conversation_element_t no_port2_elements_anc[DEINTD_NO_PORT2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -760,12 +977,10 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_port2_anc_map_key = conversation_element_list_name(wmem_epan_scope(), no_port2_elements_anc);
     conversation_hashtable_no_port2_anc = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_port2_anc_map_key),
-                    conversation_hashtable_no_port2_anc);
+    conversation_add_element_list_map(no_port2_elements_anc, conversation_hashtable_no_port2_anc);
 
     conversation_element_t no_addr2_or_port2_elements_anc[DEINTD_NO_ADDR2_PORT2_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = ADDRESS_INIT_NONE },
@@ -773,24 +988,20 @@ conversation_init(void)
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *no_addr2_or_port2_anc_map_key = conversation_element_list_name(wmem_epan_scope(), no_addr2_or_port2_elements_anc);
     conversation_hashtable_no_addr2_or_port2_anc = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                                     conversation_hash_element_list,
                                                                     conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), no_addr2_or_port2_anc_map_key),
-                    conversation_hashtable_no_addr2_or_port2_anc);
+    conversation_add_element_list_map(no_addr2_or_port2_elements_anc, conversation_hashtable_no_addr2_or_port2_anc);
 
     conversation_element_t err_pkts_elements[ERR_PKTS_COUNT] = {
         { CE_UINT, .uint_val = 0 },
         { CE_UINT, .uint_val = 0 },
         { CE_CONVERSATION_TYPE, .conversation_type_val = CONVERSATION_NONE }
     };
-    char *err_pkts_map_key = conversation_element_list_name(wmem_epan_scope(), err_pkts_elements);
     conversation_hashtable_err_pkts = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),
                                                        conversation_hash_element_list,
                                                        conversation_match_element_list);
-    wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), err_pkts_map_key),
-                    conversation_hashtable_err_pkts);
+    conversation_add_element_list_map(err_pkts_elements, conversation_hashtable_err_pkts);
 
 }
 
@@ -863,6 +1074,11 @@ conversation_insert_into_hashtable(wmem_map_t *hashtable, conversation_t *conv)
             }
         }
     }
+
+    if (hashtable == conversation_hashtable_exact_addr_port) {
+        conversation_flow_table_update(conv->key_ptr, (conversation_t *)wmem_map_lookup(hashtable, conv->key_ptr));
+    }
+    conversation_generation++;
 }
 
 /*
@@ -923,18 +1139,23 @@ conversation_remove_from_hashtable(wmem_map_t *hashtable, conversation_t *conv)
         if (chain_head->latest_found == conv)
             chain_head->latest_found = prev;
     }
+
+    if (hashtable == conversation_hashtable_exact_addr_port) {
+        conversation_flow_table_update(conv->key_ptr, (conversation_t *)wmem_map_lookup(hashtable, conv->key_ptr));
+    }
+    conversation_generation++;
 }
 
 conversation_t *conversation_new_full(const uint32_t setup_frame, conversation_element_t *elements)
 {
     DISSECTOR_ASSERT(elements);
 
-    char *el_list_map_key = conversation_element_list_name(wmem_epan_scope(), elements);
-    wmem_map_t *el_list_map = (wmem_map_t *) wmem_map_lookup(conversation_hashtable_element_list, el_list_map_key);
+    unsigned signature = conversation_element_list_signature(elements);
+    wmem_map_t *el_list_map = (wmem_map_t *) wmem_map_lookup(conversation_hashtable_element_signature, GUINT_TO_POINTER(signature));
     if (!el_list_map) {
         el_list_map = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), conversation_hash_element_list,
                 conversation_match_element_list);
-        wmem_map_insert(conversation_hashtable_element_list, wmem_strdup(wmem_epan_scope(), el_list_map_key), el_list_map);
+        conversation_add_element_list_map(elements, el_list_map);
     }
 
     size_t element_count = conversation_element_count(elements);
@@ -1578,12 +1799,10 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
     DENDENT();
 }
 
-static conversation_t *conversation_lookup_hashtable(wmem_map_t *conversation_hashtable, const uint32_t frame_num, conversation_element_t *conv_key)
+static conversation_t *conversation_lookup_chain(conversation_t *chain_head, const uint32_t frame_num)
 {
     conversation_t* convo = NULL;
     conversation_t* match = NULL;
-    conversation_t* chain_head = NULL;
-    chain_head = (conversation_t *)wmem_map_lookup(conversation_hashtable, conv_key);
 
     if (chain_head && (chain_head->setup_frame <= frame_num)) {
         match = chain_head;
@@ -1608,11 +1827,15 @@ static conversation_t *conversation_lookup_hashtable(wmem_map_t *conversation_ha
     return match;
 }
 
+static conversation_t *conversation_lookup_hashtable(wmem_map_t *conversation_hashtable, const uint32_t frame_num, conversation_element_t *conv_key)
+{
+    return conversation_lookup_chain((conversation_t *)wmem_map_lookup(conversation_hashtable, conv_key), frame_num);
+}
+
 conversation_t *find_conversation_full(const uint32_t frame_num, conversation_element_t *elements)
 {
-    char *el_list_map_key = conversation_element_list_name(NULL, elements);
-    wmem_map_t *el_list_map = (wmem_map_t *) wmem_map_lookup(conversation_hashtable_element_list, el_list_map_key);
-    g_free(el_list_map_key);
+    unsigned signature = conversation_element_list_signature(elements);
+    wmem_map_t *el_list_map = (wmem_map_t *) wmem_map_lookup(conversation_hashtable_element_signature, GUINT_TO_POINTER(signature));
     if (!el_list_map) {
         return NULL;
     }
@@ -1628,6 +1851,15 @@ static conversation_t *
 conversation_lookup_exact(const uint32_t frame_num, const address *addr1, const uint32_t port1,
                           const address *addr2, const uint32_t port2, const conversation_type ctype)
 {
+    conversation_flow_key_t flow_key;
+    if (conversation_flow_key_init(&flow_key, addr1, port1, addr2, port2, ctype)) {
+        conversation_flow_entry_t *entry;
+        unsigned dir;
+
+        entry = conversation_flow_table_find(&flow_key, &dir);
+        return entry ? conversation_lookup_chain(entry->chain_head[dir], frame_num) : NULL;
+    }
+
     conversation_element_t key[EXACT_IDX_COUNT] = {
         { CE_ADDRESS, .addr_val = *addr1 },
         { CE_PORT, .port_val = port1 },
@@ -1867,6 +2099,19 @@ find_conversation(const uint32_t frame_num, const address *addr_a, const address
         addr_b = &null_address_;
     }
 
+    /*
+     * Did we just do the same lookup, with no conversations added or
+     * removed since?
+     */
+    conversation_flow_key_t memo_key;
+    uint64_t generation = conversation_generation;
+    bool memoize = conversation_flow_key_init(&memo_key, addr_a, port_a, addr_b, port_b, ctype);
+    if (memoize && conversation_find_memo.valid && conversation_find_memo.generation == generation &&
+            conversation_find_memo.frame_num == frame_num && conversation_find_memo.options == options &&
+            memcmp(&conversation_find_memo.key, &memo_key, sizeof(memo_key)) == 0) {
+        return conversation_find_memo.conversation;
+    }
+
     DINSTR(char *addr_a_str = address_to_str(NULL, addr_a));
     DINSTR(char *addr_b_str = address_to_str(NULL, addr_b));
     /*
@@ -2250,6 +2495,15 @@ find_conversation(const uint32_t frame_num, const address *addr_a, const address
     conversation = NULL;
 
 end:
+    /* Don't remember lookups which set the second address or port. */
+    if (memoize && conversation_generation == generation) {
+        conversation_find_memo.valid = true;
+        conversation_find_memo.generation = generation;
+        conversation_find_memo.frame_num = frame_num;
+        conversation_find_memo.options = options;
+        conversation_find_memo.key = memo_key;
+        conversation_find_memo.conversation = conversation;
+    }
     DINSTR(wmem_free(NULL, addr_a_str));
     DINSTR(wmem_free(NULL, addr_b_str));
     return conversation;
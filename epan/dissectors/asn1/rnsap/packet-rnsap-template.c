@@ -230,9 +230,12 @@ dissect_sccp_rnsap_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, voi
 }
 
 
-/*--- proto_register_rnsap -------------------------------------------*/
-void proto_register_rnsap(void) {
-
+/*--- register_rnsap_fields ------------------------------------------*/
+/* RNSAP has thousands of fields, so they are only registered when it is
+ * first used or one of them is looked up by name. */
+static void
+register_rnsap_fields(const char *unused _U_)
+{
   /* List of fields */
   static hf_register_info hf[] = {
     { &hf_rnsap_transportLayerAddress_ipv4,
@@ -250,6 +253,12 @@ void proto_register_rnsap(void) {
 #include "packet-rnsap-hfarr.c"
   };
 
+  proto_register_field_array(proto_rnsap, hf, array_length(hf));
+}
+
+/*--- proto_register_rnsap -------------------------------------------*/
+void proto_register_rnsap(void) {
+
   /* List of subtrees */
   static int *ett[] = {
     &ett_rnsap,
@@ -263,7 +272,7 @@ void proto_register_rnsap(void) {
   /* Register protocol */
   proto_rnsap = proto_register_protocol("UTRAN Iur interface Radio Network Subsystem Application Part", "RNSAP", "rnsap");
   /* Register fields and subtrees */
-  proto_register_field_array(proto_rnsap, hf, array_length(hf));
+  proto_register_fields_on_demand(proto_rnsap, register_rnsap_fields);
   proto_register_subtree_array(ett, array_length(ett));
 
   /* Register dissector */
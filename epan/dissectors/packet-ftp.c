@@ -1889,6 +1889,7 @@ proto_register_ftp(void)
                              10,
                              &pref_export_maxsize);
     ftp_eo_tap = register_export_object(proto_ftp_data, ftp_eo_packet, ftp_eo_cleanup);
+    set_eo_entries_mutable(proto_ftp_data);
 }
 
 void
@@ -55761,12 +55761,12 @@ dissect_nbap_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *dat
   return true;
 }
 
-/*--- proto_register_nbap -------------------------------------------*/
-void proto_register_nbap(void)
+/*--- register_nbap_fields ------------------------------------------*/
+/* NBAP has thousands of fields, so they are only registered when it is
+ * first used or one of them is looked up by name. */
+static void
+register_nbap_fields(const char *unused _U_)
 {
-  module_t *nbap_module;
-  uint8_t i;
-
   /* List of fields */
   static hf_register_info hf[] = {
   { &hf_nbap_transportLayerAddress_ipv4,
@@ -68947,6 +68947,15 @@ void proto_register_nbap(void)
         NULL, HFILL }},
   };
 
+  proto_register_field_array(proto_nbap, hf, array_length(hf));
+}
+
+/*--- proto_register_nbap -------------------------------------------*/
+void proto_register_nbap(void)
+{
+  module_t *nbap_module;
+  uint8_t i;
+
   /* List of subtrees */
   static int *ett[] = {
     &ett_nbap,
@@ -70592,7 +70601,7 @@ void proto_register_nbap(void)
   /* Register protocol */
   proto_nbap = proto_register_protocol("UTRAN Iub interface NBAP signalling", "NBAP", "nbap");
   /* Register fields and subtrees */
-  proto_register_field_array(proto_nbap, hf, array_length(hf));
+  proto_register_fields_on_demand(proto_nbap, register_nbap_fields);
   proto_register_subtree_array(ett, array_length(ett));
   expert_nbap = expert_register_protocol(proto_nbap);
   expert_register_field_array(expert_nbap, ei, array_length(ei));
@@ -1955,7 +1955,7 @@ dissect_radius(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _
 	conversation_t *conversation;
 	radius_call_info_key radius_call_key;
 	radius_call_info_key *new_radius_call_key;
-	wmem_tree_t *radius_call_tree;
+	wmem_btree_t *radius_call_tree;
 	radius_call_t *radius_call = NULL;
 	static address null_address = ADDRESS_INIT_NONE;
 
@@ -2068,17 +2068,17 @@ dissect_radius(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _
 			radius_call_key.req_time = pinfo->abs_ts;
 
 			/* Look up the tree of calls with this ident */
-			radius_call_tree = (wmem_tree_t *)wmem_map_lookup(radius_calls, &radius_call_key);
+			radius_call_tree = (wmem_btree_t *)wmem_map_lookup(radius_calls, &radius_call_key);
 
 			if (!radius_call_tree) {
-				radius_call_tree = wmem_tree_new(wmem_file_scope());
+				radius_call_tree = wmem_btree_new(wmem_file_scope());
 				new_radius_call_key = wmem_new(wmem_file_scope(), radius_call_info_key);
 				*new_radius_call_key = radius_call_key;
 				wmem_map_insert(radius_calls, new_radius_call_key, radius_call_tree);
 			}
 
 			/* Find the last call we've seen (for this ident in this conversation) */
-			radius_call = (radius_call_t *)wmem_tree_lookup32_le(radius_call_tree, pinfo->num);
+			radius_call = (radius_call_t *)wmem_btree_lookup32_le(radius_call_tree, pinfo->num);
 			if (radius_call != NULL) {
 				/* We found a request with the same ident (in this conversation).
 				 * Is it really a duplicate?
@@ -2137,7 +2137,7 @@ dissect_radius(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _
 				radius_call->rspcode = 0;
 
 				/* Store it */
-				wmem_tree_insert32(radius_call_tree, pinfo->num, radius_call);
+				wmem_btree_insert32(radius_call_tree, pinfo->num, radius_call);
 			}
 
 			if (radius_call && radius_call->rsp_num) {
@@ -2203,14 +2203,14 @@ dissect_radius(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _
 			radius_call_key.req_time = pinfo->abs_ts;
 
 			/* Look up the tree of calls with this ident */
-			radius_call_tree = (wmem_tree_t *)wmem_map_lookup(radius_calls, &radius_call_key);
+			radius_call_tree = (wmem_btree_t *)wmem_map_lookup(radius_calls, &radius_call_key);
 			if (radius_call_tree == NULL) {
 				/* Nothing more to do here */
 				break;
 			}
 
 			/* Find the last call we've seen (for this ident in this conversation) */
-			radius_call = (radius_call_t *)wmem_tree_lookup32_le(radius_call_tree, pinfo->num);
+			radius_call = (radius_call_t *)wmem_btree_lookup32_le(radius_call_tree, pinfo->num);
 			if (radius_call == NULL) {
 				/* Nothing more to do here */
 				break;
@@ -1732,6 +1732,13 @@ follow_tcp_tap_listener(void *tapdata, packet_info *pinfo,
     return TAP_PACKET_DONT_REDRAW;
 }
 
+static bool
+follow_tcp_tap_stream_id(const void *data, uint64_t *stream_id)
+{
+    *stream_id = ((const tcp_follow_tap_data_t *)data)->stream_id;
+    return true;
+}
+
 #define EXP_PDU_TCP_INFO_DATA_LEN   20
 #define EXP_PDU_TCP_INFO_VERSION    1
 #define EXP_PDU_TAG_TCP_STREAM_ID_LEN   4
@@ -11519,6 +11526,7 @@ proto_register_tcp(void)
     register_conversation_table(proto_mptcp, false, mptcpip_conversation_packet, tcpip_endpoint_packet);
     register_follow_stream(proto_tcp, "tcp_follow", tcp_follow_conv_filter, tcp_follow_index_filter, tcp_follow_address_filter,
                             tcp_port_to_display, follow_tcp_tap_listener, get_tcp_stream_count, NULL);
+    set_follow_tap_stream_id_func(get_follow_by_proto_id(proto_tcp), follow_tcp_tap_stream_id);
 
     tcp_tap = register_tap("tcp");
     tcp_follow_tap = register_tap("tcp_follow");
@@ -2496,7 +2496,6 @@ static bool from_hex(StringInfo* out, const char* in, size_t hex_len) {
 
 /* libgcrypt wrappers for HMAC/message digest operations {{{ */
 /* hmac abstraction layer */
-#define SSL_HMAC gcry_md_hd_t
 
 static inline int
 ssl_hmac_init(SSL_HMAC* md, int algo)
@@ -3771,6 +3770,38 @@ ssl_change_cipher(SslDecryptSession *ssl_session, bool server)
 }
 /* }}} */
 
+/* Decryption statistics {{{ */
+static tls_decrypt_stats_t tls_decrypt_stats;
+static bool tls_decrypt_stats_timing;
+
+void
+tls_decrypt_stats_enable(bool enable)
+{
+    memset(&tls_decrypt_stats, 0, sizeof(tls_decrypt_stats));
+    tls_decrypt_stats_timing = enable;
+}
+
+const tls_decrypt_stats_t *
+tls_decrypt_stats_get(void)
+{
+    return &tls_decrypt_stats;
+}
+
+static inline int64_t
+tls_decrypt_stats_start(void)
+{
+    return tls_decrypt_stats_timing ? g_get_monotonic_time() : 0;
+}
+
+static inline void
+tls_decrypt_stats_stop(uint64_t *elapsed_us, int64_t start)
+{
+    if (tls_decrypt_stats_timing) {
+        *elapsed_us += (uint64_t)(g_get_monotonic_time() - start);
+    }
+}
+/* }}} */
+
 /* Init cipher state given some security parameters. {{{ */
 static bool
 ssl_decoder_destroy_cb(wmem_allocator_t *, wmem_cb_event_t, void *);
@@ -3846,6 +3877,8 @@ ssl_decoder_destroy_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U
         ssl_cipher_cleanup(&dec->evp);
     if (dec->sn_evp)
       ssl_cipher_cleanup(&dec->sn_evp);
+    if (dec->mac_hd)
+        ssl_hmac_cleanup(&dec->mac_hd);
 
 #ifdef USE_ZLIB_OR_ZLIBNG
     if (dec->decomp != NULL && dec->decomp->compression == 1 /* DEFLATE */)
@@ -3996,9 +4029,8 @@ ssl_generate_pre_master_secret(SslDecryptSession *ssl_session,
     return false;
 }
 
-/* Used for (D)TLS 1.2 and earlier versions (not with TLS 1.3). */
-int
-ssl_generate_keyring_material(SslDecryptSession*ssl_session)
+static int
+ssl_generate_keyring_material_internal(SslDecryptSession*ssl_session)
 {
     StringInfo  key_block = { NULL, 0 };
     uint8_t     _iv_c[MAX_BLOCK_SIZE],_iv_s[MAX_BLOCK_SIZE];
@@ -4323,9 +4355,20 @@ fail:
     return -1;
 }
 
-/* Generated the key material based on the given secret. */
-bool
-tls13_generate_keys(SslDecryptSession *ssl_session, const StringInfo *secret, bool is_from_server)
+/* Used for (D)TLS 1.2 and earlier versions (not with TLS 1.3). */
+int
+ssl_generate_keyring_material(SslDecryptSession*ssl_session)
+{
+    int64_t start = tls_decrypt_stats_start();
+    int ret = ssl_generate_keyring_material_internal(ssl_session);
+
+    tls_decrypt_stats.keyring_count++;
+    tls_decrypt_stats_stop(&tls_decrypt_stats.keyring_us, start);
+    return ret;
+}
+
+static bool
+tls13_generate_keys_internal(SslDecryptSession *ssl_session, const StringInfo *secret, bool is_from_server)
 {
     bool        success = false;
     unsigned char     *write_key = NULL, *write_iv = NULL;
@@ -4423,6 +4466,18 @@ end:
         wmem_free(NULL, sn_key);
     return success;
 }
+
+/* Generated the key material based on the given secret. */
+bool
+tls13_generate_keys(SslDecryptSession *ssl_session, const StringInfo *secret, bool is_from_server)
+{
+    int64_t start = tls_decrypt_stats_start();
+    bool success = tls13_generate_keys_internal(ssl_session, secret, is_from_server);
+
+    tls_decrypt_stats.keyring_count++;
+    tls_decrypt_stats_stop(&tls_decrypt_stats.keyring_us, start);
+    return success;
+}
 /* (Pre-)master secrets calculations }}} */
 
 #ifdef HAVE_LIBGNUTLS
@@ -4505,23 +4560,41 @@ ssl_decrypt_pre_master_secret(SslDecryptSession *ssl_session,
 
 /* Decryption integrity check {{{ */
 
+/* The MAC key does not change for the lifetime of a decoder, so the keyed
+ * HMAC handle is created for the first record and only reset afterwards. */
+static int
+ssl_decoder_get_hmac(SslDecoder *decoder, SSL_HMAC *hm)
+{
+    if (decoder->mac_hd) {
+        ssl_hmac_reset(&decoder->mac_hd);
+        *hm = decoder->mac_hd;
+        return 0;
+    }
+
+    int md = ssl_get_digest_by_name(ssl_cipher_suite_dig(decoder->cipher_suite)->name);
+    ssl_debug_printf("%s mac type:%s md %d\n", G_STRFUNC,
+        ssl_cipher_suite_dig(decoder->cipher_suite)->name, md);
+
+    if (ssl_hmac_init(hm, md) != 0)
+        return -1;
+    if (ssl_hmac_setkey(hm, decoder->mac_key.data, decoder->mac_key.data_len) != 0) {
+        ssl_hmac_cleanup(hm);
+        return -1;
+    }
+    decoder->mac_hd = *hm;
+    return 0;
+}
+
 static int
 tls_check_mac(SslDecoder*decoder, int ct, int ver, uint8_t* data,
         uint32_t datalen, uint8_t* mac)
 {
     SSL_HMAC hm;
-    int      md;
     uint32_t len;
     uint8_t  buf[DIGEST_MAX_SIZE];
     int16_t  temp;
 
-    md=ssl_get_digest_by_name(ssl_cipher_suite_dig(decoder->cipher_suite)->name);
-    ssl_debug_printf("tls_check_mac mac type:%s md %d\n",
-        ssl_cipher_suite_dig(decoder->cipher_suite)->name, md);
-
-    if (ssl_hmac_init(&hm,md) != 0)
-        return -1;
-    if (ssl_hmac_setkey(&hm,decoder->mac_key.data,decoder->mac_key.data_len) != 0)
+    if (ssl_decoder_get_hmac(decoder, &hm) != 0)
         return -1;
 
     /* hash sequence number */
@@ -4550,7 +4623,6 @@ tls_check_mac(SslDecoder*decoder, int ct, int ver, uint8_t* data,
     /* get digest and digest len*/
     len = sizeof(buf);
     ssl_hmac_final(&hm,buf,&len);
-    ssl_hmac_cleanup(&hm);
     ssl_print_data("Mac", buf, len);
     if(memcmp(mac,buf,len))
         return -1;
@@ -4625,7 +4697,6 @@ dtls_check_mac(SslDecryptSession *ssl, SslDecoder*decoder, int ct, uint8_t* data
         uint32_t datalen, uint8_t* mac, const unsigned char *cid, uint8_t cidl)
 {
     SSL_HMAC hm;
-    int      md;
     uint32_t len;
     uint8_t  buf[DIGEST_MAX_SIZE];
     int16_t  temp;
@@ -4633,13 +4704,7 @@ dtls_check_mac(SslDecryptSession *ssl, SslDecoder*decoder, int ct, uint8_t* data
     int ver = ssl->session.version;
     bool is_cid = ((ct == SSL_ID_TLS12_CID) && (ver == DTLSV1DOT2_VERSION));
 
-    md=ssl_get_digest_by_name(ssl_cipher_suite_dig(decoder->cipher_suite)->name);
-    ssl_debug_printf("dtls_check_mac mac type:%s md %d\n",
-        ssl_cipher_suite_dig(decoder->cipher_suite)->name, md);
-
-    if (ssl_hmac_init(&hm,md) != 0)
-        return -1;
-    if (ssl_hmac_setkey(&hm,decoder->mac_key.data,decoder->mac_key.data_len) != 0)
+    if (ssl_decoder_get_hmac(decoder, &hm) != 0)
         return -1;
 
     ssl_debug_printf("dtls_check_mac seq: %" PRIu64 " epoch: %d\n",decoder->seq,decoder->epoch);
@@ -4703,7 +4768,6 @@ dtls_check_mac(SslDecryptSession *ssl, SslDecoder*decoder, int ct, uint8_t* data
     /* get digest and digest len */
     len = sizeof(buf);
     ssl_hmac_final(&hm,buf,&len);
-    ssl_hmac_cleanup(&hm);
     ssl_print_data("Mac", buf, len);
     if(memcmp(mac,buf,len))
         return -1;
@@ -4714,7 +4778,7 @@ dtls_check_mac(SslDecryptSession *ssl, SslDecoder*decoder, int ct, uint8_t* data
 
 
 static bool
-tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, SslDecoder *decoder,
+tls_decrypt_aead_record(SslDecryptSession *ssl, SslDecoder *decoder,
         uint8_t ct, uint16_t record_version,
         bool ignore_mac_failed,
         const unsigned char *in, uint16_t inl,
@@ -4738,6 +4802,7 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
     const uint8_t   draft_version = ssl->session.tls13_draft_version;
     const unsigned char   *auth_tag_wire;
     unsigned char   auth_tag_calc[16];
+    unsigned char   aad_buf[23 + UINT8_MAX];    /* largest (D)TLS 1.2 CID AAD */
     unsigned char  *aad = NULL;
     unsigned        aad_len = 0;
 
@@ -4814,7 +4879,7 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
     if (is_cid) { /* if connection ID */
         if (ssl->session.deprecated_cid) {
             aad_len = 14 + cidl;
-            aad = wmem_alloc(allocator, aad_len);
+            aad = aad_buf;
             phtonu64(aad, decoder->seq);         /* record sequence number */
             phtonu16(aad, decoder->epoch);       /* DTLS 1.2 includes epoch. */
             aad[8] = ct;                        /* TLSCompressed.type */
@@ -4824,7 +4889,7 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
             phtonu16(aad + 12 + cidl, ciphertext_len);  /* TLSCompressed.length */
         } else {
             aad_len = 23 + cidl;
-            aad = wmem_alloc(allocator, aad_len);
+            aad = aad_buf;
             memset(aad, 0xFF, 8);               /* seq_num_placeholder */
             aad[8] = ct;                        /* TLSCompressed.type */
             aad[9] = cidl;                      /* cid_length */
@@ -4837,7 +4902,7 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
         }
     } else if (is_v12) {
         aad_len = 13;
-        aad = wmem_alloc(allocator, aad_len);
+        aad = aad_buf;
         phtonu64(aad, decoder->seq);         /* record sequence number */
         if (version == DTLSV1DOT2_VERSION) {
             phtonu16(aad, decoder->epoch);   /* DTLS 1.2 includes epoch. */
@@ -4850,7 +4915,7 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
         aad = decoder->dtls13_aad.data;
     } else if (draft_version >= 25 || draft_version == 0) {
         aad_len = 5;
-        aad = wmem_alloc(allocator, aad_len);
+        aad = aad_buf;
         aad[0] = ct;                        /* TLSCiphertext.opaque_type (23) */
         phtonu16(aad + 1, record_version);   /* TLSCiphertext.legacy_record_version (0x0303) */
         phtonu16(aad + 3, inl);              /* TLSCiphertext.length */
@@ -4913,10 +4978,8 @@ tls_decrypt_aead_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, Ssl
 }
 
 /* Record decryption glue based on security parameters {{{ */
-/* Assume that we are called only for a non-NULL decoder which also means that
- * we have a non-NULL decoder->cipher_suite. */
-int
-ssl_decrypt_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, SslDecoder *decoder, uint8_t ct, uint16_t record_version,
+static int
+ssl_decrypt_record_internal(SslDecryptSession *ssl, SslDecoder *decoder, uint8_t ct, uint16_t record_version,
         bool ignore_mac_failed,
         const unsigned char *in, uint16_t inl, const unsigned char *cid, uint8_t cidl,
         StringInfo *comp_str, StringInfo *out_str, unsigned *outl)
@@ -4950,7 +5013,7 @@ ssl_decrypt_record(wmem_allocator_t* allocator, SslDecryptSession *ssl, SslDecod
         ssl->session.version == TLSV1DOT3_VERSION ||
         ssl->session.version == DTLSV1DOT3_VERSION) {
 
-        if (!tls_decrypt_aead_record(allocator, ssl, decoder, ct, record_version, ignore_mac_failed, in, inl, cid, cidl, out_str, &worklen)) {
+        if (!tls_decrypt_aead_record(ssl, decoder, ct, record_version, ignore_mac_failed, in, inl, cid, cidl, out_str, &worklen)) {
             /* decryption failed */
             return -1;
         }
@@ -5144,6 +5207,27 @@ skip_mac:
 
     return 0;
 }
+
+/* Assume that we are called only for a non-NULL decoder which also means that
+ * we have a non-NULL decoder->cipher_suite. */
+int
+ssl_decrypt_record(wmem_allocator_t* allocator _U_, SslDecryptSession *ssl, SslDecoder *decoder, uint8_t ct, uint16_t record_version,
+        bool ignore_mac_failed,
+        const unsigned char *in, uint16_t inl, const unsigned char *cid, uint8_t cidl,
+        StringInfo *comp_str, StringInfo *out_str, unsigned *outl)
+{
+    int64_t start = tls_decrypt_stats_start();
+    int ret = ssl_decrypt_record_internal(ssl, decoder, ct, record_version, ignore_mac_failed,
+                                          in, inl, cid, cidl, comp_str, out_str, outl);
+
+    tls_decrypt_stats.records++;
+    tls_decrypt_stats.record_bytes += inl;
+    if (ret < 0) {
+        tls_decrypt_stats.records_failed++;
+    }
+    tls_decrypt_stats_stop(&tls_decrypt_stats.record_us, start);
+    return ret;
+}
 /* Record decryption glue based on security parameters }}} */
 
 
@@ -6302,6 +6386,73 @@ typedef struct ssl_master_key_match_group {
     GHashTable *master_key_ht;
 } ssl_master_key_match_group_t;
 
+typedef struct ssl_master_key_label {
+    const char *label;          /* including the separating space */
+    GHashTable *master_key_ht;
+    unsigned    secret_len;     /* required secret length, 0 for any */
+} ssl_master_key_label_t;
+
+/*
+ * Parses the "LABEL <client_random> <secret>" lines that make up nearly all
+ * of a key log file without going through the regex. Returns false if the
+ * line is not of that form, it is then left to the regex which also deals
+ * with the less common formats and reports invalid lines.
+ */
+static bool
+tls_keylog_process_line_fast(const ssl_master_key_label_t *labels, unsigned labels_count,
+                             const char *line, size_t linelen)
+{
+    const ssl_master_key_label_t *l = NULL;
+    const char *crandom, *secret, *line_end = line + linelen;
+    size_t label_len = 0, hex_len;
+    StringInfo *key, *ms;
+
+    for (unsigned i = 0; i < labels_count; i++) {
+        label_len = strlen(labels[i].label);
+        if (linelen > label_len && memcmp(line, labels[i].label, label_len) == 0) {
+            l = &labels[i];
+            break;
+        }
+    }
+    if (!l) {
+        return false;
+    }
+
+    /* 32 bytes of Client Random followed by a space. */
+    crandom = line + label_len;
+    if (line_end - crandom < 2 * 32 + 1 || crandom[2 * 32] != ' ') {
+        return false;
+    }
+    for (hex_len = 0; hex_len < 2 * 32; hex_len++) {
+        if (!g_ascii_isxdigit(crandom[hex_len])) {
+            return false;
+        }
+    }
+
+    /* Like the regex, ignore anything after the secret. */
+    secret = crandom + 2 * 32 + 1;
+    for (hex_len = 0; secret + hex_len < line_end && g_ascii_isxdigit(secret[hex_len]); hex_len++)
+        ;
+    if (l->secret_len) {
+        if (hex_len < 2 * l->secret_len) {
+            return false;
+        }
+        hex_len = 2 * l->secret_len;
+    } else {
+        hex_len &= ~(size_t)1;
+        if (hex_len == 0) {
+            return false;
+        }
+    }
+
+    key = wmem_new(wmem_file_scope(), StringInfo);
+    ms = wmem_new(wmem_file_scope(), StringInfo);
+    from_hex(key, crandom, 2 * 32);
+    from_hex(ms, secret, hex_len);
+    g_hash_table_insert(l->master_key_ht, key, ms);
+    return true;
+}
+
 void
 tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data, unsigned datalen)
 {
@@ -6321,6 +6472,16 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
         { "ech_secret",         mk_map->ech_secret },
         { "ech_config",         mk_map->ech_config },
     };
+    ssl_master_key_label_t mk_labels[] = {
+        { "CLIENT_RANDOM ",                     mk_map->crandom, SSL_MASTER_SECRET_LENGTH },
+        { "CLIENT_EARLY_TRAFFIC_SECRET ",       mk_map->tls13_client_early, 0 },
+        { "CLIENT_HANDSHAKE_TRAFFIC_SECRET ",   mk_map->tls13_client_handshake, 0 },
+        { "SERVER_HANDSHAKE_TRAFFIC_SECRET ",   mk_map->tls13_server_handshake, 0 },
+        { "CLIENT_TRAFFIC_SECRET_0 ",           mk_map->tls13_client_appdata, 0 },
+        { "SERVER_TRAFFIC_SECRET_0 ",           mk_map->tls13_server_appdata, 0 },
+        { "EARLY_EXPORTER_SECRET ",             mk_map->tls13_early_exporter, 0 },
+        { "EXPORTER_SECRET ",                   mk_map->tls13_exporter, 0 },
+    };
 
     /* The format of the file is a series of records with one of the following formats:
      *   - "RSA xxxx yyyy"
@@ -6382,6 +6543,12 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
         }
 
         ssl_debug_printf("  checking keylog line: %.*s\n", (int)linelen, line);
+        if (tls_keylog_process_line_fast(mk_labels, G_N_ELEMENTS(mk_labels), line, linelen)) {
+            tls_decrypt_stats.keylog_lines++;
+            tls_decrypt_stats.keylog_fast_lines++;
+            continue;
+        }
+
         GMatchInfo *mi;
         if (g_regex_match_full(regex, line, linelen, 0, G_REGEX_MATCH_ANCHORED, &mi, NULL)) {
             char *hex_key, *hex_pre_ms_or_ms;
@@ -6425,6 +6592,7 @@ tls_keylog_process_lines(const ssl_master_key_map_t *mk_map, const uint8_t *data
             DISSECTOR_ASSERT(ht); /* Cannot be reached, or regex is wrong. */
 
             g_hash_table_insert(ht, key, pre_ms_or_ms);
+            tls_decrypt_stats.keylog_lines++;
 
         } else if (linelen > 0 && line[0] != '#') {
             ssl_debug_printf("    unrecognized line\n");
@@ -6467,6 +6635,7 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
         }
     }
 
+    int64_t start = tls_decrypt_stats_start();
     for (;;) {
         char buf[1110], *line;
         line = fgets(buf, sizeof(buf), *keylog_file);
@@ -6483,6 +6652,7 @@ ssl_load_keyfile(const char *tls_keylog_filename, FILE **keylog_file,
         }
         tls_keylog_process_lines(mk_map, (uint8_t *)line, (int)strlen(line));
     }
+    tls_decrypt_stats_stop(&tls_decrypt_stats.keylog_us, start);
 }
 /** SSL keylog file handling. }}} */
 
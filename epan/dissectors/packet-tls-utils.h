@@ -26,6 +26,7 @@
 
 /* TODO inline this now that Libgcrypt is mandatory? */
 #define SSL_CIPHER_CTX gcry_cipher_hd_t
+#define SSL_HMAC gcry_md_hd_t
 #define SSL_DECRYPT_DEBUG
 
 
@@ -362,6 +363,7 @@ typedef struct _SslDecoder {
     StringInfo write_iv; /* for AEAD ciphers (at least GCM, CCM) */
     SSL_CIPHER_CTX sn_evp; /* used to decrypt serial number in DTLSv1.3 */
     SSL_CIPHER_CTX evp;
+    SSL_HMAC mac_hd; /**< HMAC keyed with mac_key, reused for every record. */
     SslDecompress *decomp;
     uint64_t dtls13_epoch;
     uint64_t seq;    /**< Implicit (TLS) or explicit (DTLS) record sequence number. */
@@ -842,6 +844,28 @@ extern void
 ssl_load_keyfile(const char *ssl_keylog_filename, FILE **keylog_file,
                  const ssl_master_key_map_t *mk_map);
 
+/** Counters of the TLS/DTLS decryption engine, reported by "-z tls,decrypt-stats". */
+typedef struct {
+    uint64_t keylog_lines;      /**< Key log lines added to the secrets map. */
+    uint64_t keylog_fast_lines; /**< Of those, lines parsed without the regex. */
+    uint64_t keylog_us;         /**< Time spent reading key log files. */
+    uint64_t keyring_count;     /**< Session key derivations. */
+    uint64_t keyring_us;        /**< Time spent deriving session keys. */
+    uint64_t records;           /**< Records passed to ssl_decrypt_record(). */
+    uint64_t records_failed;    /**< Records that could not be decrypted. */
+    uint64_t record_bytes;      /**< Ciphertext bytes of those records. */
+    uint64_t record_us;         /**< Time spent decrypting records. */
+} tls_decrypt_stats_t;
+
+/** Clears the decryption counters and enables or disables timing
+ * measurements, which are off by default. */
+WS_DLL_PUBLIC void
+tls_decrypt_stats_enable(bool enable);
+
+/** Returns the decryption counters collected so far. */
+WS_DLL_PUBLIC const tls_decrypt_stats_t *
+tls_decrypt_stats_get(void);
+
 #ifdef HAVE_LIBGNUTLS
 /* parse ssl related preferences (private keys and ports association strings) */
 extern void
@@ -290,10 +290,61 @@ static void epan_plugin_register_all_tap_listeners(void *data, void *user_data _
 		plug->register_all_tap_listeners();
 }
 
+/*
+ * How long the steps of epan_init() take, logged at the "info" level,
+ * e.g. with "--log-level=info --log-domains=epan".
+ */
+#define EPAN_INIT_MAX_STEPS 16
+
+typedef struct {
+	const char *name;
+	int64_t usecs;
+} epan_init_step;
+
+static epan_init_step epan_init_steps[EPAN_INIT_MAX_STEPS];
+static unsigned epan_init_num_steps;
+static int64_t epan_init_step_start;
+
+static void
+epan_init_step_done(const char *name)
+{
+	int64_t now = g_get_monotonic_time();
+
+	if (epan_init_num_steps < EPAN_INIT_MAX_STEPS) {
+		epan_init_steps[epan_init_num_steps].name = name;
+		epan_init_steps[epan_init_num_steps].usecs = now - epan_init_step_start;
+		epan_init_num_steps++;
+	}
+	epan_init_step_start = now;
+}
+
+static void
+epan_init_log_timing(int64_t start)
+{
+	GString *steps;
+	unsigned i;
+
+	if (!ws_log_msg_is_active(WS_LOG_DOMAIN, LOG_LEVEL_INFO))
+		return;
+
+	steps = g_string_new(NULL);
+	for (i = 0; i < epan_init_num_steps; i++) {
+		g_string_append_printf(steps, "%s%s %.1f ms", i ? ", " : "",
+				epan_init_steps[i].name, epan_init_steps[i].usecs / 1000.0);
+	}
+	ws_info("epan_init() took %.1f ms: %s",
+			(g_get_monotonic_time() - start) / 1000.0, steps->str);
+	g_string_free(steps, true);
+}
+
 bool
 epan_init(register_cb cb, void *client_data, bool load_plugins, epan_app_data_t* app_data)
 {
 	volatile bool status = true;
+	int64_t start = g_get_monotonic_time();
+
+	epan_init_step_start = start;
+	epan_init_num_steps = 0;
 	epan_env_prefix_cache = g_strdup(app_data->env_var_prefix);
 
 	/* Get the value of some environment variables and set corresponding globals for performance reasons*/
@@ -371,6 +422,8 @@ epan_init(register_cb cb, void *client_data, bool load_plugins, epan_app_data_t*
 	signal(SIGPIPE, SIG_IGN);
 #endif
 
+	epan_init_step_done("libraries and plugins");
+
 	TRY {
 		export_pdu_init();
 		tap_init();
@@ -392,8 +445,10 @@ epan_init(register_cb cb, void *client_data, bool load_plugins, epan_app_data_t*
 		stats_tree_init();
 		stat_tap_init();
 		g_slist_foreach(epan_plugins, epan_plugin_init, NULL);
+		epan_init_step_done("subsystems");
 		proto_init(epan_plugin_register_all_procotols, epan_plugin_register_all_handoffs,
 			(app_data != NULL) ? app_data->register_func : NULL, (app_data != NULL) ? app_data->handoff_func : NULL, cb, client_data);
+		epan_init_step_done("protocol registration");
 		g_slist_foreach(epan_plugins, epan_plugin_register_all_tap_listeners, NULL);
 		packet_cache_proto_handles();
 		dfilter_init(epan_env_prefix_cache);
@@ -401,12 +456,16 @@ epan_init(register_cb cb, void *client_data, bool load_plugins, epan_app_data_t*
 		final_registration_all_protocols();
 		print_cache_field_handles();
 		expert_packet_init();
+		epan_init_step_done("display filters");
 #ifdef HAVE_LUA
 		wslua_init(cb, client_data, epan_env_prefix_cache);
+		epan_init_step_done("Lua");
 #endif
 		g_slist_foreach(epan_plugins, epan_plugin_post_init, NULL);
 		register_all_tap_listeners(app_data->tap_reg_listeners);
+		epan_init_step_done("taps");
 		uat_load_all(epan_env_prefix_cache);
+		epan_init_step_done("UATs");
 	}
 	CATCH(DissectorError) {
 		/*
@@ -427,6 +486,7 @@ epan_init(register_cb cb, void *client_data, bool load_plugins, epan_app_data_t*
 		status = false;
 	}
 	ENDTRY;
+	epan_init_log_timing(start);
 	return status;
 }
 
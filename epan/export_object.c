@@ -21,6 +21,7 @@ struct register_eo {
     const char* tap_listen_str;          /* string used in register_tap_listener (NULL to use protocol name) */
     tap_packet_cb eo_func;               /* function to be called for new incoming packets for SRT */
     export_object_gui_reset_cb reset_cb; /* function to parse parameters of optional arguments of tap string */
+    bool entries_mutable;                /* entries are updated through get_entry after being added */
 };
 
 static wmem_tree_t *registered_eo_tables;
@@ -42,6 +43,7 @@ register_export_object(const int proto_id, tap_packet_cb export_packet_func, exp
     table->tap_listen_str = wmem_strdup_printf(wmem_epan_scope(), "%s_eo", proto_get_protocol_filter_name(proto_id));
     table->eo_func = export_packet_func;
     table->reset_cb = reset_cb;
+    table->entries_mutable = false;
 
     wmem_tree_insert_string(registered_eo_tables, proto_get_protocol_filter_name(proto_id), table, 0);
     return register_tap(table->tap_listen_str);
@@ -70,6 +72,19 @@ export_object_gui_reset_cb get_eo_reset_func(register_eo_t* eo)
     return eo->reset_cb;
 }
 
+void set_eo_entries_mutable(const int proto_id)
+{
+    register_eo_t *eo = get_eo_by_name(proto_get_protocol_filter_name(proto_id));
+
+    DISSECTOR_ASSERT(eo);
+    eo->entries_mutable = true;
+}
+
+bool get_eo_entries_mutable(register_eo_t* eo)
+{
+    return eo->entries_mutable;
+}
+
 register_eo_t* get_eo_by_name(const char* name)
 {
     return (register_eo_t*)wmem_tree_lookup_string(registered_eo_tables, name, 0);
@@ -109,6 +109,20 @@ WS_DLL_PUBLIC tap_packet_cb get_eo_packet_func(register_eo_t* eo);
  */
 WS_DLL_PUBLIC export_object_gui_reset_cb get_eo_reset_func(register_eo_t* eo);
 
+/** Declare that the Export Object tap of a protocol keeps updating entries
+ * (retrieved through get_entry) after passing them to add_entry, so they
+ * are only complete at the end of the pass. Entries of other protocols
+ * are complete when added and may be written out and freed immediately.
+ * @param proto_id protocol whose Export Object has already been registered
+ */
+WS_DLL_PUBLIC void set_eo_entries_mutable(const int proto_id);
+
+/** Whether the entries of an Export Object may change after being added
+ * @param eo Registered Export Object
+ * @return true if entries are only complete at the end of the pass
+ */
+WS_DLL_PUBLIC bool get_eo_entries_mutable(register_eo_t* eo);
+
 /** Get Export Object by its protocol filter name
  *
  * @param name protocol filter name to fetch.
@@ -12,6 +12,7 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,6 +20,8 @@
 #include <epan/packet.h>
 #include "follow.h"
 #include <epan/tap.h>
+#include <wsutil/file_util.h>
+#include <wsutil/pint.h>
 
 struct register_follow {
     int proto_id;              /* protocol id (0-indexed) */
@@ -30,10 +33,18 @@ struct register_follow {
     tap_packet_cb tap_handler; /* tap listener handler */
     follow_stream_count_func stream_count; /* maximum stream count, used for UI */
     follow_sub_stream_id_func sub_stream_id; /* sub-stream id, used for UI */
+    follow_tap_stream_id_func tap_stream_id; /* stream id of tap data, used for bulk follow */
 };
 
 static wmem_tree_t *registered_followers;
 
+static bool
+follow_stream_tap_data_stream_id(const void *tap_data, uint64_t *stream_id)
+{
+    *stream_id = ((const follow_stream_tap_data_t *)tap_data)->stream_id;
+    return true;
+}
+
 void follow_init(void)
 {
     registered_followers = wmem_tree_new(wmem_epan_scope());
@@ -63,6 +74,7 @@ void register_follow_stream(const int proto_id, const char* tap_listener,
     follower->tap_handler    = tap_handler;
     follower->stream_count   = stream_count;
     follower->sub_stream_id  = sub_stream_id;
+    follower->tap_stream_id  = (tap_handler == follow_stream_tap_listener) ? follow_stream_tap_data_stream_id : NULL;
 
     wmem_tree_insert_string(registered_followers, proto_get_protocol_short_name(find_protocol_by_id(proto_id)), follower, 0);
 }
@@ -118,6 +130,16 @@ follow_sub_stream_id_func get_follow_sub_stream_id_func(register_follow_t* follo
     return follower->sub_stream_id;
 }
 
+void set_follow_tap_stream_id_func(register_follow_t* follower, follow_tap_stream_id_func stream_id)
+{
+    follower->tap_stream_id = stream_id;
+}
+
+follow_tap_stream_id_func get_follow_tap_stream_id_func(register_follow_t* follower)
+{
+    return follower->tap_stream_id;
+}
+
 register_follow_t* get_follow_by_name(const char* proto_short_name)
 {
     return (register_follow_t*)wmem_tree_lookup_string(registered_followers, proto_short_name, 0);
@@ -279,6 +301,498 @@ follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
                                       &pinfo->src, pinfo->srcport);
 }
 
+/*
+ * Bulk follow container, all integers little-endian:
+ *
+ *   header:  magic "WSFOLLOW", uint32 version, uint32 name length,
+ *            follower protocol short name
+ *   chunk:   uint64 stream id, uint64 offset of the previous chunk of the
+ *            same stream (0 if none), uint32 frame number, uint32 flags,
+ *            int64 seconds, int32 nanoseconds, uint32 data length, data
+ *   index:   per stream, in ascending stream id order: uint64 stream id,
+ *            uint64 offset of the last chunk, uint32 chunk count,
+ *            uint32 bytes written by client and server, uint32 client and
+ *            server port, then client and server address as uint32 type,
+ *            uint32 length, data
+ *   trailer: uint64 index offset, uint64 stream count, magic "WSFOLIDX"
+ */
+#define FOLLOW_BULK_MAGIC           "WSFOLLOW"
+#define FOLLOW_BULK_INDEX_MAGIC     "WSFOLIDX"
+#define FOLLOW_BULK_MAGIC_LEN       8
+#define FOLLOW_BULK_VERSION         1
+#define FOLLOW_BULK_HEADER_LEN      (FOLLOW_BULK_MAGIC_LEN + 8)
+#define FOLLOW_BULK_CHUNK_LEN       40
+#define FOLLOW_BULK_INDEX_LEN       36
+#define FOLLOW_BULK_TRAILER_LEN     (16 + FOLLOW_BULK_MAGIC_LEN)
+#define FOLLOW_BULK_FLAG_SERVER     0x00000001
+#define FOLLOW_BULK_MAX_ADDR_LEN    256
+
+typedef struct {
+    follow_info_t info;
+    uint64_t last_chunk;        /* offset of the most recent chunk, 0 if none */
+    uint32_t chunk_count;
+} follow_bulk_stream_t;
+
+struct _follow_bulk {
+    register_follow_t *follower;
+    FILE *fh;
+    uint64_t offset;            /* current write offset */
+    GHashTable *streams;        /* stream id -> follow_bulk_stream_t */
+    unsigned indexed_streams;   /* streams in the index, set by follow_bulk_finish() */
+    int err;                    /* first write error, 0 if none */
+};
+
+static void
+follow_bulk_stream_free(void *data)
+{
+    follow_bulk_stream_t *stream = (follow_bulk_stream_t *)data;
+
+    follow_reset_stream(&stream->info);
+    g_free(stream);
+}
+
+static bool
+follow_bulk_write(follow_bulk_t *bulk, const void *data, size_t len)
+{
+    if (bulk->err != 0)
+        return false;
+
+    if (len != 0 && fwrite(data, 1, len, bulk->fh) != len) {
+        bulk->err = errno ? errno : EIO;
+        return false;
+    }
+    bulk->offset += len;
+    return true;
+}
+
+static bool
+follow_bulk_write_address(follow_bulk_t *bulk, const address *addr)
+{
+    uint8_t hdr[8];
+
+    phtoleu32(&hdr[0], (uint32_t)addr->type);
+    phtoleu32(&hdr[4], (uint32_t)addr->len);
+    return follow_bulk_write(bulk, hdr, sizeof hdr) &&
+           follow_bulk_write(bulk, addr->data, addr->len);
+}
+
+follow_bulk_t *
+follow_bulk_new(register_follow_t* follower, const char* path, int* err)
+{
+    follow_bulk_t *bulk;
+    const char *name;
+    uint8_t hdr[FOLLOW_BULK_HEADER_LEN];
+
+    if (follower->tap_stream_id == NULL) {
+        *err = ENOTSUP;
+        return NULL;
+    }
+
+    bulk = g_new0(follow_bulk_t, 1);
+    bulk->follower = follower;
+    bulk->fh = ws_fopen(path, "wb");
+    if (bulk->fh == NULL) {
+        *err = errno;
+        g_free(bulk);
+        return NULL;
+    }
+    bulk->streams = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, follow_bulk_stream_free);
+
+    name = proto_get_protocol_short_name(find_protocol_by_id(follower->proto_id));
+    memcpy(hdr, FOLLOW_BULK_MAGIC, FOLLOW_BULK_MAGIC_LEN);
+    phtoleu32(&hdr[FOLLOW_BULK_MAGIC_LEN], FOLLOW_BULK_VERSION);
+    phtoleu32(&hdr[FOLLOW_BULK_MAGIC_LEN + 4], (uint32_t)strlen(name));
+    if (!follow_bulk_write(bulk, hdr, sizeof hdr) ||
+        !follow_bulk_write(bulk, name, strlen(name))) {
+        *err = bulk->err;
+        follow_bulk_free(bulk);
+        ws_unlink(path);
+        return NULL;
+    }
+
+    return bulk;
+}
+
+static void
+follow_bulk_write_record(follow_bulk_t *bulk, follow_bulk_stream_t *stream, follow_record_t *follow_record)
+{
+    uint8_t hdr[FOLLOW_BULK_CHUNK_LEN];
+    uint64_t chunk_offset = bulk->offset;
+
+    phtoleu64(&hdr[0], stream->info.stream_id);
+    phtoleu64(&hdr[8], stream->last_chunk);
+    phtoleu32(&hdr[16], follow_record->packet_num);
+    phtoleu32(&hdr[20], follow_record->is_server ? FOLLOW_BULK_FLAG_SERVER : 0);
+    phtoleu64(&hdr[24], (uint64_t)follow_record->abs_ts.secs);
+    phtoleu32(&hdr[32], (uint32_t)follow_record->abs_ts.nsecs);
+    phtoleu32(&hdr[36], follow_record->data->len);
+
+    if (follow_bulk_write(bulk, hdr, sizeof hdr) &&
+        follow_bulk_write(bulk, follow_record->data->data, follow_record->data->len)) {
+        stream->last_chunk = chunk_offset;
+        stream->chunk_count++;
+    }
+}
+
+tap_packet_status
+follow_bulk_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt,
+                         const void *data, tap_flags_t flags)
+{
+    follow_bulk_t *bulk = (follow_bulk_t *)tapdata;
+    follow_bulk_stream_t *stream;
+    follow_record_t *follow_record;
+    GList *cur;
+    uint64_t stream_id;
+
+    if (bulk->fh == NULL || bulk->err != 0)
+        return TAP_PACKET_DONT_REDRAW;
+
+    if (!bulk->follower->tap_stream_id(data, &stream_id))
+        return TAP_PACKET_DONT_REDRAW;
+
+    stream = (follow_bulk_stream_t *)g_hash_table_lookup(bulk->streams, &stream_id);
+    if (stream == NULL) {
+        stream = g_new0(follow_bulk_stream_t, 1);
+        stream->info.stream_id = stream_id;
+        stream->info.substream_id = SUBSTREAM_UNUSED;
+        g_hash_table_insert(bulk->streams, &stream->info.stream_id, stream);
+    }
+
+    bulk->follower->tap_handler(&stream->info, pinfo, edt, data, flags);
+
+    /* Spill the chunks the follower produced for this packet (the payload
+     * list is in reverse order) and keep only the reassembly state. */
+    for (cur = g_list_last(stream->info.payload); cur; cur = g_list_previous(cur)) {
+        follow_record = (follow_record_t *)cur->data;
+        follow_bulk_write_record(bulk, stream, follow_record);
+        if (follow_record->data)
+            g_byte_array_free(follow_record->data, true);
+        g_free(follow_record);
+    }
+    g_list_free(stream->info.payload);
+    stream->info.payload = NULL;
+
+    return TAP_PACKET_DONT_REDRAW;
+}
+
+static int
+follow_bulk_stream_compare(const void *a, const void *b)
+{
+    const follow_bulk_stream_t *stream_a = *(const follow_bulk_stream_t **)a;
+    const follow_bulk_stream_t *stream_b = *(const follow_bulk_stream_t **)b;
+
+    if (stream_a->info.stream_id < stream_b->info.stream_id)
+        return -1;
+    return stream_a->info.stream_id > stream_b->info.stream_id;
+}
+
+bool
+follow_bulk_finish(follow_bulk_t* bulk, int* err)
+{
+    GPtrArray *sorted;
+    GHashTableIter iter;
+    void *value;
+    uint8_t buf[FOLLOW_BULK_INDEX_LEN];
+    uint64_t index_offset;
+    unsigned i;
+
+    if (bulk->fh == NULL) {
+        *err = bulk->err;
+        return bulk->err == 0;
+    }
+
+    sorted = g_ptr_array_sized_new(g_hash_table_size(bulk->streams));
+    g_hash_table_iter_init(&iter, bulk->streams);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        /* Streams whose packets were all empty (e.g. bare ACKs) have no
+         * chunks and are left out of the index. */
+        if (((follow_bulk_stream_t *)value)->chunk_count != 0)
+            g_ptr_array_add(sorted, value);
+    }
+    g_ptr_array_sort(sorted, follow_bulk_stream_compare);
+
+    index_offset = bulk->offset;
+    for (i = 0; i < sorted->len; i++) {
+        follow_bulk_stream_t *stream = (follow_bulk_stream_t *)g_ptr_array_index(sorted, i);
+
+        phtoleu64(&buf[0], stream->info.stream_id);
+        phtoleu64(&buf[8], stream->last_chunk);
+        phtoleu32(&buf[16], stream->chunk_count);
+        phtoleu32(&buf[20], stream->info.bytes_written[0]);
+        phtoleu32(&buf[24], stream->info.bytes_written[1]);
+        phtoleu32(&buf[28], stream->info.client_port);
+        phtoleu32(&buf[32], stream->info.server_port);
+        if (!follow_bulk_write(bulk, buf, sizeof buf) ||
+            !follow_bulk_write_address(bulk, &stream->info.client_ip) ||
+            !follow_bulk_write_address(bulk, &stream->info.server_ip))
+            break;
+    }
+
+    phtoleu64(&buf[0], index_offset);
+    phtoleu64(&buf[8], sorted->len);
+    memcpy(&buf[16], FOLLOW_BULK_INDEX_MAGIC, FOLLOW_BULK_MAGIC_LEN);
+    follow_bulk_write(bulk, buf, FOLLOW_BULK_TRAILER_LEN);
+    bulk->indexed_streams = sorted->len;
+    g_ptr_array_free(sorted, true);
+
+    if (fclose(bulk->fh) == EOF && bulk->err == 0)
+        bulk->err = errno;
+    bulk->fh = NULL;
+
+    *err = bulk->err;
+    return bulk->err == 0;
+}
+
+unsigned
+follow_bulk_get_stream_count(follow_bulk_t* bulk)
+{
+    return bulk->indexed_streams;
+}
+
+uint64_t
+follow_bulk_get_bytes_written(follow_bulk_t* bulk)
+{
+    return bulk->offset;
+}
+
+void
+follow_bulk_free(follow_bulk_t* bulk)
+{
+    if (bulk->fh)
+        fclose(bulk->fh);
+    if (bulk->streams)
+        g_hash_table_destroy(bulk->streams);
+    g_free(bulk);
+}
+
+typedef struct {
+    uint64_t stream_id;
+    uint64_t last_chunk;
+    uint32_t chunk_count;
+    uint32_t bytes_written[2];
+    uint32_t client_port;
+    uint32_t server_port;
+    address client_ip;
+    address server_ip;
+} follow_bulk_index_t;
+
+struct _follow_bulk_reader {
+    FILE *fh;
+    uint64_t file_size;
+    char *follower_name;
+    GArray *index;              /* follow_bulk_index_t, ascending stream id */
+};
+
+static bool
+follow_bulk_read(follow_bulk_reader_t *reader, void *buf, size_t len)
+{
+    return len == 0 || fread(buf, 1, len, reader->fh) == len;
+}
+
+static bool
+follow_bulk_read_address(follow_bulk_reader_t *reader, address *addr)
+{
+    uint8_t hdr[8];
+    uint32_t len;
+    void *data;
+
+    if (!follow_bulk_read(reader, hdr, sizeof hdr))
+        return false;
+    len = pletohu32(&hdr[4]);
+    if (len > FOLLOW_BULK_MAX_ADDR_LEN)
+        return false;
+    data = g_malloc(len);
+    if (!follow_bulk_read(reader, data, len)) {
+        g_free(data);
+        return false;
+    }
+    alloc_address_wmem(NULL, addr, (int)pletohu32(&hdr[0]), (int)len, data);
+    g_free(data);
+    return true;
+}
+
+follow_bulk_reader_t*
+follow_bulk_reader_open(const char* path, int* err)
+{
+    follow_bulk_reader_t *reader;
+    uint8_t buf[FOLLOW_BULK_INDEX_LEN];
+    uint64_t index_offset, stream_count, i;
+    uint32_t name_len;
+    ws_statb64 statb;
+
+    reader = g_new0(follow_bulk_reader_t, 1);
+    reader->index = g_array_new(false, false, sizeof(follow_bulk_index_t));
+    reader->fh = ws_fopen(path, "rb");
+    if (reader->fh == NULL || ws_fstat64(ws_fileno(reader->fh), &statb) != 0) {
+        *err = errno;
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+    reader->file_size = (uint64_t)statb.st_size;
+    *err = EINVAL;
+
+    if (reader->file_size < FOLLOW_BULK_HEADER_LEN + FOLLOW_BULK_TRAILER_LEN ||
+        !follow_bulk_read(reader, buf, FOLLOW_BULK_HEADER_LEN) ||
+        memcmp(buf, FOLLOW_BULK_MAGIC, FOLLOW_BULK_MAGIC_LEN) != 0 ||
+        pletohu32(&buf[FOLLOW_BULK_MAGIC_LEN]) != FOLLOW_BULK_VERSION) {
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+    name_len = pletohu32(&buf[FOLLOW_BULK_MAGIC_LEN + 4]);
+    if (name_len > reader->file_size - FOLLOW_BULK_HEADER_LEN - FOLLOW_BULK_TRAILER_LEN) {
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+    reader->follower_name = (char *)g_malloc0(name_len + 1);
+    if (!follow_bulk_read(reader, reader->follower_name, name_len)) {
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+
+    if (ws_fseek64(reader->fh, (int64_t)(reader->file_size - FOLLOW_BULK_TRAILER_LEN), SEEK_SET) != 0 ||
+        !follow_bulk_read(reader, buf, FOLLOW_BULK_TRAILER_LEN) ||
+        memcmp(&buf[16], FOLLOW_BULK_INDEX_MAGIC, FOLLOW_BULK_MAGIC_LEN) != 0) {
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+    index_offset = pletohu64(&buf[0]);
+    stream_count = pletohu64(&buf[8]);
+    if (index_offset < FOLLOW_BULK_HEADER_LEN + name_len ||
+        index_offset > reader->file_size - FOLLOW_BULK_TRAILER_LEN ||
+        stream_count > (reader->file_size - FOLLOW_BULK_TRAILER_LEN - index_offset) / FOLLOW_BULK_INDEX_LEN ||
+        ws_fseek64(reader->fh, (int64_t)index_offset, SEEK_SET) != 0) {
+        follow_bulk_reader_close(reader);
+        return NULL;
+    }
+
+    g_array_set_size(reader->index, (unsigned)stream_count);
+    memset(reader->index->data, 0, sizeof(follow_bulk_index_t) * (size_t)stream_count);
+    for (i = 0; i < stream_count; i++) {
+        follow_bulk_index_t *entry = &g_array_index(reader->index, follow_bulk_index_t, i);
+
+        if (!follow_bulk_read(reader, buf, FOLLOW_BULK_INDEX_LEN)) {
+            follow_bulk_reader_close(reader);
+            return NULL;
+        }
+        entry->stream_id        = pletohu64(&buf[0]);
+        entry->last_chunk       = pletohu64(&buf[8]);
+        entry->chunk_count      = pletohu32(&buf[16]);
+        entry->bytes_written[0] = pletohu32(&buf[20]);
+        entry->bytes_written[1] = pletohu32(&buf[24]);
+        entry->client_port      = pletohu32(&buf[28]);
+        entry->server_port      = pletohu32(&buf[32]);
+        if (!follow_bulk_read_address(reader, &entry->client_ip) ||
+            !follow_bulk_read_address(reader, &entry->server_ip)) {
+            follow_bulk_reader_close(reader);
+            return NULL;
+        }
+    }
+
+    *err = 0;
+    return reader;
+}
+
+const char*
+follow_bulk_reader_follower_name(follow_bulk_reader_t* reader)
+{
+    return reader->follower_name;
+}
+
+unsigned
+follow_bulk_reader_stream_count(follow_bulk_reader_t* reader)
+{
+    return reader->index->len;
+}
+
+uint64_t
+follow_bulk_reader_stream_id(follow_bulk_reader_t* reader, unsigned n)
+{
+    return g_array_index(reader->index, follow_bulk_index_t, n).stream_id;
+}
+
+static int
+follow_bulk_index_compare(const void *key, const void *member)
+{
+    uint64_t stream_id = *(const uint64_t *)key;
+    const follow_bulk_index_t *entry = (const follow_bulk_index_t *)member;
+
+    if (stream_id < entry->stream_id)
+        return -1;
+    return stream_id > entry->stream_id;
+}
+
+bool
+follow_bulk_reader_get_stream(follow_bulk_reader_t* reader, uint64_t stream_id, follow_info_t* info)
+{
+    const follow_bulk_index_t *entry;
+    follow_record_t *follow_record;
+    uint8_t hdr[FOLLOW_BULK_CHUNK_LEN];
+    uint64_t offset;
+    uint32_t i, len;
+
+    entry = (const follow_bulk_index_t *)bsearch(&stream_id, reader->index->data, reader->index->len,
+                                                 sizeof(follow_bulk_index_t), follow_bulk_index_compare);
+    if (entry == NULL)
+        return false;
+
+    /* Walk the chunk chain backwards; prepending yields capture order,
+     * which is then reversed to match the payload list convention. */
+    offset = entry->last_chunk;
+    for (i = 0; i < entry->chunk_count && offset != 0; i++) {
+        if (ws_fseek64(reader->fh, (int64_t)offset, SEEK_SET) != 0 ||
+            !follow_bulk_read(reader, hdr, sizeof hdr) ||
+            pletohu64(&hdr[0]) != stream_id)
+            break;
+        len = pletohu32(&hdr[36]);
+        if (len > reader->file_size - offset - FOLLOW_BULK_CHUNK_LEN)
+            break;
+
+        follow_record = g_new0(follow_record_t, 1);
+        follow_record->is_server = (pletohu32(&hdr[20]) & FOLLOW_BULK_FLAG_SERVER) != 0;
+        follow_record->packet_num = pletohu32(&hdr[16]);
+        follow_record->abs_ts.secs = (time_t)pletohu64(&hdr[24]);
+        follow_record->abs_ts.nsecs = (int)pletohu32(&hdr[32]);
+        follow_record->data = g_byte_array_sized_new(len);
+        g_byte_array_set_size(follow_record->data, len);
+        if (!follow_bulk_read(reader, follow_record->data->data, len)) {
+            g_byte_array_free(follow_record->data, true);
+            g_free(follow_record);
+            break;
+        }
+        info->payload = g_list_prepend(info->payload, follow_record);
+        offset = pletohu64(&hdr[8]);
+    }
+    info->payload = g_list_reverse(info->payload);
+
+    info->stream_id = entry->stream_id;
+    info->substream_id = SUBSTREAM_UNUSED;
+    info->bytes_written[0] = entry->bytes_written[0];
+    info->bytes_written[1] = entry->bytes_written[1];
+    info->client_port = entry->client_port;
+    info->server_port = entry->server_port;
+    copy_address(&info->client_ip, &entry->client_ip);
+    copy_address(&info->server_ip, &entry->server_ip);
+
+    return i == entry->chunk_count;
+}
+
+void
+follow_bulk_reader_close(follow_bulk_reader_t* reader)
+{
+    unsigned i;
+
+    for (i = 0; i < reader->index->len; i++) {
+        follow_bulk_index_t *entry = &g_array_index(reader->index, follow_bulk_index_t, i);
+        free_address(&entry->client_ip);
+        free_address(&entry->server_ip);
+    }
+    g_array_free(reader->index, true);
+    g_free(reader->follower_name);
+    if (reader->fh)
+        fclose(reader->fh);
+    g_free(reader);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -91,6 +91,7 @@ typedef char* (*follow_address_filter_func)(address* src_addr, address* dst_addr
 typedef char* (*follow_port_to_display_func)(wmem_allocator_t *allocator, unsigned port);
 typedef uint32_t (*follow_stream_count_func)(void);
 typedef bool (*follow_sub_stream_id_func)(unsigned stream, unsigned sub_stream, bool le, unsigned *sub_stream_out);
+typedef bool (*follow_tap_stream_id_func)(const void *tap_data, uint64_t *stream_id);
 
 /**
  * @brief Register a new follow stream.
@@ -208,6 +209,29 @@ WS_DLL_PUBLIC follow_stream_count_func get_follow_stream_count_func(register_fol
  */
 WS_DLL_PUBLIC follow_sub_stream_id_func get_follow_sub_stream_id_func(register_follow_t* follower);
 
+/**
+ * @brief Set the function that extracts the stream index from the tap data
+ * queued by the follower's dissector.
+ *
+ * This is required for following all streams of a protocol at once (see
+ * follow_bulk_new()). Followers whose tap handler is
+ * follow_stream_tap_listener() get a default extractor for
+ * follow_stream_tap_data_t at registration time.
+ *
+ * @param follower [in] Registered follower
+ * @param stream_id [in] Stream index extractor, or NULL
+ */
+WS_DLL_PUBLIC void set_follow_tap_stream_id_func(register_follow_t* follower, follow_tap_stream_id_func stream_id);
+
+/**
+ * @brief Provide function that extracts the stream index from tap data
+ * The function can be NULL if the follower does not support bulk following
+ *
+ * @param follower [in] Registered follower
+ * @return A stream index extractor
+ */
+WS_DLL_PUBLIC follow_tap_stream_id_func get_follow_tap_stream_id_func(register_follow_t* follower);
+
 typedef struct _follow_stream_tap_data {
   tvbuff_t *tvb;
   uint64_t stream_id;
@@ -294,6 +318,116 @@ WS_DLL_PUBLIC void follow_reset_stream(follow_info_t* info);
  */
 WS_DLL_PUBLIC void follow_info_free(follow_info_t* follow_info);
 
+/* Bulk follow
+ *
+ * Follows every stream seen by a follower (or the subset matching the tap
+ * filter) in a single pass and writes the payload chunks to an indexed
+ * container file as soon as the follower's tap handler has produced them.
+ * Only the per-stream reassembly state (e.g. pending out-of-order TCP
+ * segments) is kept in memory.
+ *
+ * The container is a sequence of little-endian records: a file header,
+ * the payload chunks of all streams interleaved in capture order (each one
+ * linked to the previous chunk of its stream), and a per-stream index
+ * followed by a trailer pointing at the index.
+ */
+typedef struct _follow_bulk follow_bulk_t;
+
+/**
+ * @brief Create a bulk follower writing to a container file.
+ *
+ * Register the result as tap data with follow_bulk_tap_listener() as the
+ * packet callback, and call follow_bulk_finish() after the last packet.
+ *
+ * @param follower [in] Registered follower; must have a stream index extractor
+ * @param path [in] Path of the container file to create
+ * @param err [out] errno on failure
+ * @return The bulk follower, or NULL on failure
+ */
+WS_DLL_PUBLIC follow_bulk_t* follow_bulk_new(register_follow_t* follower, const char* path, int* err);
+
+/**
+ * @brief Tap listener for bulk following.
+ *
+ * Dispatches the tap data to the follower's own tap handler with the
+ * follow_info_t of the stream it belongs to, then writes out and frees
+ * the payload chunks that were produced.
+ */
+WS_DLL_PUBLIC tap_packet_status
+follow_bulk_tap_listener(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data, tap_flags_t flags);
+
+/**
+ * @brief Write the stream index and trailer and close the container.
+ *
+ * @param bulk [in] Bulk follower
+ * @param err [out] errno on failure
+ * @return true on success
+ */
+WS_DLL_PUBLIC bool follow_bulk_finish(follow_bulk_t* bulk, int* err);
+
+/**
+ * @brief Number of streams in the container's index, i.e. the streams
+ * with data; streams whose packets were all empty are left out.
+ * Only valid after follow_bulk_finish().
+ */
+WS_DLL_PUBLIC unsigned follow_bulk_get_stream_count(follow_bulk_t* bulk);
+
+/**
+ * @brief Number of bytes written to the container so far.
+ */
+WS_DLL_PUBLIC uint64_t follow_bulk_get_bytes_written(follow_bulk_t* bulk);
+
+/**
+ * @brief Free a bulk follower, closing the container if still open.
+ */
+WS_DLL_PUBLIC void follow_bulk_free(follow_bulk_t* bulk);
+
+typedef struct _follow_bulk_reader follow_bulk_reader_t;
+
+/**
+ * @brief Open a container written by a bulk follower.
+ *
+ * @param path [in] Path of the container file
+ * @param err [out] errno on failure, or EINVAL if the file is not a valid container
+ * @return The reader, or NULL on failure
+ */
+WS_DLL_PUBLIC follow_bulk_reader_t* follow_bulk_reader_open(const char* path, int* err);
+
+/**
+ * @brief Protocol short name of the follower that wrote the container,
+ * suitable for get_follow_by_name().
+ */
+WS_DLL_PUBLIC const char* follow_bulk_reader_follower_name(follow_bulk_reader_t* reader);
+
+/**
+ * @brief Number of streams in the container.
+ */
+WS_DLL_PUBLIC unsigned follow_bulk_reader_stream_count(follow_bulk_reader_t* reader);
+
+/**
+ * @brief Stream index of the n-th stream in the container, in ascending order.
+ */
+WS_DLL_PUBLIC uint64_t follow_bulk_reader_stream_id(follow_bulk_reader_t* reader, unsigned n);
+
+/**
+ * @brief Load one stream from the container.
+ *
+ * Fills the payload, byte counters, addresses and ports of a freshly
+ * allocated (zeroed) follow_info_t exactly as if the stream had been
+ * followed on its own. Free it with follow_info_free().
+ *
+ * @param reader [in] Container reader
+ * @param stream_id [in] Stream index
+ * @param info [out] Follow info to fill
+ * @return false if the stream is not in the container or could not be read
+ */
+WS_DLL_PUBLIC bool follow_bulk_reader_get_stream(follow_bulk_reader_t* reader, uint64_t stream_id, follow_info_t* info);
+
+/**
+ * @brief Close a container reader.
+ */
+WS_DLL_PUBLIC void follow_bulk_reader_close(follow_bulk_reader_t* reader);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -15,6 +15,8 @@
 
 #include <glib.h>
 
+#include <wsutil/ones_complement.h>
+
 #include <epan/tvbuff.h>
 #include <epan/in_cksum.h>
 
@@ -22,7 +24,9 @@
  * Checksum routine for Internet Protocol family headers (Portable Version).
  *
  * This routine is very heavily used in the network
- * code and should be modified for each CPU to be as fast as possible.
+ * code and should be modified for each CPU to be as fast as possible;
+ * the bulk of the work is done by ws_ones_complement_sum(), which uses
+ * vector instructions where available.
  */
 
 #define ADDCARRY(x)  {if ((x) > 65535) (x) -= 65535;}
@@ -95,28 +99,20 @@ in_cksum_ret_partial(const vec_t *vec, int veclen, uint16_t *partial)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Sum the whole words; ws_ones_complement_sum() does
+		 * that a wider word (or vector) at a time.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
+		if (mlen >= 2) {
+			REDUCE;
+			sum += ws_ones_complement_sum(w, mlen & ~1);
+			w += mlen >> 1;
+			mlen &= 1;
 		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
-		while ((mlen -= 2) >= 0) {
-			sum += *w++;
-		}
+		/* -1 if there's an odd byte left over, -2 otherwise */
+		mlen -= 2;
 		if (byte_swapped) {
 			REDUCE;
 			sum <<= 8;
@@ -929,6 +929,17 @@ remove_last_layer(packet_info *pinfo, bool reduce_count)
 }
 
 
+/*
+ * Exception cleanup handler that stops charging file scope memory to a
+ * dissector's protocol, for dissectors that throw; the exception may be
+ * caught by a dissector further up, which then allocates more.
+ */
+static void
+memory_accounting_cleanup(void *previous)
+{
+	proto_memory_accounting_leave((protocol_t *)previous);
+}
+
 /* This function will return
  *   >0  this protocol was successfully dissected and this was this protocol.
  *   0   this packet did not match this protocol.
@@ -944,6 +955,7 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 {
 	const char *saved_proto;
 	int	    saved_proto_layer_num;
+	protocol_t *saved_memory_protocol;
 	int         len;
 
 	saved_proto = pinfo->current_proto;
@@ -954,6 +966,13 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			proto_get_protocol_short_name(handle->protocol);
 	}
 
+	/* Register the protocol's fields if this is its first use. */
+	proto_register_pending_fields(handle->protocol);
+
+	/* Charge the file scope memory it allocates to it. */
+	saved_memory_protocol = proto_memory_accounting_enter(handle->protocol);
+	CLEANUP_PUSH(memory_accounting_cleanup, saved_memory_protocol);
+
 	switch (handle->dissector_type) {
 
 	case DISSECTOR_TYPE_SIMPLE:
@@ -967,6 +986,7 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 	default:
 		ws_assert_not_reached();
 	}
+	CLEANUP_CALL_AND_POP;
 	pinfo->current_proto = saved_proto;
 	pinfo->curr_proto_layer_num = saved_proto_layer_num;
 
@@ -3086,6 +3106,7 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	const char        *saved_curr_proto;
 	int                saved_proto_layer_num;
 	const char        *saved_heur_list_name;
+	protocol_t        *saved_memory_protocol;
 	GSList            *entry;
 	GSList            *prev_entry = NULL;
 	uint16_t           saved_can_desegment;
@@ -3150,8 +3171,13 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
+		proto_register_pending_fields(hdtbl_entry->protocol);
+
 		saved_desegment_len = pinfo->desegment_len;
+		saved_memory_protocol = proto_memory_accounting_enter(hdtbl_entry->protocol);
+		CLEANUP_PUSH(memory_accounting_cleanup, saved_memory_protocol);
 		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		CLEANUP_CALL_AND_POP;
 		consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 		if (hdtbl_entry->protocol != NULL &&
 			(consumed_none || (tree && saved_tree_count == tree->tree_data->count))) {
@@ -3738,8 +3764,10 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 	const char        *saved_curr_proto;
 	unsigned           saved_proto_layer_num;
 	const char        *saved_heur_list_name;
+	protocol_t        *saved_memory_protocol;
 	uint16_t           saved_can_desegment;
 	unsigned           saved_layers_len = 0;
+	bool               accepted;
 
 	DISSECTOR_ASSERT(heur_dtbl_entry);
 
@@ -3778,8 +3806,14 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 
 	pinfo->heur_list_name = heur_dtbl_entry->list_name;
 
+	proto_register_pending_fields(heur_dtbl_entry->protocol);
+
 	/* call the dissector, in case of failure call data handle (might happen with exported PDUs) */
-	if (!(*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+	saved_memory_protocol = proto_memory_accounting_enter(heur_dtbl_entry->protocol);
+	CLEANUP_PUSH(memory_accounting_cleanup, saved_memory_protocol);
+	accepted = (*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data);
+	CLEANUP_CALL_AND_POP;
+	if (!accepted) {
 		/*
 		 * We added a protocol layer above. The dissector
 		 * didn't accept the packet or it didn't add any
@@ -3341,6 +3341,15 @@ prefs_register_modules(void)
                                    "Wrap to beginning/end of file during search?",
                                    &prefs.gui_find_wrap);
 
+    prefs_register_uint_preference(gui_module, "find_index_memory",
+                                   "Memory for the packet bytes search index (MB)",
+                                   "Maximum memory in megabytes for an index of the packet bytes that is built "
+                                   "in the background after a capture file is read, or as packets are captured, "
+                                   "and lets string and hex searches skip packets that can't match. "
+                                   "0 disables the index.",
+                                   10,
+                                   &prefs.gui_find_index_memory);
+
     prefs_register_obsolete_preference(gui_module, "use_pref_save");
 
     prefs_register_bool_preference(gui_module, "geometry.save.position",
@@ -3626,7 +3635,7 @@ prefs_register_modules(void)
 
     prefs_register_uint_preference(gui_module, "packet_list_cached_rows_max",
                                    "Maximum cached rows",
-                                   "Maximum number of rows that can be sorted by columns that require dissection. Increasing this increases memory consumption by caching column text",
+                                   "Maximum number of rows whose column text is kept ready for display. Increasing this increases memory consumption by caching column text",
                                    10,
                                    &prefs.gui_packet_list_cached_rows_max);
 
@@ -3967,6 +3976,21 @@ prefs_register_modules(void)
             "of cache entries to maintain. A 0 means no limit.",
             10, &prefs.ignore_dup_frames_cache_entries);
 
+    prefs_register_uint_preference(protocols_module, "reassembly_memory_budget",
+            "Memory limit for incomplete reassemblies (MB)",
+            "The maximum amount of memory, in megabytes, that each reassembly table may use "
+            "for reassemblies that are still missing fragments. When it is exceeded, the "
+            "reassemblies that have gone the longest without a new fragment are discarded. "
+            "A 0 means no limit.",
+            10, &prefs.reassembly_memory_budget);
+
+    prefs_register_bool_preference(protocols_module, "reassembly_spill",
+            "Spill incomplete reassemblies to disk",
+            "If the reassembly memory limit is exceeded, write the fragments of the oldest "
+            "incomplete reassemblies to a temporary file instead of discarding them, and "
+            "read them back in if more fragments arrive.",
+            &prefs.reassembly_spill);
+
 
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
@@ -4207,6 +4231,7 @@ prefs_set_global_defaults(wmem_allocator_t* pref_scope, const char** col_fmt, in
     prefs.gui_ask_unsaved            = true;
     prefs.gui_autocomplete_filter    = true;
     prefs.gui_find_wrap              = true;
+    prefs.gui_find_index_memory      = 0;
     prefs.gui_update_enabled         = true;
     prefs.gui_update_channel         = UPDATE_CHANNEL_STABLE;
     prefs.gui_update_interval        = 60*60*24; /* Seconds */
@@ -4294,6 +4319,8 @@ prefs_set_global_defaults(wmem_allocator_t* pref_scope, const char** col_fmt, in
     prefs.display_abs_time_ascii = ABS_TIME_ASCII_TREE;
     prefs.ignore_dup_frames = false;
     prefs.ignore_dup_frames_cache_entries = 10000;
+    prefs.reassembly_memory_budget = 0;
+    prefs.reassembly_spill = false;
 
     /* set the default values for the io graph dialog */
     prefs.gui_io_graph_automatic_update = true;
@@ -242,6 +242,7 @@ typedef struct _e_prefs {
     bool          gui_ask_unsaved;              /**< If true, prompt before discarding unsaved changes */
     bool          gui_autocomplete_filter;      /**< If true, enable autocomplete in the display filter bar */
     bool          gui_find_wrap;                /**< If true, wrap around when reaching the end of search results */
+    unsigned      gui_find_index_memory;        /**< Maximum memory in MB for the index of the packet bytes used by searches, 0 to disable it */
 
     /* Window title */
     char         *gui_window_title;             /**< Custom suffix appended to the main window title */
@@ -324,6 +325,10 @@ typedef struct _e_prefs {
     bool          ignore_dup_frames;                   /**< If true, suppress display of duplicate frames */
     unsigned      ignore_dup_frames_cache_entries;     /**< Number of frames to cache for duplicate detection */
 
+    /* Reassembly */
+    unsigned      reassembly_memory_budget;            /**< Maximum MB of incomplete reassemblies per reassembly table; 0 means no limit */
+    bool          reassembly_spill;                    /**< If true, write incomplete reassemblies over the budget to a temporary file instead of discarding them */
+
     /* Migration flags */
     bool          filter_expressions_old;   /**< True if legacy filter expression preferences were loaded from disk */
     bool          cols_hide_new;            /**< True if the new index-based gui.column.hide preference was loaded */
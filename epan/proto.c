@@ -420,6 +420,8 @@ struct _protocol {
 	                                   can be added to a dissector table, but use the
 	                                   parent_proto_id for things like enable/disable */
 	GList      *heur_list;          /* Heuristic dissectors associated with this protocol */
+	bool        fields_pending;     /* true if the fields are registered on demand and may not be yet */
+	uint64_t    file_scope_bytes;   /* file scope memory allocated while this protocol's dissectors ran */
 };
 
 /* List of all protocols */
@@ -470,11 +472,18 @@ static GHashTable* prefixes;
 
 #define PROTO_PRE_ALLOC_HF_FIELDS_MEM (300000+PRE_ALLOC_EXPERT_FIELDS_MEM)
 
+/* The lookup index of a field's value_string, see hf_try_val_to_str_vs() */
+typedef struct _hf_vs_index_t {
+	const value_string *vs;		/* the array vsi was made for */
+	value_string_index *vsi;	/* NULL if vs is too small to index */
+} hf_vs_index_t;
+
 /* List which stores protocols and fields that have been registered */
 typedef struct _gpa_hfinfo_t {
 	uint32_t            len;
 	uint32_t            allocated_len;
 	header_field_info **hfi;
+	hf_vs_index_t      *vsi;
 } gpa_hfinfo_t;
 
 static gpa_hfinfo_t gpa_hfinfo;
@@ -611,6 +620,7 @@ void proto_pre_init(void)
 	gpa_hfinfo.len = 0;
 	gpa_hfinfo.allocated_len = 0;
 	gpa_hfinfo.hfi = NULL;
+	gpa_hfinfo.vsi = NULL;
 	gpa_name_map = wmem_map_new(wmem_epan_scope(), wmem_str_hash, g_str_equal);
 	wmem_map_reserve(gpa_name_map, PROTO_PRE_ALLOC_HF_FIELDS_MEM);
 	gpa_protocol_aliases = g_hash_table_new(wmem_str_hash, g_str_equal);
@@ -756,10 +766,15 @@ proto_cleanup_base(void)
 	}
 
 	if (gpa_hfinfo.allocated_len) {
+		for (uint32_t i = 0; i < gpa_hfinfo.len; i++) {
+			value_string_index_free(gpa_hfinfo.vsi[i].vsi);
+		}
 		gpa_hfinfo.len           = 0;
 		gpa_hfinfo.allocated_len = 0;
 		g_free(gpa_hfinfo.hfi);
 		gpa_hfinfo.hfi           = NULL;
+		g_free(gpa_hfinfo.vsi);
+		gpa_hfinfo.vsi           = NULL;
 	}
 
 	if (deregistered_fields) {
@@ -1102,6 +1117,156 @@ proto_register_prefix(const char *prefix, prefix_initializer_t pi ) {
 	g_hash_table_insert(prefixes, (void *)prefix, (void *)pi);
 }
 
+/* Register the field array of a protocol when it's first needed */
+void
+proto_register_fields_on_demand(const int parent, prefix_initializer_t pi)
+{
+	protocol_t *protocol = find_protocol_by_id(parent);
+
+	DISSECTOR_ASSERT(protocol != NULL);
+	protocol->fields_pending = true;
+	proto_register_prefix(protocol->filter_name, pi);
+}
+
+void
+proto_register_pending_fields(protocol_t *protocol)
+{
+	prefix_initializer_t pi;
+
+	if (protocol == NULL || !protocol->fields_pending)
+		return;
+
+	/* The prefix may already have been initialized by a field lookup;
+	 * either way there's nothing left to do for this protocol. */
+	protocol->fields_pending = false;
+	if (prefixes && (pi = (prefix_initializer_t)g_hash_table_lookup(prefixes, protocol->filter_name)) != NULL) {
+		g_hash_table_remove(prefixes, protocol->filter_name);
+		pi(protocol->filter_name);
+	}
+}
+
+/*
+ * File scope memory accounting: while it's enabled, the file scope counts
+ * each allocation into the counter of the protocol whose dissector is
+ * running, or into memory_unattributed_bytes outside of any dissector.
+ */
+static wmem_allocator_t *memory_accounting_scope;
+static protocol_t *memory_accounting_protocol;
+static uint64_t memory_unattributed_bytes;
+static unsigned memory_accounting_cb_id;
+
+static bool
+memory_accounting_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
+		void *user_data _U_)
+{
+	for (GList *l = protocols; l != NULL; l = g_list_next(l)) {
+		((protocol_t *)l->data)->file_scope_bytes = 0;
+	}
+	memory_unattributed_bytes = 0;
+
+	return true;
+}
+
+void
+proto_set_memory_accounting(bool enable)
+{
+	if (enable == (memory_accounting_scope != NULL))
+		return;
+
+	if (enable) {
+		memory_accounting_scope = wmem_file_scope();
+		memory_accounting_protocol = NULL;
+		wmem_set_allocation_counter(memory_accounting_scope, &memory_unattributed_bytes);
+		memory_accounting_cb_id = wmem_register_callback(memory_accounting_scope,
+				memory_accounting_reset_cb, NULL);
+	} else {
+		wmem_set_allocation_counter(memory_accounting_scope, NULL);
+		wmem_unregister_callback(memory_accounting_scope, memory_accounting_cb_id);
+		memory_accounting_scope = NULL;
+		memory_accounting_protocol = NULL;
+	}
+}
+
+bool
+proto_memory_accounting_enabled(void)
+{
+	return memory_accounting_scope != NULL;
+}
+
+protocol_t *
+proto_memory_accounting_enter(protocol_t *protocol)
+{
+	protocol_t *previous = memory_accounting_protocol;
+
+	if (memory_accounting_scope == NULL || protocol == NULL || protocol == previous)
+		return previous;
+
+	memory_accounting_protocol = protocol;
+	wmem_set_allocation_counter(memory_accounting_scope, &protocol->file_scope_bytes);
+
+	return previous;
+}
+
+void
+proto_memory_accounting_leave(protocol_t *previous)
+{
+	if (memory_accounting_scope == NULL || previous == memory_accounting_protocol)
+		return;
+
+	memory_accounting_protocol = previous;
+	wmem_set_allocation_counter(memory_accounting_scope,
+			previous ? &previous->file_scope_bytes : &memory_unattributed_bytes);
+}
+
+uint64_t
+proto_get_file_scope_bytes(const int proto_id)
+{
+	protocol_t *protocol = find_protocol_by_id(proto_id);
+
+	return protocol ? protocol->file_scope_bytes : 0;
+}
+
+uint64_t
+proto_get_unattributed_file_scope_bytes(void)
+{
+	return memory_unattributed_bytes;
+}
+
+static int
+file_scope_usage_compare(const void *a, const void *b)
+{
+	const proto_file_scope_usage_t *ua = (const proto_file_scope_usage_t *)a;
+	const proto_file_scope_usage_t *ub = (const proto_file_scope_usage_t *)b;
+
+	if (ua->bytes != ub->bytes)
+		return ua->bytes < ub->bytes ? 1 : -1;
+	return strcmp(ua->filter_name, ub->filter_name);
+}
+
+GArray *
+proto_get_file_scope_usage(uint64_t *total)
+{
+	GArray *usage = g_array_new(false, false, sizeof(proto_file_scope_usage_t));
+	proto_file_scope_usage_t entry;
+	uint64_t sum = memory_unattributed_bytes;
+
+	for (GList *l = protocols; l != NULL; l = g_list_next(l)) {
+		protocol_t *protocol = (protocol_t *)l->data;
+
+		if (protocol->file_scope_bytes == 0)
+			continue;
+		entry.filter_name = protocol->filter_name;
+		entry.bytes = protocol->file_scope_bytes;
+		g_array_append_val(usage, entry);
+		sum += entry.bytes;
+	}
+	g_array_sort(usage, file_scope_usage_compare);
+
+	if (total)
+		*total = sum;
+	return usage;
+}
+
 /* helper to call all prefix initializers */
 static gboolean
 initialize_prefix(void *k, void *v, void *u _U_) {
@@ -8624,6 +8789,8 @@ proto_register_protocol(const char *name, const char *short_name,
 	protocol->can_toggle = true;
 	protocol->parent_proto_id = -1;
 	protocol->heur_list = NULL;
+	protocol->fields_pending = false;
+	protocol->file_scope_bytes = 0;
 
 	/* List will be sorted later by name, when all protocols completed registering */
 	protocols = g_list_prepend(protocols, protocol);
@@ -8700,6 +8867,8 @@ proto_register_protocol_in_name_only(const char *name, const char *short_name, c
 
 	protocol->parent_proto_id = parent_proto;
 	protocol->heur_list = NULL;
+	protocol->fields_pending = false;
+	protocol->file_scope_bytes = 0;
 
 	/* List will be sorted later by name, when all protocols completed registering */
 	protocols = g_list_prepend(protocols, protocol);
@@ -9456,6 +9625,9 @@ free_deregistered_field (void *data, void *user_data _U_)
 		g_slice_free(header_field_info, hfi);
 
 	gpa_hfinfo.hfi[hf_id] = NULL; /* Invalidate this hf_id / proto_id */
+	value_string_index_free(gpa_hfinfo.vsi[hf_id].vsi);
+	gpa_hfinfo.vsi[hf_id].vs = NULL;
+	gpa_hfinfo.vsi[hf_id].vsi = NULL;
 }
 
 static void
@@ -10218,6 +10390,7 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 		if (!gpa_hfinfo.hfi) {
 			gpa_hfinfo.allocated_len = PROTO_PRE_ALLOC_HF_FIELDS_MEM;
 			gpa_hfinfo.hfi = (header_field_info **)g_malloc(sizeof(header_field_info *)*PROTO_PRE_ALLOC_HF_FIELDS_MEM);
+			gpa_hfinfo.vsi = g_new0(hf_vs_index_t, PROTO_PRE_ALLOC_HF_FIELDS_MEM);
 			/* The entry with index 0 is not used. */
 			gpa_hfinfo.hfi[0] = NULL;
 			gpa_hfinfo.len = 1;
@@ -10225,6 +10398,9 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 			gpa_hfinfo.allocated_len += 1000;
 			gpa_hfinfo.hfi = (header_field_info **)g_realloc(gpa_hfinfo.hfi,
 						   sizeof(header_field_info *)*gpa_hfinfo.allocated_len);
+			gpa_hfinfo.vsi = g_renew(hf_vs_index_t, gpa_hfinfo.vsi, gpa_hfinfo.allocated_len);
+			memset(&gpa_hfinfo.vsi[gpa_hfinfo.allocated_len - 1000], 0,
+			       sizeof(hf_vs_index_t) * 1000);
 			/*ws_warning("gpa_hfinfo.allocated_len %u", gpa_hfinfo.allocated_len);*/
 		}
 	}
@@ -10767,6 +10943,35 @@ fill_label_boolean(const field_info *fi, char *label_str, size_t *value_pos)
 	label_fill(label_str, bitfield_byte_length, hfinfo, tfs_get_string(!!value, hfinfo->strings), value_pos);
 }
 
+/* Look up a value in the plain value_string of a field. Large ones, such
+ * as the VALS() of many ASN.1 types, are slow to scan, so the first lookup
+ * makes an index for the field if its array is large enough. */
+static const char *
+hf_try_val_to_str_vs(uint32_t value, const header_field_info *hfinfo)
+{
+	const value_string *vs = (const value_string *) hfinfo->strings;
+	hf_vs_index_t *entry;
+
+	/* Only registered fields have a slot. */
+	if (hfinfo->id <= 0 || (unsigned)hfinfo->id >= gpa_hfinfo.len ||
+	    gpa_hfinfo.hfi[hfinfo->id] != hfinfo)
+		return try_val_to_str(value, vs);
+
+	entry = &gpa_hfinfo.vsi[hfinfo->id];
+	if (entry->vs != vs) {
+		/* First lookup, or the field's value_string was replaced;
+		 * either array may be too small to index. */
+		value_string_index_free(entry->vsi);
+		entry->vs = vs;
+		entry->vsi = value_string_index_new(NULL, vs);
+	}
+
+	if (entry->vsi == NULL)
+		return try_val_to_str(value, vs);
+
+	return try_val_to_str_indexed(value, entry->vsi);
+}
+
 static const char *
 hf_try_val_to_str(uint32_t value, const header_field_info *hfinfo)
 {
@@ -10786,7 +10991,7 @@ hf_try_val_to_str(uint32_t value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_UNIT_STRING)
 		return unit_name_string_get_value(value, (const struct unit_name_string*) hfinfo->strings);
 
-	return try_val_to_str(value, (const value_string *) hfinfo->strings);
+	return hf_try_val_to_str_vs(value, hfinfo);
 }
 
 static const char *
@@ -2939,6 +2939,80 @@ proto_register_prefix(const char *prefix,  prefix_initializer_t initializer);
 /** Initialize every remaining uninitialized prefix. */
 WS_DLL_PUBLIC void proto_initialize_all_prefixes(void);
 
+/** Register the field array of a protocol when it's first needed.
+    This is proto_register_prefix() for the protocol's filter name, except
+    that the initializer is also called before any dissector or heuristic
+    dissector registered with the protocol is first called, so the
+    dissectors don't have to do that themselves. Large dissectors that
+    are rarely used can use it to make startup faster and use less memory.
+    Dissectors that can be called directly, not through a handle, must
+    still call proto_registrar_get_byname() on one of their fields first.
+@param parent the protocol handle from proto_register_protocol()
+@param initializer function that will register the fields of the protocol */
+WS_DLL_PUBLIC void
+proto_register_fields_on_demand(const int parent, prefix_initializer_t initializer);
+
+/** Call the initializer registered for a protocol with
+    proto_register_fields_on_demand(), if it hasn't been called yet.
+ @param protocol the protocol */
+WS_DLL_PUBLIC void
+proto_register_pending_fields(protocol_t *protocol);
+
+/** Enable or disable file scope memory accounting. While it's enabled,
+    the size of every allocation from wmem_file_scope() is attributed to
+    the protocol whose dissector or heuristic dissector made it, and the
+    totals are reset whenever the file scope is emptied. The totals are
+    of requested sizes, not of memory in use; memory that is freed again
+    still counts.
+ @param enable true to start counting, false to stop */
+WS_DLL_PUBLIC void
+proto_set_memory_accounting(bool enable);
+
+/** Check whether file scope memory accounting is enabled.
+ @return true if proto_set_memory_accounting() enabled it */
+WS_DLL_PUBLIC bool
+proto_memory_accounting_enabled(void);
+
+/** Attribute file scope allocations to a protocol until the matching
+    proto_memory_accounting_leave(). Called around every dissector call;
+    does nothing if memory accounting isn't enabled.
+ @param protocol the protocol, or NULL to keep the current one
+ @return the protocol allocations were attributed to before */
+WS_DLL_PUBLIC protocol_t *
+proto_memory_accounting_enter(protocol_t *protocol);
+
+/** Attribute file scope allocations to the protocol they were attributed
+    to before proto_memory_accounting_enter().
+ @param previous the value returned by proto_memory_accounting_enter() */
+WS_DLL_PUBLIC void
+proto_memory_accounting_leave(protocol_t *previous);
+
+/** Get the file scope memory attributed to a protocol.
+ @param proto_id the protocol id
+ @return the number of bytes allocated while the protocol's dissectors ran */
+WS_DLL_PUBLIC uint64_t
+proto_get_file_scope_bytes(const int proto_id);
+
+/** Get the file scope memory allocated outside of any dissector, e.g. by
+    init routines or taps.
+ @return the number of bytes not attributed to a protocol */
+WS_DLL_PUBLIC uint64_t
+proto_get_unattributed_file_scope_bytes(void);
+
+/** File scope memory attributed to one protocol, see proto_get_file_scope_usage(). */
+typedef struct {
+    const char *filter_name;    /**< the protocol's filter name */
+    uint64_t    bytes;          /**< the number of bytes allocated while its dissectors ran */
+} proto_file_scope_usage_t;
+
+/** Get the file scope memory attributed to each protocol.
+ @param[out] total if not NULL, set to the number of bytes attributed to
+ any protocol plus proto_get_unattributed_file_scope_bytes()
+ @return a GArray of proto_file_scope_usage_t, one for every protocol that
+ allocated memory, largest first; free it with g_array_free() */
+WS_DLL_PUBLIC GArray *
+proto_get_file_scope_usage(uint64_t *total);
+
 /** Register a header_field array.
  @param parent the protocol handle from proto_register_protocol()
  @param hf the hf_register_info array
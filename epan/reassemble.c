@@ -14,10 +14,13 @@
 
 #include <epan/packet.h>
 #include <epan/exceptions.h>
+#include <epan/prefs.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
 
+#include <wsutil/file_util.h>
 #include <wsutil/str_util.h>
+#include <wsutil/tempfile.h>
 #include <wsutil/ws_assert.h>
 
 /*
@@ -375,11 +378,15 @@ static fragment_head *new_head(const uint32_t flags)
  * For a reassembled-packet hash table entry, free the fragment data
  * to which the value refers. (The key is freed by reassembled_key_free.)
  */
+static void fragment_head_spill_release(fragment_head *fd_head);
+
 static void
 free_fd_head(fragment_head *fd_head)
 {
 	fragment_item *fd_i;
 
+	if (fd_head->flags & FD_SPILLED)
+		fragment_head_spill_release(fd_head);
 	if (fd_head->flags & FD_SUBSET_TVB)
 		fd_head->tvb_data = NULL;
 	if (fd_head->tvb_data)
@@ -454,6 +461,413 @@ reassembled_table_insert(GHashTable *reassembled_table, reassembled_key *key, fr
 	g_hash_table_insert(reassembled_table, key, fd_head);
 }
 
+/* ------------ memory budget functions ------------ */
+
+/*
+ * Fragment data of incomplete reassemblies spilled to disk.  The file is
+ * shared by all tables; it is removed when the registered tables are
+ * reinitialized at the start of a new file scope.  The space of data that
+ * has been read back in or discarded is reused, so the file only grows
+ * with the amount of data that is spilled at the same time.
+ */
+static FILE *spill_file;
+static char *spill_file_path;
+static bool spill_file_failed;
+
+typedef struct {
+	uint64_t offset;
+	uint64_t length;
+} spill_extent;
+
+static GArray *spill_free_extents;	/* of spill_extent, sorted by offset, coalesced */
+static uint64_t spill_file_end;		/* end of the last extent in use */
+
+/* Find room for length bytes in the spill file, first fit. */
+static uint64_t
+spill_extent_alloc(uint64_t length)
+{
+	spill_extent *ext;
+	uint64_t offset;
+	unsigned i;
+
+	if (spill_free_extents != NULL) {
+		for (i = 0; i < spill_free_extents->len; i++) {
+			ext = &g_array_index(spill_free_extents, spill_extent, i);
+			if (ext->length < length)
+				continue;
+			offset = ext->offset;
+			ext->offset += length;
+			ext->length -= length;
+			if (ext->length == 0)
+				g_array_remove_index(spill_free_extents, i);
+			return offset;
+		}
+	}
+	offset = spill_file_end;
+	spill_file_end += length;
+	return offset;
+}
+
+static void
+spill_extent_free(uint64_t offset, uint64_t length)
+{
+	spill_extent new_ext = { offset, length };
+	spill_extent *prev, *next;
+	unsigned i;
+
+	if (length == 0 || spill_file == NULL)
+		return;
+
+	if (spill_free_extents == NULL)
+		spill_free_extents = g_array_new(false, false, sizeof(spill_extent));
+
+	for (i = 0; i < spill_free_extents->len; i++) {
+		if (g_array_index(spill_free_extents, spill_extent, i).offset > offset)
+			break;
+	}
+	g_array_insert_val(spill_free_extents, i, new_ext);
+
+	/* Merge with the following and the preceding free extents. */
+	if (i + 1 < spill_free_extents->len) {
+		next = &g_array_index(spill_free_extents, spill_extent, i + 1);
+		if (offset + length == next->offset) {
+			g_array_index(spill_free_extents, spill_extent, i).length += next->length;
+			g_array_remove_index(spill_free_extents, i + 1);
+		}
+	}
+	if (i > 0) {
+		prev = &g_array_index(spill_free_extents, spill_extent, i - 1);
+		if (prev->offset + prev->length == offset) {
+			prev->length += g_array_index(spill_free_extents, spill_extent, i).length;
+			g_array_remove_index(spill_free_extents, i);
+			i--;
+		}
+	}
+
+	/* Free space at the end is simply no longer part of the file. */
+	prev = &g_array_index(spill_free_extents, spill_extent, i);
+	if (prev->offset + prev->length == spill_file_end) {
+		spill_file_end = prev->offset;
+		g_array_remove_index(spill_free_extents, i);
+	}
+}
+
+static FILE *
+spill_file_open(void)
+{
+	int fd;
+
+	if (spill_file != NULL || spill_file_failed)
+		return spill_file;
+
+	fd = create_tempfile(NULL, &spill_file_path, "wireshark_reassembly_", NULL, NULL);
+	if (fd == -1 || (spill_file = ws_fdopen(fd, "w+b")) == NULL) {
+		if (fd != -1)
+			ws_close(fd);
+		spill_file_failed = true;
+	}
+	return spill_file;
+}
+
+static void
+spill_file_close(void)
+{
+	if (spill_file != NULL) {
+		fclose(spill_file);
+		spill_file = NULL;
+	}
+	if (spill_file_path != NULL) {
+		ws_unlink(spill_file_path);
+		g_free(spill_file_path);
+		spill_file_path = NULL;
+	}
+	spill_file_failed = false;
+	if (spill_free_extents != NULL) {
+		g_array_free(spill_free_extents, true);
+		spill_free_extents = NULL;
+	}
+	spill_file_end = 0;
+}
+
+static size_t
+fragment_head_mem_size(const fragment_head *fd_head)
+{
+	const fragment_item *fd_i;
+	size_t size = sizeof(fragment_head);
+
+	if (fd_head->tvb_data && !(fd_head->flags & FD_SUBSET_TVB))
+		size += tvb_captured_length(fd_head->tvb_data);
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		size += sizeof(fragment_item);
+		if (fd_i->tvb_data && !(fd_i->flags & FD_SUBSET_TVB))
+			size += tvb_captured_length(fd_i->tvb_data);
+	}
+	return size;
+}
+
+static size_t
+reassembly_table_budget(const reassembly_table *table)
+{
+	if (table->memory_budget != 0)
+		return table->memory_budget;
+	return (size_t)prefs.reassembly_memory_budget * 1024 * 1024;
+}
+
+static void
+reassembly_table_set_memory_used(reassembly_table *table, size_t old_size, size_t new_size)
+{
+	table->stats.memory_used = table->stats.memory_used - old_size + new_size;
+	if (table->stats.memory_used > table->stats.memory_peak)
+		table->stats.memory_peak = table->stats.memory_used;
+}
+
+/*
+ * Stop accounting for a reassembly, because it is removed from the
+ * fragment table or has been defragmented.
+ */
+static void
+fragment_head_untrack(reassembly_table *table, fragment_head *fd_head)
+{
+	if (fd_head->lru_link == NULL)
+		return;
+
+	g_queue_delete_link((fd_head->flags & FD_SPILLED) ? &table->spilled : &table->lru,
+			    fd_head->lru_link);
+	fd_head->lru_link = NULL;
+	reassembly_table_set_memory_used(table, fd_head->mem_size, 0);
+	fd_head->mem_size = 0;
+	if (table->touched != NULL)
+		g_ptr_array_remove_fast(table->touched, fd_head);
+}
+
+/*
+ * Fragments are only ever added to a reassembly after it has been looked
+ * up, so the size of the reassemblies looked up in the previous frame is
+ * final until they are looked up again.
+ */
+static void
+reassembly_table_account_touched(reassembly_table *table)
+{
+	fragment_head *fd_head;
+	size_t new_size;
+	unsigned i;
+
+	if (table->touched == NULL)
+		return;
+
+	for (i = 0; i < table->touched->len; i++) {
+		fd_head = (fragment_head *)g_ptr_array_index(table->touched, i);
+		if (fd_head->flags & FD_DEFRAGMENTED) {
+			/* Complete, and no longer subject to the budget. */
+			g_queue_delete_link(&table->lru, fd_head->lru_link);
+			fd_head->lru_link = NULL;
+			reassembly_table_set_memory_used(table, fd_head->mem_size, 0);
+			fd_head->mem_size = 0;
+		} else {
+			new_size = fragment_head_mem_size(fd_head);
+			reassembly_table_set_memory_used(table, fd_head->mem_size, new_size);
+			fd_head->mem_size = new_size;
+		}
+	}
+	g_ptr_array_set_size(table->touched, 0);
+}
+
+static bool
+fragment_head_spill(reassembly_table *table, fragment_head *fd_head)
+{
+	FILE *fh;
+	fragment_item *fd_i;
+	uint64_t offset;
+	uint64_t length = 0;
+	size_t new_size;
+
+	fh = spill_file_open();
+	if (fh == NULL)
+		return false;
+
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		if (!fd_i->tvb_data || (fd_i->flags & FD_SUBSET_TVB) || fd_i->len == 0 ||
+		    tvb_captured_length(fd_i->tvb_data) != fd_i->len)
+			continue;
+		length += fd_i->len;
+	}
+
+	offset = spill_extent_alloc(length);
+	if (ws_fseek64(fh, (int64_t)offset, SEEK_SET) != 0) {
+		spill_extent_free(offset, length);
+		spill_file_failed = true;
+		return false;
+	}
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		if (!fd_i->tvb_data || (fd_i->flags & FD_SUBSET_TVB) || fd_i->len == 0 ||
+		    tvb_captured_length(fd_i->tvb_data) != fd_i->len)
+			continue;
+		if (fwrite(tvb_get_ptr(fd_i->tvb_data, 0, fd_i->len), 1, fd_i->len, fh) != fd_i->len) {
+			/* Most likely out of disk space; don't try again. */
+			spill_extent_free(offset, length);
+			spill_file_failed = true;
+			return false;
+		}
+	}
+
+	/* Everything is on disk, now release the memory. */
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		if (!fd_i->tvb_data || (fd_i->flags & FD_SUBSET_TVB) || fd_i->len == 0 ||
+		    tvb_captured_length(fd_i->tvb_data) != fd_i->len)
+			continue;
+		tvb_free(fd_i->tvb_data);
+		fd_i->tvb_data = NULL;
+		fd_i->flags |= FD_SPILLED;
+	}
+	fd_head->spill_offset = offset;
+	fd_head->flags |= FD_SPILLED;
+
+	g_queue_unlink(&table->lru, fd_head->lru_link);
+	g_queue_push_tail_link(&table->spilled, fd_head->lru_link);
+
+	new_size = fragment_head_mem_size(fd_head);
+	reassembly_table_set_memory_used(table, fd_head->mem_size, new_size);
+	fd_head->mem_size = new_size;
+	table->stats.spilled++;
+	table->stats.spilled_bytes += length;
+	return true;
+}
+
+/* Give the space of a spilled reassembly's data back. */
+static void
+fragment_head_spill_release(fragment_head *fd_head)
+{
+	fragment_item *fd_i;
+	uint64_t length = 0;
+
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		if (fd_i->flags & FD_SPILLED)
+			length += fd_i->len;
+	}
+	spill_extent_free(fd_head->spill_offset, length);
+}
+
+static void
+fragment_head_unspill(reassembly_table *table, fragment_head *fd_head)
+{
+	fragment_item *fd_i;
+	uint8_t *buf;
+	uint64_t length = 0;
+	bool ok;
+
+	ok = spill_file != NULL &&
+	     ws_fseek64(spill_file, (int64_t)fd_head->spill_offset, SEEK_SET) == 0;
+	for (fd_i = fd_head->next; fd_i != NULL; fd_i = fd_i->next) {
+		if (!(fd_i->flags & FD_SPILLED))
+			continue;
+		buf = (uint8_t *)g_malloc0(fd_i->len);
+		if (ok && fread(buf, 1, fd_i->len, spill_file) != fd_i->len)
+			ok = false;
+		fd_i->tvb_data = tvb_new_real_data(buf, fd_i->len, fd_i->len);
+		tvb_set_free_cb(fd_i->tvb_data, g_free);
+		fd_i->flags &= ~FD_SPILLED;
+		length += fd_i->len;
+	}
+	if (!ok)
+		fd_head->error = "fragment data could not be read back from the spill file";
+	fd_head->flags &= ~FD_SPILLED;
+	spill_extent_free(fd_head->spill_offset, length);
+
+	g_queue_unlink(&table->spilled, fd_head->lru_link);
+	g_queue_push_tail_link(&table->lru, fd_head->lru_link);
+	table->stats.reloaded++;
+}
+
+/*
+ * Called for every reassembly found in or added to the fragment table.
+ */
+static void
+fragment_head_touch(reassembly_table *table, fragment_head *fd_head,
+		    const packet_info *pinfo)
+{
+	/* Complete, or the table has no budget. */
+	if (fd_head->lru_link == NULL)
+		return;
+
+	if (table->lru_frame != pinfo->num) {
+		reassembly_table_account_touched(table);
+		table->lru_frame = pinfo->num;
+	}
+
+	if (fd_head->lru_frame == pinfo->num)
+		return;
+
+	if (fd_head->flags & FD_SPILLED) {
+		fragment_head_unspill(table, fd_head);
+	} else {
+		g_queue_unlink(&table->lru, fd_head->lru_link);
+		g_queue_push_tail_link(&table->lru, fd_head->lru_link);
+	}
+	fd_head->lru_frame = pinfo->num;
+	if (table->touched == NULL)
+		table->touched = g_ptr_array_new();
+	g_ptr_array_add(table->touched, fd_head);
+}
+
+static void
+fragment_head_evict(reassembly_table *table, GList *link)
+{
+	void *key = link->data;
+	fragment_head *fd_head;
+
+	fd_head = (fragment_head *)g_hash_table_lookup(table->fragment_table, key);
+	table->stats.evicted++;
+	table->stats.evicted_bytes += fd_head->mem_size;
+	fragment_head_untrack(table, fd_head);
+	g_hash_table_remove(table->fragment_table, key);
+	free_fd_head(fd_head);
+}
+
+/*
+ * Discard (or spill) the least recently looked up incomplete reassemblies
+ * until the table is within its budget.  Only done in the first pass, so
+ * that later passes see the same reassemblies; and never for reassemblies
+ * looked up in the current frame, as the caller may still hold them.
+ */
+static void
+reassembly_table_enforce_budget(reassembly_table *table, const packet_info *pinfo)
+{
+	size_t budget = reassembly_table_budget(table);
+	fragment_head *fd_head;
+	GList *link;
+
+	if (budget == 0 || PINFO_FD_VISITED(pinfo))
+		return;
+
+	while (table->stats.memory_used > budget && (link = table->lru.head) != NULL) {
+		fd_head = (fragment_head *)g_hash_table_lookup(table->fragment_table, link->data);
+		if (fd_head->lru_frame == pinfo->num)
+			break;
+		if (!prefs.reassembly_spill || !fragment_head_spill(table, fd_head))
+			fragment_head_evict(table, link);
+	}
+	while (table->stats.memory_used > budget && (link = table->spilled.head) != NULL) {
+		fragment_head_evict(table, link);
+	}
+}
+
+static void
+reassembly_table_reset_budget(reassembly_table *table)
+{
+	g_queue_clear(&table->lru);
+	g_queue_clear(&table->spilled);
+	if (table->touched != NULL)
+		g_ptr_array_set_size(table->touched, 0);
+	table->lru_frame = 0;
+	memset(&table->stats, 0, sizeof(table->stats));
+}
+
+void
+reassembly_table_set_memory_budget(reassembly_table *table, size_t budget)
+{
+	table->memory_budget = budget;
+}
+
 typedef struct register_reassembly_table {
 	reassembly_table *table;
 	const reassembly_table_functions *funcs;
@@ -504,6 +918,7 @@ reassembly_table_init(reassembly_table *table,
 		 */
 		g_hash_table_foreach_remove(table->fragment_table,
 					    free_all_fragments, NULL);
+		reassembly_table_reset_budget(table);
 	} else {
 		/* The fragment table does not exist. Create it */
 		table->fragment_table = g_hash_table_new_full(funcs->hash_func,
@@ -555,6 +970,11 @@ reassembly_table_destroy(reassembly_table *table)
 		 */
 		g_hash_table_destroy(table->fragment_table);
 		table->fragment_table = NULL;
+		reassembly_table_reset_budget(table);
+	}
+	if (table->touched != NULL) {
+		g_ptr_array_free(table->touched, TRUE);
+		table->touched = NULL;
 	}
 	if (table->reassembled_table != NULL) {
 		/*
@@ -597,6 +1017,9 @@ lookup_fd_head(reassembly_table *table, const packet_info *pinfo,
 	/* Free the key */
 	table->free_temporary_key_func(key);
 
+	if (value != NULL)
+		fragment_head_touch(table, (fragment_head *)value, pinfo);
+
 	return (fragment_head *)value;
 }
 
@@ -615,6 +1038,20 @@ insert_fd_head(reassembly_table *table, fragment_head *fd_head,
 	 */
 	key = table->persistent_key_func(pinfo, id, data);
 	g_hash_table_insert(table->fragment_table, key, fd_head);
+
+	/*
+	 * If the table has a memory budget, account for it, and make room
+	 * for it if the table is over the budget.  Without a budget,
+	 * reassemblies aren't tracked at all, so that the default costs
+	 * nothing.
+	 */
+	if (reassembly_table_budget(table) != 0) {
+		fd_head->lru_link = g_list_alloc();
+		fd_head->lru_link->data = key;
+		g_queue_push_tail_link(&table->lru, fd_head->lru_link);
+		fragment_head_touch(table, fd_head, pinfo);
+		reassembly_table_enforce_budget(table, pinfo);
+	}
 	return key;
 }
 
@@ -645,6 +1082,7 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		return NULL;
 	}
 
+	fragment_head_untrack(table, fd_head);
 	fd_tvb_data=fd_head->tvb_data;
 	/* loop over all partial fragments and free any tvbuffs */
 	fd = fd_head->next;
@@ -1018,6 +1456,12 @@ fragment_set_partial_reassembly(reassembly_table *table,
 static void
 fragment_unhash(reassembly_table *table, void *key)
 {
+	fragment_head *fd_head;
+
+	fd_head = (fragment_head *)g_hash_table_lookup(table->fragment_table, key);
+	if (fd_head != NULL)
+		fragment_head_untrack(table, fd_head);
+
 	/*
 	 * Remove the entry from the fragment table.
 	 */
@@ -3217,6 +3661,7 @@ static void
 reassembly_table_init_reg_tables(void)
 {
 	g_list_foreach(reassembly_table_list, reassembly_table_init_reg_table, NULL);
+	spill_file_close();
 }
 
 static void
@@ -3251,6 +3696,30 @@ reassembly_table_cleanup(void)
 {
 	g_list_foreach(reassembly_table_list, reassembly_table_free, NULL);
 	g_list_free(reassembly_table_list);
+	spill_file_close();
+}
+
+static void
+reassembly_table_add_stats(void *p, void *user_data)
+{
+	register_reassembly_table_t* reg_table = (register_reassembly_table_t*)p;
+	const reassembly_stats_t *table_stats = &reg_table->table->stats;
+	reassembly_stats_t *stats = (reassembly_stats_t *)user_data;
+
+	stats->evicted += table_stats->evicted;
+	stats->evicted_bytes += table_stats->evicted_bytes;
+	stats->spilled += table_stats->spilled;
+	stats->spilled_bytes += table_stats->spilled_bytes;
+	stats->reloaded += table_stats->reloaded;
+	stats->memory_used += table_stats->memory_used;
+	stats->memory_peak += table_stats->memory_peak;
+}
+
+void
+reassembly_tables_get_stats(reassembly_stats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	g_list_foreach(reassembly_table_list, reassembly_table_add_stats, stats);
 }
 
 /* One instance of this structure is created for each pdu that spans across
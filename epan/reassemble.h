@@ -56,6 +56,13 @@ extern "C" {
  */
 #define FD_DATALEN_SET		0x0400
 
+/* in fd_head: the fragment data of this incomplete reassembly has been
+ * written to the spill file to stay within the table's memory budget
+ * in item: tvb_data is NULL and the data is in the spill file
+ * (The data is read back in as soon as the reassembly is looked up again.)
+ */
+#define FD_SPILLED		0x0800
+
 struct dissector_handle;
 
 /**
@@ -97,6 +104,12 @@ typedef struct _fragment_head {
     tvbuff_t* tvb_data;                   /**< Tvbuff containing the reassembled payload once reassembly is complete. */
     const char* error;                    /**< NULL if reassembly completed without error; otherwise a string
                                                describing the reassembly error that occurred. */
+    GList*    lru_link;                   /**< Link in the reassembly table's eviction queues while this reassembly
+                                               is incomplete and accounted against the memory budget; NULL otherwise. */
+    uint32_t  lru_frame;                  /**< Frame number in which this reassembly was last looked up. */
+    size_t    mem_size;                   /**< Bytes of this reassembly included in the table's memory_used. */
+    uint64_t  spill_offset;               /**< Offset of the fragment data in the spill file; valid only when
+                                               FD_SPILLED is set. */
 } fragment_head;
 
 /*
@@ -134,8 +147,24 @@ typedef void * (*fragment_temporary_key)(const packet_info *pinfo,
 typedef void * (*fragment_persistent_key)(const packet_info *pinfo,
     const uint32_t id, const void *data);
 
+/**
+ * @brief Counters describing how a reassembly table kept within its memory budget.
+ */
+typedef struct {
+    uint64_t evicted;        /**< Incomplete reassemblies discarded to stay within the memory budget. */
+    uint64_t evicted_bytes;  /**< Bytes released by discarding incomplete reassemblies. */
+    uint64_t spilled;        /**< Incomplete reassemblies whose fragment data was written to the spill file. */
+    uint64_t spilled_bytes;  /**< Bytes of fragment data written to the spill file. */
+    uint64_t reloaded;       /**< Spilled reassemblies read back in because they were looked up again. */
+    size_t   memory_used;    /**< Bytes currently held by incomplete reassemblies. */
+    size_t   memory_peak;    /**< Highest value memory_used has reached. */
+} reassembly_stats_t;
+
 /**
  * @brief Tracks all in-progress fragment chains and completed reassemblies for a single reassembly context.
+ *
+ * Incomplete reassemblies are kept until the file scope ends unless a memory
+ * budget applies to the table, see reassembly_table_set_memory_budget().
  */
 typedef struct {
     GHashTable*             fragment_table;          /**< Hash table mapping fragment keys to fragment_head entries for PDUs currently being reassembled. */
@@ -143,6 +172,12 @@ typedef struct {
     fragment_temporary_key  temporary_key_func;      /**< Callback that constructs a short-lived lookup key from packet data for fragment_table queries. */
     fragment_persistent_key persistent_key_func;     /**< Callback that constructs a long-lived key allocated for permanent storage in the fragment_table. */
     GDestroyNotify          free_temporary_key_func; /**< GLib destroy callback used to release temporary keys after a lookup. */
+    size_t                  memory_budget;           /**< Maximum bytes held by incomplete reassemblies; 0 uses the protocols.reassembly_memory_budget preference. */
+    GQueue                  lru;                     /**< Persistent keys of incomplete reassemblies held in memory, least recently looked up first. */
+    GQueue                  spilled;                 /**< Persistent keys of incomplete reassemblies in the spill file, oldest first. */
+    GPtrArray*              touched;                 /**< Incomplete reassemblies looked up in frame lru_frame, accounted when the frame changes. */
+    uint32_t                lru_frame;               /**< Frame number of the most recent lookup in this table. */
+    reassembly_stats_t      stats;                   /**< Memory use and eviction counters; reset with the table. */
 } reassembly_table;
 
 /**
@@ -223,6 +258,32 @@ reassembly_table_init(reassembly_table *table,
 WS_DLL_PUBLIC void
 reassembly_table_destroy(reassembly_table *table);
 
+/**
+ * @brief Limit the memory used by the incomplete reassemblies of a table.
+ *
+ * When a new reassembly is started during the first pass and the fragment
+ * data of the incomplete reassemblies exceeds the budget, the reassemblies
+ * that have gone the longest without being looked up are discarded, oldest
+ * first.  If the protocols.reassembly_spill preference is set, their fragment
+ * data is first written to a temporary file instead, and read back in if
+ * another fragment for them arrives.  Reassemblies looked up in the current
+ * frame are never discarded.
+ *
+ * @param table The reassembly table.
+ * @param budget The budget in bytes, or 0 to use the
+ * protocols.reassembly_memory_budget preference.
+ */
+WS_DLL_PUBLIC void
+reassembly_table_set_memory_budget(reassembly_table *table, size_t budget);
+
+/**
+ * @brief Sum the memory use and eviction counters of all registered reassembly tables.
+ *
+ * @param[out] stats The totals.  memory_peak is the sum of the per-table peaks.
+ */
+WS_DLL_PUBLIC void
+reassembly_tables_get_stats(reassembly_stats_t *stats);
+
 /**
  * @brief Adds a fragment to a reassembly table.
  *
@@ -38,6 +38,7 @@
 
 #include <epan/packet.h>
 #include <epan/packet_info.h>
+#include <epan/prefs.h>
 #include <epan/proto.h>
 #include <epan/tvbuff.h>
 #include <epan/reassemble.h>
@@ -3203,6 +3204,195 @@ test_fragment_add_check_duplicate_conflict(void)
         print_fragment_table();
     }
 }
+/* This tests the memory budget.
+ * Starts two reassemblies in different frames with a budget that only
+ * allows one of them, and checks that the older one is discarded and the
+ * newer one can still be completed.
+ */
+/*   visit  id  frame  frag_off  len  more  tvb_offset
+       0    12     1       0     50   T      10
+       0    13     2       0     50   T      5
+       0    13     3      50     60   F      15
+*/
+static void
+test_fragment_add_check_memory_budget(void)
+{
+    fragment_head *fd_head;
+
+    printf("Starting test test_fragment_add_check_memory_budget\n");
+
+    reassembly_table_set_memory_budget(&test_reassembly_table, 1);
+
+    pinfo.num = 1;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 10, &pinfo, 12,
+                               NULL, 0, 50, true);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(0,test_reassembly_table.stats.evicted);
+
+    /* Starting the second reassembly discards the first one, which
+     * has not been looked up since frame 1. */
+    pinfo.num = 2;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 5, &pinfo, 13,
+                               NULL, 0, 50, true);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(1,test_reassembly_table.stats.evicted);
+    ASSERT(test_reassembly_table.stats.evicted_bytes >= 50);
+    ASSERT_EQ_POINTER(NULL,fragment_get(&test_reassembly_table, &pinfo, 12, NULL));
+
+    /* The second one is not affected */
+    pinfo.num = 3;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 15, &pinfo, 13,
+                               NULL, 50, 60, false);
+    ASSERT_EQ(0,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.reassembled_table));
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT_EQ(0,test_reassembly_table.stats.memory_used);
+    ASSERT_EQ(1,test_reassembly_table.stats.evicted);
+
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+5,50));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,50,data+15,60));
+
+    reassembly_table_set_memory_budget(&test_reassembly_table, 0);
+}
+
+/* This tests spilling to disk.
+ * As above, but the older reassembly is written to the spill file instead
+ * of being discarded, and is read back in when its last fragment arrives.
+ */
+/*   visit  id  frame  frag_off  len  more  tvb_offset
+       0    12     1       0     50   T      10
+       0    13     2       0     50   T      5
+       0    12     3      50     60   F      15
+*/
+static void
+test_fragment_add_check_spill(void)
+{
+    fragment_head *fd_head;
+
+    printf("Starting test test_fragment_add_check_spill\n");
+
+    /* Room for one reassembly with one fragment, but not for its data */
+    reassembly_table_set_memory_budget(&test_reassembly_table,
+                                       sizeof(fragment_head) + sizeof(fragment_item));
+    prefs.reassembly_spill = true;
+
+    pinfo.num = 1;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 10, &pinfo, 12,
+                               NULL, 0, 50, true);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 2;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 5, &pinfo, 13,
+                               NULL, 0, 50, true);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(1,test_reassembly_table.stats.spilled);
+    ASSERT_EQ(50,test_reassembly_table.stats.spilled_bytes);
+
+    /* Completing the first reassembly reads its data back in. */
+    pinfo.num = 3;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 15, &pinfo, 12,
+                               NULL, 50, 60, false);
+    ASSERT_EQ(1,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.reassembled_table));
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(FD_DEFRAGMENTED|FD_DATALEN_SET,fd_head->flags);
+    ASSERT_EQ_POINTER(NULL,fd_head->error);
+    ASSERT_EQ(1,test_reassembly_table.stats.reloaded);
+
+    ASSERT(!tvb_memeql(fd_head->tvb_data,0,data+10,50));
+    ASSERT(!tvb_memeql(fd_head->tvb_data,50,data+15,60));
+
+    prefs.reassembly_spill = false;
+    reassembly_table_set_memory_budget(&test_reassembly_table, 0);
+}
+
+/* Returns the only reassembly of the test table that is in the spill file. */
+static fragment_head *
+spilled_fd_head(void)
+{
+    GHashTableIter iter;
+    void *value;
+    fragment_head *spilled = NULL;
+
+    g_hash_table_iter_init(&iter, test_reassembly_table.fragment_table);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        if (((fragment_head *)value)->flags & FD_SPILLED) {
+            ASSERT_EQ_POINTER(NULL,spilled);
+            spilled = (fragment_head *)value;
+        }
+    }
+    return spilled;
+}
+
+/* This tests that the space in the spill file is reused.
+ * The data of the first reassembly is spilled, and read back in by a
+ * lookup; then the data of the second one is spilled to the same place.
+ */
+/*   visit  id  frame  frag_off  len  more  tvb_offset
+       0    12     1       0     50   T      10
+       0    13     2       0     50   T      5
+       0    12     3    (lookup)
+       0    14     4       0     50   T      15
+*/
+static void
+test_fragment_add_check_spill_reuse(void)
+{
+    fragment_head *fd_head;
+    uint64_t offset;
+
+    printf("Starting test test_fragment_add_check_spill_reuse\n");
+
+    /* Room for one reassembly with one fragment, but not for its data */
+    reassembly_table_set_memory_budget(&test_reassembly_table,
+                                       sizeof(fragment_head) + sizeof(fragment_item));
+    prefs.reassembly_spill = true;
+
+    pinfo.num = 1;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 10, &pinfo, 12,
+                               NULL, 0, 50, true);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    pinfo.num = 2;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 5, &pinfo, 13,
+                               NULL, 0, 50, true);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(1,test_reassembly_table.stats.spilled);
+    fd_head = spilled_fd_head();
+    ASSERT_NE_POINTER(NULL,fd_head);
+    offset = fd_head->spill_offset;
+
+    /* Looking the first reassembly up reads its data back in. */
+    pinfo.num = 3;
+    fd_head = fragment_get(&test_reassembly_table, &pinfo, 12, NULL);
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(0,fd_head->flags & FD_SPILLED);
+    ASSERT_EQ(1,test_reassembly_table.stats.reloaded);
+    ASSERT_EQ_POINTER(NULL,spilled_fd_head());
+
+    /* Room for both reassemblies, but only for the data of one; the
+     * second reassembly, looked up least recently, is spilled where
+     * the first one was. */
+    reassembly_table_set_memory_budget(&test_reassembly_table,
+                                       2 * (sizeof(fragment_head) + sizeof(fragment_item)) + 50);
+    pinfo.num = 4;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 15, &pinfo, 14,
+                               NULL, 0, 50, true);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(3,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(2,test_reassembly_table.stats.spilled);
+    ASSERT_EQ(0,test_reassembly_table.stats.evicted);
+    fd_head = spilled_fd_head();
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(offset,fd_head->spill_offset);
+
+    prefs.reassembly_spill = false;
+    reassembly_table_set_memory_budget(&test_reassembly_table, 0);
+}
+
 /**********************************************************************************
  *
  * main
@@ -3251,6 +3441,9 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_check_duplicate_last,
 #endif
         test_fragment_add_check_duplicate_conflict,
+        test_fragment_add_check_memory_budget,
+        test_fragment_add_check_spill,
+        test_fragment_add_check_spill_reuse,
     };
 
     /* a tvbuff for testing with */
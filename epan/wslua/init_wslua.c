@@ -172,6 +172,7 @@ lua_pinfo_end(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
     clear_outstanding_PrivateTable();
     clear_outstanding_TreeItem();
     clear_outstanding_FieldInfo();
+    wslua_clear_field_cache();
     clear_outstanding_FuncSavers(NULL);
 
     /* keep invoking this callback later? */
@@ -320,6 +320,9 @@ struct _wslua_treeitem {
 struct _wslua_header_field_info {
     char*              name; /**< The abbreviated dotted name of the registered header field. */
     header_field_info* hfi;  /**< Pointer to the registered header_field_info for this field. */
+    unsigned           cache_gen;   /**< Field cache generation the cached values belong to. */
+    unsigned           cache_count; /**< Number of field_infos found when the cache was filled. */
+    int                cache_ref;   /**< Registry reference to the table of cached FieldInfo values, or LUA_NOREF. */
 };
 
 /**
@@ -1364,6 +1367,14 @@ extern FieldInfo* push_FieldInfo(lua_State *L, field_info* f);
  */
 extern void clear_outstanding_FieldInfo(void);
 
+/**
+ * @brief Invalidates the FieldInfo values cached by Field extractors.
+ *
+ * Must be called whenever the tree the cached values point into goes away,
+ * i.e. at the end of each packet handed to Lua dissectors or taps.
+ */
+extern void wslua_clear_field_cache(void);
+
 /**
  * @brief Prints the stack of a Lua state with a given prefix.
  *
@@ -33,6 +33,9 @@ WSLUA_CLASS_DEFINE(FieldInfo,FAIL_ON_NULL_OR_EXPIRED("FieldInfo"));
 
 static GPtrArray* outstanding_FieldInfo;
 
+/* Bumped at the end of every packet, see Field__call(). */
+static unsigned field_cache_generation = 1;
+
 FieldInfo* push_FieldInfo(lua_State* L, field_info* f) {
     FieldInfo fi = (FieldInfo) g_malloc(sizeof(struct _wslua_field_info));
     fi->ws_fi = f;
@@ -43,6 +46,10 @@ FieldInfo* push_FieldInfo(lua_State* L, field_info* f) {
 
 CLEAR_OUTSTANDING(FieldInfo,expired,true)
 
+void wslua_clear_field_cache(void) {
+    field_cache_generation++;
+}
+
 /* WSLUA_ATTRIBUTE FieldInfo_len RO The length of this field. */
 WSLUA_METAMETHOD FieldInfo__len(lua_State* L) {
     /*
@@ -574,6 +581,13 @@ void lua_prime_all_fields(proto_tree* tree _U_) {
     g_string_free(fake_tap_filter, TRUE);
 }
 
+static Field new_Field(const char* name) {
+    Field f = (Field)g_new0(struct _wslua_header_field_info, 1);
+    f->name = g_strdup(name);
+    f->cache_ref = LUA_NOREF;
+    return f;
+}
+
 WSLUA_CONSTRUCTOR Field_new(lua_State *L) {
     /*
        Create a Field extractor.
@@ -592,8 +606,7 @@ WSLUA_CONSTRUCTOR Field_new(lua_State *L) {
         return 0;
     }
 
-    f = (Field)g_new0(struct _wslua_header_field_info, 1);
-    f->name = g_strdup(name);
+    f = new_Field(name);
 
     g_ptr_array_add(wanted_fields, f);
 
@@ -677,8 +690,7 @@ WSLUA_FUNCTION wslua_request_fields(lua_State *L) {
         /* Check if field exists in protocol registry or is a Lua-created field */
         if (proto_registrar_get_byname(name) || wslua_is_field_available(L, name)) {
             /* Create and register the field request */
-            Field f = (Field)g_new0(struct _wslua_header_field_info, 1);
-            f->name = g_strdup(name);
+            Field f = new_Field(name);
             g_ptr_array_add(wanted_fields, f);
 
             /* Ensure that the memory is managed by Lua */
@@ -717,8 +729,7 @@ WSLUA_FUNCTION wslua_request_fields(lua_State *L) {
         }
 
         /* Create and register the field request */
-        Field f = (Field)g_new0(struct _wslua_header_field_info, 1);
-        f->name = g_strdup(name);
+        Field f = new_Field(name);
         g_ptr_array_add(wanted_fields, f);
 
         /* Ensure that the memory is managed by Lua */
@@ -748,8 +759,7 @@ static bool wslua_add_protocol_fields(lua_State *L, const char *proto_name) {
         }
 
         /* Create and register a field request for each protocol field */
-        Field f = (Field)g_new0(struct _wslua_header_field_info, 1);
-        f->name = g_strdup(hfinfo->abbrev);
+        Field f = new_Field(hfinfo->abbrev);
         g_ptr_array_add(wanted_fields, f);
 
         /* Ensure that the memory is managed by Lua */
@@ -925,18 +935,65 @@ WSLUA_METAMETHOD Field__call (lua_State* L) {
         return 0;
     }
 
+    /* Dissectors only ever add fields to the tree, so if as many are found
+     * as the last time in this packet they are the same ones and the
+     * FieldInfo objects created then can be handed out again. */
+    for (header_field_info* hfi = in; hfi; ) {
+        GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, hfi->id);
+        if (found) {
+            items_found += found->len;
+        }
+        hfi = (hfi->same_name_prev_id != -1) ? proto_registrar_get_nth(hfi->same_name_prev_id) : NULL;
+    }
+
+    luaL_checkstack(L, items_found + 2, "too many values for this field");
+
+    if (f->cache_ref != LUA_NOREF && f->cache_gen == field_cache_generation &&
+            f->cache_count == (unsigned)items_found) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, f->cache_ref);
+        for (int i = 1; i <= items_found; i++) {
+            lua_rawgeti(L, -i, i);
+        }
+        lua_remove(L, -(items_found + 1));
+        WSLUA_RETURN(items_found); /* All the values of this field */
+    }
+
+    int base = lua_gettop(L);
     while (in) {
         GPtrArray* found = proto_get_finfo_ptr_array(lua_tree->tree, in->id);
         unsigned i;
         if (found) {
             for (i=0; i<found->len; i++) {
                 push_FieldInfo(L, (field_info *) g_ptr_array_index(found,i));
-                items_found++;
             }
         }
         in = (in->same_name_prev_id != -1) ? proto_registrar_get_nth(in->same_name_prev_id) : NULL;
     }
 
+    /* Each Field keeps a single table and overwrites it in place, so a
+     * miss costs no more than a few table stores. */
+    if (items_found > 0 || f->cache_count > 0) {
+        if (f->cache_ref == LUA_NOREF) {
+            lua_createtable(L, items_found, 0);
+            lua_pushvalue(L, -1);
+            f->cache_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        } else {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, f->cache_ref);
+        }
+        for (int i = 1; i <= items_found; i++) {
+            lua_pushvalue(L, base + i);
+            lua_rawseti(L, -2, i);
+        }
+        /* Drop the previous packet's extra values so they can be collected. */
+        for (unsigned i = items_found + 1; i <= f->cache_count; i++) {
+            lua_pushnil(L);
+            lua_rawseti(L, -2, i);
+        }
+        lua_pop(L, 1);
+    }
+    f->cache_gen = field_cache_generation;
+    f->cache_count = items_found;
+
     WSLUA_RETURN(items_found); /* All the values of this field */
 }
 
@@ -964,6 +1021,9 @@ static int Field__gc(lua_State* L) {
         g_ptr_array_remove_fast(wanted_fields, f);
     }
 
+    if (f->cache_ref != LUA_NOREF) {
+        luaL_unref(L, LUA_REGISTRYINDEX, f->cache_ref);
+    }
     g_free(f->name);
     g_free(f);
     return 0;
@@ -124,6 +124,7 @@ static tap_packet_status lua_tap_packet(void *tapdata, packet_info *pinfo, epan_
 
     clear_outstanding_Pinfo();
     clear_outstanding_Tvb();
+    wslua_clear_field_cache();
 
     lua_pinfo = NULL;
     lua_tvb = NULL;
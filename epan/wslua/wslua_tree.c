@@ -807,6 +807,113 @@ WSLUA_METHOD TreeItem_add_le(lua_State *L) {
     WSLUA_RETURN(ret); /* The new child TreeItem. */
 }
 
+/* The following is used by TreeItem_add_fields() and can THROW. */
+static void TreeItem_add_fields_any(lua_State *L, TreeItem tree_item, TvbRange tvbr, int fields_idx) {
+    lua_Unsigned count = lua_rawlen(L, fields_idx);
+
+    for (lua_Unsigned i = 1; i <= count; i++) {
+        ProtoField field;
+        lua_Integer offset, length;
+        unsigned encoding;
+
+        lua_rawgeti(L, fields_idx, i);
+        if (!lua_istable(L, -1)) {
+            THROW_LUA_ERROR("fields entry %d is not a table", (int)i);
+        }
+        lua_rawgeti(L, -1, 1);
+        lua_rawgeti(L, -2, 2);
+        lua_rawgeti(L, -3, 3);
+        lua_rawgeti(L, -4, 4);
+
+        field = isProtoField(L, -4) ? toProtoField(L, -4) : NULL;
+        if (!field || field->hfid <= 0) {
+            THROW_LUA_ERROR("fields entry %d does not start with a registered ProtoField", (int)i);
+        }
+        if (!lua_isinteger(L, -3) || !lua_isinteger(L, -2)) {
+            THROW_LUA_ERROR("fields entry %d needs an integer offset and length", (int)i);
+        }
+        offset = lua_tointeger(L, -3);
+        length = lua_tointeger(L, -2);
+        /* Checked by TreeItem_add_fields() before entering the TRY block. */
+        encoding = lua_isnil(L, -1) ? ENC_BIG_ENDIAN : (unsigned)lua_tointeger(L, -1);
+
+        /* A length of -1 runs to the end of the TvbRange. */
+        if (length == -1 && offset >= 0 && offset <= (lua_Integer)tvbr->len) {
+            length = tvbr->len - offset;
+        }
+        if (offset < 0 || length < 0 || offset + length > (lua_Integer)tvbr->len) {
+            THROW_LUA_ERROR("fields entry %d is outside of the TvbRange", (int)i);
+        }
+
+        proto_tree_add_item(tree_item->tree, field->hfid, tvbr->tvb->ws_tvb,
+                            tvbr->offset + (int)offset, (int)length, encoding);
+        lua_pop(L, 5);
+    }
+}
+
+WSLUA_METHOD TreeItem_add_fields(lua_State *L) {
+    /*
+    Adds several fields as children of this tree item in a single call.
+
+    Each entry of the fields array is a table `{ protofield, offset, length [, encoding] }`,
+    where offset and length are relative to the given <<lua_class_TvbRange,`TvbRange`>>
+    and a length of -1 covers the rest of it. The encoding defaults to `ENC_BIG_ENDIAN`.
+
+    No <<lua_class_TreeItem,`TreeItem`>> is created for the added fields, which makes this
+    much cheaper than calling `TreeItem:add()` for each of them. The fields array can be
+    built once when the dissector is loaded and reused for every packet. When no tree is
+    being built, nothing is done at all.
+
+    [discrete]
+    ====== Example
+
+    [source,lua]
+    ----
+    local proto_foo = Proto("foo", "Foo Protocol")
+    proto_foo.fields.type = ProtoField.uint8("foo.type", "Type")
+    proto_foo.fields.len = ProtoField.uint16("foo.len", "Length")
+    proto_foo.fields.flags = ProtoField.uint8("foo.flags", "Flags", base.HEX)
+
+    local header = {
+        { proto_foo.fields.type, 0, 1 },
+        { proto_foo.fields.len, 1, 2, ENC_LITTLE_ENDIAN },
+        { proto_foo.fields.flags, 3, 1 },
+    }
+
+    function proto_foo.dissector(buf, pinfo, tree)
+        tree:add(proto_foo, buf(0, 4)):add_fields(buf(0, 4), header)
+    end
+    ----
+    */
+#define WSLUA_ARG_TreeItem_add_fields_TVBRANGE 2 /* The <<lua_class_TvbRange,`TvbRange`>> the offsets are relative to. */
+#define WSLUA_ARG_TreeItem_add_fields_FIELDS 3 /* An array of `{ protofield, offset, length [, encoding] }` tables. */
+    TreeItem ti = checkTreeItem(L,1);
+    TvbRange tvbr = checkTvbRange(L,WSLUA_ARG_TreeItem_add_fields_TVBRANGE);
+
+    luaL_checktype(L, WSLUA_ARG_TreeItem_add_fields_FIELDS, LUA_TTABLE);
+
+    /* A bad encoding must not silently become 0 (ENC_BIG_ENDIAN), and
+     * luaL_checkinteger() can't be used inside WRAP_NON_LUA_EXCEPTIONS. */
+    lua_Unsigned count = lua_rawlen(L, WSLUA_ARG_TreeItem_add_fields_FIELDS);
+    for (lua_Unsigned i = 1; i <= count; i++) {
+        if (lua_rawgeti(L, WSLUA_ARG_TreeItem_add_fields_FIELDS, i) == LUA_TTABLE &&
+                lua_rawgeti(L, -1, 4) != LUA_TNIL && !lua_isinteger(L, -1)) {
+            luaL_argerror(L, WSLUA_ARG_TreeItem_add_fields_FIELDS,
+                    lua_pushfstring(L, "TreeItem_add_fields: fields entry %d needs an integer encoding", (int)i));
+        }
+        lua_settop(L, WSLUA_ARG_TreeItem_add_fields_FIELDS);
+    }
+
+    if (ti->tree) {
+        WRAP_NON_LUA_EXCEPTIONS(
+            TreeItem_add_fields_any(L, ti, tvbr, WSLUA_ARG_TreeItem_add_fields_FIELDS);
+        )
+    }
+
+    lua_settop(L, 1);
+    WSLUA_RETURN(1); /* The same TreeItem. */
+}
+
 /* WSLUA_ATTRIBUTE TreeItem_text RW Set/get the <<lua_class_TreeItem,`TreeItem`>>'s display string (string).
 
     For the getter, if the TreeItem has no display string, then nil is returned.
@@ -1714,6 +1821,7 @@ WSLUA_METHODS TreeItem_methods[] = {
     WSLUA_CLASS_FNREG(TreeItem, add_packet_field),
     WSLUA_CLASS_FNREG(TreeItem, add),
     WSLUA_CLASS_FNREG(TreeItem, add_le),
+    WSLUA_CLASS_FNREG(TreeItem, add_fields),
     WSLUA_CLASS_FNREG(TreeItem, set_text),
     WSLUA_CLASS_FNREG(TreeItem, append_text),
     WSLUA_CLASS_FNREG(TreeItem, prepend_text),
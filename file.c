@@ -56,6 +56,7 @@
 #include "ui/urls.h"
 #include "ui/ws_ui_util.h"
 #include "ui/packet_list_utils.h"
+#include "ui/find_index.h"
 
 /* Needed for addrinfo */
 #include <sys/types.h>
@@ -123,6 +124,10 @@ static match_result match_regex(capture_file *cf, frame_data *fdata,
         wtap_rec *, void *criterion);
 static match_result match_regex_reverse(capture_file *cf, frame_data *fdata,
         wtap_rec *, void *criterion);
+static find_index_candidates_t *find_data_candidates(capture_file *cf,
+        const uint8_t *string, size_t string_size);
+static match_result match_indexed(capture_file *cf, frame_data *fdata,
+        wtap_rec *, void *criterion);
 static match_result match_dfilter(capture_file *cf, frame_data *fdata,
         wtap_rec *, void *criterion);
 static match_result match_marked(capture_file *cf, frame_data *fdata,
@@ -370,6 +375,9 @@ cf_close(capture_file *cf)
     /* close things, if not already closed before */
     color_filters_cleanup();
 
+    find_index_free(cf->find_index);
+    cf->find_index = NULL;
+
     if (cf->provider.wth) {
         wtap_close(cf->provider.wth);
         cf->provider.wth = NULL;
@@ -763,6 +771,17 @@ cf_read(capture_file *cf, bool reloading)
     ws_assert(cf->read_lock);
     cf->read_lock = false;
 
+    /* Index the packet bytes for searches in the background. */
+    find_index_free(cf->find_index);
+    cf->find_index = NULL;
+    /* A read filter renumbers the frames; the index numbers the records
+     * in the file. */
+    if (prefs.gui_find_index_memory > 0 && !is_read_aborted && cf->count > 0 &&
+            cf->rfcode == NULL) {
+        cf->find_index = find_index_new(cf->filename, cf->open_type, cf->count,
+                (size_t)prefs.gui_find_index_memory * 1024 * 1024);
+    }
+
     if (reloading)
         cf_callback_invoke(cf_cb_file_reload_finished, cf);
     else
@@ -824,6 +843,19 @@ cf_read(capture_file *cf, bool reloading)
 }
 
 #ifdef HAVE_LIBPCAP
+/*
+ * Start indexing the packet bytes of a live capture for searches, as
+ * its first frames are read.
+ */
+static void
+cf_tail_find_index_init(capture_file *cf)
+{
+    if (cf->find_index == NULL && cf->count == 0 && prefs.gui_find_index_memory > 0) {
+        cf->find_index = find_index_new_incremental(
+                (size_t)prefs.gui_find_index_memory * 1024 * 1024);
+    }
+}
+
 cf_read_status_t
 cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
         int *err, fifo_string_cache_t *frame_dup_cache, GChecksum *frame_cksum)
@@ -882,6 +914,8 @@ cf_continue_tail(capture_file *cf, volatile int to_read, wtap_rec *rec,
 
     *err = 0;
 
+    cf_tail_find_index_init(cf);
+
     /* Don't freeze/thaw the list when doing live capture */
     /*packet_list_freeze();*/
 
@@ -1024,6 +1058,8 @@ cf_finish_tail(capture_file *cf, wtap_rec *rec, int *err,
         return CF_READ_ERROR;
     }
 
+    cf_tail_find_index_init(cf);
+
     /* Don't freeze/thaw the list when doing live capture */
     /*packet_list_freeze();*/
 
@@ -1388,6 +1424,10 @@ add_new_record_to_record_list(capture_file *cf, wtap_rec *rec,
         }
         cf->f_datalen = offset + fdlocal.cap_len;
 
+        /* Index the bytes of a live capture's frames for searches. */
+        find_index_add(cf->find_index, fdata->num,
+                ws_buffer_start_ptr(&rec->data), ws_buffer_length(&rec->data));
+
         // Should we check if the frame data is a duplicate, and thus, ignore
         // this frame?
         if (frame_cksum != NULL && rec->rec_type == REC_TYPE_PACKET) {
@@ -3573,6 +3613,8 @@ typedef struct {
     const uint8_t *data;
     size_t        data_len;
     ws_mempbrk_pattern *pattern;
+    ws_match_function match_function;   /* Used by match_indexed */
+    find_index_candidates_t *candidates;
 } cbs_t;    /* "Counted byte string" */
 
 
@@ -3599,6 +3641,7 @@ cf_find_packet_data(capture_file *cf, const uint8_t *string, size_t string_size,
     char needles[3];
     ws_mempbrk_pattern pattern = {0};
     ws_match_function match_function;
+    bool   found;
 
     info.data = string;
     info.data_len = string_size;
@@ -3660,6 +3703,16 @@ cf_find_packet_data(capture_file *cf, const uint8_t *string, size_t string_size,
         match_function = (dir == SD_FORWARD) ? match_binary : match_binary_reverse;
     }
 
+    info.candidates = NULL;
+    if (!cf->regex && cf->find_index != NULL) {
+        /* Only read the frames the index doesn't rule out. */
+        info.candidates = find_data_candidates(cf, string, string_size);
+        if (info.candidates != NULL) {
+            info.match_function = match_function;
+            match_function = match_indexed;
+        }
+    }
+
     if (multiple && cf->current_frame && (cf->search_pos || cf->search_len)) {
         /* Use the current frame (this will perform the equivalent of
          * cf_read_current_record() in match_function).
@@ -3677,12 +3730,67 @@ cf_find_packet_data(capture_file *cf, const uint8_t *string, size_t string_size,
                 packet_list_select_row_from_data(cf->current_frame);
             }
             cf->search_in_progress = false;
+            find_index_candidates_free(info.candidates);
             return true;
         }
     }
     cf->search_pos = 0; /* Reset the position */
     cf->search_len = 0; /* Reset length */
-    return find_packet(cf, match_function, &info, dir, true);
+    found = find_packet(cf, match_function, &info, dir, true);
+    find_index_candidates_free(info.candidates);
+    return found;
+}
+
+/*
+ * Get the frames that may contain a string or byte sequence from the
+ * index of the packet bytes, or NULL if the index can't narrow them down.
+ */
+static find_index_candidates_t *
+find_data_candidates(capture_file *cf, const uint8_t *string, size_t string_size)
+{
+    find_index_candidates_t *candidates;
+    find_index_candidates_t *wide_candidates = NULL;
+    uint8_t *wide_string;
+    size_t   i;
+
+    if (string_size == 0)
+        return NULL;
+
+    if (cf->string && cf->scs_type != SCS_NARROW) {
+        /* The wide match functions look for the characters interleaved
+         * with \0 bytes. */
+        wide_string = (uint8_t *)g_malloc0(string_size * 2 - 1);
+        for (i = 0; i < string_size; i++) {
+            wide_string[i * 2] = string[i];
+        }
+        wide_candidates = find_index_lookup(cf->find_index, wide_string, string_size * 2 - 1);
+        g_free(wide_string);
+        if (cf->scs_type == SCS_WIDE || wide_candidates == NULL)
+            return wide_candidates;
+    }
+
+    candidates = find_index_lookup(cf->find_index, string, string_size);
+    if (wide_candidates != NULL) {
+        /* Narrow or wide. */
+        if (candidates != NULL)
+            find_index_candidates_merge(candidates, wide_candidates);
+        find_index_candidates_free(wide_candidates);
+    }
+    return candidates;
+}
+
+static match_result
+match_indexed(capture_file *cf, frame_data *fdata,
+        wtap_rec *rec, void *criterion)
+{
+    cbs_t *info = (cbs_t *)criterion;
+
+    /* Frames that can't contain the string aren't read at all. Edited
+     * frames may differ from what was indexed. */
+    if (!fdata->has_modified_block && !find_index_is_candidate(info->candidates, fdata->num))
+        return MR_NOTMATCHED;
+
+    return info->match_function(cf, fdata, rec, criterion);
 }
 
 static match_result
@@ -5611,6 +5719,10 @@ cf_save_records(capture_file *cf, const char *fname, unsigned save_format,
 
     cf_callback_invoke(cf_cb_file_save_started, (void *)fname);
 
+    /* The file may be renamed or replaced below; stop indexing it and
+       keep what has been indexed, the frames don't change. */
+    find_index_stop(cf->find_index);
+
     addr_lists = get_addrinfo_list();
 
     if (save_format == cf->cd_t && compression_type == cf->compression_type
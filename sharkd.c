@@ -12,6 +12,7 @@
 #include "config.h"
 #define WS_LOG_DOMAIN  LOG_DOMAIN_MAIN
 
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -73,6 +74,11 @@ capture_file cfile;
 
 static frame_data ref_frame;
 
+/* The file loaded with --preload, until a session opens another one. */
+static bool preloaded;
+static char *preloaded_path;            /* canonical, see sharkd_canonical_path() */
+static ws_statb64 preloaded_statb;      /* as it was when it was loaded */
+
 /*
  * The leading + ensures that getopt_long() does not permute the argv[]
  * entries.
@@ -96,6 +102,7 @@ static frame_data ref_frame;
 static const struct ws_option long_options[] = {
     {"api", ws_required_argument, NULL, 'a'},
     {"foreground", ws_no_argument, NULL, LONGOPT_FOREGROUND},
+    {"preload", ws_required_argument, NULL, LONGOPT_PRELOAD},
     {"help", ws_no_argument, NULL, 'h'},
     {"version", ws_no_argument, NULL, 'v'},
     {"config-profile", ws_required_argument, NULL, 'C'},
@@ -238,6 +245,9 @@ main(int argc, char *argv[])
        line that their preferences have changed. */
     prefs_apply_all();
 
+    /* Attribute the file scope memory to protocols, for the "status" method. */
+    proto_set_memory_accounting(true);
+
     /* Build the column format array */
     build_column_format_array(&cfile.cinfo, prefs_p->num_cols, true);
 
@@ -517,9 +527,99 @@ fail:
 cf_status_t
 sharkd_cf_open(const char *fname, unsigned int type, bool is_tempfile, int *err)
 {
+    preloaded = false;
+    g_clear_pointer(&preloaded_path, g_free);
     return cf_open(&cfile, fname, type, is_tempfile, err);
 }
 
+/* The absolute path of a file, with symbolic links resolved if possible,
+ * so that different names of the same file compare equal. */
+static char *
+sharkd_canonical_path(const char *fname)
+{
+#ifndef _WIN32
+    char *resolved = realpath(fname, NULL);
+
+    if (resolved != NULL) {
+        char *path = g_strdup(resolved);
+
+        free(resolved);
+        return path;
+    }
+#endif
+    return g_canonicalize_filename(fname, NULL);
+}
+
+int
+sharkd_preload_cap_file(const char *fname)
+{
+    int err = 0;
+
+    /* Before reading it, so that a change while loading is noticed. */
+    if (ws_stat64(fname, &preloaded_statb) != 0)
+        return errno;
+
+    if (cf_open(&cfile, fname, WTAP_TYPE_AUTO, false, &err) != CF_OK)
+        return err;
+
+    err = load_cap_file(&cfile, 0, 0);
+    preloaded = (err == 0);
+    if (preloaded)
+        preloaded_path = sharkd_canonical_path(fname);
+    return err;
+}
+
+void
+sharkd_attach_preloaded_cap_file(void)
+{
+    ws_statb64 statb;
+    int err;
+
+    if (!preloaded)
+        return;
+
+    /*
+     * The random access descriptor, and with it the file offset, is
+     * shared with the daemon and all other sessions; open the file again
+     * to get one of our own. Everything else (the frame data, the
+     * dissection state of the first pass) is only read and stays shared
+     * until written to.
+     *
+     * If the path now names another file, or can't be opened, drop the
+     * preloaded file; loading it opens it normally.
+     */
+    if (!wtap_fdreopen_inherited(cfile.provider.wth, &err) ||
+        wtap_fstat(cfile.provider.wth, &statb, &err) == -1 ||
+        statb.st_dev != preloaded_statb.st_dev ||
+        statb.st_ino != preloaded_statb.st_ino) {
+        cf_close(&cfile);
+        preloaded = false;
+        g_clear_pointer(&preloaded_path, g_free);
+    }
+}
+
+bool
+sharkd_cf_is_preloaded(const char *fname)
+{
+    ws_statb64 statb;
+    char *path;
+    bool same;
+
+    if (!preloaded)
+        return false;
+
+    /* A file rewritten since the daemon loaded it has to be loaded again. */
+    if (ws_stat64(fname, &statb) != 0 ||
+        statb.st_size != preloaded_statb.st_size ||
+        statb.st_mtime != preloaded_statb.st_mtime)
+        return false;
+
+    path = sharkd_canonical_path(fname);
+    same = strcmp(path, preloaded_path) == 0;
+    g_free(path);
+    return same;
+}
+
 int
 sharkd_load_cap_file(void)
 {
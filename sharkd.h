@@ -29,6 +29,7 @@
 typedef void (*sharkd_dissect_func_t)(epan_dissect_t *edt, proto_tree *tree, struct epan_column_info *cinfo, const GSList *data_src, void *data);
 
 #define LONGOPT_FOREGROUND 4000
+#define LONGOPT_PRELOAD    4001
 
 /* sharkd.c */
 
@@ -43,6 +44,37 @@ typedef void (*sharkd_dissect_func_t)(epan_dissect_t *edt, proto_tree *tree, str
  */
 cf_status_t sharkd_cf_open(const char *fname, unsigned int type, bool is_tempfile, int *err);
 
+/**
+ * @brief Open and load a capture file in the daemon, before accepting sessions.
+ *
+ * The forked session processes start with the file already loaded, sharing
+ * its frame data copy-on-write, so loading it again in a session is
+ * instantaneous.
+ *
+ * @param fname The filename of the capture file to load.
+ * @return 0 on success, an error code on failure.
+ */
+int sharkd_preload_cap_file(const char *fname);
+
+/**
+ * @brief Give a forked session process its own access to the preloaded capture file.
+ *
+ * If the file can't be reopened, or its name now refers to another file,
+ * it is closed, and the session loads the file normally.
+ */
+void sharkd_attach_preloaded_cap_file(void);
+
+/**
+ * @brief Check whether a capture file is the one preloaded by the daemon.
+ *
+ * Different names of the same file match, but a file whose size or
+ * modification time has changed since it was preloaded doesn't.
+ *
+ * @param fname The filename of the capture file.
+ * @return true if the file is preloaded and hasn't been replaced in this session.
+ */
+bool sharkd_cf_is_preloaded(const char *fname);
+
 /**
  * @brief Load a capture file without any limits.
  *
@@ -32,6 +32,7 @@
 #include <wsutil/wslog.h>
 #include <wsutil/ws_getopt.h>
 #include <app/application_flavor.h>
+#include <wiretap/wtap.h>
 
 #ifndef _WIN32
 #include <sys/un.h>
@@ -64,6 +65,7 @@
 #endif
 
 static int mode;
+static const char *preload_filename;
 static socket_handle_t _server_fd = INVALID_SOCKET;
 static bool abstract_socket;
 
@@ -227,6 +229,8 @@ print_usage(FILE* output)
     fprintf(output, "  -a <socket>, --api <socket>\n");
     fprintf(output, "                           listen on this socket instead of the console\n");
     fprintf(output, "  --foreground             do not detach from console\n");
+    fprintf(output, "  --preload <file>         load this capture file once, before accepting\n");
+    fprintf(output, "                           connections; sessions loading it share it\n");
     fprintf(output, "  -h, --help               show this help information\n");
     fprintf(output, "  -v, --version            show version information\n");
     fprintf(output, "  -C <config profile>, --config-profile <config profile>\n");
@@ -384,6 +388,10 @@ sharkd_init(int argc, char **argv)
                     foreground = true;
                     break;
 
+                case LONGOPT_PRELOAD:
+                    preload_filename = ws_optarg;
+                    break;
+
                 default:
                     /* wslog arguments are okay */
                     if (ws_log_is_wslog_arg(opt))
@@ -398,6 +406,12 @@ sharkd_init(int argc, char **argv)
         } while (opt != -1);
     }
 
+    if (preload_filename && mode == SHARKD_MODE_GOLD_CONSOLE)
+    {
+        fprintf(stderr, "--preload requires daemon mode (-a <socket>)\n");
+        return -1;
+    }
+
     if (!foreground && (mode == SHARKD_MODE_CLASSIC_DAEMON || mode == SHARKD_MODE_GOLD_DAEMON))
     {
         /* all good - try to daemonize */
@@ -429,6 +443,25 @@ sharkd_loop(int argc _U_, char* argv[])
         return sharkd_session_main(mode);
     }
 
+    if (preload_filename)
+    {
+#ifndef _WIN32
+        /* The sessions are forked from this process, so they all start
+           with the file loaded. */
+        int err = sharkd_preload_cap_file(preload_filename);
+
+        if (err != 0)
+        {
+            fprintf(stderr, "cannot preload %s: %s\n", preload_filename, wtap_strerror(err));
+            return -1;
+        }
+        fprintf(stderr, "Sharkd preloaded: %s\n", preload_filename);
+#else
+        /* The sessions are separate processes, so there's nothing to share. */
+        fprintf(stderr, "--preload is not supported on Windows, ignoring it\n");
+#endif
+    }
+
     while (1)
     {
 #ifndef _WIN32
@@ -483,6 +516,8 @@ sharkd_loop(int argc _U_, char* argv[])
             dup2(fd, 1);
             close(fd);
 
+            sharkd_attach_preloaded_cap_file();
+
             exit(sharkd_session_main(mode));
         }
 
@@ -532,7 +567,11 @@ sharkd_loop(int argc _U_, char* argv[])
                 {
                     i++;  // skip the socket details
                 }
-                else
+                else if (!strcmp(argv[i], "--preload"))
+                {
+                    i++;  // skip the file name; it's rejected in console mode
+                }
+                else if (!g_str_has_prefix(argv[i], "--preload="))
                 {
                     (void) g_strlcat(command_line, " ", sizeof(command_line));
                     (void) g_strlcat(command_line, argv[i], sizeof(command_line));
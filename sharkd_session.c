@@ -18,6 +18,11 @@
 #include <errno.h>
 #include <inttypes.h>
 
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 #include <glib.h>
 
 #include <wsutil/wsjson.h>
@@ -377,6 +382,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"method",     "download",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "dumpconf",       1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "follow",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
+        {"method",     "followbulk",     1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "field",          1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "fields",         1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
         {"method",     "frame",          1, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_OPTIONAL},
@@ -400,6 +406,8 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
         {"follow",     "follow",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"follow",     "filter",         2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"follow",     "sub_stream",     2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
+        {"followbulk", "file",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
+        {"followbulk", "stream",         2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_OPTIONAL},
         {"field",      "name",           2, JSMN_STRING,       SHARKD_JSON_STRING,   SHARKD_MANDATORY},
         {"frame",      "frame",          2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, SHARKD_MANDATORY},
         {"frame",      "proto",          2, JSMN_PRIMITIVE,    SHARKD_JSON_BOOLEAN,  SHARKD_OPTIONAL},
@@ -1279,6 +1287,291 @@ sharkd_session_process_field(const char* buf, const jsmntok_t* tokens, int count
     sharkd_json_result_epilogue();
 }
 
+/*
+ * Cache of the column text of frames sent in "frames" replies.
+ *
+ * User interfaces page through the same frames again and again; with the
+ * cache, only frames that haven't been sent with the same columns yet
+ * need to be dissected. The text also depends on the time reference and
+ * the previously displayed frame, so they're part of the key; the column
+ * sets are interned, so equal sets (including the default one) have the
+ * same id.
+ *
+ * After a capture file is loaded, the cache is filled for the default
+ * columns while the session is waiting for requests, see
+ * sharkd_column_cache_prefill().
+ */
+#define SHARKD_COLUMN_CACHE_SIZE    (64 * 1024 * 1024)
+#define SHARKD_COLUMN_PREFILL_CHUNK 256
+/* Minimum time between two restarts of the cache because of newly
+ * resolved names, which usually arrive in bursts. */
+#define SHARKD_COLUMN_CACHE_RESOLVE_INTERVAL (2 * G_USEC_PER_SEC)
+
+struct sharkd_column_cache_key
+{
+    uint32_t framenum;
+    uint32_t ref_frame;
+    uint32_t prev_dis_num;
+    uint32_t column_set;
+};
+
+struct sharkd_column_cache_entry
+{
+    struct sharkd_column_cache_key key;
+    GList link;            /* in column_cache.lru */
+    size_t size;
+    unsigned num_cols;
+    char text[];           /* num_cols NUL-terminated strings */
+};
+
+static struct
+{
+    GHashTable *entries;     /* key -> struct sharkd_column_cache_entry */
+    GQueue lru;              /* least recently used first */
+    GHashTable *column_sets; /* column set description -> id */
+    size_t size;
+    uint64_t hits;
+    uint64_t misses;
+    uint32_t prefill_next;   /* next frame to prefill, 0 if done */
+    bool names_changed;      /* names were resolved since the last restart */
+    int64_t restart_time;    /* monotonic time of the last restart */
+} column_cache;
+
+static unsigned
+sharkd_column_cache_key_hash(const void *k)
+{
+    const struct sharkd_column_cache_key *key = (const struct sharkd_column_cache_key *) k;
+
+    return (key->framenum * 2654435761U) ^ key->column_set ^ (key->ref_frame << 16) ^ key->prev_dis_num;
+}
+
+static gboolean
+sharkd_column_cache_key_equal(const void *a, const void *b)
+{
+    return memcmp(a, b, sizeof(struct sharkd_column_cache_key)) == 0;
+}
+
+static void
+sharkd_column_cache_clear(void)
+{
+    if (column_cache.entries)
+        g_hash_table_remove_all(column_cache.entries);
+    /* The entries were freed with the hash table's values. */
+    g_queue_init(&column_cache.lru);
+    column_cache.size = 0;
+    column_cache.prefill_next = 0;
+}
+
+static void
+sharkd_column_cache_init(void)
+{
+    column_cache.entries = g_hash_table_new_full(sharkd_column_cache_key_hash, sharkd_column_cache_key_equal, NULL, g_free);
+    column_cache.column_sets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_queue_init(&column_cache.lru);
+}
+
+static uint32_t
+sharkd_column_cache_column_set(const column_info *cinfo)
+{
+    GString *desc = g_string_new(NULL);
+    void *id;
+
+    for (unsigned i = 0; i < cinfo->num_cols; i++)
+    {
+        const col_item_t *col_item = &cinfo->columns[i];
+
+        if (col_item->col_fmt == COL_CUSTOM)
+            g_string_append_printf(desc, "%d:%s:%d\n", col_item->col_fmt, col_item->col_custom_fields, col_item->col_custom_occurrence);
+        else
+            g_string_append_printf(desc, "%d\n", col_item->col_fmt);
+    }
+
+    id = g_hash_table_lookup(column_cache.column_sets, desc->str);
+    if (id == NULL)
+    {
+        id = GUINT_TO_POINTER(g_hash_table_size(column_cache.column_sets) + 1);
+        g_hash_table_insert(column_cache.column_sets, g_string_free(desc, FALSE), id);
+    }
+    else
+        g_string_free(desc, TRUE);
+
+    return GPOINTER_TO_UINT(id);
+}
+
+static const struct sharkd_column_cache_entry *
+sharkd_column_cache_lookup(const struct sharkd_column_cache_key *key)
+{
+    struct sharkd_column_cache_entry *entry;
+
+    entry = (struct sharkd_column_cache_entry *) g_hash_table_lookup(column_cache.entries, key);
+    if (entry == NULL)
+        return NULL;
+
+    g_queue_unlink(&column_cache.lru, &entry->link);
+    g_queue_push_tail_link(&column_cache.lru, &entry->link);
+    return entry;
+}
+
+static void
+sharkd_column_cache_remove(struct sharkd_column_cache_entry *entry)
+{
+    g_queue_unlink(&column_cache.lru, &entry->link);
+    column_cache.size -= entry->size;
+    g_hash_table_remove(column_cache.entries, &entry->key);
+}
+
+static void
+sharkd_column_cache_add(const struct sharkd_column_cache_key *key, column_info *cinfo)
+{
+    struct sharkd_column_cache_entry *entry;
+    size_t len = 0;
+    char *p;
+
+    for (unsigned col = 0; col < cinfo->num_cols; ++col)
+        len += strlen(get_column_text(cinfo, col)) + 1;
+
+    entry = (struct sharkd_column_cache_entry *) g_malloc(sizeof(*entry) + len);
+    entry->key = *key;
+    entry->link.data = entry;
+    entry->link.prev = entry->link.next = NULL;
+    entry->size = sizeof(*entry) + len;
+    entry->num_cols = cinfo->num_cols;
+
+    p = entry->text;
+    for (unsigned col = 0; col < cinfo->num_cols; ++col)
+    {
+        const char *text = get_column_text(cinfo, col);
+        size_t text_len = strlen(text) + 1;
+
+        memcpy(p, text, text_len);
+        p += text_len;
+    }
+
+    while (column_cache.size + entry->size > SHARKD_COLUMN_CACHE_SIZE && column_cache.lru.head != NULL)
+        sharkd_column_cache_remove((struct sharkd_column_cache_entry *) column_cache.lru.head->data);
+
+    /* A frame dissected again (e.g. after a read error) replaces the old text. */
+    if (g_hash_table_contains(column_cache.entries, key))
+        sharkd_column_cache_remove((struct sharkd_column_cache_entry *) g_hash_table_lookup(column_cache.entries, key));
+
+    g_hash_table_insert(column_cache.entries, &entry->key, entry);
+    g_queue_push_tail_link(&column_cache.lru, &entry->link);
+    column_cache.size += entry->size;
+}
+
+static void
+sharkd_column_cache_invalidate_frame(uint32_t framenum)
+{
+    GList *link = column_cache.lru.head;
+
+    while (link != NULL)
+    {
+        struct sharkd_column_cache_entry *entry = (struct sharkd_column_cache_entry *) link->data;
+
+        link = link->next;
+        if (entry->key.framenum == framenum)
+            sharkd_column_cache_remove(entry);
+    }
+}
+
+/* Start over after the column text may have changed, e.g. by a preference. */
+static void
+sharkd_column_cache_restart(void)
+{
+    sharkd_column_cache_clear();
+    column_cache.prefill_next = (cfile.count > 0) ? 1 : 0;
+    column_cache.names_changed = false;
+    column_cache.restart_time = g_get_monotonic_time();
+}
+
+/*
+ * Newly resolved names change the address columns, and often the Info
+ * column. With name resolution on, names are resolved while the user
+ * pages through the frames, so starting over every time would leave the
+ * cache nearly empty; it's done at most once per
+ * SHARKD_COLUMN_CACHE_RESOLVE_INTERVAL instead, and rows sent in between
+ * might still show the addresses.
+ */
+static void
+sharkd_column_cache_names_resolved(bool resolved)
+{
+    if (resolved)
+        column_cache.names_changed = true;
+
+    if (column_cache.names_changed &&
+            g_get_monotonic_time() - column_cache.restart_time >= SHARKD_COLUMN_CACHE_RESOLVE_INTERVAL)
+        sharkd_column_cache_restart();
+}
+
+static void
+sharkd_column_cache_prefill_cb(epan_dissect_t *edt _U_, proto_tree *tree _U_,
+        struct epan_column_info *cinfo, const GSList *data_src _U_, void *data)
+{
+    sharkd_column_cache_add((const struct sharkd_column_cache_key *) data, cinfo);
+}
+
+/*
+ * Cache the default columns of the next few frames, as an unfiltered
+ * "frames" request without time references would get them. It stops when
+ * the cache is three quarters full, so prefilled text doesn't push out
+ * the text of other column sets.
+ */
+static void
+sharkd_column_cache_prefill(void)
+{
+    struct sharkd_column_cache_key key;
+    wtap_rec rec;
+    uint32_t framenum = column_cache.prefill_next;
+    uint32_t chunk;
+
+    if (framenum == 0)
+        return;
+
+    if (cfile.cinfo.num_cols == 0)
+    {
+        column_cache.prefill_next = 0;
+        return;
+    }
+
+    key.column_set = sharkd_column_cache_column_set(&cfile.cinfo);
+
+    wtap_rec_init(&rec, DEFAULT_INIT_BUFFER_SIZE_2048);
+
+    for (chunk = 0; chunk < SHARKD_COLUMN_PREFILL_CHUNK && framenum != 0 && framenum <= cfile.count; chunk++, framenum++)
+    {
+        frame_data *fdata;
+        int err;
+        char *err_info;
+
+        if (column_cache.size >= SHARKD_COLUMN_CACHE_SIZE / 4 * 3)
+        {
+            framenum = 0;
+            break;
+        }
+
+        key.framenum = framenum;
+        key.ref_frame = (framenum != 1) ? 1 : 0;
+        key.prev_dis_num = framenum - 1;
+
+        if (g_hash_table_contains(column_cache.entries, &key))
+            continue;
+
+        fdata = sharkd_get_frame(framenum);
+        if (sharkd_dissect_request(framenum, key.ref_frame, key.prev_dis_num,
+                    &rec, &cfile.cinfo,
+                    (fdata->color_filter == NULL) ? SHARKD_DISSECT_FLAG_COLOR : SHARKD_DISSECT_FLAG_NULL,
+                    &sharkd_column_cache_prefill_cb, &key,
+                    &err, &err_info) == DISSECT_REQUEST_READ_ERROR)
+        {
+            g_free(err_info);
+        }
+    }
+
+    wtap_rec_cleanup(&rec);
+
+    column_cache.prefill_next = (framenum <= cfile.count) ? framenum : 0;
+}
+
 /**
  * sharkd_session_process_load()
  *
@@ -1333,6 +1626,14 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
     fprintf(stderr, "load: filename=%s, max_packets=%u, max_bytes=%" PRIu64 "\n",
             tok_file, max_packets, max_bytes);
 
+    if (max_packets == 0 && max_bytes == 0 && sharkd_cf_is_preloaded(tok_file))
+    {
+        /* Loaded by the daemon before this session was started. */
+        sharkd_column_cache_restart();
+        sharkd_json_simple_ok(rpcid);
+        return;
+    }
+
     if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, false, &err) != CF_OK)
     {
         sharkd_json_error(
@@ -1368,6 +1669,8 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
     }
     ENDTRY;
 
+    sharkd_column_cache_restart();
+
     if (err == 0)
     {
         sharkd_json_simple_ok(rpcid);
@@ -1382,6 +1685,33 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 }
 
+static void
+sharkd_session_process_status_memory(void)
+{
+    GArray *usage;
+    uint64_t total;
+
+    usage = proto_get_file_scope_usage(&total);
+
+    sharkd_json_object_open("memory");
+    sharkd_json_value_anyf("total", "%" PRIu64, total);
+    sharkd_json_value_anyf("unattributed", "%" PRIu64, proto_get_unattributed_file_scope_bytes());
+    sharkd_json_array_open("protocols");
+    for (unsigned i = 0; i < usage->len; i++)
+    {
+        proto_file_scope_usage_t *u = &g_array_index(usage, proto_file_scope_usage_t, i);
+
+        sharkd_json_object_open(NULL);
+        sharkd_json_value_string("proto", u->filter_name);
+        sharkd_json_value_anyf("bytes", "%" PRIu64, u->bytes);
+        sharkd_json_object_close();
+    }
+    sharkd_json_array_close();
+    sharkd_json_object_close();
+
+    g_array_free(usage, true);
+}
+
 /**
  * sharkd_session_process_status()
  *
@@ -1392,6 +1722,16 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
  *   (m) duration    - time difference between time of first frame, and last loaded frame
  *   (o) filename    - capture filename
  *   (o) filesize    - capture filesize
+ *   (m) column_cache - column text cache of frames requests, object with attributes:
+ *                      'entries'  - number of cached rows
+ *                      'size'     - memory used, in bytes
+ *                      'hits'     - rows sent from the cache
+ *                      'misses'   - rows that had to be dissected
+ *   (o) memory      - file scope memory allocated since the file was loaded, object with attributes:
+ *                      'total'        - bytes allocated
+ *                      'unattributed' - bytes allocated outside of any dissector
+ *                      'protocols'    - array of object with attributes 'proto' and 'bytes',
+ *                                       for each protocol that allocated memory, largest first
  *   (o) columns     - array of column titles
  *   (o) column_info - array of column infos, array of object with attributes:
  *                      'title'    - column title
@@ -1423,6 +1763,16 @@ sharkd_session_process_status(void)
             sharkd_json_value_anyf("filesize", "%" PRId64, file_size);
     }
 
+    sharkd_json_object_open("column_cache");
+    sharkd_json_value_anyf("entries", "%u", g_hash_table_size(column_cache.entries));
+    sharkd_json_value_anyf("size", "%zu", column_cache.size);
+    sharkd_json_value_anyf("hits", "%" PRIu64, column_cache.hits);
+    sharkd_json_value_anyf("misses", "%" PRIu64, column_cache.misses);
+    sharkd_json_object_close();
+
+    if (proto_memory_accounting_enabled())
+        sharkd_session_process_status_memory();
+
     if (cfile.cinfo.num_cols > 0)
     {
         sharkd_json_array_open("columns");
@@ -1640,25 +1990,13 @@ sharkd_session_create_columns(column_info *cinfo, const char *buf, const jsmntok
 }
 
 static void
-sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
-        struct epan_column_info *cinfo, const GSList *data_src _U_, void *data _U_)
+sharkd_session_process_frames_attrs(frame_data *fdata)
 {
-    packet_info *pi = &edt->pi;
-    frame_data *fdata = pi->fd;
     wtap_block_t pkt_block = NULL;
     unsigned int i;
     char *comment = NULL;
 
-    json_dumper_begin_object(&dumper);
-
-    sharkd_json_array_open("c");
-    for (unsigned col = 0; col < cinfo->num_cols; ++col)
-    {
-        sharkd_json_value_string(NULL, get_column_text(cinfo, col));
-    }
-    sharkd_json_array_close();
-
-    sharkd_json_value_anyf("num", "%u", pi->num);
+    sharkd_json_value_anyf("num", "%u", fdata->num);
 
     /*
      * Get the block for this record, if it has one.
@@ -1693,6 +2031,45 @@ sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
     }
 
     wtap_block_unref(pkt_block);
+}
+
+static void
+sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
+        struct epan_column_info *cinfo, const GSList *data_src _U_, void *data)
+{
+    const struct sharkd_column_cache_key *key = (const struct sharkd_column_cache_key *) data;
+
+    json_dumper_begin_object(&dumper);
+
+    sharkd_json_array_open("c");
+    for (unsigned col = 0; col < cinfo->num_cols; ++col)
+    {
+        sharkd_json_value_string(NULL, get_column_text(cinfo, col));
+    }
+    sharkd_json_array_close();
+
+    sharkd_column_cache_add(key, cinfo);
+
+    sharkd_session_process_frames_attrs(edt->pi.fd);
+    json_dumper_end_object(&dumper);
+}
+
+static void
+sharkd_session_process_frames_cached(const struct sharkd_column_cache_entry *entry, frame_data *fdata)
+{
+    const char *text = entry->text;
+
+    json_dumper_begin_object(&dumper);
+
+    sharkd_json_array_open("c");
+    for (unsigned col = 0; col < entry->num_cols; ++col)
+    {
+        sharkd_json_value_string(NULL, text);
+        text += strlen(text) + 1;
+    }
+    sharkd_json_array_close();
+
+    sharkd_session_process_frames_attrs(fdata);
     json_dumper_end_object(&dumper);
 }
 
@@ -1734,6 +2111,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
     uint32_t current_ref_frame = 0, next_ref_frame = UINT32_MAX;
     uint32_t skip;
     uint32_t limit;
+    uint32_t column_set;
 
     wtap_rec rec; /* Record information */
     column_info *cinfo = &cfile.cinfo;
@@ -1790,6 +2168,8 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
             return;
     }
 
+    column_set = sharkd_column_cache_column_set(cinfo);
+
     sharkd_json_result_array_prologue(rpcid);
 
     wtap_rec_init(&rec, DEFAULT_INIT_BUFFER_SIZE_2048);
@@ -1798,6 +2178,8 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
     {
         frame_data *fdata;
         uint32_t ref_frame = (framenum != 1) ? 1 : 0;
+        struct sharkd_column_cache_key key;
+        const struct sharkd_column_cache_entry *cached;
         enum dissect_request_status status;
         int err;
         char *err_info;
@@ -1844,12 +2226,28 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
         }
 
         fdata = sharkd_get_frame(framenum);
-        status = sharkd_dissect_request(framenum,
-                ref_frame, prev_dis_num,
-                &rec, cinfo,
-                (fdata->color_filter == NULL) ? SHARKD_DISSECT_FLAG_COLOR : SHARKD_DISSECT_FLAG_NULL,
-                &sharkd_session_process_frames_cb, NULL,
-                &err, &err_info);
+
+        key.framenum = framenum;
+        key.ref_frame = ref_frame;
+        key.prev_dis_num = prev_dis_num;
+        key.column_set = column_set;
+        cached = sharkd_column_cache_lookup(&key);
+        if (cached)
+        {
+            column_cache.hits++;
+            sharkd_session_process_frames_cached(cached, fdata);
+            status = DISSECT_REQUEST_SUCCESS;
+        }
+        else
+        {
+            column_cache.misses++;
+            status = sharkd_dissect_request(framenum,
+                    ref_frame, prev_dis_num,
+                    &rec, cinfo,
+                    (fdata->color_filter == NULL) ? SHARKD_DISSECT_FLAG_COLOR : SHARKD_DISSECT_FLAG_NULL,
+                    &sharkd_session_process_frames_cb, &key,
+                    &err, &err_info);
+        }
         switch (status) {
 
             case DISSECT_REQUEST_SUCCESS:
@@ -4116,6 +4514,56 @@ cleanup:
     }
 }
 
+static void
+sharkd_session_follow_result(register_follow_t *follower, follow_info_t *follow_info)
+{
+    const char *host;
+    char *port;
+
+    /* Server information: hostname, port, bytes sent */
+    host = address_to_name(&follow_info->server_ip);
+    sharkd_json_value_string("shost", host);
+
+    port = get_follow_port_to_display(follower)(NULL, follow_info->server_port);
+    sharkd_json_value_string("sport", port);
+    wmem_free(NULL, port);
+
+    sharkd_json_value_anyf("sbytes", "%u", follow_info->bytes_written[0]);
+
+    /* Client information: hostname, port, bytes sent */
+    host = address_to_name(&follow_info->client_ip);
+    sharkd_json_value_string("chost", host);
+
+    port = get_follow_port_to_display(follower)(NULL, follow_info->client_port);
+    sharkd_json_value_string("cport", port);
+    wmem_free(NULL, port);
+
+    sharkd_json_value_anyf("cbytes", "%u", follow_info->bytes_written[1]);
+
+    if (follow_info->payload)
+    {
+        follow_record_t *follow_record;
+        GList *cur;
+
+        sharkd_json_array_open("payloads");
+        for (cur = g_list_last(follow_info->payload); cur; cur = g_list_previous(cur))
+        {
+            follow_record = (follow_record_t *) cur->data;
+
+            json_dumper_begin_object(&dumper);
+
+            sharkd_json_value_anyf("n", "%u", follow_record->packet_num);
+            sharkd_json_value_base64("d", follow_record->data->data, follow_record->data->len);
+
+            if (follow_record->is_server)
+                sharkd_json_value_anyf("s", "%d", 1);
+
+            json_dumper_end_object(&dumper);
+        }
+        sharkd_json_array_close();
+    }
+}
+
 /**
  * sharkd_session_process_follow()
  *
@@ -4152,8 +4600,6 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
     GString *tap_error;
 
     follow_info_t *follow_info;
-    const char *host;
-    char *port;
 
     follower = get_follow_by_name(tok_follow);
     if (!follower)
@@ -4191,53 +4637,120 @@ sharkd_session_process_follow(char *buf, const jsmntok_t *tokens, int count)
     sharkd_retap();
 
     sharkd_json_result_prologue(rpcid);
+    sharkd_session_follow_result(follower, follow_info);
+    sharkd_json_result_epilogue();
 
-    /* Server information: hostname, port, bytes sent */
-    host = address_to_name(&follow_info->server_ip);
-    sharkd_json_value_string("shost", host);
-
-    port = get_follow_port_to_display(follower)(NULL, follow_info->server_port);
-    sharkd_json_value_string("sport", port);
-    wmem_free(NULL, port);
-
-    sharkd_json_value_anyf("sbytes", "%u", follow_info->bytes_written[0]);
+    remove_tap_listener(follow_info);
+    follow_info_free(follow_info);
+}
 
-    /* Client information: hostname, port, bytes sent */
-    host = address_to_name(&follow_info->client_ip);
-    sharkd_json_value_string("chost", host);
+/* Container kept open between followbulk requests, to avoid reloading its index. */
+static follow_bulk_reader_t *followbulk_reader;
+static char *followbulk_reader_path;
 
-    port = get_follow_port_to_display(follower)(NULL, follow_info->client_port);
-    sharkd_json_value_string("cport", port);
-    wmem_free(NULL, port);
+/**
+ * sharkd_session_process_followbulk()
+ *
+ * Process followbulk request, reading from a container written by
+ * tshark -z follow,<proto>,bulk,<file>
+ *
+ * Input:
+ *   (m) file   - container file name
+ *   (o) stream - stream index number
+ *
+ * Output object with attributes:
+ *
+ *   (m) err    - error code
+ *
+ *   Without stream:
+ *   (m) follow  - follower that wrote the container (e.g. TCP)
+ *   (m) streams - array of the stream index numbers in the container
+ *
+ *   With stream, the same attributes as the follow request:
+ *   (m) shost, sport, sbytes, chost, cport, cbytes
+ *   (o) payloads
+ */
+static void
+sharkd_session_process_followbulk(char *buf, const jsmntok_t *tokens, int count)
+{
+    const char *tok_file = json_find_attr(buf, tokens, count, "file");
+    const char *tok_stream = json_find_attr(buf, tokens, count, "stream");
 
-    sharkd_json_value_anyf("cbytes", "%u", follow_info->bytes_written[1]);
+    register_follow_t *follower;
+    follow_info_t *follow_info;
+    uint64_t stream_id;
+    int err;
 
-    if (follow_info->payload)
+    if (followbulk_reader == NULL || strcmp(followbulk_reader_path, tok_file) != 0)
     {
-        follow_record_t *follow_record;
-        GList *cur;
-
-        sharkd_json_array_open("payloads");
-        for (cur = g_list_last(follow_info->payload); cur; cur = g_list_previous(cur))
+        if (followbulk_reader)
         {
-            follow_record = (follow_record_t *) cur->data;
+            follow_bulk_reader_close(followbulk_reader);
+            g_free(followbulk_reader_path);
+            followbulk_reader = NULL;
+            followbulk_reader_path = NULL;
+        }
 
-            json_dumper_begin_object(&dumper);
+        followbulk_reader = follow_bulk_reader_open(tok_file, &err);
+        if (!followbulk_reader)
+        {
+            sharkd_json_error(
+                    rpcid, -12003, NULL,
+                    "sharkd_session_process_followbulk() file=%s error=%s", tok_file, g_strerror(err)
+                    );
+            return;
+        }
+        followbulk_reader_path = g_strdup(tok_file);
+    }
 
-            sharkd_json_value_anyf("n", "%u", follow_record->packet_num);
-            sharkd_json_value_base64("d", follow_record->data->data, follow_record->data->len);
+    follower = get_follow_by_name(follow_bulk_reader_follower_name(followbulk_reader));
+    if (!follower)
+    {
+        sharkd_json_error(
+                rpcid, -12004, NULL,
+                "sharkd_session_process_followbulk() follower=%s not found", follow_bulk_reader_follower_name(followbulk_reader)
+                );
+        return;
+    }
 
-            if (follow_record->is_server)
-                sharkd_json_value_anyf("s", "%d", 1);
+    if (!tok_stream)
+    {
+        unsigned i;
 
-            json_dumper_end_object(&dumper);
-        }
+        sharkd_json_result_prologue(rpcid);
+        sharkd_json_value_string("follow", follow_bulk_reader_follower_name(followbulk_reader));
+        sharkd_json_array_open("streams");
+        for (i = 0; i < follow_bulk_reader_stream_count(followbulk_reader); i++)
+            sharkd_json_value_anyf(NULL, "%" PRIu64, follow_bulk_reader_stream_id(followbulk_reader, i));
         sharkd_json_array_close();
+        sharkd_json_result_epilogue();
+        return;
+    }
+
+    if (!ws_strtou64(tok_stream, NULL, &stream_id))
+    {
+        sharkd_json_error(
+                rpcid, -12005, NULL,
+                "Invalid stream=%s", tok_stream
+                );
+        return;
+    }
+
+    follow_info = g_new0(follow_info_t, 1);
+    if (!follow_bulk_reader_get_stream(followbulk_reader, stream_id, follow_info))
+    {
+        sharkd_json_error(
+                rpcid, -12006, NULL,
+                "sharkd_session_process_followbulk() stream=%" PRIu64 " not found or truncated", stream_id
+                );
+        follow_info_free(follow_info);
+        return;
     }
 
+    sharkd_json_result_prologue(rpcid);
+    sharkd_session_follow_result(follower, follow_info);
     sharkd_json_result_epilogue();
 
-    remove_tap_listener(follow_info);
     follow_info_free(follow_info);
 }
 
@@ -5422,6 +5935,8 @@ sharkd_session_process_setcomment(char *buf, const jsmntok_t *tokens, int count)
     else
     {
         sharkd_set_modified_block(fdata, pkt_block);
+        /* Custom columns may show comments. */
+        sharkd_column_cache_invalidate_frame(framenum);
         sharkd_json_simple_ok(rpcid);
     }
 }
@@ -5473,6 +5988,7 @@ sharkd_session_process_setconf(char *buf, const jsmntok_t *tokens, int count)
     switch (ret)
     {
         case PREFS_SET_OK:
+            sharkd_column_cache_restart();
             sharkd_json_simple_ok(rpcid);
             break;
 
@@ -6164,6 +6680,8 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
             sharkd_session_process_tap(buf, tokens, count);
         else if (!strcmp(tok_method, "follow"))
             sharkd_session_process_follow(buf, tokens, count);
+        else if (!strcmp(tok_method, "followbulk"))
+            sharkd_session_process_followbulk(buf, tokens, count);
         else if (!strcmp(tok_method, "iograph"))
             sharkd_session_process_iograph(buf, tokens, count);
         else if (!strcmp(tok_method, "intervals"))
@@ -6193,6 +6711,95 @@ sharkd_session_process(char *buf, const jsmntok_t *tokens, int count)
     }
 }
 
+#ifndef _WIN32
+/*
+ * Requests are read from stdin into our own buffer rather than with
+ * stdio, so that the prefill can poll() stdin once the buffer is empty
+ * without stdin having to be unbuffered.
+ */
+static struct
+{
+    char data[8 * 1024];
+    size_t start;
+    size_t end;
+    bool eof;
+} stdin_buf;
+
+/* Like fgets(buf, size, stdin). */
+static bool
+sharkd_session_read_line(char *line, size_t size)
+{
+    size_t len = 0;
+
+    while (len + 1 < size)
+    {
+        const char *start;
+        const char *nl;
+        size_t n;
+
+        if (stdin_buf.start == stdin_buf.end)
+        {
+            ssize_t ret;
+
+            if (stdin_buf.eof)
+                break;
+
+            do
+                ret = read(fileno(stdin), stdin_buf.data, sizeof(stdin_buf.data));
+            while (ret == -1 && errno == EINTR);
+
+            if (ret <= 0)
+            {
+                stdin_buf.eof = true;
+                break;
+            }
+            stdin_buf.start = 0;
+            stdin_buf.end = (size_t) ret;
+        }
+
+        start = stdin_buf.data + stdin_buf.start;
+        nl = (const char *) memchr(start, '\n', stdin_buf.end - stdin_buf.start);
+        n = (nl != NULL) ? (size_t) (nl - start) + 1 : stdin_buf.end - stdin_buf.start;
+        if (n > size - 1 - len)
+            n = size - 1 - len;
+
+        memcpy(line + len, start, n);
+        stdin_buf.start += n;
+        len += n;
+        if (line[len - 1] == '\n')
+            break;
+    }
+
+    line[len] = '\0';
+    return len > 0;
+}
+#endif
+
+/* Prefill the column cache until a request arrives; returns true. */
+static bool
+sharkd_session_wait_for_request(void)
+{
+#ifndef _WIN32
+    struct pollfd pfd;
+
+    /* There's a request, or part of one, in the buffer already. */
+    if (stdin_buf.start != stdin_buf.end)
+        return true;
+
+    pfd.fd = fileno(stdin);
+    pfd.events = POLLIN;
+
+    while (column_cache.prefill_next != 0)
+    {
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 0) != 0)
+            break;
+        sharkd_column_cache_prefill();
+    }
+#endif
+    return true;
+}
+
 int
 sharkd_session_main(int mode_setting)
 {
@@ -6208,13 +6815,18 @@ sharkd_session_main(int mode_setting)
 
     /* XXX - This could be a wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(),...) */
     filter_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_filter_free);
+    sharkd_column_cache_init();
 
 #ifdef HAVE_MAXMINDDB
     /* mmdbresolve was stopped before fork(), force starting it */
     uat_get_table_by_name("MaxMind Database Paths")->post_update_cb();
 #endif
 
-    while (fgets(buf, sizeof(buf), stdin))
+#ifndef _WIN32
+    while (sharkd_session_wait_for_request() && sharkd_session_read_line(buf, sizeof(buf)))
+#else
+    while (sharkd_session_wait_for_request() && fgets(buf, sizeof(buf), stdin))
+#endif
     {
         /* every command is line separated JSON */
         int ret;
@@ -6250,7 +6862,7 @@ sharkd_session_main(int mode_setting)
             continue;
         }
 
-        host_name_lookup_process();
+        sharkd_column_cache_names_resolved(host_name_lookup_process());
 
         sharkd_session_process(buf, tokens, ret);
     }
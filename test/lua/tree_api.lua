@@ -8,10 +8,22 @@ local ip_src = Field.new("ip.src")
 local ip_dst = Field.new("ip.dst")
 
 testlib.init({
-    [TREE] = 12,
+    [TREE] = 21,
 })
 
 local tree_proto = Proto("tree_api", "Tree API Tests")
+local pf_u8 = ProtoField.uint8("tree_api.u8", "Unsigned byte")
+local pf_u16 = ProtoField.uint16("tree_api.u16", "Unsigned short")
+tree_proto.fields = { pf_u8, pf_u16 }
+
+local f_u8 = Field.new("tree_api.u8")
+local f_u16 = Field.new("tree_api.u16")
+
+local header_fields = {
+    { pf_u8, 0, 1 },
+    { pf_u16, 1, 2 },
+    { pf_u8, 3, 1 },
+}
 local numinits = 0
 local ran_tests = false
 
@@ -70,6 +82,30 @@ function tree_proto.dissector(tvb, pinfo, tree)
     end
     local finfo = ip_src_item and ip_src_item:get_field_info() or nil
     testlib.test(TREE, "field_info_ip_src", finfo and finfo.name == "ip.src")
+
+    local t = tree:add(tree_proto, tvb(0,4))
+    testlib.test(TREE, "add_fields_returns_item", t:add_fields(tvb(0,4), header_fields) == t)
+
+    local u8s = { f_u8() }
+    local u16s = { f_u16() }
+    testlib.test(TREE, "add_fields_values", #u8s == 2 and #u16s == 1 and
+                 u8s[1].value == tvb(0,1):uint() and u8s[2].value == tvb(3,1):uint() and
+                 u16s[1].value == tvb(1,2):uint())
+
+    local again = { f_u8() }
+    testlib.test(TREE, "field_cached_values", #again == 2 and rawequal(again[1], u8s[1]) and rawequal(again[2], u8s[2]))
+
+    t:add_fields(tvb(0,4), { { pf_u8, 2, 1 } })
+    testlib.test(TREE, "field_cache_sees_new_values", #{ f_u8() } == 3)
+
+    t:add_fields(tvb(0,4), { { pf_u16, 2, -1, ENC_LITTLE_ENDIAN } })
+    u16s = { f_u16() }
+    testlib.test(TREE, "add_fields_le_to_end", #u16s == 2 and u16s[2].value == tvb(2,2):le_uint())
+
+    testlib.test(TREE, "add_fields_out_of_bounds", not pcall(function() t:add_fields(tvb(0,4), { { pf_u8, 4, 1 } }) end))
+    testlib.test(TREE, "add_fields_bad_field", not pcall(function() t:add_fields(tvb(0,4), { { "tree_api.u8", 0, 1 } }) end))
+    testlib.test(TREE, "add_fields_bad_entry", not pcall(function() t:add_fields(tvb(0,4), { 1 }) end))
+    testlib.test(TREE, "add_fields_bad_encoding", not pcall(function() t:add_fields(tvb(0,4), { { pf_u16, 0, 2, "le" } }) end))
 end
 
 register_postdissector(tree_proto)
@@ -93,6 +93,15 @@ class TestBasicClopts:
         assert process.returncode == ExitCodes.INVALID_FILE_ERROR
 
 
+class TestTsharkInitTiming:
+    def test_epan_init_timing(self, cmd_tshark, test_env):
+        '''The steps of epan_init() are timed at the info level.'''
+        proc = subprocesstest.run((cmd_tshark, '--log-level=info', '--log-domains=epan', '-v'),
+            capture_output=True, env=test_env)
+        assert proc.returncode == ExitCodes.OK
+        assert grep_output(proc.stderr, r'epan_init\(\) took [0-9.]+ ms: .*protocol registration [0-9.]+ ms')
+
+
 class TestTsharkOptions:
     # XXX Should we generate individual test functions instead of looping?
     def test_tshark_invalid_chars(self, cmd_tshark, test_env):
@@ -322,6 +331,69 @@ class TestTsharkZExpert:
         assert not grep_output(proc.stdout, 'Chats')
 
 
+class TestTsharkZMemory:
+    def test_tshark_z_memory(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'memory',
+            '-r', capture_file('http-ooo.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        assert grep_output(proc.stdout, 'File Scope Memory by Protocol')
+        # TCP keeps its conversation and analysis data in the file scope.
+        assert grep_output(proc.stdout, r'^  tcp +[1-9][0-9]* ')
+
+    def test_tshark_z_memory_invalid_argument(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'memory,tcp',
+            '-r', capture_file('http-ooo.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == ExitCodes.COMMAND_LINE
+
+
+class TestTsharkExportObjects:
+    # http-duplicate-objects.pcap has three HTTP responses on separate
+    # connections: /a.txt and /b.txt with the same body, /c.txt another.
+    def export_objects(self, cmd_tshark, capture_file, test_env, save_dir, *args):
+        return subprocesstest.run((cmd_tshark, '-q',
+            '-r', capture_file('http-duplicate-objects.pcap'),
+            '--export-objects', 'http,' + save_dir) + args,
+            capture_output=True, env=test_env)
+
+    def saved_objects(self, save_dir):
+        objects = {}
+        for name in os.listdir(save_dir):
+            with open(os.path.join(save_dir, name), 'rb') as f:
+                objects[name] = f.read()
+        return objects
+
+    def test_tshark_export_objects(self, cmd_tshark, capture_file, result_file, test_env):
+        save_dir = result_file('objects')
+        proc = self.export_objects(cmd_tshark, capture_file, test_env, save_dir)
+        assert proc.returncode == 0
+        assert self.saved_objects(save_dir) == {
+            'a.txt': b'same content\n',
+            'b.txt': b'same content\n',
+            'c.txt': b'other content\n',
+        }
+
+    def test_tshark_export_objects_stream(self, cmd_tshark, capture_file, result_file, test_env):
+        save_dir = result_file('objects')
+        proc = self.export_objects(cmd_tshark, capture_file, test_env, save_dir,
+            '--export-objects-stream')
+        assert proc.returncode == 0
+        # The second object with the same content is skipped.
+        assert self.saved_objects(save_dir) == {
+            'a.txt': b'same content\n',
+            'c.txt': b'other content\n',
+        }
+        assert grep_output(proc.stderr, 'Skipped 1 duplicate http objects')
+
+    def test_tshark_export_objects_stream_bad_dir(self, cmd_tshark, capture_file, result_file, test_env):
+        # A directory can't be created below a regular file.
+        not_a_dir = result_file('not-a-dir')
+        with open(not_a_dir, 'w'):
+            pass
+        proc = self.export_objects(cmd_tshark, capture_file, test_env,
+            os.path.join(not_a_dir, 'objects'), '--export-objects-stream')
+        assert count_output(proc.stderr, 'Failed to create export objects output directory') == 1
+
+
 class TestTsharkExtcap:
     # dumpcap dependency has been added to run this test only with capture support
     def test_tshark_extcap_interfaces(self, cmd_tshark, cmd_dumpcap, test_env, home_path):
@@ -590,6 +590,18 @@ class TestDecryptTLS:
             ), encoding='utf-8', env=test_env)
         assert grep_output(stdout, 'TLS13-CHACHA20-POLY1305-SHA256')
 
+    def test_tls_decrypt_stats(self, cmd_tshark, dirs, capture_file, test_env):
+        '''TLS decryption statistics'''
+        key_file = os.path.join(dirs.key_dir, 'tls13-20-chacha20poly1305.keys')
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('tls13-20-chacha20poly1305.pcap'),
+                '-o', f'tls.keylog_file: {key_file}',
+                '-q',
+                '-z', 'tls,decrypt-stats',
+            ), encoding='utf-8', env=test_env)
+        assert grep_output(stdout, 'TLS Decryption Statistics:')
+        assert grep_output(stdout, 'Key log lines parsed without regex: 8')
+
     def test_tls13_rfc8446(self, cmd_tshark, dirs, features, capture_file, test_env):
         '''TLS 1.3 (normal session, then early data followed by normal data).'''
         key_file = os.path.join(dirs.key_dir, 'tls13-rfc8446.keys')
@@ -253,6 +253,57 @@ class TestFileFormatsPcapngDsb:
         assert dsb1_contents == dsb1_out
         assert dsb2_contents == dsb2_out
 
+class TestFileFormatEditcapSplit:
+    def split_files(self, cmd_editcap, infile, outfile, args, env):
+        subprocess.run((cmd_editcap, *args, infile, outfile), check=True, env=env)
+        p = PurePath(outfile)
+        split = {}
+        for name in os.listdir(p.parent):
+            if name.startswith(p.stem + '_'):
+                with open(os.path.join(p.parent, name), 'rb') as f:
+                    split[name[len(p.stem):]] = f.read()
+        return split
+
+    @pytest.mark.parametrize('args, capture', [
+        (('-c', '1'), 'dhcp.pcapng'),
+        (('-c', '2'), 'dhe1.pcapng.gz'),
+        (('-i', '0.05'), 'dhcp.pcap'),
+    ])
+    def test_editcap_split_threads(self, cmd_editcap, capture_file, result_file, base_env, args, capture):
+        '''Splitting with --split-threads writes the same files as without it.'''
+        infile = capture_file(capture)
+        single = self.split_files(cmd_editcap, infile, result_file('single.pcapng'), args, base_env)
+        threaded = self.split_files(cmd_editcap, infile, result_file('threaded.pcapng'),
+            ('--split-threads', '3', *args), base_env)
+        assert len(single) > 1
+        assert single == threaded
+
+    def test_editcap_flow_shards(self, cmd_editcap, cmd_tshark, capture_file, result_file, base_env):
+        '''Both directions of a flow are written to the same --flow-shards file.'''
+        infile = capture_file('dns+icmp.pcapng.gz')
+        outfile = result_file('shards.pcapng')
+        subprocess.run((cmd_editcap, '--flow-shards', '4', infile, outfile), check=True, env=base_env)
+        fields = ('-Tfields', '-E', 'occurrence=f',
+            '-e', 'ip.src', '-e', 'ip.dst', '-e', 'ip.proto', '-e', 'udp.srcport', '-e', 'udp.dstport')
+        p = PurePath(outfile)
+        shard_of = {}
+        shard_count = 0
+        for n in range(4):
+            shard = str(p.with_name(f'{p.stem}_{n:05d}{p.suffix}'))
+            lines = subprocess.check_output((cmd_tshark, '-r', shard, *fields),
+                encoding='utf-8', env=base_env).splitlines()
+            for line in lines:
+                src, dst, proto, sport, dport = line.split('\t')
+                if proto != '17':
+                    # Only the outer header counts, not the one in an ICMP error.
+                    sport = dport = ''
+                flow = (proto, frozenset(((src, sport), (dst, dport))))
+                assert shard_of.setdefault(flow, n) == n
+            shard_count += len(lines)
+        in_count = len(subprocess.check_output((cmd_tshark, '-r', infile, *fields),
+            encoding='utf-8', env=base_env).splitlines())
+        assert shard_count == in_count
+
 class TestFileFormatMime:
     def test_mime_pcapng_gz(self, cmd_tshark, capture_file, test_env):
         '''Test that the full uncompressed contents is shown.'''
@@ -277,3 +328,45 @@ class TestFileFormatCllog:
             ), encoding='utf-8', env=test_env)
         assert ' '.join(proc_stdout.strip().splitlines()) == \
             '2015 2024 2015 2024 2015 2024 2015 2024'
+
+class TestFileFormatBlf:
+    # blf-log-containers.blf has 60 Ethernet frames in 13 log containers,
+    # one of them uncompressed, which the frames straddle.
+    blf_frame_lens = [14 + 20 + 8 + 30 * (1 + i % 7) for i in range(60)]
+
+    def test_blf_log_containers(self, cmd_tshark, capture_file, test_env):
+        '''Read the frames of a BLF file with several compressed log containers.'''
+        proc_stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('blf-log-containers.blf'),
+                '-Tfields',
+                '-e', 'frame.len',
+                '-e', 'udp.srcport',
+            ), encoding='utf-8', env=test_env)
+        assert proc_stdout.splitlines() == \
+            ['{}\t{}'.format(frame_len, 40000 + i) for i, frame_len in enumerate(self.blf_frame_lens)]
+
+    @pytest.mark.parametrize('args', [(), ('-2',), ('-Y', 'udp.dstport == 5001',)])
+    def test_blf_readahead(self, cmd_tshark, capture_file, test_env, args):
+        '''Decompressing log containers ahead in other threads doesn't change the output.'''
+        outputs = []
+        for inflate_threads in ('0', '1', '4'):
+            env = dict(test_env, BLF_INFLATE_THREADS=inflate_threads)
+            outputs.append(subprocess.check_output((cmd_tshark,
+                    '-r', capture_file('blf-log-containers.blf'),
+                    '-V', '-x', *args,
+                ), encoding='utf-8', env=env))
+        assert count_output(outputs[0], '^Frame [0-9]+:') > 0
+        assert outputs[1] == outputs[0]
+        assert outputs[2] == outputs[0]
+
+    def test_blf_readahead_pipe(self, cmd_tshark, capture_file, test_env):
+        '''The same when the BLF file is read from a pipe.'''
+        with open(capture_file('blf-log-containers.blf'), 'rb') as f:
+            blf_data = f.read()
+        outputs = []
+        for inflate_threads in ('0', '4'):
+            env = dict(test_env, BLF_INFLATE_THREADS=inflate_threads)
+            outputs.append(subprocess.run((cmd_tshark, '-r', '-', '-V', '-x'),
+                    input=blf_data, stdout=subprocess.PIPE, check=True, env=env).stdout.decode('utf-8'))
+        assert count_output(outputs[0], '^Frame [0-9]+:') == len(self.blf_frame_lens)
+        assert outputs[1] == outputs[0]
@@ -11,6 +11,7 @@
 import os.path
 import shutil
 import subprocess
+import time
 
 import pytest
 
@@ -106,3 +107,27 @@ class TestNameResolution:
                 ), encoding='utf-8', env=base_env)
         assert '174.137.42.65\twww.wireshark.org' not in stdout
         assert 'fe80::6233:4bff:fe13:c558\tCrunch.local' in stdout
+
+    @pytest.mark.parametrize('cache_lifetime, cached', [(24, True), (0, False)])
+    def test_dns_cache(self, cmd_tshark, capture_file, conf_path, test_env, cache_lifetime, cached):
+        '''Names from the resolver cache are only used if it is enabled.'''
+        expires = int(time.time()) + 3600
+        with open(os.path.join(conf_path, 'dns_cache'), 'w') as f:
+            f.write('192.168.43.9 {} cached-192-168-43-9\n'.format(expires))
+            # Every other address in the capture, so that nothing is looked up.
+            for addr in ('192.168.43.1', '174.137.42.65', '8.8.8.8', '8.8.4.4', '4.2.2.2'):
+                f.write('{} {}\n'.format(addr, expires))
+        # Anything that is looked up anyway, e.g. with the cache disabled,
+        # goes to a closed port on the loopback address and fails at once.
+        with open(os.path.join(conf_path, 'addr_resolve_dns_servers'), 'w') as f:
+            f.write('"127.0.0.1","9","9"\n')
+        stdout = subprocess.check_output((cmd_tshark,
+                '-r', capture_file('dns+icmp.pcapng.gz'),
+                '-o', 'nameres.network_name: TRUE',
+                '-o', 'nameres.use_external_name_resolver: TRUE',
+                '-o', 'nameres.use_custom_dns_servers: TRUE',
+                '-o', 'nameres.dns_cache_lifetime: {}'.format(cache_lifetime),
+                ), encoding='utf-8', env=test_env)
+        assert grep_output(stdout, 'cached-192-168-43-9') == cached
+        # No temporary files are left behind by saving the cache.
+        assert [f for f in os.listdir(conf_path) if f.startswith('dns_cache')] == ['dns_cache']
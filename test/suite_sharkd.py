@@ -9,7 +9,12 @@
 '''sharkd tests'''
 
 import json
+import os
+import shutil
+import socket
 import subprocess
+import sys
+import tempfile
 
 import pytest
 
@@ -182,7 +187,9 @@ class TestSharkd:
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"status"},
         ), (
-            {"jsonrpc":"2.0","id":1,"result":{"frames":0,"duration":0.000000000,"columns":["No.","Time","Delta","Source","Destination","Protocol","Length","Info"],
+            {"jsonrpc":"2.0","id":1,"result":{"frames":0,"duration":0.000000000,
+                "column_cache": MatchAny(dict), "memory": MatchAny(dict),
+                "columns":["No.","Time","Delta","Source","Destination","Protocol","Length","Info"],
                 "column_info":[{
                     "title":"No.","format": "%m","visible":True, "display": "R"
                 },{
@@ -213,6 +220,12 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
             {"jsonrpc":"2.0","id":2,"result":{"frames": 4, "duration": 0.070345000,
                 "filename": "dhcp.pcap", "filesize": 1400,
+                "column_cache": MatchAny(dict),
+                "memory": MatchObject({
+                    "total": MatchAny(int),
+                    "unattributed": MatchAny(int),
+                    "protocols": MatchList({"proto": MatchAny(str), "bytes": MatchAny(int)}),
+                }),
                 "columns":["No.","Time","Delta","Source","Destination","Protocol","Length","Info"],
                 "column_info":[{
                     "title":"No.","format": "%m","visible":True, "display": "R"
@@ -332,6 +345,26 @@ class TestSharkd:
             },
         ))
 
+    def test_sharkd_req_frames_column_cache(self, run_sharkd_session, capture_file):
+        outputs = run_sharkd_session([json.dumps(x) for x in (
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"frames"},
+            {"jsonrpc":"2.0", "id":3, "method":"status"},
+            {"jsonrpc":"2.0", "id":4, "method":"frames"},
+            {"jsonrpc":"2.0", "id":5, "method":"status"},
+        )])
+        assert len(outputs) == 5
+        first = outputs[2]["result"]["column_cache"]
+        second = outputs[4]["result"]["column_cache"]
+        # Every row of the first reply was looked up; the same rows are
+        # then all found again.
+        assert first["hits"] + first["misses"] == 4
+        assert second["hits"] == first["hits"] + 4
+        assert second["misses"] == first["misses"]
+        assert outputs[3]["result"] == outputs[1]["result"]
+
     def test_sharkd_req_frames_delta_times(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1342,6 +1375,78 @@ class TestSharkd:
              },
         ))
 
+    def test_sharkd_req_followbulk(self, check_sharkd_session, cmd_tshark, capture_file, result_file, base_env):
+        container = result_file('udp-follow.wsfc')
+        subprocess.check_call((cmd_tshark,
+                               '-r', capture_file('dhcp.pcap'),
+                               '-qz', f'follow,udp,bulk,{container},frame.number==1',
+                               ), env=base_env, stdout=subprocess.DEVNULL)
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"followbulk",
+            "params":{"file": container}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"followbulk",
+            "params":{"file": container, "stream": 0}
+            },
+            {"jsonrpc":"2.0", "id":3, "method":"followbulk",
+            "params":{"file": container, "stream": 1}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"follow": "UDP", "streams": [0]}},
+            {"jsonrpc":"2.0","id":2,
+            "result":{
+             "shost": "255.255.255.255", "sport": "67", "sbytes": 272,
+             "chost": "0.0.0.0", "cport": "68", "cbytes": 0,
+             "payloads": [
+                 {"n": 1, "d": MatchRegExp(r'AQEGAAAAPR0A[a-zA-Z0-9]{330}AANwQBAwYq/wAAAAAAAAA=')}]}
+            },
+            {"jsonrpc":"2.0","id":3,
+            "error":{"code":-12006,"message":"sharkd_session_process_followbulk() stream=1 not found or truncated"}
+            },
+        ))
+
+    def test_sharkd_req_followbulk_tcp(self, check_sharkd_session, cmd_tshark, capture_file, result_file, base_env):
+        # TCP stream 0 is a lone RST/ACK without payload, so only stream 1
+        # is written to the container.
+        container = result_file('tcp-follow.wsfc')
+        proc = subprocess.run((cmd_tshark,
+                               '-r', capture_file('dns-mdns.pcap'),
+                               '-qz', f'follow,tcp,bulk,{container}',
+                               ), env=base_env, check=True, capture_output=True, encoding='utf-8')
+        assert 'Streams: 1\n' in proc.stdout
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"followbulk",
+            "params":{"file": container}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"followbulk",
+            "params":{"file": container, "stream": 1}
+            },
+            {"jsonrpc":"2.0", "id":3, "method":"followbulk",
+            "params":{"file": container, "stream": 0}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"follow": "TCP", "streams": [1]}},
+            {"jsonrpc":"2.0","id":2,
+            "result":{
+             "shost": "44.209.25.113", "sport": "443", "sbytes": 3228,
+             "chost": "192.168.100.158", "cport": "33460", "cbytes": 894,
+             "payloads": [
+                 {"n": 485, "d": MatchRegExp(r'^FgMB')},
+                 {"n": 488, "s": 1, "d": MatchAny(str)},
+                 {"n": 489, "s": 1, "d": MatchAny(str)},
+                 {"n": 494, "d": MatchAny(str)},
+                 {"n": 505, "d": MatchAny(str)},
+                 {"n": 510, "s": 1, "d": MatchAny(str)},
+                 {"n": 512, "d": MatchAny(str)},
+                 {"n": 519, "d": MatchAny(str)},
+                 {"n": 521, "s": 1, "d": MatchAny(str)},
+             ]}
+            },
+            {"jsonrpc":"2.0","id":3,
+            "error":{"code":-12006,"message":"sharkd_session_process_followbulk() stream=0 not found or truncated"}
+            },
+        ))
+
     def test_sharkd_req_iograph_bad(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
@@ -1784,3 +1889,106 @@ class TestSharkd:
             {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
             MatchAny(),
         ))
+
+
+@pytest.mark.skipif(sys.platform == 'win32', reason='--preload needs fork()')
+class TestSharkdPreload:
+    requests = (
+        {"jsonrpc":"2.0", "id":2, "method":"frames"},
+        {"jsonrpc":"2.0", "id":3, "method":"frame",
+         "params":{"frame": 2, "proto": True, "bytes": True}
+         },
+    )
+
+    def load(self, path):
+        return {"jsonrpc":"2.0", "id":1, "method":"load", "params":{"file": path}}
+
+    def console_session(self, run_sharkd_session, path):
+        return run_sharkd_session([json.dumps(x) for x in (self.load(path),) + self.requests])
+
+    def daemon_session(self, sock_path, path):
+        outputs = []
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+            sock.connect(sock_path)
+            with sock.makefile('rw', encoding='utf-8') as sock_file:
+                for request in (self.load(path),) + self.requests:
+                    sock_file.write(json.dumps(request) + '\n')
+                    sock_file.flush()
+                    outputs.append(json.loads(sock_file.readline()))
+        return tuple(outputs)
+
+    def run_daemon(self, cmd_sharkd, base_env, sock_path, preload, cwd):
+        daemon = subprocess.Popen(
+            (cmd_sharkd, '-a', 'unix:' + sock_path, '--foreground', '--preload', preload),
+            cwd=cwd, stderr=subprocess.PIPE, encoding='utf-8', env=base_env)
+        # Sessions are accepted once the file is loaded.
+        for line in daemon.stderr:
+            if line.startswith('Sharkd preloaded:'):
+                return daemon
+        daemon.wait()
+        pytest.fail('sharkd did not preload {}'.format(preload))
+
+    def test_sharkd_preload(self, cmd_sharkd, run_sharkd_session, capture_file, base_env):
+        path = capture_file('dhcp.pcap')
+        expected = self.console_session(run_sharkd_session, path)
+        with tempfile.TemporaryDirectory() as sock_dir:
+            sock_path = os.path.join(sock_dir, 'sharkd.sock')
+            # Preload a relative path, then load the absolute one.
+            daemon = self.run_daemon(cmd_sharkd, base_env, sock_path,
+                os.path.basename(path), os.path.dirname(path))
+            try:
+                # Each session is forked from the daemon with the file
+                # loaded, and reads the frames with its own descriptor.
+                for _ in range(2):
+                    assert self.daemon_session(sock_path, path) == expected
+            finally:
+                daemon.terminate()
+                daemon.wait()
+
+    def test_sharkd_preload_changed_file(self, cmd_sharkd, run_sharkd_session, capture_file, base_env):
+        expected = self.console_session(run_sharkd_session, capture_file('dns-mdns.pcap'))
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            sock_path = os.path.join(tmp_dir, 'sharkd.sock')
+            path = os.path.join(tmp_dir, 'capture.pcap')
+            shutil.copyfile(capture_file('dhcp.pcap'), path)
+            daemon = self.run_daemon(cmd_sharkd, base_env, sock_path, path, tmp_dir)
+            try:
+                # A file rewritten after it was preloaded is loaded again.
+                shutil.copyfile(capture_file('dns-mdns.pcap'), path)
+                assert self.daemon_session(sock_path, path) == expected
+            finally:
+                daemon.terminate()
+                daemon.wait()
+
+    def test_sharkd_preload_replaced_file(self, cmd_sharkd, run_sharkd_session, capture_file, base_env):
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            sock_path = os.path.join(tmp_dir, 'sharkd.sock')
+            path = os.path.join(tmp_dir, 'capture.pcap')
+            shutil.copyfile(capture_file('dhcp.pcap'), path)
+            daemon = self.run_daemon(cmd_sharkd, base_env, sock_path, path, tmp_dir)
+            try:
+                # Replace the file with another one of the same size and
+                # modification time, differing in the DHCP transaction ID
+                # of frame 1 (shown in its Info column). The session must
+                # notice that the name refers to another file.
+                with open(capture_file('dhcp.pcap'), 'rb') as f:
+                    data = bytearray(f.read())
+                data[89] ^= 0xff
+                other_path = os.path.join(tmp_dir, 'other.pcap')
+                with open(other_path, 'wb') as f:
+                    f.write(data)
+                statb = os.stat(path)
+                os.utime(other_path, ns=(statb.st_atime_ns, statb.st_mtime_ns))
+                os.replace(other_path, path)
+                expected = self.console_session(run_sharkd_session, path)
+                assert self.daemon_session(sock_path, path) == expected
+            finally:
+                daemon.terminate()
+                daemon.wait()
+
+    def test_sharkd_preload_console(self, cmd_sharkd, capture_file, base_env):
+        # Without -a there are no sessions to share the file with.
+        proc = subprocess.run((cmd_sharkd, '--preload', capture_file('dhcp.pcap')),
+            stdin=subprocess.DEVNULL, capture_output=True, encoding='utf-8', env=base_env)
+        assert proc.returncode != 0
+        assert '--preload requires daemon mode' in proc.stderr
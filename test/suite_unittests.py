@@ -18,6 +18,14 @@ class TestUnitTests:
         '''exntest'''
         subprocess.check_call(program('exntest'), env=base_env)
 
+    def test_unit_file_wrappers_test(self, program, base_env):
+        '''file_wrappers_test'''
+        subprocess.check_call(program('file_wrappers_test'), env=base_env)
+
+    def test_unit_find_index_test(self, program, base_env):
+        '''find_index_test'''
+        subprocess.check_call(program('find_index_test'), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         subprocess.check_call(program('oids_test'), env=base_env)
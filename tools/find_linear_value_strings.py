@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+# Find large value_string arrays that are searched linearly.
+#
+# The value_strings of fields are indexed the first time they are used, but
+# calls such as val_to_str(), try_val_to_str() and val_to_str_const() that
+# are passed an array directly still scan it from the start. This lists the
+# arrays with at least --min-entries entries that are passed to them, the
+# biggest and most often called first, as candidates for conversion to a
+# value_string_ext (VALUE_STRING_EXT_INIT and the _ext functions).
+
+import argparse
+import concurrent.futures
+import os
+import re
+import sys
+
+from check_common import (
+    findDissectorFilesInFolder,
+    getFilesFromCommits,
+    getFilesFromOpen,
+    isDissectorFile,
+    isGeneratedFile,
+    removeComments,
+)
+
+# value_string arrays and the number of entries before the {0, NULL} entry.
+VS_DEF_RE = re.compile(r'\bvalue_string\s+(\w+)\s*\[\s*\]\s*=\s*\{(.*?)\}\s*;', re.DOTALL)
+VS_ENTRY_RE = re.compile(r'\{\s*[^{},]+,\s*"')
+
+# Calls that search a plain value_string array linearly; the array is
+# their second argument.
+LINEAR_CALL_RE = re.compile(r'(?<![\w.>])((?:try_)?val_to_str(?:_const|_wmem|_idx)?)\s*\(\s*[^,()]*(?:\([^()]*\))?[^,()]*,\s*(?:VALS\()?\s*(\w+)')
+
+
+def scanFile(filename):
+    with open(filename, 'r', encoding='utf8', errors='ignore') as f:
+        contents = removeComments(f.read())
+
+    tables = {}
+    for m in VS_DEF_RE.finditer(contents):
+        tables[m.group(1)] = len(VS_ENTRY_RE.findall(m.group(2)))
+
+    calls = {}
+    for m in LINEAR_CALL_RE.finditer(contents):
+        name = m.group(2)
+        if name in tables:
+            calls[name] = calls.get(name, 0) + 1
+
+    return [(filename, name, tables[name], count) for name, count in calls.items()]
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Find large value_string arrays that are searched linearly')
+    parser.add_argument('--file', action='append',
+                        help='specify individual dissector file to scan')
+    parser.add_argument('--commits', action='store',
+                        help='last N commits to scan')
+    parser.add_argument('--open', action='store_true',
+                        help='scan open files')
+    parser.add_argument('--min-entries', action='store', type=int, default=32,
+                        help='only report arrays with at least this many entries (default: 32)')
+    parser.add_argument('--no-generated', action='store_true',
+                        help='skip generated dissectors')
+
+    args = parser.parse_args()
+
+    files = []
+    if args.file:
+        for f in args.file:
+            if not os.path.isfile(f):
+                print('Chosen file', f, 'does not exist.')
+                sys.exit(1)
+            if isDissectorFile(f):
+                files.append(f)
+    elif args.commits:
+        files = getFilesFromCommits(args.commits)
+    elif args.open:
+        files = getFilesFromOpen()
+    else:
+        files = findDissectorFilesInFolder(os.path.join('epan', 'dissectors'))
+        files += findDissectorFilesInFolder(os.path.join('plugins', 'epan'), recursive=True)
+        files += findDissectorFilesInFolder(os.path.join('epan', 'dissectors', 'asn1'), recursive=True)
+
+    if args.no_generated:
+        files = [f for f in files if not isGeneratedFile(f)]
+
+    found = []
+    with concurrent.futures.ProcessPoolExecutor() as executor:
+        for result in executor.map(scanFile, files):
+            found += [r for r in result if r[2] >= args.min_entries]
+
+    # Each call scans half the array on average for values that are in it,
+    # and all of it for values that aren't.
+    found.sort(key=lambda r: (r[2] * r[3], r[2]), reverse=True)
+
+    print('%8s %6s  %s' % ('Entries', 'Calls', 'Array'))
+    for filename, name, entries, count in found:
+        print('%8d %6d  %s (%s)' % (entries, count, name, filename))
+    print(len(found), 'linearly searched arrays with at least', args.min_entries, 'entries')
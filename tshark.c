@@ -144,6 +144,7 @@
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
 #define LONGOPT_JSON_COMPACT            LONGOPT_BASE_APPLICATION+12
+#define LONGOPT_EXPORT_OBJECTS_STREAM   LONGOPT_BASE_APPLICATION+13
 
 capture_file cfile;
 
@@ -585,6 +586,8 @@ print_usage(FILE *output)
     fprintf(output, "  --export-objects <protocol>,<destdir>\n");
     fprintf(output, "                           save exported objects for a protocol to a directory\n");
     fprintf(output, "                           named \"destdir\"\n");
+    fprintf(output, "  --export-objects-stream  write exported objects as soon as they are complete,\n");
+    fprintf(output, "                           skipping objects with duplicate content\n");
     fprintf(output, "  --export-tls-session-keys <keyfile>\n");
     fprintf(output, "                           export TLS Session Keys to a file named \"keyfile\"\n");
     fprintf(output, "  --color                  color output text similarly to the Wireshark GUI,\n");
@@ -1076,6 +1079,7 @@ main(int argc, char *argv[])
         LONGOPT_WSLOG
         {"print", ws_no_argument, NULL, 'P'},
         {"export-objects", ws_required_argument, NULL, LONGOPT_EXPORT_OBJECTS},
+        {"export-objects-stream", ws_no_argument, NULL, LONGOPT_EXPORT_OBJECTS_STREAM},
         {"export-tls-session-keys", ws_required_argument, NULL, LONGOPT_EXPORT_TLS_SESSION_KEYS},
         {"color", ws_no_argument, NULL, LONGOPT_COLOR},
         {"no-duplicate-keys", ws_no_argument, NULL, LONGOPT_NO_DUPLICATE_KEYS},
@@ -1876,6 +1880,9 @@ main(int argc, char *argv[])
                     goto clean_exit;
                 }
                 break;
+            case LONGOPT_EXPORT_OBJECTS_STREAM:   /* --export-objects-stream */
+                eo_tap_opt_set_streaming(true);
+                break;
             case LONGOPT_EXPORT_TLS_SESSION_KEYS:   /* --export-tls-session-keys */
                 tls_session_keys_file = ws_optarg;
                 break;
@@ -2604,8 +2611,10 @@ main(int argc, char *argv[])
     if (cf_name) {
         ws_debug("tshark: Opening capture file: %s", cf_name);
         /*
-         * We're reading a capture file.
+         * We're reading a capture file, once, and then exiting, so it
+         * can be read through a memory mapping.
          */
+        wtap_set_file_mapping(true);
         if (cf_open(&cfile, cf_name, in_file_type, false, &err) != CF_OK) {
             epan_cleanup();
             extcap_cleanup();
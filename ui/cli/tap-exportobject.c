@@ -26,12 +26,23 @@
 #include <epan/export_object.h>
 #include "tap-exportobject.h"
 
+/* Index record of an object already written in streaming mode */
+typedef struct _eo_written_t {
+    size_t payload_len;
+    char *path;
+} eo_written_t;
+
 typedef struct _export_object_list_gui_t {
     GSList *entries;
     register_eo_t* eo;
+    GHashTable *written;        /* streaming mode: eo_entry_hash -> GSList of eo_written_t */
+    unsigned duplicates;        /* streaming mode: objects skipped as duplicates */
+    bool save_dir_created;      /* streaming mode: the output directory exists */
+    bool save_dir_failed;       /* streaming mode: it couldn't be created */
 } export_object_list_gui_t;
 
 static GHashTable* eo_opts;
+static bool eo_streaming;
 
 static bool
 list_exportobject_protocol(const void *key, void *value _U_, void *userdata _U_)
@@ -82,11 +93,146 @@ bool eo_tap_opt_add(const char *option_string)
     return false;
 }
 
+void eo_tap_opt_set_streaming(bool streaming)
+{
+    eo_streaming = streaming;
+}
+
+static const char *
+eo_save_dir(export_object_list_gui_t *object_list)
+{
+    return (const char*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
+}
+
+static bool
+eo_create_save_dir(const char *save_in_path)
+{
+    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
+        /* If the destination directory (or its parents) do not exist, create them. */
+        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
+            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
+                    save_in_path, g_strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Write an object to a new file in save_in_path, returning the path used */
+static char *
+eo_save_entry(const char *save_in_path, export_object_entry_t *entry)
+{
+    GString *safe_filename = NULL;
+    char *save_as_fullpath = NULL;
+    unsigned count = 0;
+
+    do {
+        g_free(save_as_fullpath);
+        if (entry->filename) {
+            safe_filename = eo_massage_str(entry->filename,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        } else {
+            char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
+            const char *ext;
+            ext = eo_ct2ext(entry->content_type);
+            snprintf(generic_name, sizeof(generic_name),
+                "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
+            safe_filename = eo_massage_str(generic_name,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        }
+        save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
+        g_string_free(safe_filename, TRUE);
+    } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
+    write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
+    return save_as_fullpath;
+}
+
+/* Does the file at path hold exactly the given payload? */
+static bool
+eo_file_has_payload(const char *path, const uint8_t *payload, size_t payload_len)
+{
+    uint8_t buf[65536];
+    size_t offset = 0, len;
+    FILE *fh;
+    bool equal = true;
+
+    fh = ws_fopen(path, "rb");
+    if (fh == NULL)
+        return false;
+
+    while (equal && (len = fread(buf, 1, sizeof buf, fh)) > 0) {
+        equal = len <= payload_len - offset && memcmp(buf, payload + offset, len) == 0;
+        offset += len;
+    }
+    fclose(fh);
+
+    return equal && offset == payload_len;
+}
+
+/* Streaming mode: write an object unless one with the same content has
+ * already been written, and remember only its hash, size and path. */
+static void
+eo_stream_entry(export_object_list_gui_t *object_list, export_object_entry_t *entry)
+{
+    const char *save_in_path = eo_save_dir(object_list);
+    unsigned hash = eo_entry_hash(entry);
+    GSList *candidates, *cur;
+    eo_written_t *written;
+
+    if (object_list->save_dir_failed)
+        return;
+
+    candidates = (GSList *)g_hash_table_lookup(object_list->written, GUINT_TO_POINTER(hash));
+    for (cur = candidates; cur; cur = cur->next) {
+        written = (eo_written_t *)cur->data;
+        if (written->payload_len == entry->payload_len &&
+            eo_file_has_payload(written->path, entry->payload_data, entry->payload_len)) {
+            object_list->duplicates++;
+            return;
+        }
+    }
+
+    if (!object_list->save_dir_created) {
+        if (!eo_create_save_dir(save_in_path)) {
+            /* Report it once rather than for every object. */
+            object_list->save_dir_failed = true;
+            return;
+        }
+        object_list->save_dir_created = true;
+    }
+
+    written = g_new(eo_written_t, 1);
+    written->payload_len = entry->payload_len;
+    written->path = eo_save_entry(save_in_path, entry);
+    g_hash_table_insert(object_list->written, GUINT_TO_POINTER(hash), g_slist_prepend(candidates, written));
+}
+
+static void
+eo_written_free(void *data)
+{
+    GSList *candidates = (GSList *)data;
+    GSList *cur;
+
+    for (cur = candidates; cur; cur = cur->next) {
+        eo_written_t *written = (eo_written_t *)cur->data;
+        g_free(written->path);
+        g_free(written);
+    }
+    g_slist_free(candidates);
+}
+
 static void
 object_list_add_entry(void *gui_data, export_object_entry_t *entry)
 {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
+    if (object_list->written && !get_eo_entries_mutable(object_list->eo)) {
+        /* The entry is complete; don't keep its payload around. */
+        eo_stream_entry(object_list, entry);
+        eo_free_entry(entry);
+        return;
+    }
+
     object_list->entries = g_slist_append(object_list->entries, entry);
 }
 
@@ -105,43 +251,27 @@ eo_draw(void *tapdata)
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
     GSList *slist = object_list->entries;
     export_object_entry_t *entry;
-    char* save_in_path = (char*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
-    GString *safe_filename = NULL;
-    char *save_as_fullpath = NULL;
-    unsigned count = 0;
+    const char* save_in_path = eo_save_dir(object_list);
 
-    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
-        /* If the destination directory (or its parents) do not exist, create them. */
-        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
-            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
-                    save_in_path, g_strerror(errno));
-            return;
+    if (object_list->written) {
+        /* Objects that were only complete now */
+        for (; slist; slist = slist->next) {
+            eo_stream_entry(object_list, (export_object_entry_t *)slist->data);
+        }
+        if (object_list->duplicates) {
+            fprintf(stderr, "Skipped %u duplicate %s objects\n", object_list->duplicates,
+                    proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
         }
+        return;
+    }
+
+    if (!eo_create_save_dir(save_in_path)) {
+        return;
     }
 
     while (slist) {
         entry = (export_object_entry_t *)slist->data;
-        do {
-            g_free(save_as_fullpath);
-            if (entry->filename) {
-                safe_filename = eo_massage_str(entry->filename,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            } else {
-                char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
-                const char *ext;
-                ext = eo_ct2ext(entry->content_type);
-                snprintf(generic_name, sizeof(generic_name),
-                    "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
-                safe_filename = eo_massage_str(generic_name,
-                    EXPORT_OBJECT_MAXFILELEN, count);
-            }
-            save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
-            g_string_free(safe_filename, TRUE);
-        } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
-        count = 0;
-        write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
-        g_free(save_as_fullpath);
-        save_as_fullpath = NULL;
+        g_free(eo_save_entry(save_in_path, entry));
         slist = slist->next;
     }
 }
@@ -160,6 +290,10 @@ eo_reset(void *tapdata)
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
 
     g_slist_free_full(g_steal_pointer(&object_list->entries), object_list_free_entry);
+    if (object_list->written) {
+        g_hash_table_remove_all(object_list->written);
+        object_list->duplicates = 0;
+    }
 }
 
 /* Clean up our listener state, tapping is done */
@@ -170,6 +304,9 @@ eo_finish(void *tapdata)
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
 
     g_slist_free_full(g_steal_pointer(&object_list->entries), object_list_free_entry);
+    if (object_list->written) {
+        g_hash_table_destroy(object_list->written);
+    }
     g_free(object_list);
     g_free(tap_object);
 }
@@ -197,6 +334,9 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     tap_data->gui_data = (void*)object_list;
 
     object_list->eo = eo;
+    if (eo_streaming) {
+        object_list->written = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, eo_written_free);
+    }
 
     /* Data will be gathered via a tap callback */
     error_msg = register_tap_listener(get_eo_tap_listener_name(eo), tap_data, NULL, TL_REQUIRES_NOTHING,
@@ -205,6 +345,9 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     if (error_msg) {
         cmdarg_err("Can't register %s tap: %s", (const char*)key, error_msg->str);
         g_string_free(error_msg, TRUE);
+        if (object_list->written) {
+            g_hash_table_destroy(object_list->written);
+        }
         g_free(tap_data);
         g_free(object_list);
         return;
@@ -31,6 +31,17 @@ void eo_list_object_types(void);
  */
 bool eo_tap_opt_add(const char *ws_optarg);
 
+/**
+ * @brief Enables or disables streaming export.
+ *
+ * In streaming mode objects are written as soon as the dissector hands
+ * them over instead of at the end of the pass, and objects whose content
+ * is identical to one already written are skipped.
+ *
+ * @param streaming true to write objects as they are found.
+ */
+void eo_tap_opt_set_streaming(bool streaming);
+
 /**
  * @brief Starts exporting objects based on the current options.
  */
@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <epan/addr_resolv.h>
@@ -70,6 +71,7 @@ typedef struct _cli_follow_info {
 #define STR_RAW         ",raw"
 #define STR_CODEC       ",utf-8"
 #define STR_YAML        ",yaml"
+#define STR_BULK        ",bulk,"
 
 static const char * follow_str_type(cli_follow_info_t* cli_follow_info)
 {
@@ -583,6 +585,83 @@ follow_arg_done(const char *opt_argp)
   return true;
 }
 
+static void
+follow_bulk_draw(void *contextp)
+{
+  static const char     separator[] =
+    "===================================================================\n";
+
+  follow_bulk_t *bulk = (follow_bulk_t*)contextp;
+  int err;
+
+  if (!follow_bulk_finish(bulk, &err))
+  {
+    cmdarg_err("Error writing follow container: %s.", g_strerror(err));
+    return;
+  }
+
+  printf("\n%s", separator);
+  printf("Streams: %u\n", follow_bulk_get_stream_count(bulk));
+  printf("Bytes written: %" PRIu64 "\n", follow_bulk_get_bytes_written(bulk));
+  printf("%s", separator);
+}
+
+/* -z follow,<proto>,bulk,<file>[,<filter>] */
+static bool
+follow_bulk_stream(const char *opt_argp, register_follow_t *follower)
+{
+  follow_bulk_t *bulk;
+  const char    *filter;
+  char          *path;
+  GString       *errp;
+  int            err;
+
+  if (get_follow_tap_stream_id_func(follower) == NULL)
+  {
+    cmdarg_err("Bulk mode is not supported for %s.", proto_get_protocol_filter_name(get_follow_proto_id(follower)));
+    return false;
+  }
+
+  filter = strchr(opt_argp, ',');
+  if (filter != NULL)
+  {
+    path = g_strndup(opt_argp, filter - opt_argp);
+    filter++;
+  }
+  else
+  {
+    path = g_strdup(opt_argp);
+  }
+
+  if (*path == 0)
+  {
+    g_free(path);
+    cmdarg_err("Missing output file.");
+    return false;
+  }
+
+  bulk = follow_bulk_new(follower, path, &err);
+  if (bulk == NULL)
+  {
+    cmdarg_err("Can't create follow container \"%s\": %s.", path, g_strerror(err));
+    g_free(path);
+    return false;
+  }
+  g_free(path);
+
+  errp = register_tap_listener(get_follow_tap_string(follower), bulk, filter, 0,
+                               NULL, follow_bulk_tap_listener, follow_bulk_draw, (tap_finish_cb)follow_bulk_free);
+
+  if (errp != NULL)
+  {
+    follow_bulk_free(bulk);
+    cmdarg_err("Error registering tap listener: %s", errp->str);
+    g_string_free(errp, TRUE);
+    return false;
+  }
+  return true;
+}
+
 static bool follow_stream(const char *opt_argp, void *userdata)
 {
   follow_info_t *follow_info;
@@ -598,6 +677,11 @@ static bool follow_stream(const char *opt_argp, void *userdata)
   opt_argp += strlen(STR_FOLLOW);
   opt_argp += strlen(proto_filter_name);
 
+  if (follow_arg_strncmp(&opt_argp, STR_BULK))
+  {
+    return follow_bulk_stream(opt_argp, follower);
+  }
+
   cli_follow_info = g_new0(cli_follow_info_t, 1);
   cli_follow_info->stream_index = -1;
   /* use second parameter only for followers that have sub streams
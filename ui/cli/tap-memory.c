@@ -0,0 +1,112 @@
+/* tap-memory.c
+ * Report the file scope memory allocated by each protocol
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/proto.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <wsutil/cmdarg_err.h>
+
+#define TAP_NAME "memory"
+
+void register_tap_listener_memory(void);
+
+static void
+memory_draw(void *tapdata _U_)
+{
+    GArray   *usage;
+    uint64_t  total;
+    uint64_t  unattributed = proto_get_unattributed_file_scope_bytes();
+
+    usage = proto_get_file_scope_usage(&total);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("File Scope Memory by Protocol\n");
+    printf("Allocated: %" PRIu64 " bytes\n", total);
+    printf("  %-32s %20s %8s\n", "Protocol", "Bytes", "Percent");
+    for (unsigned i = 0; i < usage->len; i++) {
+        proto_file_scope_usage_t *u = &g_array_index(usage, proto_file_scope_usage_t, i);
+        printf("  %-32s %20" PRIu64 " %7.2f%%\n", u->filter_name, u->bytes,
+               100.0 * (double)u->bytes / (double)total);
+    }
+    if (unattributed != 0) {
+        printf("  %-32s %20" PRIu64 " %7.2f%%\n", "(outside dissectors)",
+               unattributed, 100.0 * (double)unattributed / (double)total);
+    }
+    printf("===================================================================\n");
+
+    g_array_free(usage, true);
+}
+
+static void
+memory_finish(void *tapdata _U_)
+{
+    proto_set_memory_accounting(false);
+}
+
+static bool
+memory_init(const char *opt_arg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(opt_arg, TAP_NAME) != 0) {
+        cmdarg_err("invalid \"-z " TAP_NAME "\" argument");
+        return false;
+    }
+
+    /* No packet callback: we want memory_draw() to run after the last
+     * packet, and memory_finish() to turn the accounting off again. */
+    error_string = register_tap_listener("frame", NULL, NULL, TL_REQUIRES_NOTHING,
+                                         NULL, NULL, memory_draw, memory_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register " TAP_NAME " tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        return false;
+    }
+
+    proto_set_memory_accounting(true);
+
+    return true;
+}
+
+static stat_tap_ui memory_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    TAP_NAME,
+    memory_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_memory(void)
+{
+    register_stat_tap_ui(&memory_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
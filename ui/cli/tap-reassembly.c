@@ -0,0 +1,102 @@
+/* tap-reassembly.c
+ * Report of the memory used by incomplete reassemblies and of what was
+ * done to keep it within the reassembly memory budget
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+
+#include <glib.h>
+
+#include <epan/packet.h>
+#include <epan/prefs.h>
+#include <epan/reassemble.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+
+#include <wsutil/cmdarg_err.h>
+
+void register_tap_listener_reassembly(void);
+
+/* Only identifies our listener. Every reassembly table keeps its counters
+ * all the time, so there's nothing to collect per packet; reassembly_draw()
+ * sums them up over all registered tables. */
+static int reassembly_tapdata;
+
+static void
+reassembly_draw(void *tapdata _U_)
+{
+    reassembly_stats_t stats;
+
+    reassembly_tables_get_stats(&stats);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("Reassembly Statistics:\n");
+    if (prefs.reassembly_memory_budget) {
+        printf("Memory budget per table: %u MB%s\n", prefs.reassembly_memory_budget,
+               prefs.reassembly_spill ? ", spilling to disk" : "");
+    } else {
+        printf("Memory budget per table: none\n");
+    }
+    printf("Incomplete reassembly memory at end: %zu bytes\n", stats.memory_used);
+    printf("Incomplete reassembly memory peak (sum of tables): %zu bytes\n", stats.memory_peak);
+    printf("Reassemblies discarded: %" PRIu64 " (%" PRIu64 " bytes)\n",
+           stats.evicted, stats.evicted_bytes);
+    printf("Reassemblies spilled to disk: %" PRIu64 " (%" PRIu64 " bytes)\n",
+           stats.spilled, stats.spilled_bytes);
+    printf("Reassemblies read back from disk: %" PRIu64 "\n", stats.reloaded);
+    printf("===================================================================\n");
+}
+
+static bool
+reassembly_init(const char *opt_arg _U_, void *userdata _U_)
+{
+    GString *error_string;
+
+    error_string = register_tap_listener("frame", &reassembly_tapdata, NULL, TL_REQUIRES_NOTHING,
+                                         NULL, NULL, reassembly_draw, NULL);
+    if (error_string) {
+        cmdarg_err("Couldn't register reassembly,stats tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        return false;
+    }
+
+    return true;
+}
+
+static stat_tap_ui reassembly_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "reassembly,stats",
+    reassembly_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_reassembly(void)
+{
+    register_stat_tap_ui(&reassembly_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,109 @@
+/* tap-tlsdecrypt.c
+ * Report of the work done by the TLS/DTLS decryption engine
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+
+#include <glib.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/dissectors/packet-tls-utils.h>
+
+#include <wsutil/cmdarg_err.h>
+
+void register_tap_listener_tlsdecrypt(void);
+
+/* Only identifies our listener. The statistics are collected by the TLS
+ * dissector while tls_decrypt_stats_enable() is on, as timing every record
+ * isn't free, and tlsdecrypt_draw() reads them once at the end. */
+static int tlsdecrypt_tapdata;
+
+static void
+tlsdecrypt_print_time(const char *what, uint64_t count, uint64_t elapsed_us)
+{
+    printf("%-24s %12" PRIu64 " %12.6f %12.3f\n", what, count,
+           elapsed_us / 1000000.0, count ? (double)elapsed_us / count : 0.0);
+}
+
+static void
+tlsdecrypt_draw(void *tapdata _U_)
+{
+    const tls_decrypt_stats_t *stats = tls_decrypt_stats_get();
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("TLS Decryption Statistics:\n");
+    printf("%-24s %12s %12s %12s\n", "", "Count", "Time (s)", "Avg (us)");
+    tlsdecrypt_print_time("Key log lines", stats->keylog_lines, stats->keylog_us);
+    tlsdecrypt_print_time("Session key derivations", stats->keyring_count, stats->keyring_us);
+    tlsdecrypt_print_time("Records decrypted", stats->records, stats->record_us);
+    printf("\n");
+    printf("Key log lines parsed without regex: %" PRIu64 "\n", stats->keylog_fast_lines);
+    printf("Records failed to decrypt: %" PRIu64 "\n", stats->records_failed);
+    printf("Ciphertext bytes: %" PRIu64 "\n", stats->record_bytes);
+    printf("===================================================================\n");
+}
+
+static void
+tlsdecrypt_finish(void *tapdata _U_)
+{
+    tls_decrypt_stats_enable(false);
+}
+
+static bool
+tlsdecrypt_init(const char *opt_arg _U_, void *userdata _U_)
+{
+    GString *error_string;
+
+    tls_decrypt_stats_enable(true);
+
+    error_string = register_tap_listener("frame", &tlsdecrypt_tapdata, NULL, TL_REQUIRES_NOTHING,
+                                         NULL, NULL, tlsdecrypt_draw, tlsdecrypt_finish);
+    if (error_string) {
+        cmdarg_err("Couldn't register tls,decrypt-stats tap: %s",
+                   error_string->str);
+        g_string_free(error_string, TRUE);
+        tls_decrypt_stats_enable(false);
+        return false;
+    }
+
+    return true;
+}
+
+static stat_tap_ui tlsdecrypt_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "tls,decrypt-stats",
+    tlsdecrypt_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_tlsdecrypt(void)
+{
+    register_stat_tap_ui(&tlsdecrypt_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
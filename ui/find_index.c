@@ -0,0 +1,392 @@
+/* find_index.c
+ * Index of the packet bytes of a capture file for "Find Packet"
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <app/application_flavor.h>
+#include <wiretap/wtap.h>
+
+#include "ui/find_index.h"
+
+/*
+ * The trigrams are hashed into 2^16 buckets. Real frames contain at most
+ * a few thousand distinct trigrams, so a bucket being set rarely matches
+ * by accident, and a search string of a few characters already rules out
+ * nearly all frames that don't contain it.
+ *
+ * Each bucket has a posting list of the frames containing any of its
+ * trigrams, stored as LEB128 encoded differences between ascending frame
+ * numbers.
+ */
+#define FIND_INDEX_BUCKET_BITS  16
+#define FIND_INDEX_BUCKETS      (1 << FIND_INDEX_BUCKET_BITS)
+
+/* Intersecting the posting lists of the rarest trigrams of the search
+ * string is enough; more would cost more than it saves. */
+#define FIND_INDEX_MAX_LOOKUP_BUCKETS 8
+
+typedef struct {
+    uint8_t  *data;
+    uint32_t  len;
+    uint32_t  size;
+    uint32_t  last_frame;
+} find_index_postings;
+
+struct find_index {
+    char                *filename;
+    unsigned int         type;
+    uint32_t             max_frames;
+    size_t               max_memory;
+    GThread             *thread;
+    int                  stop;          /* Accessed atomically */
+    GMutex               lock;          /* Protects the members below */
+    find_index_postings *postings;
+    uint32_t             num_frames;    /* Frames 1 to num_frames are indexed */
+    size_t               memory_used;
+    bool                 full;          /* The memory limit was reached */
+};
+
+typedef struct {
+    uint32_t len;
+    uint32_t bucket;
+} find_index_lookup_bucket;
+
+static inline uint32_t
+find_index_bucket(uint32_t trigram)
+{
+    return (trigram * 2654435761U) >> (32 - FIND_INDEX_BUCKET_BITS);
+}
+
+static bool
+find_index_postings_add(find_index_t *idx, find_index_postings *p, uint32_t framenum)
+{
+    uint32_t gap;
+
+    if (p->last_frame == framenum)
+        return true;
+
+    /* A 32-bit difference takes at most five bytes. */
+    if (p->len + 5 > p->size) {
+        uint32_t new_size = p->size ? p->size * 2 : 16;
+
+        if (idx->memory_used + (new_size - p->size) > idx->max_memory)
+            return false;
+        idx->memory_used += new_size - p->size;
+        p->data = (uint8_t *)g_realloc(p->data, new_size);
+        p->size = new_size;
+    }
+
+    gap = framenum - p->last_frame;
+    while (gap >= 0x80) {
+        p->data[p->len++] = (uint8_t)(gap | 0x80);
+        gap >>= 7;
+    }
+    p->data[p->len++] = (uint8_t)gap;
+    p->last_frame = framenum;
+    return true;
+}
+
+static bool
+find_index_add_frame(find_index_t *idx, uint32_t framenum, const uint8_t *pd, size_t len)
+{
+    uint32_t trigram;
+    size_t   i;
+
+    if (len < 3)
+        return true;
+
+    trigram = ((uint32_t)g_ascii_toupper(pd[0]) << 8) | (uint32_t)g_ascii_toupper(pd[1]);
+    for (i = 2; i < len; i++) {
+        trigram = ((trigram << 8) | (uint32_t)g_ascii_toupper(pd[i])) & 0xffffff;
+        if (!find_index_postings_add(idx, &idx->postings[find_index_bucket(trigram)], framenum))
+            return false;
+    }
+    return true;
+}
+
+static void *
+find_index_thread(void *data)
+{
+    find_index_t *idx = (find_index_t *)data;
+    wtap         *wth;
+    wtap_rec      rec;
+    int           err;
+    char         *err_info = NULL;
+    int64_t       data_offset;
+    uint32_t      framenum = 0;
+    bool          indexed;
+
+    /* Errors aren't reported; searches just use the frames indexed so far. */
+    wth = wtap_open_offline(idx->filename, idx->type, &err, &err_info, false,
+            application_configuration_environment_prefix());
+    if (wth == NULL) {
+        g_free(err_info);
+        return NULL;
+    }
+
+    wtap_rec_init(&rec, 1514);
+    while (!g_atomic_int_get(&idx->stop) && framenum < idx->max_frames &&
+            wtap_read(wth, &rec, &err, &err_info, &data_offset)) {
+        framenum++;
+        g_mutex_lock(&idx->lock);
+        indexed = find_index_add_frame(idx, framenum,
+                ws_buffer_start_ptr(&rec.data), ws_buffer_length(&rec.data));
+        if (indexed)
+            idx->num_frames = framenum;
+        else
+            idx->full = true;
+        g_mutex_unlock(&idx->lock);
+        wtap_rec_reset(&rec);
+        if (!indexed) {
+            /* Out of memory budget. */
+            break;
+        }
+    }
+    g_free(err_info);
+    wtap_rec_cleanup(&rec);
+    wtap_close(wth);
+    return NULL;
+}
+
+static find_index_t *
+find_index_alloc(size_t max_memory)
+{
+    find_index_t *idx;
+
+    if (max_memory < FIND_INDEX_BUCKETS * sizeof(find_index_postings))
+        return NULL;
+
+    idx = g_new0(find_index_t, 1);
+    idx->max_memory = max_memory;
+    g_mutex_init(&idx->lock);
+    idx->postings = g_new0(find_index_postings, FIND_INDEX_BUCKETS);
+    idx->memory_used = FIND_INDEX_BUCKETS * sizeof(find_index_postings);
+    return idx;
+}
+
+find_index_t *
+find_index_new(const char *filename, unsigned int type, uint32_t max_frames,
+        size_t max_memory)
+{
+    find_index_t *idx;
+
+    if (filename == NULL || max_frames == 0)
+        return NULL;
+
+    idx = find_index_alloc(max_memory);
+    if (idx == NULL)
+        return NULL;
+    idx->filename = g_strdup(filename);
+    idx->type = type;
+    idx->max_frames = max_frames;
+
+    idx->thread = g_thread_try_new("find_index_worker", find_index_thread, idx, NULL);
+    if (idx->thread == NULL) {
+        find_index_free(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+find_index_t *
+find_index_new_incremental(size_t max_memory)
+{
+    return find_index_alloc(max_memory);
+}
+
+void
+find_index_add(find_index_t *idx, uint32_t framenum, const uint8_t *pd, size_t len)
+{
+    if (idx == NULL || idx->filename != NULL)
+        return;
+
+    g_mutex_lock(&idx->lock);
+    /* Frames must be added in order; once one doesn't fit, the later
+     * ones are left to be searched without the index. */
+    if (!idx->full && framenum == idx->num_frames + 1) {
+        if (find_index_add_frame(idx, framenum, pd, len))
+            idx->num_frames = framenum;
+        else
+            idx->full = true;
+    }
+    g_mutex_unlock(&idx->lock);
+}
+
+void
+find_index_stop(find_index_t *idx)
+{
+    if (idx == NULL || idx->thread == NULL)
+        return;
+
+    g_atomic_int_set(&idx->stop, 1);
+    g_thread_join(idx->thread);
+    idx->thread = NULL;
+}
+
+void
+find_index_free(find_index_t *idx)
+{
+    unsigned i;
+
+    if (idx == NULL)
+        return;
+
+    find_index_stop(idx);
+    for (i = 0; i < FIND_INDEX_BUCKETS; i++) {
+        g_free(idx->postings[i].data);
+    }
+    g_free(idx->postings);
+    g_mutex_clear(&idx->lock);
+    g_free(idx->filename);
+    g_free(idx);
+}
+
+static void
+find_index_postings_decode(const find_index_postings *p, uint32_t num_frames, uint64_t *bits)
+{
+    uint32_t framenum = 0;
+    uint32_t gap;
+    unsigned shift;
+    uint8_t  byte;
+    uint32_t i = 0;
+
+    while (i < p->len) {
+        gap = 0;
+        shift = 0;
+        do {
+            byte = p->data[i++];
+            gap |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        framenum += gap;
+        /* The frame being indexed when the lookup started isn't covered. */
+        if (framenum > num_frames)
+            break;
+        bits[(framenum - 1) / 64] |= UINT64_C(1) << ((framenum - 1) % 64);
+    }
+}
+
+static int
+find_index_lookup_bucket_compare(const void *a, const void *b)
+{
+    const find_index_lookup_bucket *bucket_a = (const find_index_lookup_bucket *)a;
+    const find_index_lookup_bucket *bucket_b = (const find_index_lookup_bucket *)b;
+
+    if (bucket_a->len != bucket_b->len)
+        return bucket_a->len < bucket_b->len ? -1 : 1;
+    if (bucket_a->bucket != bucket_b->bucket)
+        return bucket_a->bucket < bucket_b->bucket ? -1 : 1;
+    return 0;
+}
+
+find_index_candidates_t *
+find_index_lookup(find_index_t *idx, const uint8_t *pattern, size_t len)
+{
+    find_index_candidates_t  *candidates;
+    find_index_lookup_bucket *buckets;
+    uint64_t                 *bits;
+    size_t                    num_buckets, num_words;
+    size_t                    i, j;
+    uint32_t                  trigram;
+
+    if (idx == NULL || len < 3)
+        return NULL;
+
+    num_buckets = len - 2;
+    buckets = g_new(find_index_lookup_bucket, num_buckets);
+
+    g_mutex_lock(&idx->lock);
+    if (idx->num_frames == 0) {
+        g_mutex_unlock(&idx->lock);
+        g_free(buckets);
+        return NULL;
+    }
+
+    /* Look at the rarest buckets first; a bucket shared by several
+     * trigrams is only looked at once. */
+    trigram = ((uint32_t)g_ascii_toupper(pattern[0]) << 8) | (uint32_t)g_ascii_toupper(pattern[1]);
+    for (i = 0; i < num_buckets; i++) {
+        trigram = ((trigram << 8) | (uint32_t)g_ascii_toupper(pattern[i + 2])) & 0xffffff;
+        buckets[i].bucket = find_index_bucket(trigram);
+        buckets[i].len = idx->postings[buckets[i].bucket].len;
+    }
+    qsort(buckets, num_buckets, sizeof(find_index_lookup_bucket), find_index_lookup_bucket_compare);
+
+    candidates = g_new(find_index_candidates_t, 1);
+    candidates->num_frames = idx->num_frames;
+    num_words = (candidates->num_frames + 63) / 64;
+    candidates->bits = g_new0(uint64_t, num_words);
+    find_index_postings_decode(&idx->postings[buckets[0].bucket], candidates->num_frames, candidates->bits);
+
+    bits = g_new(uint64_t, num_words);
+    for (i = 1, j = 1; i < num_buckets && j < FIND_INDEX_MAX_LOOKUP_BUCKETS; i++) {
+        bool any = false;
+        size_t w;
+
+        if (buckets[i].bucket == buckets[i - 1].bucket)
+            continue;
+        j++;
+        memset(bits, 0, num_words * sizeof(uint64_t));
+        find_index_postings_decode(&idx->postings[buckets[i].bucket], candidates->num_frames, bits);
+        for (w = 0; w < num_words; w++) {
+            candidates->bits[w] &= bits[w];
+            any = any || candidates->bits[w];
+        }
+        if (!any)
+            break;
+    }
+    g_mutex_unlock(&idx->lock);
+
+    g_free(bits);
+    g_free(buckets);
+    return candidates;
+}
+
+void
+find_index_candidates_merge(find_index_candidates_t *dst, const find_index_candidates_t *src)
+{
+    uint32_t num_frames = MIN(dst->num_frames, src->num_frames);
+    uint32_t w;
+
+    /* Frames beyond either lookup's coverage are candidates anyway; both
+     * lookups cover at least the first num_frames. */
+    for (w = 0; w < (num_frames + 63) / 64; w++) {
+        dst->bits[w] |= src->bits[w];
+    }
+    dst->num_frames = num_frames;
+}
+
+void
+find_index_candidates_free(find_index_candidates_t *candidates)
+{
+    if (candidates == NULL)
+        return;
+
+    g_free(candidates->bits);
+    g_free(candidates);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
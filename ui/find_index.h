@@ -0,0 +1,151 @@
+/** @file
+ *
+ * Index of the packet bytes of a capture file for "Find Packet"
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FIND_INDEX_H__
+#define __FIND_INDEX_H__
+
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @brief A trigram index over the raw bytes of the frames of a capture file.
+ *
+ * For every frame the index records which (hashed, ASCII case folded)
+ * three-byte sequences occur in its bytes. A frame can only contain a
+ * string or byte sequence if it contains all of its trigrams, so searches
+ * only need to read and check the frames the index doesn't rule out.
+ *
+ * The index of a file that has been read is built in a background thread
+ * that reads the file through its own wiretap handle, so it can be used,
+ * for the frames indexed so far, while it is still being built. The index
+ * of a live capture is built incrementally as its frames are read.
+ */
+typedef struct find_index find_index_t;
+
+/**
+ * @brief The frames that may contain a searched byte sequence.
+ */
+typedef struct {
+    uint32_t  num_frames; /**< Frames 1 to num_frames are covered; later frames are always candidates */
+    uint64_t *bits;       /**< Bit (frame number - 1) is set for candidate frames */
+} find_index_candidates_t;
+
+/**
+ * @brief Start indexing a capture file in the background.
+ *
+ * @param filename The capture file.
+ * @param type The file type to open it as, e.g. WTAP_TYPE_AUTO.
+ * @param max_frames The number of frames to index, i.e. the frame count
+ * of the capture file.
+ * @param max_memory The memory the index may use, in bytes. Indexing stops
+ * (keeping the frames indexed so far) when it is reached.
+ * @return The index, or NULL if the indexing thread couldn't be started.
+ */
+find_index_t *find_index_new(const char *filename, unsigned int type,
+        uint32_t max_frames, size_t max_memory);
+
+/**
+ * @brief Create an empty index to which frames are added with
+ * find_index_add(), e.g. as they are read from a live capture.
+ *
+ * @param max_memory The memory the index may use, in bytes. Frames that
+ * don't fit aren't indexed.
+ * @return The index, or NULL if max_memory is too small for any index.
+ */
+find_index_t *find_index_new_incremental(size_t max_memory);
+
+/**
+ * @brief Add a frame to an index created with find_index_new_incremental().
+ *
+ * Frames must be added in order, starting with frame 1; frames that are
+ * out of order, or that don't fit in the index's memory, and all frames
+ * after them are not indexed and are always candidates.
+ *
+ * @param idx The index, may be NULL.
+ * @param framenum The frame number.
+ * @param pd The bytes of the frame.
+ * @param len Their length.
+ */
+void find_index_add(find_index_t *idx, uint32_t framenum,
+        const uint8_t *pd, size_t len);
+
+/**
+ * @brief Stop building an index, keeping the frames indexed so far.
+ *
+ * This closes the index's handle on the capture file, which must be
+ * done before the file is renamed or removed.
+ *
+ * @param idx The index, may be NULL.
+ */
+void find_index_stop(find_index_t *idx);
+
+/**
+ * @brief Stop building and free an index.
+ *
+ * @param idx The index, may be NULL.
+ */
+void find_index_free(find_index_t *idx);
+
+/**
+ * @brief Look up the frames that may contain a byte sequence.
+ *
+ * Both the index and the lookup fold ASCII case, so the candidates are
+ * valid for case sensitive and case insensitive searches.
+ *
+ * @param idx The index.
+ * @param pattern The byte sequence.
+ * @param len Its length; at least three bytes are needed.
+ * @return The candidate frames, to be freed with find_index_candidates_free(),
+ * or NULL if the index can't narrow down the search.
+ */
+find_index_candidates_t *find_index_lookup(find_index_t *idx,
+        const uint8_t *pattern, size_t len);
+
+/**
+ * @brief Add the candidate frames of another lookup, e.g. to search for
+ * either of two byte sequences.
+ *
+ * @param dst The candidates to add to.
+ * @param src The candidates to add.
+ */
+void find_index_candidates_merge(find_index_candidates_t *dst,
+        const find_index_candidates_t *src);
+
+/**
+ * @brief Free the result of find_index_lookup().
+ *
+ * @param candidates The candidates, may be NULL.
+ */
+void find_index_candidates_free(find_index_candidates_t *candidates);
+
+/**
+ * @brief Check whether a frame may contain the looked up byte sequence.
+ *
+ * @param candidates The candidates, may be NULL to allow all frames.
+ * @param framenum The frame number.
+ * @return false if the frame can't contain the byte sequence.
+ */
+static inline bool
+find_index_is_candidate(const find_index_candidates_t *candidates, uint32_t framenum)
+{
+    if (candidates == NULL || framenum == 0 || framenum > candidates->num_frames)
+        return true;
+    return (candidates->bits[(framenum - 1) / 64] >> ((framenum - 1) % 64)) & 1;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FIND_INDEX_H__ */
@@ -0,0 +1,306 @@
+/* find_index_test.c
+ * Tests for the index of the packet bytes used by "Find Packet".
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "ui/find_index.h"
+
+#define TEST_MEMORY (16 * 1024 * 1024)
+
+static void
+add_string(find_index_t *idx, uint32_t framenum, const char *str)
+{
+    find_index_add(idx, framenum, (const uint8_t *)str, strlen(str));
+}
+
+static find_index_candidates_t *
+lookup_string(find_index_t *idx, const char *str)
+{
+    return find_index_lookup(idx, (const uint8_t *)str, strlen(str));
+}
+
+/* The candidates among frames 1 to num_frames, as a string of 0s and 1s. */
+static char *
+candidates_string(const find_index_candidates_t *candidates, uint32_t num_frames)
+{
+    GString *str = g_string_new(NULL);
+
+    for (uint32_t framenum = 1; framenum <= num_frames; framenum++) {
+        g_string_append_c(str, find_index_is_candidate(candidates, framenum) ? '1' : '0');
+    }
+    return g_string_free(str, FALSE);
+}
+
+static void
+check_candidates(find_index_t *idx, const char *pattern, const char *expected)
+{
+    find_index_candidates_t *candidates = lookup_string(idx, pattern);
+    char *str;
+
+    g_assert_nonnull(candidates);
+    str = candidates_string(candidates, (uint32_t)strlen(expected));
+    g_assert_cmpstr(str, ==, expected);
+    g_free(str);
+    find_index_candidates_free(candidates);
+}
+
+static void
+test_trigrams(void)
+{
+    find_index_t *idx = find_index_new_incremental(TEST_MEMORY);
+    find_index_candidates_t *candidates;
+
+    g_assert_nonnull(idx);
+
+    /* Nothing indexed yet. */
+    g_assert_null(lookup_string(idx, "Hello"));
+
+    add_string(idx, 1, "GET /index.html HTTP/1.1");
+    add_string(idx, 2, "hello, world");
+    add_string(idx, 3, "no match in here");
+    add_string(idx, 4, "xy");
+    add_string(idx, 5, "Say HELLO again");
+
+    /* ASCII case is folded; the frames that can't match are ruled out. */
+    check_candidates(idx, "Hello", "01001");
+    check_candidates(idx, "HTTP/1.1", "10000");
+    check_candidates(idx, "match", "00100");
+    check_candidates(idx, "quux", "00000");
+
+    /* All of the pattern's trigrams must be in the same frame, not just
+     * some of them, or each of them in some frame. */
+    check_candidates(idx, "hello there", "00000");
+    add_string(idx, 6, "abcdX");
+    add_string(idx, 7, "Ybcde");
+    check_candidates(idx, "abcd", "0000010");
+    check_candidates(idx, "abcde", "0000000");
+
+    /* Frames that haven't been indexed are always candidates. */
+    candidates = lookup_string(idx, "quux");
+    g_assert_cmpuint(candidates->num_frames, ==, 7);
+    g_assert_true(find_index_is_candidate(candidates, 8));
+    g_assert_true(find_index_is_candidate(candidates, 1000));
+    find_index_candidates_free(candidates);
+
+    /* The index can't narrow down patterns shorter than a trigram. */
+    g_assert_null(lookup_string(idx, "xy"));
+    g_assert_null(lookup_string(idx, ""));
+
+    /* NULL candidates allow all frames. */
+    g_assert_true(find_index_is_candidate(NULL, 3));
+
+    find_index_free(idx);
+}
+
+static void
+test_binary(void)
+{
+    static const uint8_t frame1[] = { 0x00, 0x01, 0x02, 0x03, 0xff, 0xfe, 0x00 };
+    static const uint8_t frame2[] = { 'a', 0x00, 'b', 0x00, 'c', 0x00 };
+    static const uint8_t frame3[] = { 0xe9, 0xc9, 0x41, 0x61 };
+    static const uint8_t pattern1[] = { 0x02, 0x03, 0xff, 0xfe };
+    static const uint8_t pattern2[] = { 'A', 0x00, 'B', 0x00, 'C' };
+    static const uint8_t pattern3[] = { 0xc9, 0xe9, 0x61 };
+    find_index_t *idx = find_index_new_incremental(TEST_MEMORY);
+    find_index_candidates_t *candidates;
+    char *str;
+
+    find_index_add(idx, 1, frame1, sizeof frame1);
+    find_index_add(idx, 2, frame2, sizeof frame2);
+    find_index_add(idx, 3, frame3, sizeof frame3);
+
+    candidates = find_index_lookup(idx, pattern1, sizeof pattern1);
+    str = candidates_string(candidates, 3);
+    g_assert_cmpstr(str, ==, "100");
+    g_free(str);
+    find_index_candidates_free(candidates);
+
+    /* A wide string, as searched for by SCS_WIDE. */
+    candidates = find_index_lookup(idx, pattern2, sizeof pattern2);
+    str = candidates_string(candidates, 3);
+    g_assert_cmpstr(str, ==, "010");
+    g_free(str);
+    find_index_candidates_free(candidates);
+
+    /* Only ASCII case is folded. */
+    candidates = find_index_lookup(idx, pattern3, sizeof pattern3);
+    str = candidates_string(candidates, 3);
+    g_assert_cmpstr(str, ==, "000");
+    g_free(str);
+    find_index_candidates_free(candidates);
+
+    find_index_free(idx);
+}
+
+static void
+test_long_pattern(void)
+{
+    const char *text = "The quick brown fox jumps over the lazy dog";
+    find_index_t *idx = find_index_new_incremental(TEST_MEMORY);
+    char *changed;
+
+    /* More trigrams than are intersected; frame 2 differs from the pattern
+     * only in its last trigram. */
+    changed = g_strdup(text);
+    changed[strlen(changed) - 1] = 'x';
+    add_string(idx, 1, text);
+    add_string(idx, 2, changed);
+    add_string(idx, 3, "");
+
+    check_candidates(idx, text, "100");
+    check_candidates(idx, changed, "010");
+
+    g_free(changed);
+    find_index_free(idx);
+}
+
+static void
+test_merge(void)
+{
+    find_index_t *idx = find_index_new_incremental(TEST_MEMORY);
+    find_index_candidates_t *narrow, *wide;
+    char *str;
+
+    add_string(idx, 1, "alpha");
+    add_string(idx, 2, "beta");
+    add_string(idx, 3, "gamma");
+    narrow = lookup_string(idx, "alpha");
+
+    /* A later lookup covers more frames. */
+    add_string(idx, 4, "beta again");
+    add_string(idx, 5, "and alpha");
+    wide = lookup_string(idx, "beta");
+    g_assert_cmpuint(narrow->num_frames, ==, 3);
+    g_assert_cmpuint(wide->num_frames, ==, 5);
+
+    /* The merged candidates are either's candidates, and only cover the
+     * frames both lookups covered; frame 5 contains "alpha", which the
+     * first lookup didn't see, so it must stay a candidate. */
+    find_index_candidates_merge(wide, narrow);
+    g_assert_cmpuint(wide->num_frames, ==, 3);
+    str = candidates_string(wide, 6);
+    g_assert_cmpstr(str, ==, "110111");
+    g_free(str);
+    find_index_candidates_free(wide);
+
+    /* The same, merging the other way around. */
+    wide = lookup_string(idx, "beta");
+    find_index_candidates_merge(narrow, wide);
+    g_assert_cmpuint(narrow->num_frames, ==, 3);
+    str = candidates_string(narrow, 6);
+    g_assert_cmpstr(str, ==, "110111");
+    g_free(str);
+    find_index_candidates_free(wide);
+    find_index_candidates_free(narrow);
+
+    find_index_free(idx);
+}
+
+static void
+test_incremental(void)
+{
+    find_index_t *idx = find_index_new_incremental(TEST_MEMORY);
+    find_index_candidates_t *candidates;
+
+    /* Frames that aren't the next one aren't indexed. */
+    add_string(idx, 2, "skipped ahead");
+    g_assert_null(lookup_string(idx, "skipped"));
+
+    add_string(idx, 1, "first frame");
+    add_string(idx, 1, "first again");
+    add_string(idx, 3, "skipped frame 2");
+    candidates = lookup_string(idx, "again");
+    g_assert_cmpuint(candidates->num_frames, ==, 1);
+    g_assert_false(find_index_is_candidate(candidates, 1));
+    g_assert_true(find_index_is_candidate(candidates, 2));
+    find_index_candidates_free(candidates);
+
+    /* Too little memory for an index at all. */
+    g_assert_null(find_index_new_incremental(0));
+
+    /* NULL indexes are ignored. */
+    find_index_add(NULL, 1, (const uint8_t *)"abc", 3);
+    g_assert_null(lookup_string(NULL, "abc"));
+    find_index_stop(NULL);
+    find_index_free(NULL);
+
+    find_index_free(idx);
+}
+
+static void
+test_memory_limit(void)
+{
+    /* Enough for the buckets and a fraction of their posting lists. */
+    find_index_t *idx = find_index_new_incremental(2 * 1024 * 1024);
+    find_index_candidates_t *candidates;
+    GRand *rand = g_rand_new_with_seed(42);
+    uint8_t frame[1500];
+    uint8_t first_bytes[8];
+    uint32_t framenum;
+
+    g_assert_nonnull(idx);
+    for (framenum = 1; framenum <= 1000; framenum++) {
+        for (size_t i = 0; i < sizeof frame; i++) {
+            frame[i] = (uint8_t)g_rand_int(rand);
+        }
+        find_index_add(idx, framenum, frame, sizeof frame);
+        if (framenum == 1) {
+            memcpy(first_bytes, frame + 100, sizeof first_bytes);
+        }
+    }
+
+    /* Indexing stopped at the limit; the later frames are candidates,
+     * the indexed ones still match what they contain. */
+    candidates = find_index_lookup(idx, first_bytes, sizeof first_bytes);
+    g_assert_nonnull(candidates);
+    g_assert_cmpuint(candidates->num_frames, >, 0);
+    g_assert_cmpuint(candidates->num_frames, <, 1000);
+    g_assert_true(find_index_is_candidate(candidates, 1));
+    g_assert_true(find_index_is_candidate(candidates, 1000));
+    find_index_candidates_free(candidates);
+
+    g_rand_free(rand);
+    find_index_free(idx);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/find_index/trigrams", test_trigrams);
+    g_test_add_func("/find_index/binary", test_binary);
+    g_test_add_func("/find_index/long_pattern", test_long_pattern);
+    g_test_add_func("/find_index/merge", test_merge);
+    g_test_add_func("/find_index/incremental", test_incremental);
+    g_test_add_func("/find_index/memory_limit", test_memory_limit);
+
+    ret = g_test_run();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -22,22 +22,18 @@
 #include "ui/io_graph_item.h"
 
 int64_t get_io_graph_index(packet_info *pinfo, int interval) {
-    nstime_t time_delta;
+    int64_t rel_us;
 
     ws_return_val_if(interval <= 0, -1);
 
     /*
      * Find in which interval this is supposed to go and store the interval index as idx
      */
-    time_delta = pinfo->rel_ts;
-    if (time_delta.nsecs<0) {
-        time_delta.secs--;
-        time_delta.nsecs += 1000000000;
-    }
-    if (time_delta.secs<0) {
+    rel_us = get_io_graph_rel_us(pinfo);
+    if (rel_us < 0) {
         return -1;
     }
-    return ((time_delta.secs*INT64_C(1000000) + time_delta.nsecs/1000) / interval);
+    return rel_us / interval;
 }
 
 GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_unit_t item_unit, const char* type_unit_name)
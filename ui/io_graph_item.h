@@ -207,6 +207,247 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
  */
 double get_io_graph_item(const io_graph_item_t *items, io_graph_item_unit_t val_units, int idx, int hf_index, const capture_file *cap_file, int interval, int cur_idx, bool asAOT);
 
+/** A value of the Y field of an advanced I/O graph, converted from its
+ * field_info so that it can be kept after the dissection is gone.
+ */
+typedef union {
+    uint64_t uint_val;    /**< Value of unsigned integer fields */
+    int64_t  int_val;     /**< Value of signed integer fields */
+    double   double_val;  /**< Value of floating-point fields */
+    nstime_t time_val;    /**< Value of relative time fields */
+} io_graph_value_t;
+
+/** Convert the value of a Y field.
+ *
+ * @param fi [in] The field.
+ * @param ftype [in] The type of the header field.
+ * @param value [out] The value. Only filled in for the types that
+ *                    update_io_graph_item_value() uses the value of.
+ */
+static inline void
+get_io_graph_value(const field_info *fi, enum ftenum ftype, io_graph_value_t *value) {
+    switch (ftype) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+        value->uint_val = fvalue_get_uinteger(fi->value);
+        break;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+        value->int_val = fvalue_get_sinteger(fi->value);
+        break;
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        value->uint_val = fvalue_get_uinteger64(fi->value);
+        break;
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        value->int_val = fvalue_get_sinteger64(fi->value);
+        break;
+    case FT_FLOAT:
+        value->double_val = (float)fvalue_get_floating(fi->value);
+        break;
+    case FT_DOUBLE:
+        value->double_val = fvalue_get_floating(fi->value);
+        break;
+    case FT_RELATIVE_TIME:
+        value->time_val = *fvalue_get_time(fi->value);
+        break;
+    default:
+        break;
+    }
+}
+
+/** Get the time of a packet relative to the first packet in microseconds,
+ * as used by get_io_graph_index().
+ *
+ * @param [in] pinfo Packet of interest.
+ * @return The relative time, or -1 if the packet is before the first packet.
+ */
+static inline int64_t
+get_io_graph_rel_us(packet_info *pinfo) {
+    nstime_t time_delta = pinfo->rel_ts;
+
+    if (time_delta.nsecs<0) {
+        time_delta.secs--;
+        time_delta.nsecs += 1000000000;
+    }
+    if (time_delta.secs<0) {
+        return -1;
+    }
+    return time_delta.secs*INT64_C(1000000) + time_delta.nsecs/1000;
+}
+
+/** Add one value of the Y field to the advanced statistics of an
+ * io_graph_item_t.
+ *
+ * @param items [in,out] Array containing the item to update.
+ * @param idx [in] Index of the item to update.
+ * @param frame_num [in] The number of the frame containing the value.
+ * @param rel_us [in] The time of the frame as returned by get_io_graph_rel_us().
+ * @param ftype [in] The type of the header field.
+ * @param value [in] The value, from get_io_graph_value().
+ * @param item_unit [in] The type of unit to calculate. From IOG_ITEM_UNITS.
+ * @param interval [in] Timing interval in μs.
+ */
+static inline void
+update_io_graph_item_value(io_graph_item_t *items, int idx, uint32_t frame_num, int64_t rel_us, enum ftenum ftype, const io_graph_value_t *value, int item_unit, uint32_t interval) {
+    io_graph_item_t *item = &items[idx];
+    const nstime_t *new_time;
+
+    /* Update the appropriate counters. If fields == 0, this is the first seen
+     *  value so set any min/max values accordingly. */
+    switch (ftype) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        if ((value->uint_val > item->uint_max) || (item->fields == 0)) {
+            item->uint_max = value->uint_val;
+            item->max_frame_in_invl = frame_num;
+        }
+        if ((value->uint_val < item->uint_min) || (item->fields == 0)) {
+            item->uint_min = value->uint_val;
+            item->min_frame_in_invl = frame_num;
+        }
+        item->double_tot += (double)value->uint_val;
+        item->fields++;
+        break;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        if ((value->int_val > item->int_max) || (item->fields == 0)) {
+            item->int_max = value->int_val;
+            item->max_frame_in_invl = frame_num;
+        }
+        if ((value->int_val < item->int_min) || (item->fields == 0)) {
+            item->int_min = value->int_val;
+            item->min_frame_in_invl = frame_num;
+        }
+        item->double_tot += (double)value->int_val;
+        item->fields++;
+        break;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        if ((value->double_val > item->double_max) || (item->fields == 0)) {
+            item->double_max = value->double_val;
+            item->max_frame_in_invl = frame_num;
+        }
+        if ((value->double_val < item->double_min) || (item->fields == 0)) {
+            item->double_min = value->double_val;
+            item->min_frame_in_invl = frame_num;
+        }
+        item->double_tot += value->double_val;
+        item->fields++;
+        break;
+    case FT_RELATIVE_TIME:
+        new_time = &value->time_val;
+
+        switch (item_unit) {
+        case IOG_ITEM_UNIT_CALC_LOAD:
+        {
+            uint64_t t, pt; /* time in us */
+            int j;
+            /*
+             * Add the time this call spanned each interval according to
+             * its contribution to that interval.
+             * If the call time is negative (unlikely, requires both an
+             * out of order capture file plus retransmission), ignore.
+             */
+            const nstime_t time_zero = NSTIME_INIT_ZERO;
+            if (nstime_cmp(new_time, &time_zero) < 0) {
+                break;
+            }
+            t = new_time->secs;
+            t = t * 1000000 + new_time->nsecs / 1000;
+            j = idx;
+            /*
+             * Handle current interval
+             * This cannot be negative, because get_io_graph_index
+             * returns an invalid interval if so.
+             */
+            pt = (uint64_t)rel_us;
+            pt = pt % interval;
+            if (pt > t) {
+                pt = t;
+            }
+            while (t) {
+                io_graph_item_t *load_item;
+
+                load_item = &items[j];
+                load_item->time_tot.nsecs += (int) (pt * 1000);
+                if (load_item->time_tot.nsecs > 1000000000) {
+                    load_item->time_tot.secs++;
+                    load_item->time_tot.nsecs -= 1000000000;
+                }
+                load_item->fields++;
+
+                if (j == 0) {
+                    break;
+                }
+                j--;
+                t -= pt;
+                if (t > (uint64_t) interval) {
+                    pt = (uint64_t) interval;
+                } else {
+                    pt = t;
+                }
+            }
+            break;
+        }
+        default:
+            if ( (nstime_cmp(new_time, &item->time_max) > 0)
+                 || (item->fields == 0)) {
+                item->time_max = *new_time;
+                item->max_frame_in_invl = frame_num;
+            }
+            if ( (nstime_cmp(new_time, &item->time_min) < 0)
+                 || (item->fields == 0)) {
+                item->time_min = *new_time;
+                item->min_frame_in_invl = frame_num;
+            }
+            nstime_add(&item->time_tot, new_time);
+            item->fields++;
+        }
+        break;
+    default:
+        if ((item_unit == IOG_ITEM_UNIT_CALC_FRAMES) ||
+            (item_unit == IOG_ITEM_UNIT_CALC_FIELDS)) {
+            /*
+             * It's not an integeresque type, but
+             * all we want to do is count it, so
+             * that's all right.
+             */
+            item->fields++;
+        }
+        else {
+            /*
+             * "Can't happen"; see the "check that the
+             * type is compatible" check in
+             * filter_callback().
+             */
+            ws_assert_not_reached();
+        }
+        break;
+    }
+}
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
@@ -234,203 +475,21 @@ update_io_graph_item(io_graph_item_t *items, int idx, packet_info *pinfo, epan_d
     if (edt && hf_index >= 0) {
         GPtrArray *gp;
         unsigned i;
+        enum ftenum ftype;
+        int64_t rel_us;
 
         gp = proto_get_finfo_ptr_array(edt->tree, hf_index);
         if (!gp) {
             return false;
         }
 
-        /* Update the appropriate counters. If fields == 0, this is the first seen
-         *  value so set any min/max values accordingly. */
+        ftype = proto_registrar_get_ftype(hf_index);
+        rel_us = get_io_graph_rel_us(pinfo);
         for (i=0; i < gp->len; i++) {
-            int64_t new_int64;
-            uint64_t new_uint64;
-            float new_float;
-            double new_double;
-            const nstime_t *new_time;
+            io_graph_value_t value;
 
-            switch (proto_registrar_get_ftype(hf_index)) {
-            case FT_UINT8:
-            case FT_UINT16:
-            case FT_UINT24:
-            case FT_UINT32:
-                new_uint64 = fvalue_get_uinteger(((field_info *)gp->pdata[i])->value);
-
-                if ((new_uint64 > item->uint_max) || (item->fields == 0)) {
-                    item->uint_max = new_uint64;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_uint64 < item->uint_min) || (item->fields == 0)) {
-                    item->uint_min = new_uint64;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += (double)new_uint64;
-                item->fields++;
-                break;
-            case FT_INT8:
-            case FT_INT16:
-            case FT_INT24:
-            case FT_INT32:
-                new_int64 = fvalue_get_sinteger(((field_info *)gp->pdata[i])->value);
-                if ((new_int64 > item->int_max) || (item->fields == 0)) {
-                    item->int_max = new_int64;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_int64 < item->int_min) || (item->fields == 0)) {
-                    item->int_min = new_int64;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += (double)new_int64;
-                item->fields++;
-                break;
-            case FT_UINT40:
-            case FT_UINT48:
-            case FT_UINT56:
-            case FT_UINT64:
-                new_uint64 = fvalue_get_uinteger64(((field_info *)gp->pdata[i])->value);
-                if ((new_uint64 > item->uint_max) || (item->fields == 0)) {
-                    item->uint_max = new_uint64;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_uint64 < item->uint_min) || (item->fields == 0)) {
-                    item->uint_min = new_uint64;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += (double)new_uint64;
-                item->fields++;
-                break;
-            case FT_INT40:
-            case FT_INT48:
-            case FT_INT56:
-            case FT_INT64:
-                new_int64 = fvalue_get_sinteger64(((field_info *)gp->pdata[i])->value);
-                if ((new_int64 > item->int_max) || (item->fields == 0)) {
-                    item->int_max = new_int64;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_int64 < item->int_min) || (item->fields == 0)) {
-                    item->int_min = new_int64;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += (double)new_int64;
-                item->fields++;
-                break;
-            case FT_FLOAT:
-                new_float = (float)fvalue_get_floating(((field_info *)gp->pdata[i])->value);
-                if ((new_float > item->double_max) || (item->fields == 0)) {
-                    item->double_max = new_float;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_float < item->double_min) || (item->fields == 0)) {
-                    item->double_min = new_float;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += new_float;
-                item->fields++;
-                break;
-            case FT_DOUBLE:
-                new_double = fvalue_get_floating(((field_info *)gp->pdata[i])->value);
-                if ((new_double > item->double_max) || (item->fields == 0)) {
-                    item->double_max = new_double;
-                    item->max_frame_in_invl = pinfo->num;
-                }
-                if ((new_double < item->double_min) || (item->fields == 0)) {
-                    item->double_min = new_double;
-                    item->min_frame_in_invl = pinfo->num;
-                }
-                item->double_tot += new_double;
-                item->fields++;
-                break;
-            case FT_RELATIVE_TIME:
-                new_time = fvalue_get_time(((field_info *)gp->pdata[i])->value);
-
-                switch (item_unit) {
-                case IOG_ITEM_UNIT_CALC_LOAD:
-                {
-                    uint64_t t, pt; /* time in us */
-                    int j;
-                    /*
-                     * Add the time this call spanned each interval according to
-                     * its contribution to that interval.
-                     * If the call time is negative (unlikely, requires both an
-                     * out of order capture file plus retransmission), ignore.
-                     */
-                    const nstime_t time_zero = NSTIME_INIT_ZERO;
-                    if (nstime_cmp(new_time, &time_zero) < 0) {
-                        break;
-                    }
-                    t = new_time->secs;
-                    t = t * 1000000 + new_time->nsecs / 1000;
-                    j = idx;
-                    /*
-                     * Handle current interval
-                     * This cannot be negative, because get_io_graph_index
-                     * returns an invalid interval if so.
-                     */
-                    pt = pinfo->rel_ts.secs * 1000000 + pinfo->rel_ts.nsecs / 1000;
-                    pt = pt % interval;
-                    if (pt > t) {
-                        pt = t;
-                    }
-                    while (t) {
-                        io_graph_item_t *load_item;
-
-                        load_item = &items[j];
-                        load_item->time_tot.nsecs += (int) (pt * 1000);
-                        if (load_item->time_tot.nsecs > 1000000000) {
-                            load_item->time_tot.secs++;
-                            load_item->time_tot.nsecs -= 1000000000;
-                        }
-                        load_item->fields++;
-
-                        if (j == 0) {
-                            break;
-                        }
-                        j--;
-                        t -= pt;
-                        if (t > (uint64_t) interval) {
-                            pt = (uint64_t) interval;
-                        } else {
-                            pt = t;
-                        }
-                    }
-                    break;
-                }
-                default:
-                    if ( (nstime_cmp(new_time, &item->time_max) > 0)
-                         || (item->fields == 0)) {
-                        item->time_max = *new_time;
-                        item->max_frame_in_invl = pinfo->num;
-                    }
-                    if ( (nstime_cmp(new_time, &item->time_min) < 0)
-                         || (item->fields == 0)) {
-                        item->time_min = *new_time;
-                        item->min_frame_in_invl = pinfo->num;
-                    }
-                    nstime_add(&item->time_tot, new_time);
-                    item->fields++;
-                }
-                break;
-            default:
-                if ((item_unit == IOG_ITEM_UNIT_CALC_FRAMES) ||
-                    (item_unit == IOG_ITEM_UNIT_CALC_FIELDS)) {
-                    /*
-                     * It's not an integeresque type, but
-                     * all we want to do is count it, so
-                     * that's all right.
-                     */
-                    item->fields++;
-                }
-                else {
-                    /*
-                     * "Can't happen"; see the "check that the
-                     * type is compatible" check in
-                     * filter_callback().
-                     */
-                    ws_assert_not_reached();
-                }
-                break;
-            }
+            get_io_graph_value((field_info *)gp->pdata[i], ftype, &value);
+            update_io_graph_item_value(items, idx, pinfo->num, rel_us, ftype, &value, item_unit, interval);
         }
     }
 
@@ -30,7 +30,65 @@
 // 2^25 = 16777216
 const int max_io_items_ = 1 << 25;
 
-IOGraph::IOGraph(QCustomPlot* parent, const char* type_unit_name) :
+// The most memory the graphs of a capture use to cache tapped packets,
+// 12 bytes per frame plus a bit per frame for each graph and the
+// values of graphs with a Y field. Past this the graphs retap instead.
+const size_t max_packet_cache_bytes_ = 256 * 1024 * 1024;
+
+IOGraphPacketCache::IOGraphPacketCache() :
+    reserved_(0)
+{
+}
+
+bool IOGraphPacketCache::addFrame(uint32_t frame_num, int64_t rel_us, uint32_t pkt_len)
+{
+    const size_t frame_bytes = sizeof(int64_t) + sizeof(uint32_t);
+
+    if (frame_num == 0) {
+        return false;
+    }
+    if (frame_num > rel_us_.size()) {
+        const size_t old_size = rel_us_.size();
+        size_t new_size = MAX(MAX(old_size * 2, (size_t)1024), (size_t)frame_num);
+        if (new_size * frame_bytes + reserved_ > max_packet_cache_bytes_) {
+            new_size = frame_num;
+            if (new_size * frame_bytes + reserved_ > max_packet_cache_bytes_) {
+                return false;
+            }
+        }
+        try {
+            rel_us_.resize(new_size);
+            pkt_len_.resize(new_size);
+        }
+        catch (std::bad_alloc&) {
+            ws_warning("Failed memory allocation.");
+            rel_us_.resize(old_size);
+            pkt_len_.resize(old_size);
+            return false;
+        }
+    }
+    rel_us_[frame_num - 1] = rel_us;
+    pkt_len_[frame_num - 1] = pkt_len;
+    return true;
+}
+
+bool IOGraphPacketCache::reserve(size_t bytes)
+{
+    const size_t frame_bytes = sizeof(int64_t) + sizeof(uint32_t);
+
+    if (rel_us_.size() * frame_bytes + reserved_ + bytes > max_packet_cache_bytes_) {
+        return false;
+    }
+    reserved_ += bytes;
+    return true;
+}
+
+void IOGraphPacketCache::release(size_t bytes)
+{
+    reserved_ -= MIN(bytes, reserved_);
+}
+
+IOGraph::IOGraph(QCustomPlot* parent, const char* type_unit_name, IOGraphPacketCache* packet_cache) :
     Graph(parent),
     moving_avg_period_(0),
     tap_registered_(true),
@@ -41,7 +99,13 @@ IOGraph::IOGraph(QCustomPlot* parent, const char* type_unit_name) :
     interval_(0),
     asAOT_(false),
     type_unit_name_(type_unit_name),
-    cur_idx_(-1)
+    cur_idx_(-1),
+    packet_cache_(packet_cache),
+    sample_fields_(false),
+    sample_bytes_(0),
+    samples_valid_(false),
+    keep_samples_(false),
+    retap_skipped_(false)
 {
     GString* error_string;
     error_string = register_tap_listener("frame",
@@ -63,6 +127,7 @@ IOGraph::IOGraph(QCustomPlot* parent, const char* type_unit_name) :
 
 IOGraph::~IOGraph() {
     removeTapListener();
+    clearSamples();
 }
 
 void IOGraph::removeTapListener()
@@ -126,6 +191,8 @@ bool IOGraph::setFilter(const QString& filter)
 
         filter_ = filter;
         full_filter_ = full_filter;
+        // The cached packets match the old filter.
+        clearSamples();
         /* If we changed the tap filter the graph is visible, we need to
          * retap.
          * Note that setting the tap dfilter will mark the tap as needing a
@@ -241,12 +308,15 @@ void IOGraph::setValueUnits(int val_units)
                 if (val_units == IOG_ITEM_UNIT_CALC_LOAD ||
                     old_val_units == IOG_ITEM_UNIT_CALC_LOAD) {
                     // LOAD graphs fill in the io_graph_item_t differently
-                    // than other advanced graphs, so we have to retap even
-                    // if the filter is the same. (update_io_graph_item could
-                    // instead calculate and store LOAD information for any
-                    // advanced graph type, but the tradeoff might not be
-                    // worth it.)
-                    setNeedRetap(true);
+                    // than other advanced graphs, so we have to recalculate
+                    // the items even if the filter is the same, from the
+                    // cached packets if we have them.
+                    if (samples_valid_ && !need_retap_) {
+                        recalcItemsFromSamples();
+                        emit requestRecalc();
+                    } else {
+                        setNeedRetap(true);
+                    }
                 }
             }
         }
@@ -324,9 +394,83 @@ void IOGraph::clearAllData()
         reset_io_graph_items(&items_[0], items_.size(), hf_index_);
     }
     nstime_set_zero(&start_time_);
+    clearSamples();
     Graph::clearAllData();
 }
 
+void IOGraph::clearSamples()
+{
+    // swap() releases the memory, clear() doesn't.
+    std::vector<bool>().swap(sample_matches_);
+    std::vector<uint32_t>().swap(sample_num_values_);
+    std::vector<io_graph_value_t>().swap(sample_values_);
+    packet_cache_->release(sample_bytes_);
+    sample_bytes_ = 0;
+    samples_valid_ = false;
+    keep_samples_ = false;
+}
+
+void IOGraph::keepSamplesOnRetap()
+{
+    keep_samples_ = samples_valid_ && !need_retap_;
+}
+
+void IOGraph::recalcItemsFromSamples()
+{
+    cur_idx_ = -1;
+    if (items_.size()) {
+        reset_io_graph_items(&items_[0], items_.size(), hf_index_);
+    }
+
+    size_t num_values_idx = 0;
+    size_t value_idx = 0;
+    for (size_t i = 0; i < sample_matches_.size(); i++) {
+        if (!sample_matches_[i]) {
+            continue;
+        }
+        Sample sample;
+        sample.frame_num = (uint32_t)(i + 1);
+        sample.rel_us = packet_cache_->relUs(sample.frame_num);
+        sample.pkt_len = packet_cache_->pktLen(sample.frame_num);
+        sample.num_values = sample_fields_ ? sample_num_values_[num_values_idx++] : 0;
+        addSample(sample, sample_values_.data() + value_idx);
+        if (sample.num_values != no_field_) {
+            value_idx += sample.num_values;
+        }
+    }
+}
+
+bool IOGraph::cacheSample(const Sample& sample, const io_graph_value_t* values)
+{
+    if (!packet_cache_->addFrame(sample.frame_num, sample.rel_us, sample.pkt_len)) {
+        return false;
+    }
+
+    if (sample.frame_num > sample_matches_.size()) {
+        const size_t old_size = sample_matches_.size();
+        size_t new_size = MAX(MAX(old_size * 2, (size_t)1024), (size_t)sample.frame_num);
+        size_t bytes = (new_size - old_size) / 8 + 1;
+        if (!packet_cache_->reserve(bytes)) {
+            return false;
+        }
+        sample_bytes_ += bytes;
+        sample_matches_.resize(new_size);
+    }
+    sample_matches_[sample.frame_num - 1] = true;
+
+    if (sample_fields_) {
+        size_t num_values = sample.num_values != no_field_ ? sample.num_values : 0;
+        size_t bytes = sizeof(uint32_t) + num_values * sizeof(io_graph_value_t);
+        if (!packet_cache_->reserve(bytes)) {
+            return false;
+        }
+        sample_bytes_ += bytes;
+        sample_num_values_.push_back(sample.num_values);
+        sample_values_.insert(sample_values_.end(), values, values + num_values);
+    }
+    return true;
+}
+
 void IOGraph::recalcGraphData(capture_file* cap_file)
 {
     /* Moving average variables */
@@ -471,6 +615,12 @@ void IOGraph::captureEvent(const CaptureEvent& e)
     {
         removeTapListener();
     }
+    if ((e.captureContext() == CaptureEvent::Retap) &&
+        (e.eventType() == CaptureEvent::Finished))
+    {
+        keep_samples_ = false;
+        retap_skipped_ = false;
+    }
 }
 
 void IOGraph::reloadValueUnitField()
@@ -554,12 +704,20 @@ bool IOGraph::hasItemToShow(int idx, double value) const
     return result;
 }
 
-void IOGraph::setInterval(int interval)
+bool IOGraph::setInterval(int interval)
 {
+    if (interval == interval_) {
+        return true;
+    }
     interval_ = interval;
     if (bars_) {
         bars_->setWidth(interval_ / SCALE_F);
     }
+    if (samples_valid_ && !need_retap_) {
+        recalcItemsFromSamples();
+        return true;
+    }
+    return false;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -577,7 +735,17 @@ void IOGraph::tapReset(void* iog_ptr)
     if (!iog) return;
 
     //    qDebug() << "=tapReset" << iog->name_;
+    if (iog->keep_samples_) {
+        // Another graph needs the retap; our cached packets are still good.
+        iog->keep_samples_ = false;
+        iog->retap_skipped_ = true;
+        return;
+    }
+    iog->retap_skipped_ = false;
     iog->clearAllData();
+    iog->samples_valid_ = true;
+    // Only graphs with a Y field need its values.
+    iog->sample_fields_ = iog->val_units_ >= IOG_ITEM_UNIT_CALC_SUM && iog->hf_index_ >= 0;
 }
 
 // "tap_packet" callback for register_tap_listener
@@ -588,16 +756,10 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
-    bool recalc = false;
-
-    /* some sanity checks */
-    if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
-        iog->cur_idx_ = (int)iog->items_.size() - 1;
+    if (iog->retap_skipped_) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    int idx = (int)tmp_idx;
     /* If the graph isn't visible, don't do the work or redraw, but mark
      * the graph in need of a retap if it is ever enabled. The alternative
      * is to do the work, but clear pending retaps when the taps are reset
@@ -607,14 +769,84 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
      * enabled/disabled taps.
      */
     if (!iog->visible()) {
-        if (idx > iog->cur_idx_) {
+        int64_t tmp_idx = get_io_graph_index(pinfo, iog->interval_);
+        if (tmp_idx >= 0 && tmp_idx < max_io_items_ && (int)tmp_idx > iog->cur_idx_) {
             iog->need_retap_ = true;
         }
+        iog->samples_valid_ = false;
+        return TAP_PACKET_DONT_REDRAW;
+    }
+
+    Sample sample;
+    sample.rel_us = get_io_graph_rel_us(pinfo);
+    sample.frame_num = pinfo->num;
+    sample.pkt_len = pinfo->fd->pkt_len;
+    sample.num_values = 0;
+
+    /* For ADVANCED mode we need to keep track of some more stuff than just frame and byte counts */
+    std::vector<io_graph_value_t> values;
+    if (iog->val_units_ >= IOG_ITEM_UNIT_CALC_SUM && edt && iog->hf_index_ >= 0) {
+        GPtrArray* gp = proto_get_finfo_ptr_array(edt->tree, iog->hf_index_);
+        if (gp) {
+            enum ftenum ftype = proto_registrar_get_ftype(iog->hf_index_);
+            values.resize(gp->len);
+            for (unsigned i = 0; i < gp->len; i++) {
+                get_io_graph_value((field_info*)gp->pdata[i], ftype, &values[i]);
+            }
+            sample.num_values = gp->len;
+        }
+        else {
+            sample.num_values = no_field_;
+        }
+    }
+
+    // Cache the packet so that changing the interval doesn't need a retap.
+    if (iog->samples_valid_) {
+        bool cached;
+        try {
+            cached = iog->cacheSample(sample, values.data());
+        }
+        catch (std::bad_alloc&) {
+            ws_warning("Failed memory allocation.");
+            cached = false;
+        }
+        if (!cached) {
+            // Too much to cache; the next change retaps instead.
+            iog->clearSamples();
+        }
+    }
+
+    /* set start time */
+    if (sample.rel_us >= 0 && nstime_is_zero(&iog->start_time_)) {
+        nstime_delta(&iog->start_time_, &pinfo->abs_ts, &pinfo->rel_ts);
+    }
+
+    int old_cur_idx = iog->cur_idx_;
+    if (!iog->addSample(sample, values.data())) {
         return TAP_PACKET_DONT_REDRAW;
     }
 
-    if ((size_t)idx >= iog->items_.size()) {
-        const size_t old_size = iog->items_.size();
+    //    qDebug() << "=tapPacket" << iog->name_ << idx << iog->hf_index_ << iog->val_units_ << iog->num_items_;
+
+    if (iog->cur_idx_ > old_cur_idx) {
+        emit iog->requestRecalc();
+    }
+    return TAP_PACKET_REDRAW;
+}
+
+bool IOGraph::addSample(const Sample& sample, const io_graph_value_t* values)
+{
+    int64_t tmp_idx = (sample.rel_us >= 0 && interval_ > 0) ? sample.rel_us / interval_ : -1;
+
+    /* some sanity checks */
+    if ((tmp_idx < 0) || (tmp_idx >= max_io_items_)) {
+        cur_idx_ = (int)items_.size() - 1;
+        return false;
+    }
+
+    int idx = (int)tmp_idx;
+    if ((size_t)idx >= items_.size()) {
+        const size_t old_size = items_.size();
         size_t new_size;
         if (old_size == 0) {
             new_size = 1024;
@@ -624,44 +856,44 @@ tap_packet_status IOGraph::tapPacket(void* iog_ptr, packet_info* pinfo, epan_dis
         }
         new_size = MAX(new_size, (size_t)idx + 1);
         try {
-            iog->items_.resize(new_size);
+            items_.resize(new_size);
         }
         catch (std::bad_alloc&) {
             // std::vector.resize() has strong exception safety
             ws_warning("Failed memory allocation.");
-            return TAP_PACKET_DONT_REDRAW;
+            return false;
         }
         // resize zero-initializes new items, which is what we want
-        //reset_io_graph_items(&iog->items_[old_size], new_size - old_size);
+        //reset_io_graph_items(&items_[old_size], new_size - old_size);
     }
 
     /* update num_items */
-    if (idx > iog->cur_idx_) {
-        iog->cur_idx_ = idx;
-        recalc = true;
+    if (idx > cur_idx_) {
+        cur_idx_ = idx;
     }
 
-    /* set start time */
-    if (nstime_is_zero(&iog->start_time_)) {
-        nstime_delta(&iog->start_time_, &pinfo->abs_ts, &pinfo->rel_ts);
-    }
+    io_graph_item_t* item = &items_[idx];
 
-    epan_dissect_t* adv_edt = NULL;
-    /* For ADVANCED mode we need to keep track of some more stuff than just frame and byte counts */
-    if (iog->val_units_ >= IOG_ITEM_UNIT_CALC_SUM) {
-        adv_edt = edt;
+    /* Set the first and last frame num in current interval matching the target field+filter  */
+    if (item->first_frame_in_invl == 0) {
+        item->first_frame_in_invl = sample.frame_num;
     }
+    item->last_frame_in_invl = sample.frame_num;
 
-    if (!update_io_graph_item(&iog->items_[0], idx, pinfo, adv_edt, iog->hf_index_, iog->val_units_, iog->interval_)) {
-        return TAP_PACKET_DONT_REDRAW;
+    if (sample.num_values == no_field_) {
+        return false;
     }
-
-    //    qDebug() << "=tapPacket" << iog->name_ << idx << iog->hf_index_ << iog->val_units_ << iog->num_items_;
-
-    if (recalc) {
-        emit iog->requestRecalc();
+    if (sample.num_values > 0) {
+        enum ftenum ftype = proto_registrar_get_ftype(hf_index_);
+        for (uint32_t i = 0; i < sample.num_values; i++) {
+            update_io_graph_item_value(&items_[0], idx, sample.frame_num, sample.rel_us, ftype, &values[i], val_units_, interval_);
+        }
     }
-    return TAP_PACKET_REDRAW;
+
+    item = &items_[idx];
+    item->frames++;
+    item->bytes += sample.pkt_len;
+    return true;
 }
 
 // "tap_draw" callback for register_tap_listener
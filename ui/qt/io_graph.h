@@ -60,6 +60,64 @@ static const value_string y_axis_event_vs[] = {
     { 0, NULL }
 };
 
+/**
+ * @brief The time and length of the frames tapped by the graphs of a capture.
+ *
+ * Shared by the graphs so that each of them only has to remember which
+ * frames matched its filter. Caching stops once the cache and the graphs'
+ * own data reach a fixed size; the graphs then retap instead.
+ */
+class IOGraphPacketCache {
+public:
+    IOGraphPacketCache();
+
+    /**
+     * @brief Stores the time and length of a frame.
+     * @param frame_num The frame number.
+     * @param rel_us The relative time in microseconds, see get_io_graph_rel_us().
+     * @param pkt_len The packet length.
+     * @return True if the frame was stored, false if the cache is full.
+     */
+    bool addFrame(uint32_t frame_num, int64_t rel_us, uint32_t pkt_len);
+
+    /**
+     * @brief Retrieves the relative time of a stored frame.
+     * @param frame_num The frame number.
+     * @return The relative time in microseconds.
+     */
+    int64_t relUs(uint32_t frame_num) const { return rel_us_[frame_num - 1]; }
+
+    /**
+     * @brief Retrieves the packet length of a stored frame.
+     * @param frame_num The frame number.
+     * @return The packet length.
+     */
+    uint32_t pktLen(uint32_t frame_num) const { return pkt_len_[frame_num - 1]; }
+
+    /**
+     * @brief Accounts for memory used by a graph's own cached data.
+     * @param bytes The number of bytes the graph is about to allocate.
+     * @return True if they fit, false if the cache is full.
+     */
+    bool reserve(size_t bytes);
+
+    /**
+     * @brief Gives back memory accounted for by reserve().
+     * @param bytes The number of bytes the graph freed.
+     */
+    void release(size_t bytes);
+
+private:
+    /** Relative times in microseconds, indexed by frame number - 1. */
+    std::vector<int64_t> rel_us_;
+
+    /** Packet lengths, indexed by frame number - 1. */
+    std::vector<uint32_t> pkt_len_;
+
+    /** The bytes reserved by the graphs. */
+    size_t reserved_;
+};
+
 /**
  * @brief Represents an individual input/output graph, handling tapping, packet processing, and data scaling.
  */
@@ -70,8 +128,9 @@ public:
      * @brief Constructs a new IOGraph.
      * @param parent The parent QCustomPlot widget.
      * @param type_unit_name The name string representing the graph's unit type.
+     * @param packet_cache The cache of tapped frames shared with the other graphs of the capture.
      */
-    explicit IOGraph(QCustomPlot* parent, const char* type_unit_name);
+    explicit IOGraph(QCustomPlot* parent, const char* type_unit_name, IOGraphPacketCache* packet_cache);
 
     /**
      * @brief Destroys the IOGraph.
@@ -183,9 +242,23 @@ public:
 
     /**
      * @brief Sets the time interval for data bucketing.
+     *
+     * If the packets of the last tap are cached, the data is re-bucketed
+     * from them.
+     *
      * @param interval The interval in milliseconds.
+     * @return True if the data is up to date for the new interval, false
+     * if a retap is needed.
+     */
+    bool setInterval(int interval);
+
+    /**
+     * @brief Keeps the cached packets across the next retap if they are still valid.
+     *
+     * Called before a retap that other graphs need, so that it doesn't
+     * tap this graph again.
      */
-    void setInterval(int interval);
+    void keepSamplesOnRetap();
 
     /**
      * @brief Determines the packet number closest to a specific timestamp.
@@ -288,6 +361,46 @@ private:
      */
     void removeTapListener();
 
+    /**
+     * @brief A tapped packet, as needed to recalculate the items for any
+     * interval or value unit that doesn't change the filter.
+     */
+    struct Sample {
+        int64_t rel_us;         /**< Relative time in microseconds, see get_io_graph_rel_us(). */
+        uint32_t frame_num;     /**< The frame number. */
+        uint32_t pkt_len;       /**< The packet length. */
+        uint32_t num_values;    /**< The number of values of the Y field, or no_field_. */
+    };
+
+    /** Sample::num_values of a packet without the Y field. */
+    static const uint32_t no_field_ = UINT32_MAX;
+
+    /**
+     * @brief Adds a tapped packet to the cache.
+     * @param sample The packet.
+     * @param values The values of the Y field of the packet.
+     * @return True if the packet was cached, false if the cache is full.
+     */
+    bool cacheSample(const Sample& sample, const io_graph_value_t* values);
+
+    /**
+     * @brief Adds a tapped packet to the items.
+     * @param sample The packet.
+     * @param values The values of the Y field of the packet.
+     * @return True if the items were updated, false otherwise.
+     */
+    bool addSample(const Sample& sample, const io_graph_value_t* values);
+
+    /**
+     * @brief Recalculates the items from the cached packets.
+     */
+    void recalcItemsFromSamples();
+
+    /**
+     * @brief Discards the cached packets.
+     */
+    void clearSamples();
+
     /**
      * @brief Checks if zero values should be plotted or ignored.
      * @return True if zero values are shown, false otherwise.
@@ -358,6 +471,36 @@ private:
 
     /** The highest interval index currently populated with data. */
     int cur_idx_;
+
+    /** The time and length of the tapped frames, shared with the other graphs. */
+    IOGraphPacketCache* packet_cache_;
+
+    /**
+     * The frames that matched the filter in the last tap, indexed by frame
+     * number - 1, so that the interval can be changed without retapping.
+     */
+    std::vector<bool> sample_matches_;
+
+    /** Whether the Y field values are cached, i.e. the graph has a Y field. */
+    bool sample_fields_;
+
+    /** Sample::num_values of each matching frame, if sample_fields_. */
+    std::vector<uint32_t> sample_num_values_;
+
+    /** The values of the Y field of the matching frames, in the same order. */
+    std::vector<io_graph_value_t> sample_values_;
+
+    /** The bytes reserved in packet_cache_ for the above. */
+    size_t sample_bytes_;
+
+    /** Whether the cache holds every packet matching the current filter. */
+    bool samples_valid_;
+
+    /** Whether to skip the next retap, see keepSamplesOnRetap(). */
+    bool keep_samples_;
+
+    /** Whether the current retap is skipped. */
+    bool retap_skipped_;
 };
 
 #endif // IO_GRAPH_H
@@ -48,7 +48,10 @@
 // - Regular (non-stacked) bar graphs are drawn on top of each other on the Z axis.
 //   The QCP forum suggests drawing them side by side:
 //   https://www.qcustomplot.com/index.php/support/forum/62
-// - We retap and redraw more than we should.
+// - We retap and redraw more than we should. Graphs cache the packets of
+//   their last tap, up to a fixed size, so changing the interval doesn't
+//   retap and a retap for one graph doesn't tap the others again, but the
+//   retap still dissects every packet.
 // - Smoothing doesn't seem to match GTK+
 // - Closing the color picker on macOS sends the dialog to the background.
 // - X-axis time buckets are based on the file relative time, even in
@@ -591,7 +594,7 @@ void IOGraphDialog::addGraph(bool copy_from_current)
 void IOGraphDialog::createIOGraph(int currentRow)
 {
     // XXX - Should IOGraph have its own list that has to sync with UAT?
-    ioGraphs_.insert(currentRow, new IOGraph(ui->ioPlot, type_unit_name_));
+    ioGraphs_.insert(currentRow, new IOGraph(ui->ioPlot, type_unit_name_, &packet_cache_));
     IOGraph* iog = ioGraphs_[currentRow];
 
     connect(this, &IOGraphDialog::recalcGraphData, iog, &IOGraph::recalcGraphData);
@@ -1435,6 +1438,13 @@ void IOGraphDialog::updateStatistics()
      */
     if (need_retap_ && !file_closed_ && !retapDepth() && prefs.gui_io_graph_automatic_update) {
         need_retap_ = false;
+        // Graphs that still have the packets of the last tap cached
+        // aren't tapped again.
+        foreach (IOGraph *iog, ioGraphs_) {
+            if (iog) {
+                iog->keepSamplesOnRetap();
+            }
+        }
         QTimer::singleShot(0, &cap_file_, &CaptureFile::retapPackets);
         // The user might have closed the window while tapping, which means
         // we might no longer exist.
@@ -1532,6 +1542,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 {
     int interval = ui->intervalComboBox->itemData(ui->intervalComboBox->currentIndex()).toInt();
     bool need_retap = false;
+    bool need_recalc = false;
 
     precision_ = ceil(log10(SCALE_F / interval));
     if (precision_ < 0) {
@@ -1553,8 +1564,10 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
             if (iog) {
-                iog->setInterval(interval);
-                if (iog->visible()) {
+                if (iog->setInterval(interval)) {
+                    // Recalculated from the cached packets.
+                    need_recalc = true;
+                } else if (iog->visible()) {
                     need_retap = true;
                 } else {
                     iog->setNeedRetap(true);
@@ -1565,6 +1578,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else if (need_recalc) {
+        scheduleRecalc(true);
     }
 }
 
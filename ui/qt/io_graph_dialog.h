@@ -459,6 +459,9 @@ private:
     /** Graph objects in UAT row order; must stay synchronised with uat_model_. */
     QVector<IOGraph *> ioGraphs_;
 
+    /** The time and length of the frames tapped by ioGraphs_, shared between them. */
+    IOGraphPacketCache packet_cache_;
+
     QString hint_err_;                         /**< Error string shown in the hint area. */
     QCPGraph *base_graph_;                     /**< The first QCPGraph, used as the time-axis reference. */
     QCPItemTracer *tracer_;                    /**< Crosshair tracer shown on mouse hover. */
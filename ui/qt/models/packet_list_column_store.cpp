@@ -0,0 +1,161 @@
+/* packet_list_column_store.cpp
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "packet_list_column_store.h"
+
+#include <string.h>
+
+#include <limits>
+
+// QByteArray is limited to INT_MAX bytes in Qt 5 and the offsets are 32 bits.
+static const qsizetype max_arena_size_ = std::numeric_limits<int>::max() - 1;
+
+void PacketListColumnStore::reset(int num_columns)
+{
+    columns_.clear();
+    columns_.resize(num_columns);
+    full_ = false;
+}
+
+void PacketListColumnStore::clear()
+{
+    for (Column &column : columns_) {
+        column.arena.clear();
+        column.offsets.clear();
+        column.intern.clear();
+        column.interned = 0;
+    }
+    full_ = false;
+}
+
+// FNV-1a
+static uint32_t text_hash(const char *text, qsizetype len)
+{
+    uint32_t hash = 2166136261U;
+    for (qsizetype i = 0; i < len; i++) {
+        hash = (hash ^ static_cast<uint8_t>(text[i])) * 16777619U;
+    }
+    return hash;
+}
+
+uint32_t PacketListColumnStore::intern(Column &column, const char *text, qsizetype len)
+{
+    // Open addressing with linear probing; slots hold offset + 1 like
+    // the per-frame offsets, so a slot costs four bytes.
+    if ((column.interned + 1) * 2 > column.intern.size()) {
+        QVector<uint32_t> old_intern;
+        old_intern.swap(column.intern);
+        column.intern.fill(0, qMax<qsizetype>(1024, old_intern.size() * 2));
+        uint32_t mask = static_cast<uint32_t>(column.intern.size()) - 1;
+        for (uint32_t id : old_intern) {
+            if (id != 0) {
+                const char *old_text = column.arena.constData() + id - 1;
+                uint32_t slot = text_hash(old_text, static_cast<qsizetype>(strlen(old_text))) & mask;
+                while (column.intern.at(slot) != 0) {
+                    slot = (slot + 1) & mask;
+                }
+                column.intern[slot] = id;
+            }
+        }
+    }
+
+    uint32_t mask = static_cast<uint32_t>(column.intern.size()) - 1;
+    uint32_t slot = text_hash(text, len) & mask;
+    while (uint32_t id = column.intern.at(slot)) {
+        if (strcmp(column.arena.constData() + id - 1, text) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (column.arena.size() + len + 1 > max_arena_size_) {
+        return 0;
+    }
+    uint32_t id = static_cast<uint32_t>(column.arena.size()) + 1;
+    column.arena.append(text, len + 1);
+    column.intern[slot] = id;
+    column.interned++;
+    return id;
+}
+
+void PacketListColumnStore::invalidate(uint32_t frame_num)
+{
+    // The text stays in the arena (and may be shared with other frames)
+    // until the next clear(); invalidating single frames (e.g. after
+    // editing a comment) is rare.
+    for (Column &column : columns_) {
+        if (frame_num < static_cast<uint32_t>(column.offsets.size())) {
+            column.offsets[frame_num] = 0;
+        }
+    }
+}
+
+bool PacketListColumnStore::contains(uint32_t frame_num) const
+{
+    for (const Column &column : columns_) {
+        if (frame_num >= static_cast<uint32_t>(column.offsets.size()) || column.offsets.at(frame_num) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PacketListColumnStore::store(uint32_t frame_num, int text_column, const char *text)
+{
+    if (text_column < 0 || text_column >= columns_.size()) {
+        return false;
+    }
+    Column &column = columns_[text_column];
+
+    uint32_t id = intern(column, text, static_cast<qsizetype>(strlen(text)));
+    if (id == 0) {
+        full_ = true;
+        return false;
+    }
+
+    if (frame_num >= static_cast<uint32_t>(column.offsets.size())) {
+        // Frames are mostly stored in order; grow geometrically.
+        qsizetype new_size = qMax<qsizetype>(static_cast<qsizetype>(frame_num) + 1, column.offsets.size() * 3 / 2);
+        column.offsets.resize(new_size);
+    }
+    column.offsets[frame_num] = id;
+    return true;
+}
+
+const char *PacketListColumnStore::text(uint32_t frame_num, int text_column) const
+{
+    if (text_column < 0 || text_column >= columns_.size()) {
+        return nullptr;
+    }
+    const Column &column = columns_.at(text_column);
+    if (frame_num >= static_cast<uint32_t>(column.offsets.size())) {
+        return nullptr;
+    }
+    return textById(text_column, column.offsets.at(frame_num));
+}
+
+uint32_t PacketListColumnStore::textId(uint32_t frame_num, int text_column) const
+{
+    if (text_column < 0 || text_column >= columns_.size()) {
+        return 0;
+    }
+    const Column &column = columns_.at(text_column);
+    if (frame_num >= static_cast<uint32_t>(column.offsets.size())) {
+        return 0;
+    }
+    return column.offsets.at(frame_num);
+}
+
+const char *PacketListColumnStore::textById(int text_column, uint32_t id) const
+{
+    if (id == 0 || text_column < 0 || text_column >= columns_.size()) {
+        return nullptr;
+    }
+    return columns_.at(text_column).arena.constData() + id - 1;
+}
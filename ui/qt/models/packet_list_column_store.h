@@ -0,0 +1,131 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PACKET_LIST_COLUMN_STORE_H
+#define PACKET_LIST_COLUMN_STORE_H
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Compact storage for the text of the columns that require dissection.
+ *
+ * Unlike the column text cache in PacketListRecord, which keeps QStrings for
+ * a limited number of recently displayed rows, this keeps the UTF-8 text of
+ * every dissected frame. Each text column has its own arena holding the
+ * NUL-terminated strings back to back, and a table of offsets into it indexed
+ * by frame number. Strings are interned, so a row costs four bytes per column
+ * plus its text only if no other frame has the same text, and equal texts
+ * have equal ids, which lets sorting work on the distinct texts only.
+ *
+ * Each PacketListModel owns a store, which is filled whenever a record's
+ * columns are dissected, including by the model's idle dissection, so that
+ * sorting and scrolling can use it instead of dissecting again.
+ */
+class PacketListColumnStore
+{
+public:
+    /**
+     * @brief Discard everything and set the number of text columns.
+     * @param num_columns The number of columns that require dissection.
+     */
+    void reset(int num_columns);
+
+    /**
+     * @brief Discard the text of all frames, keeping the columns.
+     */
+    void clear();
+
+    /**
+     * @brief Discard the text of one frame.
+     * @param frame_num The frame number.
+     */
+    void invalidate(uint32_t frame_num);
+
+    /**
+     * @brief Check whether the text of all columns of a frame is stored.
+     * @param frame_num The frame number.
+     * @return True if every text column can be read with text().
+     */
+    bool contains(uint32_t frame_num) const;
+
+    /**
+     * @brief Check whether some text couldn't be stored because an arena
+     * is full.
+     *
+     * Until the next clear() or reset(), frames that aren't stored yet
+     * may not be stored at all, so callers should fall back to keeping
+     * the text of only the rows they display.
+     *
+     * @return True if store() has failed.
+     */
+    bool isFull() const { return full_; }
+
+    /**
+     * @brief Store the text of one column of a frame.
+     *
+     * Nothing is stored if the arena for the column is full, and isFull()
+     * is true from then on.
+     *
+     * @param frame_num The frame number.
+     * @param text_column The text column index (see PacketListRecord::textColumn()).
+     * @param text The UTF-8 column text.
+     * @return True if the text was stored.
+     */
+    bool store(uint32_t frame_num, int text_column, const char *text);
+
+    /**
+     * @brief Get the text of one column of a frame.
+     * @param frame_num The frame number.
+     * @param text_column The text column index.
+     * @return The UTF-8 column text, valid until the store is changed, or
+     * nullptr if it isn't stored.
+     */
+    const char *text(uint32_t frame_num, int text_column) const;
+
+    /**
+     * @brief Get the id of the text of one column of a frame.
+     * @param frame_num The frame number.
+     * @param text_column The text column index.
+     * @return The id, the same for all frames with the same text in this
+     * column, or 0 if it isn't stored.
+     */
+    uint32_t textId(uint32_t frame_num, int text_column) const;
+
+    /**
+     * @brief Get a text by its id.
+     * @param text_column The text column index.
+     * @param id A non-zero id returned by textId().
+     * @return The UTF-8 column text, valid until the store is changed.
+     */
+    const char *textById(int text_column, uint32_t id) const;
+
+private:
+    struct Column {
+        QByteArray arena; /**< NUL-terminated strings back to back. */
+        QVector<uint32_t> offsets; /**< Offset + 1 into arena by frame number, 0 if not stored. */
+        QVector<uint32_t> intern; /**< Hash table of the offsets + 1 of the distinct strings. */
+        qsizetype interned = 0; /**< Number of distinct strings. */
+    };
+
+    QVector<Column> columns_; /**< One entry per text column. */
+    bool full_ = false; /**< Whether some text didn't fit in its arena. */
+
+    /**
+     * @brief Find or add a string in a column's arena.
+     * @return Its offset + 1, or 0 if the arena is full.
+     */
+    static uint32_t intern(Column &column, const char *text, qsizetype len);
+};
+
+#endif // PACKET_LIST_COLUMN_STORE_H
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 #include "packet_list_model.h"
@@ -99,6 +100,7 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     number_to_row_.reserve(reserved_packets_);
 
     idle_dissection_timer_ = new QElapsedTimer();
+    column_store_ = new PacketListColumnStore();
 
     refreshThemeColors();
     connect(ThemeManager::instance(), &ThemeManager::themeChanged,
@@ -108,6 +110,7 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
 PacketListModel::~PacketListModel()
 {
     delete idle_dissection_timer_;
+    delete column_store_;
 }
 
 void PacketListModel::setCaptureFile(capture_file *cf)
@@ -165,7 +168,7 @@ unsigned PacketListModel::recreateVisibleRows()
 void PacketListModel::clear() {
     beginResetModel();
     qDeleteAll(physical_rows_);
-    PacketListRecord::invalidateAllRecords();
+    PacketListRecord::invalidateAllRecords(column_store_);
     physical_rows_.resize(0);
     visible_rows_.resize(0);
     new_visible_rows_.resize(0);
@@ -207,7 +210,7 @@ void PacketListModel::invalidateAllColumnStrings()
     // neither QTreeView::dataChanged nor QAbstractItemView::dataChanged
     // actually use the roles parameter, and just reset everything.
     emit layoutAboutToBeChanged();
-    PacketListRecord::invalidateAllRecords();
+    PacketListRecord::invalidateAllRecords(column_store_);
     emit layoutChanged();
 #if 0
     // TODO: Check to see if Qt 6.9.0 is faster with the old approach now that
@@ -221,7 +224,7 @@ void PacketListModel::resetColumns()
 {
     emit layoutAboutToBeChanged();
     if (cap_file_) {
-        PacketListRecord::resetColumns(&cap_file_->cinfo);
+        PacketListRecord::resetColumns(&cap_file_->cinfo, column_store_);
     }
 
     emit layoutChanged();
@@ -356,7 +359,7 @@ void PacketListModel::toggleFrameRefTime(const QModelIndex &rt_index)
     if (!fdata->ref_time && !fdata->passed_dfilter) {
         cap_file_->displayed_count--;
     }
-    record->resetColumns(&cap_file_->cinfo);
+    record->resetColumns(&cap_file_->cinfo, column_store_);
     emit layoutChanged();
 #if 0
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
@@ -378,7 +381,7 @@ void PacketListModel::unsetAllFrameRefTime()
     }
     cap_file_->ref_time_count = 0;
     cf_reftime_packets(cap_file_);
-    PacketListRecord::resetColumns(&cap_file_->cinfo);
+    PacketListRecord::resetColumns(&cap_file_->cinfo, column_store_);
     emit layoutChanged();
 #if 0
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
@@ -422,7 +425,7 @@ void PacketListModel::addFrameComment(const QModelIndexList &indices, const QByt
         // If there were, then we'd need to reset data for all frames instead
         // of just the frames changed.
         record->invalidateColorized();
-        record->invalidateRecord();
+        record->invalidateRecord(column_store_);
         emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                 QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
     }
@@ -454,7 +457,7 @@ void PacketListModel::setFrameComment(const QModelIndex &index, const QByteArray
     }
 
     record->invalidateColorized();
-    record->invalidateRecord();
+    record->invalidateRecord(column_store_);
     emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
             QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
 }
@@ -485,7 +488,7 @@ void PacketListModel::deleteFrameComments(const QModelIndexList &indices)
             }
 
             record->invalidateColorized();
-            record->invalidateRecord();
+            record->invalidateRecord(column_store_);
             emit dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), sectionMax),
                     QVector<int>() << Qt::BackgroundRole << Qt::ForegroundRole << Qt::DisplayRole);
         }
@@ -512,7 +515,7 @@ void PacketListModel::deleteAllFrameComments()
             cf_set_modified_block(cap_file_, fdata, pkt_block);
 
             record->invalidateColorized();
-            record->invalidateRecord();
+            record->invalidateRecord(column_store_);
             row = packetNumberToRow(fdata->num);
             if (row > -1) {
                 emit dataChanged(index(row, 0), index(row, sectionMax),
@@ -526,9 +529,11 @@ void PacketListModel::deleteAllFrameComments()
 
 int PacketListModel::sort_column_;
 int PacketListModel::sort_column_is_numeric_;
+bool PacketListModel::sort_column_is_address_;
 int PacketListModel::text_sort_column_;
 Qt::SortOrder PacketListModel::sort_order_;
 capture_file *PacketListModel::sort_cap_file_;
+PacketListColumnStore *PacketListModel::sort_column_store_;
 bool PacketListModel::stop_flag_;
 ProgressFrame *PacketListModel::progress_frame_;
 double PacketListModel::comps_;
@@ -546,32 +551,6 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     QString col_title = get_column_title(column);
 
-    /* Make sure we're actually going to sort. Note that the header
-     * has no way of knowing that sorting failed, so in these cases
-     * the sort indicator have the value that the user requested
-     * regardless.
-     */
-    if (PacketListRecord::textColumn(column) >= 0 && (unsigned)visible_rows_.count() > prefs.gui_packet_list_cached_rows_max) {
-        /* Column not based on frame data but by column text that requires
-         * dissection, so to sort in a reasonable amount of time the column
-         * text needs to be cached.
-         */
-        /* If the sort is being triggered because the columns were already
-         * sorted and the filter is being cleared (or changed to something
-         * else with more rows than fit in the cache), then the temporary
-         * message will be immediately overwritten with the standard capture
-         * statistics by the packets_bar_update() call after thawing the rows.
-         * It will still blink yellow, and the user will get the message if
-         * they then click on the header file (wondering why it didn't sort.)
-         */
-        if (col_title.isEmpty()) {
-            col_title = tr("Column");
-        }
-        QString temp_msg = tr("%1 can only be sorted with %2 or fewer visible rows; increase cache size in Layout preferences").arg(col_title).arg(prefs.gui_packet_list_cached_rows_max);
-        mainApp->pushStatus(MainApplication::TemporaryStatus, temp_msg);
-        return;
-    }
-
     /* If we are currently in the middle of reading the capture file, don't
      * sort. PacketList::captureFileReadFinished invalidates all the cached
      * column strings and then tries to sort again.
@@ -596,6 +575,7 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
         return;
     }
     sort_cap_file_ = cap_file_;
+    sort_column_store_ = column_store_;
     sort_cap_file_->read_lock = true;
     sort_order_ = order;
     sort_column_ = column;
@@ -628,22 +608,44 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
+    sort_column_is_address_ = isAddressColumn(sort_column_);
     QVector<PacketListRecord *> sorted_visible_rows_ = visible_rows_;
     try {
+        bool sorted = false;
+        if (text_sort_column_ >= 0) {
+            /* Column not based on frame data but by column text that
+             * requires dissection. Make sure the text of every row is in
+             * the column store first (most of it usually is already, from
+             * the idle dissection) so that the comparisons don't dissect.
+             */
+            storeColumnText(sorted_visible_rows_);
+            sorted = sortByStoredText(sorted_visible_rows_);
+        }
+        if (!sorted) {
+            std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
+        }
+
+        /* The rows of the aggregation view are already aggregated; keep
+         * their keys, indexed by the old row, instead of aggregating again. */
+        QVector<QString> aggregation_keys;
         if (recent.aggregation_view && prefs.aggregation_fields_num > 0) {
+            aggregation_keys.resize(visible_rows_.count());
             for (QHash<QString, int>::const_iterator it = aggregation_key_row_.constBegin();
                 it != aggregation_key_row_.constEnd(); ++it) {
-                sorted_visible_rows_[it.value()]->frameData()->aggregation_key = g_strdup(it.key().toUtf8());
+                aggregation_keys[it.value()] = it.key();
             }
         }
-        std::sort(sorted_visible_rows_.begin(), sorted_visible_rows_.end(), recordLessThan);
 
         beginResetModel();
         visible_rows_.resize(0);
         number_to_row_.fill(0);
         aggregation_key_row_.clear();
         foreach (PacketListRecord *record, sorted_visible_rows_) {
-            updateVisibleRows(record);
+            if (aggregation_keys.isEmpty()) {
+                updateVisibleRows(record);
+            } else {
+                updateVisibleAggregatedRow(record, aggregation_keys.at(record->row() - 1));
+            }
         }
         endResetModel();
     } catch (const SortAbort& e) {
@@ -667,6 +669,166 @@ void PacketListModel::stopSorting()
     stop_flag_ = true;
 }
 
+int PacketListModel::compareColumnText(const char *r1_text, const char *r2_text)
+{
+    // XXX: The naive string comparison compares Unicode code points.
+    // Proper collation is more expensive
+    int cmp_val = strcmp(r1_text, r2_text);
+    if (cmp_val == 0) {
+        return 0;
+    }
+
+    if (sort_column_is_numeric_) {
+        // Custom column with numeric data (or something like a port number).
+        // Attempt to convert to numbers.
+        bool ok_r1, ok_r2;
+        double num_r1 = parseNumericColumn(r1_text, &ok_r1);
+        double num_r2 = parseNumericColumn(r2_text, &ok_r2);
+
+        if (!ok_r1 && !ok_r2) {
+            cmp_val = 0;
+        } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
+            // either r1 is invalid (and sort it before others) or both
+            // r1 and r2 are valid (sort normally)
+            cmp_val = -1;
+        } else if (!ok_r2 || (num_r1 > num_r2)) {
+            cmp_val = 1;
+        } else {
+            cmp_val = 0;
+        }
+    } else if (sort_column_is_address_) {
+        // IPv4 addresses before IPv6 addresses before anything else (names,
+        // MAC addresses), addresses in numeric order.
+        ws_in6_addr addr_r1, addr_r2;
+        int family_r1 = parseAddressColumn(r1_text, &addr_r1);
+        int family_r2 = parseAddressColumn(r2_text, &addr_r2);
+
+        if (family_r1 != family_r2) {
+            cmp_val = family_r1 < family_r2 ? -1 : 1;
+        } else if (family_r1 == 0) {
+            cmp_val = memcmp(&addr_r1, &addr_r2, sizeof(ws_in4_addr));
+        } else if (family_r1 == 1) {
+            cmp_val = memcmp(&addr_r1, &addr_r2, sizeof(ws_in6_addr));
+        }
+    }
+    return cmp_val;
+}
+
+// Sorts by the stored column text without any string comparisons per row:
+// the distinct texts (usually far fewer than rows, as they are interned)
+// are ordered once and ranked, and the rows are then sorted by plain integer
+// (rank, frame number) keys. Returns false if the text of some row isn't
+// stored.
+bool PacketListModel::sortByStoredText(QVector<PacketListRecord *> &records)
+{
+    struct SortKey {
+        uint32_t rank;
+        uint32_t frame_num;
+        PacketListRecord *record;
+    };
+
+    QVector<uint32_t> ids;
+    ids.reserve(records.count());
+    foreach (PacketListRecord *record, records) {
+        uint32_t id = record->columnTextId(sort_column_store_, sort_column_);
+        if (id == 0) {
+            return false;
+        }
+        ids << id;
+    }
+
+    QVector<uint32_t> distinct = ids;
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    QVector<const char *> texts;
+    texts.reserve(distinct.count());
+    foreach (uint32_t id, distinct) {
+        texts << sort_column_store_->textById(text_sort_column_, id);
+    }
+    QVector<uint32_t> order(distinct.count());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(order.count()); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&texts](uint32_t a, uint32_t b) {
+        return compareColumnText(texts.at(a), texts.at(b)) < 0;
+    });
+
+    // Texts that compare equal (e.g. "1.0" and "1" in a numeric column)
+    // get the same rank.
+    QVector<uint32_t> rank(distinct.count());
+    uint32_t cur_rank = 0;
+    for (qsizetype i = 0; i < order.count(); i++) {
+        if (i > 0 && compareColumnText(texts.at(order.at(i - 1)), texts.at(order.at(i))) != 0) {
+            cur_rank++;
+        }
+        rank[order.at(i)] = cur_rank;
+    }
+
+    QVector<SortKey> keys;
+    keys.reserve(records.count());
+    for (qsizetype i = 0; i < records.count(); i++) {
+        qsizetype distinct_idx = std::lower_bound(distinct.begin(), distinct.end(), ids.at(i)) - distinct.begin();
+        keys << SortKey{ rank.at(distinct_idx), records.at(i)->frameData()->num, records.at(i) };
+    }
+    std::sort(keys.begin(), keys.end(), [](const SortKey &a, const SortKey &b) {
+        return a.rank < b.rank || (a.rank == b.rank && a.frame_num < b.frame_num);
+    });
+
+    // The keys are unique, so descending is exactly the reverse.
+    for (qsizetype i = 0; i < records.count(); i++) {
+        if (sort_order_ == Qt::AscendingOrder) {
+            records[i] = keys[i].record;
+        } else {
+            records[i] = keys[keys.count() - 1 - i].record;
+        }
+    }
+    return true;
+}
+
+void PacketListModel::storeColumnText(const QVector<PacketListRecord *> &records)
+{
+    qsizetype stored = 0;
+    foreach (PacketListRecord *record, records) {
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            if (progress_frame_) {
+                progress_frame_->setValue(static_cast<int>(stored * 100 / records.count()));
+            }
+            mainApp->processEvents(QEventLoop::ExcludeSocketNotifiers, 1);
+            if (stop_flag_) {
+                throw SortAbort("Sorting aborted");
+            }
+            busy_timer_.restart();
+        }
+        record->ensureColumnsStored(sort_cap_file_, sort_column_store_);
+        stored++;
+    }
+}
+
+bool PacketListModel::isAddressColumn(int column)
+{
+    if (column < 0) {
+        return false;
+    }
+    switch (sort_cap_file_->cinfo.columns[column].col_fmt) {
+    case COL_DEF_SRC:
+    case COL_RES_SRC:
+    case COL_UNRES_SRC:
+    case COL_DEF_DST:
+    case COL_RES_DST:
+    case COL_UNRES_DST:
+    case COL_DEF_NET_SRC:
+    case COL_RES_NET_SRC:
+    case COL_UNRES_NET_SRC:
+    case COL_DEF_NET_DST:
+    case COL_RES_NET_DST:
+    case COL_UNRES_NET_DST:
+        return true;
+    default:
+        return false;
+    }
+}
+
 bool PacketListModel::isNumericColumn(int column)
 {
     /* XXX - Should this and ui/packet_list_utils.c right_justify_column()
@@ -763,6 +925,22 @@ void PacketListModel::updateVisibleRows(PacketListRecord* record)
     }
 }
 
+void PacketListModel::updateVisibleAggregatedRow(PacketListRecord* record, const QString &aggregation_key)
+{
+    if (aggregation_key.isNull()) {
+        return;
+    }
+    const frame_data* fdata = record->frameData();
+    record->setRow(static_cast<int>(visible_rows_.count()) + 1);
+    aggregation_key_row_[aggregation_key] = record->row() - 1;
+    visible_rows_ << record;
+    if (static_cast<uint32_t>(number_to_row_.size()) <= fdata->num) {
+        number_to_row_.resize(fdata->num + buffer_size_);
+    }
+    number_to_row_[fdata->num] = record->row();
+    cap_file_->aggregation_count = static_cast<uint32_t>(visible_rows_.count());
+}
+
 bool PacketListModel::updateVisibleAggregationViewRows(PacketListRecord* record) {
     if (prefs.aggregation_fields_num == 0) return true;
 
@@ -812,31 +990,15 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
         // Column comes directly from frame data
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
     } else  {
-        QString r1String = r1->columnString(sort_cap_file_, sort_column_);
-        QString r2String = r2->columnString(sort_cap_file_, sort_column_);
-        // XXX: The naive string comparison compares Unicode code points.
-        // Proper collation is more expensive
-        cmp_val = r1String.compare(r2String);
-        if (cmp_val != 0 && sort_column_is_numeric_) {
-            // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this? Perhaps the actual
-            // values used for sorting should be cached too as QVariant[List].
-            // If so, we could consider using QCollatorSortKeys or similar
-            // for strings as well.
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1String, &ok_r1);
-            double num_r2 = parseNumericColumn(r2String, &ok_r2);
-
-            if (!ok_r1 && !ok_r2) {
-                cmp_val = 0;
-            } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
-                // either r1 is invalid (and sort it before others) or both
-                // r1 and r2 are valid (sort normally)
-                cmp_val = -1;
-            } else if (!ok_r2 || (num_r1 > num_r2)) {
-                cmp_val = 1;
-            }
+        const char *r1_text = r1->columnText(sort_column_store_, sort_column_);
+        const char *r2_text = r2->columnText(sort_column_store_, sort_column_);
+        if (r1_text && r2_text) {
+            cmp_val = compareColumnText(r1_text, r2_text);
+        } else {
+            // The text couldn't be stored (e.g. the store is full).
+            QByteArray r1String = r1->columnString(sort_cap_file_, sort_column_store_, sort_column_).toUtf8();
+            QByteArray r2String = r2->columnString(sort_cap_file_, sort_column_store_, sort_column_).toUtf8();
+            cmp_val = compareColumnText(r1String.constData(), r2String.constData());
         }
 
         if (cmp_val == 0) {
@@ -852,13 +1014,24 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
     }
 }
 
+// Parses a field as an IPv4 or IPv6 address. Names (with name resolution)
+// and other addresses are left to the string comparison.
+int PacketListModel::parseAddressColumn(const char *strval, ws_in6_addr *addr)
+{
+    if (ws_inet_pton4(strval, reinterpret_cast<ws_in4_addr *>(addr))) {
+        return 0;
+    }
+    if (ws_inet_pton6(strval, addr)) {
+        return 1;
+    }
+    return 2;
+}
+
 // Parses a field as a double. Handle values with suffixes ("12ms"), negative
 // values ("-1.23") and fields with multiple occurrences ("1,2"). Marks values
 // that do not contain any numeric value ("Unknown") as invalid.
-double PacketListModel::parseNumericColumn(const QString &val, bool *ok)
+double PacketListModel::parseNumericColumn(const char *strval, bool *ok)
 {
-    QByteArray ba = val.toUtf8();
-    const char *strval = ba.constData();
     char *end = NULL;
     double num = g_ascii_strtod(strval, &end);
     *ok = strval != end;
@@ -939,7 +1112,7 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
         return QVariant();
     case Qt::AccessibleTextRole:
     {
-        return record->columnString(cap_file_, d_index.column(), true);
+        return record->columnString(cap_file_, column_store_, d_index.column(), true);
     }
     case Qt::AccessibleDescriptionRole:
     {
@@ -969,7 +1142,7 @@ QVariant PacketListModel::data(const QModelIndex &d_index, int role) const
     }
     case Qt::DisplayRole:
     {
-        return record->columnString(cap_file_, d_index.column(), true);
+        return record->columnString(cap_file_, column_store_, d_index.column(), true);
     }
     default:
         return QVariant();
@@ -1015,8 +1188,11 @@ void PacketListModel::flushVisibleRows()
     }
 }
 
-// Fill our column string and colorization cache while the application is
-// idle. Try to be as conservative with the CPU and disk as possible.
+// Fill our column store and colorization cache while the application is
+// idle, so that sorting by a column that requires dissection and scrolling
+// through rows that were never displayed don't have to dissect. Try to be as
+// conservative with the CPU and disk as possible. This runs in short slices
+// on the GUI thread, as dissection can't run concurrently with it.
 static const int idle_dissection_interval_ = 5; // ms
 void PacketListModel::dissectIdle(bool reset)
 {
@@ -1106,8 +1282,8 @@ void PacketListModel::ensureRowColorized(int row)
     PacketListRecord *record = visible_rows_[row];
     if (!record)
         return;
-    if (!record->colorized()) {
-        record->ensureColorized(cap_file_);
+    if (!record->colorized() || !record->columnsStored(column_store_)) {
+        record->ensureColorized(cap_file_, column_store_);
     }
 }
 
@@ -27,6 +27,8 @@
 
 #include <epan/cfile.h>
 
+#include <wsutil/inet_addr.h>
+
 class QElapsedTimer;
 
 /**
@@ -349,6 +351,9 @@ private:
     /** Flag indicating if the current sort column is numeric. */
     static int sort_column_is_numeric_;
 
+    /** Whether the current sort column holds (IP) addresses. */
+    static bool sort_column_is_address_;
+
     /** The column index used as a secondary text sort column. */
     static int text_sort_column_;
 
@@ -358,6 +363,9 @@ private:
     /** Pointer to the capture file context used during sorting. */
     static capture_file *sort_cap_file_;
 
+    /** The column store of the model being sorted. */
+    static PacketListColumnStore *sort_column_store_;
+
     /**
      * @brief Compare function used to sort records.
      * @param r1 The first record.
@@ -367,12 +375,45 @@ private:
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
 
     /**
-     * @brief Parses a string value from a column as a numeric double.
-     * @param val The string value to parse.
+     * @brief Compares the text of two rows in the sort column.
+     * @param r1_text The UTF-8 text of the first row.
+     * @param r2_text The UTF-8 text of the second row.
+     * @return Less than, equal to or greater than zero like strcmp().
+     */
+    static int compareColumnText(const char *r1_text, const char *r2_text);
+
+    /**
+     * @brief Parses a string value from an address column.
+     * @param strval The string value to parse.
+     * @param addr Set to the IPv4 or IPv6 address.
+     * @return 0 for IPv4, 1 for IPv6, 2 if it isn't an IP address.
+     */
+    static int parseAddressColumn(const char *strval, ws_in6_addr *addr);
+
+    /**
+     * @brief Parses a UTF-8 string value from a column as a numeric double.
+     * @param strval The string value to parse.
      * @param ok Pointer to a boolean set to true if parsing was successful.
      * @return The parsed double value.
      */
-    static double parseNumericColumn(const QString &val, bool *ok);
+    static double parseNumericColumn(const char *strval, bool *ok);
+
+    /**
+     * @brief Dissects the records whose column text isn't stored yet.
+     *
+     * Shows progress while sorting and throws SortAbort if stopped.
+     *
+     * @param records The records to be sorted.
+     */
+    static void storeColumnText(const QVector<PacketListRecord *> &records);
+
+    /**
+     * @brief Sorts records by the stored text of the sort column.
+     * @param records The records to be sorted.
+     * @return False if the text of some record isn't stored, in which case
+     * the records are unchanged.
+     */
+    static bool sortByStoredText(QVector<PacketListRecord *> &records);
 
     /** Flag used to signal stopping a long-running operation. */
     static bool stop_flag_;
@@ -392,6 +433,9 @@ private:
     /** The current row index being processed by idle dissection. */
     int idle_dissection_row_;
 
+    /** The text of the columns that require dissection, for all rows. */
+    PacketListColumnStore *column_store_;
+
     /**
      * @brief Determines if the specified column contains numeric data.
      * @param column The column index to check.
@@ -399,12 +443,27 @@ private:
      */
     bool isNumericColumn(int column);
 
+    /**
+     * @brief Determines if the specified column contains source or destination addresses.
+     * @param column The column index to check.
+     * @return True if it is an address column, false otherwise.
+     */
+    bool isAddressColumn(int column);
+
     /**
      * @brief Updates the internal lists with a newly visible row.
      * @param record Pointer to the packet list record that is now visible.
      */
     void updateVisibleRows(PacketListRecord* record);
 
+    /**
+     * @brief Re-adds an already aggregated row of the aggregation view.
+     * @param record Pointer to the packet list record of the row.
+     * @param aggregation_key The aggregation key of the row; rows with a null
+     * key are skipped.
+     */
+    void updateVisibleAggregatedRow(PacketListRecord* record, const QString &aggregation_key);
+
     /**
      * @brief Updates the aggregation view rows based on a newly visible record.
      * @param record Pointer to the packet list record that is now visible.
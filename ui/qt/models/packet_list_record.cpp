@@ -48,7 +48,7 @@ PacketListRecord::~PacketListRecord()
     g_slist_free(color_filters_);
 }
 
-void PacketListRecord::ensureColorized(capture_file *cap_file)
+void PacketListRecord::ensureColorized(capture_file *cap_file, PacketListColumnStore *column_store)
 {
     // packet_list_store.c:packet_list_get_value
     Q_ASSERT(fdata_);
@@ -58,16 +58,31 @@ void PacketListRecord::ensureColorized(capture_file *cap_file)
     }
 
     bool dissect_color = !colorized_ || ( color_ver_ != rows_color_ver_ );
-    if (dissect_color) {
-        /* Dissect columns only if it won't evict anything from cache */
-        bool dissect_columns = col_text_cache_.totalCost() < col_text_cache_.maxCost();
-        dissect(cap_file, dissect_columns, dissect_color);
+    /* Once the column store is full, dissect columns only if it won't
+     * evict anything from the column text cache, as we did before there
+     * was a store. */
+    bool dissect_columns = !columnsStored(column_store) &&
+            (!column_store->isFull() ||
+             (!col_text_cache_.contains(fdata_->num) && col_text_cache_.totalCost() < col_text_cache_.maxCost()));
+    if (dissect_color || dissect_columns) {
+        dissect(cap_file, column_store, dissect_columns, dissect_color, false);
+    }
+}
+
+void PacketListRecord::ensureColumnsStored(capture_file *cap_file, PacketListColumnStore *column_store)
+{
+    Q_ASSERT(fdata_);
+
+    if (!cap_file || column_store->isFull() || columnsStored(column_store)) {
+        return;
     }
+
+    dissect(cap_file, column_store, true, !colorized_ || ( color_ver_ != rows_color_ver_ ), false);
 }
 
 // We might want to return a const char * instead. This would keep us from
 // creating excessive QByteArrays, e.g. in PacketListModel::recordLessThan.
-const QString PacketListRecord::columnString(capture_file *cap_file, int column, bool colorized)
+const QString PacketListRecord::columnString(capture_file *cap_file, PacketListColumnStore *column_store, int column, bool colorized)
 {
     // packet_list_store.c:packet_list_get_value
     Q_ASSERT(fdata_);
@@ -85,18 +100,26 @@ const QString PacketListRecord::columnString(capture_file *cap_file, int column,
     QStringList *col_text = nullptr;
     if (!dissect_color) {
         col_text = col_text_cache_.object(fdata_->num);
+        if (col_text == nullptr) {
+            // Dissected before but no longer in the cache, e.g. by the
+            // idle dissection or while sorting.
+            const char *text = columnText(column_store, column);
+            if (text != nullptr) {
+                return QString::fromUtf8(text);
+            }
+        }
     }
     if (col_text == nullptr || column >= col_text->count() || col_text->at(column).isNull()) {
-        dissect(cap_file, true, dissect_color);
+        dissect(cap_file, column_store, true, dissect_color);
         col_text = col_text_cache_.object(fdata_->num);
     }
 
     return col_text ? col_text->at(column) : QString();
 }
 
-void PacketListRecord::resetColumns(column_info *cinfo)
+void PacketListRecord::resetColumns(column_info *cinfo, PacketListColumnStore *column_store)
 {
-    invalidateAllRecords();
+    invalidateAllRecords(column_store);
 
     if (!cinfo) {
         return;
@@ -110,9 +133,10 @@ void PacketListRecord::resetColumns(column_info *cinfo)
             j++;
         }
     }
+    column_store->reset(static_cast<int>(j));
 }
 
-void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color)
+void PacketListRecord::dissect(capture_file *cap_file, PacketListColumnStore *column_store, bool dissect_columns, bool dissect_color, bool may_evict)
 {
     // packet_list_store.c:packet_list_dissect_and_cache_record
     epan_dissect_t edt;
@@ -156,7 +180,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
         if (dissect_columns) {
             col_fill_in_error(cinfo, fdata_, false, false /* fill_fd_columns */);
 
-            cacheColumnStrings(cinfo);
+            cacheColumnStrings(cinfo, column_store, may_evict);
         }
         if (dissect_color) {
             fdata_->color_filter = NULL;
@@ -204,7 +228,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
     if (dissect_columns) {
         /* "Stringify" non frame_data vals */
         epan_dissect_fill_in_columns(&edt, false, false /* fill_fd_columns */);
-        cacheColumnStrings(cinfo);
+        cacheColumnStrings(cinfo, column_store, may_evict);
     }
 
     if (dissect_color) {
@@ -241,7 +265,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, boo
     wtap_rec_cleanup(&rec);
 }
 
-void PacketListRecord::cacheColumnStrings(column_info *cinfo)
+void PacketListRecord::cacheColumnStrings(column_info *cinfo, PacketListColumnStore *column_store, bool may_evict)
 {
     // packet_list_store.c:packet_list_change_record(PacketList *packet_list, PacketListRecord *record, int col, column_info *cinfo)
     if (!cinfo) {
@@ -260,6 +284,8 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         int text_col = cinfo_column_.value(column, -1);
         if (text_col < 0) {
             col_fill_in_frame_data(fdata_, cinfo, column, false);
+        } else {
+            column_store->store(fdata_->num, text_col, get_column_text(cinfo, column));
         }
 
         col_str = QString(get_column_text(cinfo, column));
@@ -271,5 +297,13 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         }
     }
 
-    col_text_cache_.insert(fdata_->num, col_text);
+    // Rows dissected in the background (idle dissection, the overview
+    // and sorting) are kept by the column store; don't let them push the
+    // displayed rows out of the cache.
+    if (may_evict || col_text_cache_.contains(fdata_->num) ||
+            col_text_cache_.totalCost() < col_text_cache_.maxCost()) {
+        col_text_cache_.insert(fdata_->num, col_text);
+    } else {
+        delete col_text;
+    }
 }
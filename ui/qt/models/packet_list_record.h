@@ -17,6 +17,8 @@
 #include <epan/column.h>
 #include <epan/packet.h>
 
+#include "packet_list_column_store.h"
+
 #include <QByteArray>
 #include <QCache>
 #include <QList>
@@ -44,18 +46,62 @@ public:
 
     /**
      * @brief Ensure that the record is colorized.
+     *
+     * The column text is collected too if it can be without evicting
+     * displayed rows from the column text cache.
+     *
      * @param cap_file The capture file containing the packet.
+     * @param column_store The model's column store.
      */
-    void ensureColorized(capture_file *cap_file);
+    void ensureColorized(capture_file *cap_file, PacketListColumnStore *column_store);
 
     /**
      * @brief Return the string value for a column. Data is cached if possible.
      * @param cap_file The capture file containing the packet.
+     * @param column_store The model's column store.
      * @param column The column index.
      * @param colorized Whether to fetch the colorized string.
      * @return The string value for the specified column.
      */
-    const QString columnString(capture_file *cap_file, int column, bool colorized = false);
+    const QString columnString(capture_file *cap_file, PacketListColumnStore *column_store, int column, bool colorized = false);
+
+    /**
+     * @brief Return the stored UTF-8 text of a column that requires dissection.
+     *
+     * Unlike columnString() this never dissects the packet.
+     *
+     * @param column_store The model's column store.
+     * @param column The column index.
+     * @return The column text, or nullptr if the column doesn't require
+     * dissection or its text isn't in the column store.
+     */
+    const char *columnText(const PacketListColumnStore *column_store, int column) const { return column_store->text(fdata_->num, textColumn(column)); }
+
+    /**
+     * @brief Return the id of the stored text of a column that requires dissection.
+     * @param column_store The model's column store.
+     * @param column The column index.
+     * @return The id, equal for records with equal text, or 0 if the text
+     * isn't in the column store.
+     */
+    uint32_t columnTextId(const PacketListColumnStore *column_store, int column) const { return column_store->textId(fdata_->num, textColumn(column)); }
+
+    /**
+     * @brief Checks whether the text of all columns that require dissection is stored.
+     * @param column_store The model's column store.
+     * @return True if no dissection is needed to get the column text.
+     */
+    bool columnsStored(const PacketListColumnStore *column_store) const { return column_store->contains(fdata_->num); }
+
+    /**
+     * @brief Dissect the packet if the text of its columns isn't stored yet.
+     *
+     * Does nothing once the column store is full.
+     *
+     * @param cap_file The capture file containing the packet.
+     * @param column_store The model's column store.
+     */
+    void ensureColumnsStored(capture_file *cap_file, PacketListColumnStore *column_store);
 
     /**
      * @brief Gets the underlying frame data.
@@ -114,13 +160,15 @@ public:
 
     /**
      * @brief Removes this specific record from the column text cache.
+     * @param column_store The model's column store.
      */
-    void invalidateRecord() { col_text_cache_.remove(fdata_->num); }
+    void invalidateRecord(PacketListColumnStore *column_store) { col_text_cache_.remove(fdata_->num); column_store->invalidate(fdata_->num); }
 
     /**
      * @brief Clears the column text cache for all records.
+     * @param column_store The model's column store.
      */
-    static void invalidateAllRecords() { col_text_cache_.clear(); }
+    static void invalidateAllRecords(PacketListColumnStore *column_store) { col_text_cache_.clear(); column_store->clear(); }
 
     /**
      * @brief Sets the maximum capacity of the column text cache.
@@ -135,8 +183,9 @@ public:
     /**
      * @brief Resets the columns configuration.
      * @param cinfo Pointer to the new column information.
+     * @param column_store The model's column store.
      */
-    static void resetColumns(column_info *cinfo);
+    static void resetColumns(column_info *cinfo, PacketListColumnStore *column_store);
 
     /**
      * @brief Increments the global color version to reset colorization for all.
@@ -204,16 +253,22 @@ private:
     /**
      * @brief Dissects the packet to evaluate columns and/or coloring.
      * @param cap_file The capture file containing the packet.
+     * @param column_store The model's column store.
      * @param dissect_columns True to run dissection for column data.
      * @param dissect_color True to run dissection for color filters.
+     * @param may_evict True if the column strings may evict other records
+     * from the column text cache.
      */
-    void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false);
+    void dissect(capture_file *cap_file, PacketListColumnStore *column_store, bool dissect_columns, bool dissect_color = false, bool may_evict = true);
 
     /**
-     * @brief Populates the cache with column strings based on the dissected packet.
+     * @brief Populates the caches with column strings based on the dissected packet.
      * @param cinfo Pointer to the column information structure.
+     * @param column_store The model's column store.
+     * @param may_evict True if the column strings may evict other records
+     * from the column text cache.
      */
-    void cacheColumnStrings(column_info *cinfo);
+    void cacheColumnStrings(column_info *cinfo, PacketListColumnStore *column_store, bool may_evict);
 };
 
 #endif // PACKET_LIST_RECORD_H
@@ -95,6 +95,19 @@ typedef struct blf_log_container {
     unsigned char  *real_data;        /* cache for decompressed data */
 } blf_log_container_t;
 
+/*
+ * A log container found ahead of the current one during the first pass,
+ * which is possibly still being decompressed by the inflate thread pool.
+ */
+typedef struct blf_readahead {
+    blf_log_container_t container;
+    unsigned char      *data;         /* compressed data, owned by the inflate thread */
+    unsigned            data_len;
+    bool                done;         /* protected by blf_t.readahead_mutex */
+    int                 err;
+    char               *err_info;
+} blf_readahead_t;
+
 typedef struct blf_data {
     int64_t     start_of_last_obj;
     int64_t     current_real_seek_pos;
@@ -103,6 +116,15 @@ typedef struct blf_data {
 
     GArray     *log_containers;
 
+    /* First pass read-ahead, see blf_fill_readahead() */
+    GThreadPool *inflate_pool;
+    GQueue      readahead;
+    GMutex      readahead_mutex;
+    GCond       readahead_cond;
+    bool        readahead_eof;
+    int         readahead_err;
+    char       *readahead_err_info;
+
     GHashTable *channel_to_iface_ht;
     GHashTable *channel_to_name_ht;
     uint32_t    next_interface_id;
@@ -969,26 +991,19 @@ blf_decompress_zlib(uint8_t *compressed_data, unsigned compressed_len, uint64_t
 }
 #endif /* USE_ZLIB_OR_ZLIBNG */
 
-/** Ensures the given log container is in memory
+/** Reads the data of the given log container
  *
- * If the log container already is not already in memory,
- * it reads it from the current seek position, allocating a
- * properly sized buffer.
+ * Reads the (possibly compressed) data of the container from the current
+ * seek position into a newly allocated buffer, or skips it if the
+ * container is empty; *data is NULL then.
  * The file offset must be set to the start of the container
  * data (container->infile_data_start) before calling this function.
  */
 static bool
-blf_pull_logcontainer_into_memory(blf_params_t *params, blf_log_container_t *container, int *err, char **err_info) {
-
-    if (container == NULL) {
-        *err = WTAP_ERR_INTERNAL;
-        *err_info = ws_strdup("blf_pull_logcontainer_into_memory called with NULL container");
-        return false;
-    }
+blf_read_logcontainer_data(blf_params_t *params, const blf_log_container_t *container, unsigned char **data, unsigned *data_len, int *err, char **err_info) {
 
-    if (container->real_data != NULL) {
-        return true;
-    }
+    *data = NULL;
+    *data_len = 0;
 
     /* pull compressed data into buffer */
     if (container->infile_start_pos < 0) {
@@ -1070,7 +1085,8 @@ blf_pull_logcontainer_into_memory(blf_params_t *params, blf_log_container_t *con
             }
             return false;
         }
-        container->real_data = buf;
+        *data = buf;
+        *data_len = (unsigned)data_length;
         return true;
 
     } else if (container->compression_method == BLF_COMPRESSION_ZLIB) {
@@ -1096,12 +1112,8 @@ blf_pull_logcontainer_into_memory(blf_params_t *params, blf_log_container_t *con
             }
             return false;
         }
-
-        container->real_data = blf_decompress_zlib(compressed_data, (unsigned)data_length, container->real_length, err, err_info);
-        g_free(compressed_data);
-        if (container->real_data == NULL) {
-            return false;
-        }
+        *data = compressed_data;
+        *data_len = (unsigned)data_length;
         return true;
 #else /* USE_ZLIB_OR_ZLIBNG */
         (void) params;
@@ -1114,26 +1126,77 @@ blf_pull_logcontainer_into_memory(blf_params_t *params, blf_log_container_t *con
     return false;
 }
 
+/** Sets the decompressed data of the given log container
+ *
+ * Takes ownership of the data read by blf_read_logcontainer_data().
+ * This doesn't do any I/O, so it can be called from another thread.
+ */
+static bool
+blf_inflate_logcontainer(blf_log_container_t *container, unsigned char *data, unsigned data_len, int *err, char **err_info) {
+    if (data == NULL) {
+        /* Empty container */
+        return true;
+    }
+
+#ifdef USE_ZLIB_OR_ZLIBNG
+    if (container->compression_method == BLF_COMPRESSION_ZLIB) {
+        container->real_data = blf_decompress_zlib(data, data_len, container->real_length, err, err_info);
+        g_free(data);
+        return container->real_data != NULL;
+    }
+#else
+    (void) data_len;
+    (void) err;
+    (void) err_info;
+#endif /* USE_ZLIB_OR_ZLIBNG */
+
+    container->real_data = data;
+    return true;
+}
+
+/** Ensures the given log container is in memory
+ *
+ * If the log container already is not already in memory,
+ * it reads it from the current seek position, allocating a
+ * properly sized buffer.
+ * The file offset must be set to the start of the container
+ * data (container->infile_data_start) before calling this function.
+ */
+static bool
+blf_pull_logcontainer_into_memory(blf_params_t *params, blf_log_container_t *container, int *err, char **err_info) {
+    unsigned char *data;
+    unsigned data_len;
+
+    if (container == NULL) {
+        *err = WTAP_ERR_INTERNAL;
+        *err_info = ws_strdup("blf_pull_logcontainer_into_memory called with NULL container");
+        return false;
+    }
+
+    if (container->real_data != NULL) {
+        return true;
+    }
+
+    if (!blf_read_logcontainer_data(params, container, &data, &data_len, err, err_info)) {
+        return false;
+    }
+
+    return blf_inflate_logcontainer(container, data, data_len, err, err_info);
+}
+
 /** Finds the next log container starting at the current file offset
  *
- * Adds the container to the containers array for later access
+ * Fills in everything but the real start position, which depends on
+ * the containers before it; see blf_append_logcontainer().
  */
 static bool
-blf_find_next_logcontainer(blf_params_t* params, int* err, char** err_info) {
+blf_find_logcontainer(blf_params_t* params, blf_log_container_t* container, int* err, char** err_info) {
     blf_blockheader_t           header;
     blf_logcontainerheader_t    logcontainer_header;
     blf_log_container_t         tmp;
     unsigned char*              header_ptr;
     unsigned int                i;
 
-    uint64_t current_real_start;
-    if (params->blf_data->log_containers->len == 0) {
-        current_real_start = 0;
-    } else {
-        const blf_log_container_t* container = &g_array_index(params->blf_data->log_containers, blf_log_container_t, params->blf_data->log_containers->len - 1);
-        current_real_start = container->real_start_pos + container->real_length;
-    }
-
     header_ptr = (unsigned char*)&header;
     i = 0;
 
@@ -1223,11 +1286,10 @@ blf_find_next_logcontainer(blf_params_t* params, int* err, char** err_info) {
         }
         tmp.infile_length = header.object_length;
 
-        tmp.real_start_pos = current_real_start;
         tmp.real_length = logcontainer_header.uncompressed_size;
         tmp.compression_method = logcontainer_header.compression_method;
 
-        ws_debug("found log container with real_pos=0x%" PRIx64 ", real_length=0x%" PRIx64, tmp.real_start_pos, tmp.real_length);
+        ws_debug("found log container with real_length=0x%" PRIx64, tmp.real_length);
     } else {
         ws_debug("found BLF object without log container");
 
@@ -1260,37 +1322,212 @@ blf_find_next_logcontainer(blf_params_t* params, int* err, char** err_info) {
         tmp.infile_data_start = tmp.infile_start_pos;
         tmp.infile_length = header.object_length;
 
-        tmp.real_start_pos = current_real_start;
         tmp.real_length = header.object_length;
         tmp.compression_method = BLF_COMPRESSION_NONE;
 
         tmp.real_data = buf;
 
-        ws_debug("found non-log-container object with real_pos=0x%" PRIx64 ", real_length=0x%" PRIx64, tmp.real_start_pos, tmp.real_length);
+        ws_debug("found non-log-container object with real_length=0x%" PRIx64, tmp.real_length);
     }
 
-    g_array_append_val(params->blf_data->log_containers, tmp);
+    *container = tmp;
 
     return true;
 }
 
+/** Adds the container to the containers array for later access
+ *
+ * The container is placed right after the last one in the real layout.
+ */
+static blf_log_container_t*
+blf_append_logcontainer(blf_t* blf, blf_log_container_t* container) {
+    if (blf->log_containers->len == 0) {
+        container->real_start_pos = 0;
+    } else {
+        const blf_log_container_t* last = &g_array_index(blf->log_containers, blf_log_container_t, blf->log_containers->len - 1);
+        container->real_start_pos = last->real_start_pos + last->real_length;
+    }
+
+    ws_debug("adding log container with real_pos=0x%" PRIx64 ", real_length=0x%" PRIx64, container->real_start_pos, container->real_length);
+
+    g_array_append_val(blf->log_containers, *container);
+
+    return &g_array_index(blf->log_containers, blf_log_container_t, blf->log_containers->len - 1);
+}
+
+/** Finds the next log container starting at the current file offset
+ *
+ * Adds the container to the containers array for later access
+ */
+static bool
+blf_find_next_logcontainer(blf_params_t* params, int* err, char** err_info) {
+    blf_log_container_t tmp;
+
+    if (!blf_find_logcontainer(params, &tmp, err, err_info)) {
+        return false;
+    }
+
+    blf_append_logcontainer(params->blf_data, &tmp);
+
+    return true;
+}
+
+/** Decompresses a read-ahead log container; runs in the inflate thread pool */
+static void
+blf_inflate_readahead(void *data, void *user_data) {
+    blf_readahead_t *job = (blf_readahead_t *)data;
+    blf_t           *blf = (blf_t *)user_data;
+    int              err = 0;
+    char            *err_info = NULL;
+
+    blf_inflate_logcontainer(&job->container, job->data, job->data_len, &err, &err_info);
+    job->data = NULL;
+
+    g_mutex_lock(&blf->readahead_mutex);
+    job->err = err;
+    job->err_info = err_info;
+    job->done = true;
+    g_cond_broadcast(&blf->readahead_cond);
+    g_mutex_unlock(&blf->readahead_mutex);
+}
+
+/** Reads log containers ahead of the current one in the first pass
+ *
+ * Reading the file stays sequential, but the compressed containers are
+ * handed to the inflate thread pool, so that they are decompressed in
+ * parallel while the records of the current container are processed.
+ */
+static void
+blf_fill_readahead(blf_params_t* params) {
+    blf_t   *blf = params->blf_data;
+    unsigned max_readahead = 2 * (unsigned)g_thread_pool_get_max_threads(blf->inflate_pool);
+
+    while (!blf->readahead_eof && g_queue_get_length(&blf->readahead) < max_readahead) {
+        blf_readahead_t *job = g_new0(blf_readahead_t, 1);
+
+        if (!blf_find_logcontainer(params, &job->container, &blf->readahead_err, &blf->readahead_err_info)) {
+            /* EOF or error; reported once the queued containers are used up. */
+            g_free(job);
+            blf->readahead_eof = true;
+            break;
+        }
+
+        g_queue_push_tail(&blf->readahead, job);
+
+        if (job->container.real_data != NULL) {
+            /* Lone object, already in memory */
+            job->done = true;
+            continue;
+        }
+
+        if (!blf_read_logcontainer_data(params, &job->container, &job->data, &job->data_len, &job->err, &job->err_info)) {
+            /*
+             * Reported when this container is reached; a short read
+             * means we're at EOF, and anything else ends the first pass
+             * anyway.
+             */
+            job->done = true;
+            blf->readahead_eof = true;
+            break;
+        }
+
+        if (job->data != NULL && job->container.compression_method == BLF_COMPRESSION_ZLIB) {
+            g_thread_pool_push(blf->inflate_pool, job, NULL);
+        } else {
+            blf_inflate_logcontainer(&job->container, job->data, job->data_len, &job->err, &job->err_info);
+            job->data = NULL;
+            job->done = true;
+        }
+    }
+}
+
+/** Takes the next log container from the read-ahead queue
+ *
+ * Waits for it to be decompressed and adds it to the containers array.
+ * Returns NULL at EOF or if finding the container failed; otherwise *err
+ * is set if reading or decompressing the container failed.
+ */
+static blf_log_container_t*
+blf_pull_readahead(blf_params_t* params, int* err, char** err_info) {
+    blf_t               *blf = params->blf_data;
+    blf_readahead_t     *job;
+    blf_log_container_t *container;
+
+    blf_fill_readahead(params);
+
+    job = (blf_readahead_t *)g_queue_pop_head(&blf->readahead);
+    if (job == NULL) {
+        *err = blf->readahead_err;
+        *err_info = blf->readahead_err_info;
+        blf->readahead_err = 0;
+        blf->readahead_err_info = NULL;
+        return NULL;
+    }
+
+    g_mutex_lock(&blf->readahead_mutex);
+    while (!job->done) {
+        g_cond_wait(&blf->readahead_cond, &blf->readahead_mutex);
+    }
+    g_mutex_unlock(&blf->readahead_mutex);
+
+    container = blf_append_logcontainer(blf, &job->container);
+    *err = job->err;
+    *err_info = job->err_info;
+    g_free(job);
+
+    return container;
+}
+
+/** Stops reading ahead and frees the containers that weren't used */
+static void
+blf_stop_readahead(blf_t* blf) {
+    blf_readahead_t *job;
+
+    if (blf->inflate_pool != NULL) {
+        /* Drop the pending jobs and wait for the running ones. */
+        g_thread_pool_free(blf->inflate_pool, TRUE, TRUE);
+        blf->inflate_pool = NULL;
+    }
+
+    while ((job = (blf_readahead_t *)g_queue_pop_head(&blf->readahead)) != NULL) {
+        g_free(job->data);
+        g_free(job->container.real_data);
+        g_free(job->err_info);
+        g_free(job);
+    }
+
+    g_free(blf->readahead_err_info);
+    blf->readahead_err_info = NULL;
+}
+
 static bool
 // NOLINTNEXTLINE(misc-no-recursion)
 blf_pull_next_logcontainer(blf_params_t* params, int* err, char** err_info) {
     blf_log_container_t* container;
+    bool pulled;
 
-    if (!blf_find_next_logcontainer(params, err, err_info)) {
-        return false;
-    }
+    if (params->blf_data->inflate_pool != NULL) {
+        container = blf_pull_readahead(params, err, err_info);
+        if (container == NULL) {
+            return false;
+        }
+        pulled = (*err == 0);
+    } else {
+        if (!blf_find_next_logcontainer(params, err, err_info)) {
+            return false;
+        }
 
-    /* Is there a next log container to pull? */
-    if (params->blf_data->log_containers->len == 0) {
-        /* No. */
-        return false;
+        /* Is there a next log container to pull? */
+        if (params->blf_data->log_containers->len == 0) {
+            /* No. */
+            return false;
+        }
+
+        container = &g_array_index(params->blf_data->log_containers, blf_log_container_t, params->blf_data->log_containers->len - 1);
+        pulled = blf_pull_logcontainer_into_memory(params, container, err, err_info);
     }
 
-    container = &g_array_index(params->blf_data->log_containers, blf_log_container_t, params->blf_data->log_containers->len - 1);
-    if (!blf_pull_logcontainer_into_memory(params, container, err, err_info)) {
+    if (!pulled) {
         if (*err == WTAP_ERR_DECOMPRESS || *err == WTAP_ERR_SHORT_READ) {
             report_warning("Error while decompressing BLF log container number %u (file pos. 0x%" PRIx64 "): %s",
                 params->blf_data->log_containers->len - 1, container->infile_start_pos, *err_info ? *err_info : "(none)");
@@ -3914,6 +4151,9 @@ static bool blf_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec, int *err,
 
 static void blf_free(blf_t *blf) {
     if (blf != NULL) {
+        blf_stop_readahead(blf);
+        g_mutex_clear(&blf->readahead_mutex);
+        g_cond_clear(&blf->readahead_cond);
         if (blf->log_containers != NULL) {
             for (unsigned i = 0; i < blf->log_containers->len; i++) {
                 blf_log_container_t* log_container = &g_array_index(blf->log_containers, blf_log_container_t, i);
@@ -3935,6 +4175,10 @@ static void blf_free(blf_t *blf) {
     }
 }
 
+static void blf_sequential_close(wtap *wth) {
+    blf_stop_readahead((blf_t *)wth->priv);
+}
+
 static void blf_close(wtap *wth) {
     blf_free((blf_t *)wth->priv);
 
@@ -3992,6 +4236,34 @@ blf_open(wtap *wth, int *err, char **err_info) {
     blf->start_offset_ns = blf_data_to_ns(&header.start_date);
     blf->end_offset_ns = blf_data_to_ns(&header.end_date);
 
+    blf->inflate_pool = NULL;
+    g_queue_init(&blf->readahead);
+    g_mutex_init(&blf->readahead_mutex);
+    g_cond_init(&blf->readahead_cond);
+    blf->readahead_eof = false;
+    blf->readahead_err = 0;
+    blf->readahead_err_info = NULL;
+#ifdef USE_ZLIB_OR_ZLIBNG
+    /*
+     * Most BLF files are zlib-compressed, and decompressing is the bulk
+     * of the work of the first pass; spread it over a few threads.
+     */
+    const char *s;
+    int32_t n;
+    unsigned num_processors = g_get_num_processors();
+    unsigned inflate_threads = num_processors > 1 ? MIN(num_processors, 8) : 0;
+
+    /* number of inflate threads, 0 to decompress in the reading thread */
+    if ((s = getenv("BLF_INFLATE_THREADS")) != NULL) {
+        if (ws_strtoi32(s, NULL, &n) && n >= 0 && n <= 64) {
+            inflate_threads = n;
+        }
+    }
+    if (inflate_threads > 0) {
+        blf->inflate_pool = g_thread_pool_new(blf_inflate_readahead, blf, inflate_threads, FALSE, NULL);
+    }
+#endif
+
     blf->channel_to_iface_ht = g_hash_table_new_full(g_int64_hash, g_int64_equal, &blf_free_key, &blf_free_channel_to_iface_entry);
     blf->channel_to_name_ht = g_hash_table_new_full(g_int64_hash, g_int64_equal, &blf_free_key, &blf_free_channel_to_name_entry);
     blf->next_interface_id = 0;
@@ -4006,6 +4278,7 @@ blf_open(wtap *wth, int *err, char **err_info) {
     wth->file_end_ts.nsecs = blf->end_offset_ns % (1000 * 1000 * 1000);
     wth->subtype_read = blf_read;
     wth->subtype_seek_read = blf_seek_read;
+    wth->subtype_sequential_close = blf_sequential_close;
     wth->subtype_close = blf_close;
     wth->file_type_subtype = blf_file_type_subtype;
 
@@ -968,6 +968,9 @@ wtap_open_offline(const char *filename, unsigned int type, int *err, char **err_
 	/* initialization */
 	wth->ispipe = ispipe;
 	wth->file_encap = WTAP_ENCAP_UNKNOWN;
+	wth->subtype_read_batch = NULL;
+	wth->supports_headers_only = false;
+	wth->headers_only = false;
 	wth->subtype_sequential_close = NULL;
 	wth->subtype_close = NULL;
 	wth->file_tsprec = WTAP_TSPREC_USEC;
@@ -1083,6 +1086,22 @@ wtap_fdreopen(wtap *wth, const char *filename, int *err)
 	return true;
 }
 
+/*
+ * Give the random stream of a handle inherited across fork() a file
+ * descriptor of its own, so that reads in the child don't move the file
+ * offset of the parent's, and other children's, descriptor.
+ */
+bool
+wtap_fdreopen_inherited(wtap *wth, int *err)
+{
+	errno = WTAP_ERR_CANT_OPEN;
+	if (!file_fdreopen_inherited(wth->random_fh, wth->pathname)) {
+		*err = errno;
+		return false;
+	}
+	return true;
+}
+
 /* Table of the file types and subtypes for which we have support. */
 
 /*
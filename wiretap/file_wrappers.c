@@ -28,6 +28,10 @@
 #include <wsutil/zlib_compat.h>
 #include <wsutil/file_compressed.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif /* HAVE_MMAP */
+
 #ifdef HAVE_ZSTD
 #include <zstd.h>
 #endif /* HAVE_ZSTD */
@@ -48,6 +52,19 @@ wtap_get_compression_type(wtap *wth)
 	return file_get_compression_type((wth->fh == NULL) ? wth->random_fh : wth->fh);
 }
 
+#ifdef HAVE_MMAP
+/* Map the files we open?  See wtap_set_file_mapping(). */
+static bool map_files;
+#endif /* HAVE_MMAP */
+
+void
+wtap_set_file_mapping(bool enable _U_)
+{
+#ifdef HAVE_MMAP
+	map_files = enable;
+#endif /* HAVE_MMAP */
+}
+
 /* #define GZBUFSIZE 8192 */
 #define GZBUFSIZE 4096
 #define LZ4BUFSIZE 4194304 // 4MiB, maximum block size
@@ -139,6 +156,13 @@ struct wtap_reader {
     /* fast seeking */
     GPtrArray *fast_seek;
     void *fast_seek_cur;
+
+#ifdef HAVE_MMAP
+    /* mapping of the file, for uncompressed data */
+    uint8_t *map;               /* start of the mapping, or NULL if not mapped */
+    int64_t map_size;           /* size of the mapping */
+    uint8_t *out_buf;           /* allocated output buffer, while out points into the mapping */
+#endif /* HAVE_MMAP */
 };
 
 /* Current read offset within a buffer. */
@@ -385,9 +409,128 @@ fast_seek_reset(FILE_T state)
     }
 }
 
+/* Is the output buffer pointing into the mapping? */
+static bool
+out_is_mapped(FILE_T state _U_)
+{
+#ifdef HAVE_MMAP
+    return state->out.buf != state->out_buf;
+#else /* HAVE_MMAP */
+    return false;
+#endif /* HAVE_MMAP */
+}
+
+#ifdef HAVE_MMAP
+/*
+ * Map a regular file, so that uncompressed data can be delivered from
+ * the mapping rather than read into the output buffer.  If the file
+ * can't be mapped, we just read it.
+ *
+ * The mapping covers the file as it was when it was mapped; anything
+ * appended to it later, e.g. by a capture that's still running, is
+ * read with ws_read() once we reach the end of the mapping.  A file
+ * that's truncated while it's mapped gets us SIGBUS, so this is only
+ * done if the program asked for it with wtap_set_file_mapping().
+ */
+static void
+file_map(FILE_T state)
+{
+    ws_statb64 st;
+    void *map;
+
+    state->map = NULL;
+    state->map_size = 0;
+    if (!map_files)
+        return;
+    if (ws_fstat64(state->fd, &st) == -1 || !S_ISREG(st.st_mode))
+        return;
+    if (st.st_size <= 0 || (uint64_t)st.st_size > SIZE_MAX)
+        return;
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, state->fd, 0);
+    if (map == MAP_FAILED)
+        return;
+#ifdef HAVE_POSIX_MADVISE
+    /* Until file_set_random_access() says otherwise, read ahead. */
+    (void)posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif /* HAVE_POSIX_MADVISE */
+    state->map = (uint8_t *)map;
+    state->map_size = st.st_size;
+}
+
+/*
+ * Point the output buffer back at the allocated buffer, discarding
+ * what's left of the mapped data; the raw position goes back to the
+ * first discarded byte.
+ */
+static void
+unmap_out_buffer(FILE_T state)
+{
+    if (out_is_mapped(state)) {
+        state->raw_pos -= state->out.avail;
+        state->out.buf = state->out_buf;
+        buf_reset(&state->out);
+    }
+}
+
+static void
+file_unmap(FILE_T state)
+{
+    unmap_out_buffer(state);
+    if (state->map != NULL) {
+        munmap(state->map, (size_t)state->map_size);
+        state->map = NULL;
+        state->map_size = 0;
+    }
+}
+
+/*
+ * Deliver uncompressed data straight from the mapping, by pointing the
+ * output buffer at the data following the current raw position.  That
+ * saves a read() and a copy for each buffer's worth of data, and lets
+ * seeks within up to MAX_READ_BUF_SIZE bytes be done without any I/O.
+ *
+ * Returns false if the raw position is at or past the end of the mapping.
+ */
+static bool
+mapped_fill_out_buffer(FILE_T state)
+{
+    int64_t left;
+
+    if (state->raw_pos >= state->map_size)
+        return false;
+    left = state->map_size - state->raw_pos;
+    state->out.buf = state->map + state->raw_pos;
+    state->out.next = state->out.buf;
+    state->out.avail = left > MAX_READ_BUF_SIZE ? MAX_READ_BUF_SIZE : (unsigned)left;
+    state->raw_pos += state->out.avail;
+    return true;
+}
+#endif /* HAVE_MMAP */
+
 static bool
 uncompressed_fill_out_buffer(FILE_T state)
 {
+#ifdef HAVE_MMAP
+    if (state->map != NULL && !state->is_compressed) {
+        if (mapped_fill_out_buffer(state))
+            return true;
+
+        /*
+         * We're past the end of the mapping; if we were delivering
+         * data from it, the file descriptor isn't at the raw position,
+         * so move it there and read into the allocated buffer again.
+         */
+        if (out_is_mapped(state)) {
+            state->out.buf = state->out_buf;
+            buf_reset(&state->out);
+            if (ws_lseek64(state->fd, state->raw_pos, SEEK_SET) == -1) {
+                state->err = errno;
+                state->err_info = NULL;
+                return false;
+            }
+        }
+    }
+#endif /* HAVE_MMAP */
     if (buf_read(state, &state->out) < 0)
         return false;
     return true;
@@ -1281,6 +1424,14 @@ static compression_type_test const compression_type_tests[] = {
 static int
 check_for_compression(FILE_T state)
 {
+#ifdef HAVE_MMAP
+    /*
+     * We may copy data into the output buffer below, so it mustn't
+     * point into the mapping.  (There's no data left in it.)
+     */
+    unmap_out_buffer(state);
+
+#endif /* HAVE_MMAP */
     /*
      * If this isn't the first frame / compressed stream, ensure that
      * we're starting at the beginning of the buffer. This shouldn't
@@ -1465,6 +1616,9 @@ gz_skip(FILE_T state, int64_t len)
 static void
 gz_reset(FILE_T state)
 {
+#ifdef HAVE_MMAP
+    state->out.buf = state->out_buf; /* not delivering from the mapping */
+#endif /* HAVE_MMAP */
     buf_reset(&state->out);       /* no output data available */
     state->eof = false;           /* not at end of file */
     state->compression = UNKNOWN; /* look for compression header */
@@ -1606,6 +1760,9 @@ file_fdopen(int fd)
     state->in.next = state->in.buf;
     state->in.avail = 0;
     state->out.buf = (unsigned char *)g_try_malloc(want << 1);
+#ifdef HAVE_MMAP
+    state->out_buf = state->out.buf;
+#endif /* HAVE_MMAP */
     state->out.next = state->out.buf;
     state->out.avail = 0;
     state->size = want;
@@ -1642,6 +1799,10 @@ file_fdopen(int fd)
     }
 #endif /* HAVE_LZ4FRAME_H */
 
+#ifdef HAVE_MMAP
+    file_map(state);
+#endif /* HAVE_MMAP */
+
     /* return stream */
     return state;
 
@@ -1718,6 +1879,11 @@ void
 file_set_random_access(FILE_T stream, bool random_flag _U_, GPtrArray *seek)
 {
     stream->fast_seek = seek;
+#if defined(HAVE_MMAP) && defined(HAVE_POSIX_MADVISE)
+    /* Reads will be all over the file, so reading ahead is wasted. */
+    if (random_flag && stream->map != NULL)
+        (void)posix_madvise(stream->map, (size_t)stream->map_size, POSIX_MADV_RANDOM);
+#endif /* HAVE_MMAP && HAVE_POSIX_MADVISE */
 }
 
 int64_t
@@ -1888,7 +2054,10 @@ file_seek(FILE_T file, int64_t offset, int whence, int *err)
             break;
         }
 
-        if (ws_lseek64(file->fd, off, SEEK_SET) == -1) {
+        /* If we're delivering uncompressed data from the mapping,
+           the next read will come from there, so don't bother. */
+        if (!(here->compression == UNCOMPRESSED && out_is_mapped(file)) &&
+            ws_lseek64(file->fd, off, SEEK_SET) == -1) {
             *err = errno;
             return -1;
         }
@@ -2020,9 +2189,12 @@ file_seek(FILE_T file, int64_t offset, int whence, int *err)
         && (file->fast_seek != NULL))
     {
         /*
-         * Yes.  Just seek there within the file.
+         * Yes.  Just seek there within the file.  (If we're delivering
+         * data from the mapping, the next read will come from there,
+         * so there's nothing to seek.)
          */
-        if (ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
+        if (!out_is_mapped(file) &&
+            ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
             *err = errno;
             return -1;
         }
@@ -2413,6 +2585,36 @@ file_fdreopen(FILE_T file, const char *path)
 
     if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
         return false;
+#ifdef HAVE_MMAP
+    /* The mapping is of the old file; map the new one instead. */
+    file_unmap(file);
+#endif /* HAVE_MMAP */
+    file->fd = fd;
+#ifdef HAVE_MMAP
+    file_map(file);
+#endif /* HAVE_MMAP */
+    return true;
+}
+
+bool
+file_fdreopen_inherited(FILE_T file, const char *path)
+{
+    int fd;
+
+    if ((fd = ws_open(path, O_RDONLY|O_BINARY, 0000)) == -1)
+        return false;
+    /* Buffered reads and relative seeks continue at raw_pos without
+       seeking, so put the new descriptor there. A mapping, if any, is
+       of the same file and stays. */
+    if (ws_lseek64(fd, file->raw_pos, SEEK_SET) == -1) {
+        int err = errno;
+
+        ws_close(fd);
+        errno = err;
+        return false;
+    }
+    if (file->fd != -1)
+        ws_close(file->fd);
     file->fd = fd;
     return true;
 }
@@ -2422,6 +2624,10 @@ file_close(FILE_T file)
 {
     int fd = file->fd;
 
+#ifdef HAVE_MMAP
+    file_unmap(file);
+#endif /* HAVE_MMAP */
+
     /* free memory and close file */
     if (file->size) {
 #ifdef USE_ZLIB_OR_ZLIBNG
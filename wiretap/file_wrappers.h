@@ -192,6 +192,20 @@ extern void file_fdclose(FILE_T file);
  */
 extern bool file_fdreopen(FILE_T file, const char *path);
 
+/**
+ * @brief Give a stream still in use its own file descriptor.
+ *
+ * For a stream inherited across fork(), whose descriptor, and so file
+ * offset, is shared with the parent. Unlike file_fdreopen(), the new
+ * descriptor is positioned where the old one is, so reading continues
+ * where it left off.
+ *
+ * @param file The stream.
+ * @param path The path of the file the stream is reading.
+ * @return true if the file was successfully reopened, false otherwise.
+ */
+extern bool file_fdreopen_inherited(FILE_T file, const char *path);
+
 /**
  * @brief Close a file stream.
  *
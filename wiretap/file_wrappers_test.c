@@ -0,0 +1,225 @@
+/* file_wrappers_test.c
+ * Tests for reading uncompressed files through file_wrappers.c, with
+ * and without a memory mapping.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "wtap.h"
+#include "file_wrappers.h"
+
+#define FILE_SIZE   (256 * 1024)
+#define APPEND_SIZE (64 * 1024)
+
+/* The byte at a given offset in the test file. */
+static uint8_t
+byte_at(int64_t offset)
+{
+    return (uint8_t)((offset * 7) ^ (offset >> 8));
+}
+
+static void
+append_bytes(const char *path, int64_t offset, int64_t count)
+{
+    FILE *fp = ws_fopen(path, offset == 0 ? "wb" : "ab");
+    g_assert_nonnull(fp);
+    for (int64_t i = offset; i < offset + count; i++) {
+        g_assert_cmpint(fputc(byte_at(i), fp), !=, EOF);
+    }
+    g_assert_cmpint(fclose(fp), ==, 0);
+}
+
+static char *
+make_file(int64_t size)
+{
+    GError *error = NULL;
+    char *path = NULL;
+    int fd = g_file_open_tmp("file_wrappers_test_XXXXXX", &path, &error);
+
+    g_assert_no_error(error);
+    ws_close(fd);
+    append_bytes(path, 0, size);
+    return path;
+}
+
+/* Read count bytes and check that they're the ones at offset. */
+static void
+check_read(FILE_T fh, int64_t offset, unsigned count)
+{
+    uint8_t *buf = (uint8_t *)g_malloc(count);
+
+    g_assert_cmpint(file_tell(fh), ==, offset);
+    g_assert_cmpint(file_read(buf, count, fh), ==, (int)count);
+    for (unsigned i = 0; i < count; i++) {
+        if (buf[i] != byte_at(offset + i)) {
+            g_assert_cmphex(buf[i], ==, byte_at(offset + i));
+        }
+    }
+    g_assert_cmpint(file_tell(fh), ==, offset + count);
+    g_free(buf);
+}
+
+static void
+check_eof(FILE_T fh)
+{
+    uint8_t c;
+
+    g_assert_cmpint(file_read(&c, 1, fh), ==, 0);
+    g_assert_true(file_eof(fh));
+    g_assert_cmpint(file_error(fh, NULL), ==, 0);
+}
+
+static void
+check_seek(FILE_T fh, int64_t offset, int whence, int64_t expected)
+{
+    int err = 0;
+
+    g_assert_cmpint(file_seek(fh, offset, whence, &err), ==, expected);
+    g_assert_cmpint(err, ==, 0);
+}
+
+static void
+test_sequential(const void *data)
+{
+    char *path = make_file(FILE_SIZE);
+    FILE_T fh;
+
+    wtap_set_file_mapping(GPOINTER_TO_INT(data));
+    fh = file_open(path);
+    g_assert_nonnull(fh);
+    g_assert_false(file_iscompressed(fh));
+
+    /* Odd sizes, so that reads straddle buffer boundaries. */
+    for (int64_t offset = 0; offset < FILE_SIZE; ) {
+        unsigned count = (unsigned)MIN(4093, FILE_SIZE - offset);
+        check_read(fh, offset, count);
+        offset += count;
+    }
+    check_eof(fh);
+
+    file_close(fh);
+    ws_unlink(path);
+    g_free(path);
+}
+
+static void
+test_seek(const void *data)
+{
+    char *path = make_file(FILE_SIZE);
+    GPtrArray *fast_seek = g_ptr_array_new_with_free_func(g_free);
+    FILE_T fh;
+
+    wtap_set_file_mapping(GPOINTER_TO_INT(data));
+    fh = file_open(path);
+    g_assert_nonnull(fh);
+
+    /* Without fast seek points: forward skips and rewinds. */
+    check_read(fh, 0, 100);
+    check_seek(fh, 1000, SEEK_CUR, 1100);
+    check_read(fh, 1100, 100);
+    check_seek(fh, 10, SEEK_SET, 10);
+    check_read(fh, 10, 5000);
+    check_seek(fh, FILE_SIZE - 50, SEEK_SET, FILE_SIZE - 50);
+    check_read(fh, FILE_SIZE - 50, 50);
+    check_eof(fh);
+
+    /* With them, as for the random-access handle. */
+    file_set_random_access(fh, true, fast_seek);
+    check_seek(fh, 12345, SEEK_SET, 12345);
+    check_read(fh, 12345, 1);
+    check_seek(fh, 100000, SEEK_CUR, 112346);
+    check_read(fh, 112346, 20000);
+    check_seek(fh, 3, SEEK_SET, 3);
+    check_read(fh, 3, FILE_SIZE - 3);
+    check_eof(fh);
+
+    /* Seeking past the end succeeds, reading there doesn't. */
+    check_seek(fh, FILE_SIZE + 100, SEEK_SET, FILE_SIZE + 100);
+    check_eof(fh);
+
+    file_close(fh);
+    g_ptr_array_free(fast_seek, true);
+    ws_unlink(path);
+    g_free(path);
+}
+
+static void
+test_append(const void *data)
+{
+    char *path = make_file(FILE_SIZE);
+    GPtrArray *fast_seek = g_ptr_array_new_with_free_func(g_free);
+    FILE_T fh;
+
+    wtap_set_file_mapping(GPOINTER_TO_INT(data));
+    fh = file_open(path);
+    g_assert_nonnull(fh);
+    file_set_random_access(fh, true, fast_seek);
+
+    /* Read to the end, then have the file grow, as a live capture does. */
+    check_read(fh, 0, FILE_SIZE);
+    check_eof(fh);
+    append_bytes(path, FILE_SIZE, APPEND_SIZE);
+    file_clearerr(fh);
+    check_read(fh, FILE_SIZE, APPEND_SIZE);
+    check_eof(fh);
+
+    /* Seek back and read across the end of what was there at first. */
+    check_seek(fh, FILE_SIZE - 1000, SEEK_SET, FILE_SIZE - 1000);
+    check_read(fh, FILE_SIZE - 1000, 2000);
+    check_seek(fh, 500, SEEK_SET, 500);
+    check_read(fh, 500, FILE_SIZE + APPEND_SIZE - 500);
+    check_eof(fh);
+
+    /* And straight into the appended data. */
+    check_seek(fh, FILE_SIZE + 10, SEEK_SET, FILE_SIZE + 10);
+    check_read(fh, FILE_SIZE + 10, 100);
+
+    file_close(fh);
+    g_ptr_array_free(fast_seek, true);
+    ws_unlink(path);
+    g_free(path);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_data_func("/file_wrappers/read/sequential", GINT_TO_POINTER(false), test_sequential);
+    g_test_add_data_func("/file_wrappers/read/seek", GINT_TO_POINTER(false), test_seek);
+    g_test_add_data_func("/file_wrappers/read/append", GINT_TO_POINTER(false), test_append);
+    g_test_add_data_func("/file_wrappers/mapped/sequential", GINT_TO_POINTER(true), test_sequential);
+    g_test_add_data_func("/file_wrappers/mapped/seek", GINT_TO_POINTER(true), test_seek);
+    g_test_add_data_func("/file_wrappers/mapped/append", GINT_TO_POINTER(true), test_append);
+
+    ret = g_test_run();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -78,6 +78,9 @@ static try_record_ret_t libpcap_try_record(wtap *wth, pcap_variant_t variant,
 
 static bool libpcap_read(wtap *wth, wtap_rec *rec,
     int *err, char **err_info, int64_t *data_offset);
+static bool libpcap_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs,
+    size_t max_bytes, unsigned *n_recs, int *err, char **err_info,
+    int64_t *offsets);
 static bool libpcap_seek_read(wtap *wth, int64_t seek_off,
     wtap_rec *rec, int *err, char **err_info);
 static bool libpcap_read_packet(wtap *wth, FILE_T fh,
@@ -351,6 +354,8 @@ wtap_open_return_val libpcap_open(wtap *wth, int *err, char **err_info)
 
 	/* This is a libpcap file */
 	wth->subtype_read = libpcap_read;
+	wth->subtype_read_batch = libpcap_read_batch;
+	wth->supports_headers_only = true;
 	wth->subtype_seek_read = libpcap_seek_read;
 	wth->subtype_close = libpcap_close;
 	wth->snapshot_length = hdr.snaplen;
@@ -1291,6 +1296,28 @@ static bool libpcap_read(wtap *wth, wtap_rec *rec,
 	return libpcap_read_packet(wth, wth->fh, rec, err, err_info);
 }
 
+/* Read packets until we've read max_recs of them or max_bytes of data */
+static bool libpcap_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs,
+    size_t max_bytes, unsigned *n_recs, int *err, char **err_info,
+    int64_t *offsets)
+{
+	size_t bytes = 0;
+	unsigned n;
+
+	for (n = 0; n < max_recs; n++) {
+		if (max_bytes != 0 && bytes >= max_bytes)
+			break;
+		offsets[n] = file_tell(wth->fh);
+		if (!libpcap_read_packet(wth, wth->fh, &recs[n], err, err_info)) {
+			*n_recs = n;
+			return false;
+		}
+		bytes += ws_buffer_length(&recs[n].data);
+	}
+	*n_recs = n;
+	return true;
+}
+
 static bool
 libpcap_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec,
     int *err, char **err_info)
@@ -1414,7 +1441,9 @@ libpcap_read_packet(wtap *wth, FILE_T fh, wtap_rec *rec,
 	/*
 	 * Read the packet data.
 	 */
-	if (!wtap_read_bytes_buffer(fh, &rec->data, rec->rec_header.packet_header.caplen, err, err_info))
+	if (!pcap_read_packet_data(wth, fh, wth->file_encap,
+	    libpcap->byte_swapped, rec, rec->rec_header.packet_header.caplen,
+	    err, err_info))
 		return false;	/* failed */
 
 	pcap_read_post_process(is_nokia, wth->file_encap, rec,
@@ -2712,6 +2712,40 @@ pcap_read_post_process(bool is_nokia, int wtap_encap,
 	}
 }
 
+/*
+ * Does pcap_read_post_process() look at, or change, the packet data
+ * of records with this encapsulation?
+ */
+static bool
+pcap_post_process_needs_data(int wtap_encap, bool bytes_swapped)
+{
+	switch (wtap_encap) {
+
+	case WTAP_ENCAP_ATM_PDUS:
+	case WTAP_ENCAP_USB_LINUX_MMAPPED:
+		return true;
+
+	case WTAP_ENCAP_SLL:
+	case WTAP_ENCAP_SLL2:
+	case WTAP_ENCAP_USB_LINUX:
+	case WTAP_ENCAP_NFLOG:
+	case WTAP_ENCAP_PFLOG:
+		return bytes_swapped;
+	}
+	return false;
+}
+
+bool
+pcap_read_packet_data(wtap *wth, FILE_T fh, int wtap_encap,
+    bool bytes_swapped, wtap_rec *rec, unsigned len, int *err,
+    char **err_info)
+{
+	if (wth->headers_only && fh == wth->fh &&
+	    !pcap_post_process_needs_data(wtap_encap, bytes_swapped))
+		return wtap_read_bytes(fh, NULL, len, err, err_info);
+	return wtap_read_bytes_buffer(fh, &rec->data, len, err, err_info);
+}
+
 bool
 wtap_encap_requires_phdr(int wtap_encap)
 {
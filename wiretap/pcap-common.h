@@ -64,6 +64,28 @@ extern int pcap_process_pseudo_header(FILE_T fh, bool is_nokia,
 extern void pcap_read_post_process(bool is_nokia, int wtap_encap,
     wtap_rec *rec, bool bytes_swapped, int fcs_len);
 
+/**
+ * @brief Reads the packet data of a pcap or pcapng packet record.
+ *
+ * The data is read into the record's buffer or, if this is a sequential
+ * read for a caller that asked for headers only with wtap_set_headers_only()
+ * and pcap_read_post_process() doesn't need the data, skipped.
+ *
+ * @param wth          Wiretap handle.
+ * @param fh           File handle the record is being read from.
+ * @param wtap_encap   Wiretap encapsulation type for this packet.
+ * @param bytes_swapped @c true if the file was written by a host with
+ *                     the opposite byte order.
+ * @param rec          wtap record structure to read the data into.
+ * @param len          Number of bytes of packet data.
+ * @param err          Pointer to store an error code on failure.
+ * @param err_info     Pointer to store additional error information on failure.
+ * @return @c true on success, @c false on error or end of file.
+ */
+extern bool pcap_read_packet_data(wtap *wth, FILE_T fh, int wtap_encap,
+    bool bytes_swapped, wtap_rec *rec, unsigned len, int *err,
+    char **err_info);
+
 /**
  * @brief Retrieves the size of the pseudo-header for a given encapsulation type and pseudo-header.
  *
@@ -48,6 +48,10 @@ static bool
 pcapng_read(wtap *wth, wtap_rec *rec, int *err,
             char **err_info, int64_t *data_offset);
 static bool
+pcapng_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs,
+                  size_t max_bytes, unsigned *n_recs, int *err,
+                  char **err_info, int64_t *offsets);
+static bool
 pcapng_seek_read(wtap *wth, int64_t seek_off,
                  wtap_rec *rec, int *err, char **err_info);
 static void
@@ -2023,7 +2027,7 @@ pcapng_process_packet_block_option(wtapng_block_t *wblock,
 }
 
 static bool
-pcapng_read_packet_block(wtap *wth _U_, FILE_T fh, uint32_t block_type,
+pcapng_read_packet_block(wtap *wth, FILE_T fh, uint32_t block_type,
                          uint32_t block_content_length,
                          section_info_t *section_info,
                          wtapng_block_t *wblock,
@@ -2261,8 +2265,9 @@ pcapng_read_packet_block(wtap *wth _U_, FILE_T fh, uint32_t block_type,
     wblock->rec->ts.secs = (time_t)(wblock->rec->ts.secs + iface_info.tsoffset);
 
     /* "(Enhanced) Packet Block" read capture data */
-    if (!wtap_read_bytes_buffer(fh, &wblock->rec->data,
-                                packet.cap_len - pseudo_header_len, err, err_info))
+    if (!pcap_read_packet_data(wth, fh, iface_info.wtap_encap,
+                               section_info->byte_swapped, wblock->rec,
+                               packet.cap_len - pseudo_header_len, err, err_info))
         return false;
     block_read += packet.cap_len - pseudo_header_len;
 
@@ -2324,7 +2329,7 @@ pcapng_read_packet_block(wtap *wth _U_, FILE_T fh, uint32_t block_type,
 
 
 static bool
-pcapng_read_simple_packet_block(wtap *wth _U_, FILE_T fh,
+pcapng_read_simple_packet_block(wtap *wth, FILE_T fh,
                                 uint32_t block_type _U_,
                                 uint32_t block_content_length,
                                 section_info_t *section_info,
@@ -2449,8 +2454,9 @@ pcapng_read_simple_packet_block(wtap *wth _U_, FILE_T fh,
     }
 
     /* "Simple Packet Block" read capture data */
-    if (!wtap_read_bytes_buffer(fh, &wblock->rec->data,
-                                simple_packet.cap_len - pseudo_header_len, err, err_info))
+    if (!pcap_read_packet_data(wth, fh, iface_info.wtap_encap,
+                               section_info->byte_swapped, wblock->rec,
+                               simple_packet.cap_len - pseudo_header_len, err, err_info))
         return false;
 
     /* jump over potential padding bytes at end of the packet data */
@@ -3681,6 +3687,8 @@ pcapng_open(wtap *wth, int *err, char **err_info)
     g_array_append_val(pcapng->sections, first_section);
 
     wth->subtype_read = pcapng_read;
+    wth->subtype_read_batch = pcapng_read_batch;
+    wth->supports_headers_only = true;
     wth->subtype_seek_read = pcapng_seek_read;
     wth->subtype_close = pcapng_close;
     wth->file_type_subtype = pcapng_file_type_subtype;
@@ -3839,6 +3847,28 @@ pcapng_read(wtap *wth, wtap_rec *rec, int *err, char **err_info,
     return true;
 }
 
+/* classic wtap: read blocks until we have max_recs records or max_bytes of data */
+static bool
+pcapng_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs,
+                  size_t max_bytes, unsigned *n_recs, int *err,
+                  char **err_info, int64_t *offsets)
+{
+    size_t bytes = 0;
+    unsigned n;
+
+    for (n = 0; n < max_recs; n++) {
+        if (max_bytes != 0 && bytes >= max_bytes)
+            break;
+        if (!pcapng_read(wth, &recs[n], err, err_info, &offsets[n])) {
+            *n_recs = n;
+            return false;
+        }
+        bytes += ws_buffer_length(&recs[n].data);
+    }
+    *n_recs = n;
+    return true;
+}
+
 /* classic wtap: seek to file position and read packet */
 static bool
 pcapng_seek_read(wtap *wth, int64_t seek_off, wtap_rec *rec,
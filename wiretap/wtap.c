@@ -1860,38 +1860,39 @@ wtap_setup_custom_block_rec(wtap_rec *rec, uint32_t pen,
 	rec->rec_header.custom_block_header.copy_allowed = copy_allowed;
 }
 
-bool
-wtap_read(wtap *wth, wtap_rec *rec, int *err, char **err_info, int64_t *offset)
+/*
+ * Clean up after a read routine failed to read a record, either because
+ * of an error or because it reached the end of the file.
+ */
+static void
+wtap_read_failed(wtap *wth, wtap_rec *rec, int *err, char **err_info)
 {
 	/*
-	 * Reset the record to default values.
+	 * If we didn't get an error indication, we read
+	 * the last packet.  See if there's any deferred
+	 * error, as might, for example, occur if we're
+	 * reading a compressed file, and we got an error
+	 * reading compressed data from the file, but
+	 * got enough compressed data to decompress the
+	 * last packet of the file.
 	 */
-	wtap_reset_rec(wth, rec);
-
-	*err = 0;
-	*err_info = NULL;
-	if (!wth->subtype_read(wth, rec, err, err_info, offset)) {
+	if (*err == 0)
+		*err = file_error(wth->fh, err_info);
+	if (rec->block != NULL) {
 		/*
-		 * If we didn't get an error indication, we read
-		 * the last packet.  See if there's any deferred
-		 * error, as might, for example, occur if we're
-		 * reading a compressed file, and we got an error
-		 * reading compressed data from the file, but
-		 * got enough compressed data to decompress the
-		 * last packet of the file.
+		 * Unreference any block created for this record.
 		 */
-		if (*err == 0)
-			*err = file_error(wth->fh, err_info);
-		if (rec->block != NULL) {
-			/*
-			 * Unreference any block created for this record.
-			 */
-			wtap_block_unref(rec->block);
-			rec->block = NULL;
-		}
-		return false;	/* failure */
+		wtap_block_unref(rec->block);
+		rec->block = NULL;
 	}
+}
 
+/*
+ * Sanity-check a record that a read routine has read.
+ */
+static void
+wtap_read_check_rec(wtap *wth, wtap_rec *rec)
+{
 	/*
 	 * Is this a packet record?
 	 */
@@ -1929,7 +1930,11 @@ wtap_read(wtap *wth, wtap_rec *rec, int *err, char **err_info, int64_t *offset)
 		cap_len = 0;
 	}
 
-	if (cap_len > ws_buffer_length(&rec->data)) {
+	/*
+	 * If our caller asked for headers only, the file type may have
+	 * skipped the data.
+	 */
+	if (!wth->headers_only && cap_len > ws_buffer_length(&rec->data)) {
 		/* XXX - fdata->cap_len *should* match ws_buffer_length(&rec->data),
 		 * if the record was set up correctly. Why not just use that? Some
 		 * wiretap modules, including some of the main distribution until
@@ -1948,10 +1953,92 @@ wtap_read(wtap *wth, wtap_rec *rec, int *err, char **err_info, int64_t *offset)
 		 * space. */
 		ws_buffer_assure_space((Buffer *)&rec->data, cap_len - ws_buffer_length(&rec->data));
 	}
+}
+
+bool
+wtap_read(wtap *wth, wtap_rec *rec, int *err, char **err_info, int64_t *offset)
+{
+	/*
+	 * Reset the record to default values.
+	 */
+	wtap_reset_rec(wth, rec);
+
+	*err = 0;
+	*err_info = NULL;
+	if (!wth->subtype_read(wth, rec, err, err_info, offset)) {
+		wtap_read_failed(wth, rec, err, err_info);
+		return false;	/* failure */
+	}
 
+	wtap_read_check_rec(wth, rec);
 	return true;	/* success */
 }
 
+bool
+wtap_set_headers_only(wtap *wth, bool headers_only)
+{
+	if (headers_only && !wth->supports_headers_only)
+		return false;
+	wth->headers_only = headers_only;
+	return true;
+}
+
+unsigned
+wtap_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs, size_t max_bytes,
+    int *err, char **err_info, int64_t *offsets)
+{
+	unsigned n_recs;
+	bool ok;
+
+	*err = 0;
+	*err_info = NULL;
+	if (max_recs == 0)
+		return 0;
+
+	if (wth->subtype_read_batch != NULL) {
+		/*
+		 * Reset the records to default values, and let the file
+		 * type read them all at once.
+		 */
+		for (unsigned i = 0; i < max_recs; i++)
+			wtap_reset_rec(wth, &recs[i]);
+		n_recs = 0;
+		ok = wth->subtype_read_batch(wth, recs, max_recs, max_bytes,
+		    &n_recs, err, err_info, offsets);
+	} else {
+		/*
+		 * Read them one at a time.
+		 */
+		size_t bytes = 0;
+
+		ok = true;
+		for (n_recs = 0; n_recs < max_recs; n_recs++) {
+			if (max_bytes != 0 && bytes >= max_bytes)
+				break;
+			wtap_reset_rec(wth, &recs[n_recs]);
+			if (!wth->subtype_read(wth, &recs[n_recs], err, err_info,
+			    &offsets[n_recs])) {
+				ok = false;
+				break;
+			}
+			bytes += ws_buffer_length(&recs[n_recs].data);
+		}
+	}
+
+	/*
+	 * If the read stopped because of an error or the end of the
+	 * file, recs[n_recs] is the record it failed to read.
+	 */
+	if (!ok) {
+		ws_assert(n_recs < max_recs);
+		wtap_read_failed(wth, &recs[n_recs], err, err_info);
+	}
+
+	for (unsigned i = 0; i < n_recs; i++)
+		wtap_read_check_rec(wth, &recs[i]);
+	return n_recs;
+}
+
 /*
  * Read a given number of bytes from a file into a buffer or, if
  * buf is NULL, just discard them.
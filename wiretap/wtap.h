@@ -2234,6 +2234,60 @@ WS_DLL_PUBLIC
 bool wtap_read(wtap *wth, wtap_rec *rec, int *err, char **err_info,
     int64_t *offset);
 
+/**
+ * @brief Read a batch of records from the file.
+ *
+ * This is equivalent to calling wtap_read() for each record, but lets
+ * file types that support it read the records in one call, which cuts
+ * the per-record overhead for programs that read every record of large
+ * files.
+ *
+ * As with wtap_read(), each record must have been initialized with
+ * wtap_rec_init(), and should be reset with wtap_rec_reset() once the
+ * caller has finished with it.
+ *
+ * @param wth a wtap * returned by a call that opened a file for reading.
+ * @param recs an array of at least max_recs records.
+ * @param max_recs the maximum number of records to read.
+ * @param max_bytes if non-zero, stop reading once the records read hold
+ * at least this many bytes of data.
+ * @param err set to 0 if no error occurred, or to a positive "errno" value,
+ * or a negative number indicating the type of error, if the read failed
+ * after the records returned were read.
+ * @param err_info for some errors, a string giving more details of
+ * the error
+ * @param offsets an array of at least max_recs int64_ts, set to the
+ * offsets of the records read, as with wtap_read().
+ * @return the number of records read.  That's less than max_recs if
+ * the byte limit was reached, the end of the file was reached, or an
+ * error occurred; 0 means that there are no more records to read, or
+ * that an error occurred before any were read.
+ */
+WS_DLL_PUBLIC
+unsigned wtap_read_batch(wtap *wth, wtap_rec *recs, unsigned max_recs,
+    size_t max_bytes, int *err, char **err_info, int64_t *offsets);
+
+/**
+ * @brief Ask for records to be read without their data.
+ *
+ * For programs such as capinfos that only look at the record metadata
+ * (time stamps, lengths, interfaces, options etc.), file types that
+ * support it skip the data of packet records read with wtap_read() and
+ * wtap_read_batch(), rather than reading it into the record's buffer;
+ * everything else about the records is the same.  Some records may still
+ * have their data read, if the file type needs it to fill in the metadata.
+ *
+ * Records read with wtap_seek_read() always have their data read.
+ *
+ * @param wth a wtap * returned by a call that opened a file for reading.
+ * @param headers_only true to skip record data, false to read it.
+ * @return true on success, false if headers_only is true and the file
+ * type doesn't support skipping record data, in which case records will
+ * be read in full.
+ */
+WS_DLL_PUBLIC
+bool wtap_set_headers_only(wtap *wth, bool headers_only);
+
 /**
  * @brief Read the record at a specified offset in a capture file, filling in
  * *phdr and *buf.
@@ -2391,6 +2445,24 @@ void wtap_setup_custom_block_rec(wtap_rec *rec, uint32_t pen,
 WS_DLL_PUBLIC
 ws_compression_type wtap_get_compression_type(wtap *wth);
 
+/**
+ * @brief Read regular files through a memory mapping.
+ *
+ * Files opened for reading afterwards have their uncompressed data
+ * delivered from a mapping of the file rather than read() into a buffer,
+ * on systems that support it.  Data appended to a file after it was
+ * opened is still read.
+ *
+ * This is off by default, and should only be turned on by programs that
+ * read a file once and exit, such as TShark reading a capture file: if
+ * a mapped file is truncated while it is open, or the disk returns an
+ * I/O error, the process gets SIGBUS rather than a read error.
+ *
+ * @param enable true to map files opened from now on, false not to.
+ */
+WS_DLL_PUBLIC
+void wtap_set_file_mapping(bool enable);
+
 /*** get various information snippets about the current file ***/
 
 /**
@@ -2684,6 +2756,21 @@ void wtap_fdclose(wtap *wth);
 WS_DLL_PUBLIC
 bool wtap_fdreopen(wtap *wth, const char *filename, int *err);
 
+/**
+ * @brief Give an inherited handle its own random-access file descriptor.
+ *
+ * A process forked after opening a file shares the descriptors, and so
+ * the file offsets, with its parent. This reopens the file for the random
+ * stream, positioned where the shared descriptor is, so that the process
+ * can read without disturbing the others.
+ *
+ * @param wth Wiretap file handle.
+ * @param err Pointer to an error code variable.
+ * @return True on success; false on failure.
+ */
+WS_DLL_PUBLIC
+bool wtap_fdreopen_inherited(wtap *wth, int *err);
+
 /**
  * @brief Close the sequential-access side of the file.
  *
@@ -52,6 +52,29 @@ typedef bool (*subtype_read_func)(struct wtap* wtap, wtap_rec* rec,
 typedef bool (*subtype_seek_read_func)(struct wtap* wtap, int64_t seek_off, wtap_rec* rec,
                                        int* err, char** err_info);
 
+/**
+ * @brief Function pointer type for reading a batch of records.
+ *
+ * Reads records into recs, which have been reset, until max_recs records
+ * have been read or, if max_bytes is non-zero, until the records read
+ * hold at least max_bytes bytes of data.
+ *
+ * @param wtap Wiretap handle.
+ * @param recs Output records.
+ * @param max_recs Maximum number of records to read.
+ * @param max_bytes Number of bytes of data after which to stop, or 0.
+ * @param n_recs Set to the number of records read.
+ * @param err Optional error code output.
+ * @param err_info Optional error info string.
+ * @param offsets Offsets of the records read.
+ * @return true if a limit was reached, false on failure or end of file,
+ * in which case recs[*n_recs] is the record that couldn't be read.
+ */
+typedef bool (*subtype_read_batch_func)(struct wtap* wtap, wtap_rec* recs,
+                                        unsigned max_recs, size_t max_bytes,
+                                        unsigned* n_recs, int* err,
+                                        char** err_info, int64_t* offsets);
+
 /**
  * Struct holding data of the currently read file.
  */
@@ -78,6 +101,9 @@ struct wtap {
 
     subtype_read_func           subtype_read;           /**< Function called for sequential reads */
     subtype_seek_read_func      subtype_seek_read;      /**< Function called for random access reads */
+    subtype_read_batch_func     subtype_read_batch;     /**< Function called for batched sequential reads, or NULL */
+    bool                        supports_headers_only;  /**< true if the sequential read functions can skip packet data */
+    bool                        headers_only;           /**< true if the sequential read functions should skip packet data */
     void                        (*subtype_sequential_close)(struct wtap*); /**< Cleanup for sequential read state. */
     void                        (*subtype_close)(struct wtap*);            /**< Cleanup for general file state. */
     int                         file_encap;    /**< Per-file encapsulation type, for those
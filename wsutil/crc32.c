@@ -15,9 +15,13 @@
 
 #include "config.h"
 
+#include <glib.h>
+
 #include <wsutil/crc32.h>
 #include <wsutil/zlib_compat.h>
 
+#include "crc32_int.h"
+
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
 /*****************************************************************/
@@ -429,26 +433,61 @@ crc32_ccitt_table_lookup (unsigned char pos)
 	return crc32_ccitt_table[pos];
 }
 
-uint32_t
-crc32c_calculate(const void *buf, int len, uint32_t crc)
+/*
+ * Which vectorized implementations the CPU supports; checked on first
+ * use, as CPUID can be slow (e.g. in virtual machines).
+ */
+#define CRC32_SIMD_UNKNOWN	0
+#define CRC32_SIMD_NONE		1
+#define CRC32_SIMD_SSE42	2
+#define CRC32_SIMD_PCLMUL	4
+
+static int crc32_simd = CRC32_SIMD_UNKNOWN;
+
+static inline int
+crc32_simd_supported(void)
+{
+	int simd = g_atomic_int_get(&crc32_simd);
+
+	if (simd == CRC32_SIMD_UNKNOWN) {
+		simd = CRC32_SIMD_NONE;
+#ifdef HAVE_SSE4_2
+		if (crc32c_sse42_supported())
+			simd |= CRC32_SIMD_SSE42;
+#ifdef HAVE_PCLMUL
+		if (crc32_pclmul_supported())
+			simd |= CRC32_SIMD_PCLMUL;
+#endif
+#endif
+		g_atomic_int_set(&crc32_simd, simd);
+	}
+	return simd;
+}
+
+static uint32_t
+crc32c_update(uint32_t crc, const uint8_t *p, int len)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	crc = CRC32C_SWAP(crc);
+#ifdef HAVE_SSE4_2
+	if (len > 0 && (crc32_simd_supported() & CRC32_SIMD_SSE42))
+		return crc32c_sse42(crc, p, (size_t)len);
+#endif
 	while (len-- > 0) {
 		CRC32C(crc, *p++);
 	}
+	return crc;
+}
+
+uint32_t
+crc32c_calculate(const void *buf, int len, uint32_t crc)
+{
+	crc = crc32c_update(CRC32C_SWAP(crc), (const uint8_t *)buf, len);
 	return CRC32C_SWAP(crc);
 }
 
 uint32_t
 crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
-
-	return crc;
+	return crc32c_update(crc, (const uint8_t *)buf, len);
 }
 
 uint32_t
@@ -460,6 +499,23 @@ crc32_ccitt(const uint8_t *buf, unsigned len)
 uint32_t
 crc32_ccitt_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 {
+#if defined(HAVE_SSE4_2) && defined(HAVE_PCLMUL)
+	/*
+	 * Folding with carry-less multiplication is faster than zlib's
+	 * crc32() unless zlib does the same, which only zlib-ng does.
+	 */
+	if (len >= CRC32_PCLMUL_MIN_LEN && (crc32_simd_supported() & CRC32_SIMD_PCLMUL)) {
+		unsigned i;
+		unsigned folded = len & ~15U;
+		uint32_t crc32;
+
+		crc32 = crc32_pclmul(&crc32_ccitt_fold_constants, seed, buf, folded);
+		for (i = folded; i < len; i++)
+			CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
+
+		return ( ~crc32 );
+	}
+#endif
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
 	return (unsigned)ZLIB_PREFIX(crc32)(~seed, buf, len);
 #else /* USE_ZLIB_OR_ZLIBNG */
@@ -493,6 +549,15 @@ crc32_0x0AA725CF_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 	unsigned crc32;
 
 	crc32 = (unsigned)seed;
+#if defined(HAVE_SSE4_2) && defined(HAVE_PCLMUL)
+	if (len >= CRC32_PCLMUL_MIN_LEN && (crc32_simd_supported() & CRC32_SIMD_PCLMUL)) {
+		unsigned folded = len & ~15U;
+
+		crc32 = crc32_pclmul(&crc32_0x0AA725CF_fold_constants, crc32, buf, folded);
+		buf += folded;
+		len -= folded;
+	}
+#endif
 	while( len-- != 0 )
 		CRC32_ACCUMULATE(crc32, *buf++, crc32_0AA725CF_reverse);
 
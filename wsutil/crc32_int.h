@@ -0,0 +1,87 @@
+/** @file
+ *
+ * Internal definitions for the vectorized CRC-32 routines
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __CRC32_INT_H__
+#define __CRC32_INT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef HAVE_SSE4_2
+
+/**
+ * @brief Check whether the CPU has the SSE4.2 CRC32 instruction.
+ *
+ * @return true if crc32c_sse42() can be used.
+ */
+bool crc32c_sse42_supported(void);
+
+/**
+ * @brief Update a CRC32C with the SSE4.2 CRC32 instruction.
+ *
+ * @param crc The CRC register, as used by the table driven code, i.e.
+ * neither swapped nor inverted.
+ * @param buf The data.
+ * @param len The number of bytes of data.
+ * @return The updated CRC register.
+ */
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t len);
+
+#ifdef HAVE_PCLMUL
+
+/**
+ * @brief The constants for folding a bit-reflected CRC-32 with carry-less
+ * multiplication, from "Fast CRC Computation for Generic Polynomials Using
+ * PCLMULQDQ Instruction" (Intel, 2009).
+ */
+typedef struct {
+	uint64_t k1k2[2];	/**< x^(4*128+32) and x^(4*128-32) mod P */
+	uint64_t k3k4[2];	/**< x^(128+32) and x^(128-32) mod P */
+	uint64_t k5k0[2];	/**< x^64 mod P and 0 */
+	uint64_t poly[2];	/**< P and floor(x^64 / P) */
+} crc32_fold_constants;
+
+/** The AUTODIN/HDLC/802.x CRC-32 (polynomial 0x04C11DB7). */
+extern const crc32_fold_constants crc32_ccitt_fold_constants;
+
+/** The CRC-32 with polynomial 0x0AA725CF. */
+extern const crc32_fold_constants crc32_0x0AA725CF_fold_constants;
+
+/** The minimum length crc32_pclmul() accepts. */
+#define CRC32_PCLMUL_MIN_LEN 64
+
+/**
+ * @brief Check whether the CPU has the PCLMULQDQ instruction (and SSE4.2).
+ *
+ * @return true if crc32_pclmul() can be used.
+ */
+bool crc32_pclmul_supported(void);
+
+/**
+ * @brief Update a bit-reflected CRC-32 by folding the data with carry-less
+ * multiplication.
+ *
+ * @param constants The folding constants for the polynomial.
+ * @param crc The CRC register, as used by the table driven code.
+ * @param buf The data.
+ * @param len The number of bytes of data, at least CRC32_PCLMUL_MIN_LEN
+ * and a multiple of 16.
+ * @return The updated CRC register.
+ */
+uint32_t crc32_pclmul(const crc32_fold_constants *constants, uint32_t crc,
+		const uint8_t *buf, size_t len);
+
+#endif /* HAVE_PCLMUL */
+
+#endif /* HAVE_SSE4_2 */
+
+#endif /* __CRC32_INT_H__ */
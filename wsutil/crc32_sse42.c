@@ -0,0 +1,178 @@
+/* crc32_sse42.c
+ * CRC-32 routines using the SSE4.2 CRC32 and the PCLMULQDQ instructions
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <string.h>
+
+#include <nmmintrin.h>
+#ifdef HAVE_PCLMUL
+#include <wmmintrin.h>
+#endif
+
+#include "ws_cpuid.h"
+#include "crc32_int.h"
+
+bool
+crc32c_sse42_supported(void)
+{
+	return ws_cpuid_sse42() != 0;
+}
+
+uint32_t
+crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t len)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	uint64_t crc64 = crc;
+	uint64_t word;
+
+	while (len >= 8) {
+		memcpy(&word, buf, sizeof word);
+		crc64 = _mm_crc32_u64(crc64, word);
+		buf += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#else
+	uint32_t word;
+
+	while (len >= 4) {
+		memcpy(&word, buf, sizeof word);
+		crc = _mm_crc32_u32(crc, word);
+		buf += 4;
+		len -= 4;
+	}
+#endif
+	while (len-- > 0) {
+		crc = _mm_crc32_u8(crc, *buf++);
+	}
+	return crc;
+}
+
+#ifdef HAVE_PCLMUL
+
+/* The constants are the bit-reflected, shifted left by one bit, remainders
+ * (and quotient) described in crc32_int.h. */
+const crc32_fold_constants crc32_ccitt_fold_constants = {
+	{ UINT64_C(0x0154442bd4), UINT64_C(0x01c6e41596) },
+	{ UINT64_C(0x01751997d0), UINT64_C(0x00ccaa009e) },
+	{ UINT64_C(0x0163cd6124), UINT64_C(0x0000000000) },
+	{ UINT64_C(0x01db710641), UINT64_C(0x01f7011641) }
+};
+
+const crc32_fold_constants crc32_0x0AA725CF_fold_constants = {
+	{ UINT64_C(0x009ef855c0), UINT64_C(0x01f5efb4ea) },
+	{ UINT64_C(0x01e2b0f7f2), UINT64_C(0x014b4cbeb4) },
+	{ UINT64_C(0x00e13055b2), UINT64_C(0x0000000000) },
+	{ UINT64_C(0x01e749caa1), UINT64_C(0x009a1f0ea1) }
+};
+
+bool
+crc32_pclmul_supported(void)
+{
+	return ws_cpuid_sse42() && ws_cpuid_pclmulqdq();
+}
+
+#define LOADU(p) _mm_loadu_si128((const __m128i *)(const void *)(p))
+
+uint32_t
+crc32_pclmul(const crc32_fold_constants *constants, uint32_t crc,
+		const uint8_t *buf, size_t len)
+{
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+	__m128i mask32;
+
+	/* Load the first 64 bytes into four accumulators. */
+	x1 = _mm_xor_si128(LOADU(buf), _mm_cvtsi32_si128((int)crc));
+	x2 = LOADU(buf + 16);
+	x3 = LOADU(buf + 32);
+	x4 = LOADU(buf + 48);
+	buf += 64;
+	len -= 64;
+
+	/* Fold 64 bytes at a time. */
+	x0 = LOADU(constants->k1k2);
+	while (len >= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), LOADU(buf));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), LOADU(buf + 16));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), LOADU(buf + 32));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), LOADU(buf + 48));
+		buf += 64;
+		len -= 64;
+	}
+
+	/* Fold the four accumulators into one. */
+	x0 = LOADU(constants->k3k4);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	/* Fold the remaining 16 byte blocks. */
+	while (len >= 16) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, LOADU(buf)), x5);
+		buf += 16;
+		len -= 16;
+	}
+
+	/* Fold 128 bits to 64 bits. */
+	mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x0 = _mm_loadl_epi64((const __m128i *)(const void *)constants->k5k0);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	/* Barrett reduction to 32 bits. */
+	x0 = LOADU(constants->poly);
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+#endif /* HAVE_PCLMUL */
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
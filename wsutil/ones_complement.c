@@ -0,0 +1,117 @@
+/* ones_complement.c
+ * One's complement sum of 16-bit words, as used by the Internet checksum
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <wsutil/ones_complement.h>
+
+#include "ws_cpuid.h"
+#include "ones_complement_int.h"
+
+/*
+ * As 2^16 is 1 modulo 65535, a 32 or 64-bit word is congruent to the sum
+ * of its 16-bit words, in either byte order, and a carry out of a 64-bit
+ * sum can be added back in ("end-around carry"). So the words can be
+ * summed 64 bits at a time and folded to 16 bits at the end (RFC 1071).
+ */
+static inline uint64_t
+add_end_around(uint64_t sum, uint64_t word)
+{
+	sum += word;
+	/* If the sum overflowed, it is less than word, and adding the
+	 * carry back can't overflow again. */
+	return sum + (sum < word);
+}
+
+static uint64_t
+ones_complement_sum_portable(const uint8_t *p, size_t len)
+{
+	uint64_t sum = 0;
+	uint64_t word64;
+	uint16_t word16;
+
+	while (len >= 32) {
+		memcpy(&word64, p, 8);
+		sum = add_end_around(sum, word64);
+		memcpy(&word64, p + 8, 8);
+		sum = add_end_around(sum, word64);
+		memcpy(&word64, p + 16, 8);
+		sum = add_end_around(sum, word64);
+		memcpy(&word64, p + 24, 8);
+		sum = add_end_around(sum, word64);
+		p += 32;
+		len -= 32;
+	}
+	while (len >= 8) {
+		memcpy(&word64, p, 8);
+		sum = add_end_around(sum, word64);
+		p += 8;
+		len -= 8;
+	}
+	while (len >= 2) {
+		memcpy(&word16, p, 2);
+		sum = add_end_around(sum, word16);
+		p += 2;
+		len -= 2;
+	}
+	return sum;
+}
+
+#ifdef HAVE_AVX2
+/* -1 until the CPU has been checked. */
+static int use_avx2 = -1;
+#endif
+
+uint16_t
+ws_ones_complement_sum(const void *buf, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+	uint64_t sum = 0;
+
+#ifdef HAVE_AVX2
+	/* Below a few blocks the portable loop is as fast. */
+	if (len >= 128) {
+		int avx2 = g_atomic_int_get(&use_avx2);
+
+		if (avx2 < 0) {
+			avx2 = ws_cpuid_avx2();
+			g_atomic_int_set(&use_avx2, avx2);
+		}
+		if (avx2) {
+			size_t blocks_len = len & ~(size_t)31;
+
+			sum = ws_ones_complement_sum_avx2(p, blocks_len);
+			p += blocks_len;
+			len -= blocks_len;
+		}
+	}
+#endif
+	sum = add_end_around(sum, ones_complement_sum_portable(p, len));
+
+	/* Fold to 16 bits. */
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
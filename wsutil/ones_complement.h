@@ -0,0 +1,38 @@
+/** @file
+ *
+ * One's complement sum of 16-bit words, as used by the Internet checksum
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ONES_COMPLEMENT_H__
+#define __ONES_COMPLEMENT_H__
+
+#include <wireshark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @brief Compute the one's complement sum of the 16-bit words of a buffer.
+ *
+ * The words are read in host byte order, so, like the Internet checksum
+ * of RFC 1071, the sum is in the byte order of the data. Vector
+ * instructions are used if the CPU supports them.
+ *
+ * @param buf The buffer; it need not be aligned.
+ * @param len The number of bytes in the buffer, which must be even.
+ * @return The sum, folded to 16 bits; 0 only if all the words are 0.
+ */
+WS_DLL_PUBLIC uint16_t ws_ones_complement_sum(const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ONES_COMPLEMENT_H__ */
@@ -0,0 +1,66 @@
+/* ones_complement_avx2.c
+ * One's complement sum of 16-bit words using AVX2 instructions
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <immintrin.h>
+
+#include "ones_complement_int.h"
+
+uint64_t
+ws_ones_complement_sum_avx2(const uint8_t *buf, size_t len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc_lo = zero;
+	__m256i acc_hi = zero;
+	__m256i data;
+	uint64_t lanes[4];
+	uint64_t sum = 0;
+	int i;
+
+	/*
+	 * Widen the 32-bit words to 64-bit lanes and add them up; the lanes
+	 * can't overflow before 2^32 blocks, i.e. 128 GiB.
+	 */
+	while (len >= 32) {
+		data = _mm256_loadu_si256((const __m256i *)(const void *)buf);
+		acc_lo = _mm256_add_epi64(acc_lo, _mm256_unpacklo_epi32(data, zero));
+		acc_hi = _mm256_add_epi64(acc_hi, _mm256_unpackhi_epi32(data, zero));
+		buf += 32;
+		len -= 32;
+	}
+
+	_mm256_storeu_si256((__m256i *)(void *)lanes, _mm256_add_epi64(acc_lo, acc_hi));
+	for (i = 0; i < 4; i++) {
+		sum += lanes[i];
+		sum += (sum < lanes[i]);
+	}
+	return sum;
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,34 @@
+/** @file
+ *
+ * Internal definitions for the one's complement sum
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ONES_COMPLEMENT_INT_H__
+#define __ONES_COMPLEMENT_INT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAVE_AVX2
+
+/**
+ * @brief Sum the 16-bit words of the whole 32 byte blocks of a buffer
+ * with AVX2 instructions.
+ *
+ * @param buf The buffer.
+ * @param len The number of bytes; any bytes after the last whole 32 byte
+ * block are ignored.
+ * @return A 64-bit sum congruent to the one's complement sum of the words
+ * modulo 65535, 0 only if all the words are 0.
+ */
+uint64_t ws_ones_complement_sum_avx2(const uint8_t *buf, size_t len);
+
+#endif /* HAVE_AVX2 */
+
+#endif /* __ONES_COMPLEMENT_INT_H__ */
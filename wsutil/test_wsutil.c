@@ -15,6 +15,7 @@
 #include <wsutil/time_util.h>
 #include <wsutil/to_str.h>
 #include <wsutil/saplzclzh.h>
+#include <wsutil/value_string.h>
 
 #include "inet_addr.h"
 
@@ -1265,6 +1266,367 @@ static void test_ws_hexbuftoi64(void)
     test_int64(hexstr, 2, &hexstr[1], 16, true, 0, 0);
     test_int64(hexstr, 2, &hexstr[1], 0, true, 0, 0);
 }
+
+#include <wsutil/crc32.h>
+#include <wsutil/ones_complement.h>
+
+/*
+ * Straightforward versions of the CRCs and of the one's complement sum,
+ * to cross-check the vectorized ones (if the CPU running the test has
+ * the instructions) against.
+ */
+static uint32_t
+crc32c_bytewise(const uint8_t *buf, size_t len, uint32_t crc)
+{
+    crc = CRC32C_SWAP(crc);
+    while (len-- > 0)
+        crc = (crc >> 8) ^ crc32c_table_lookup((crc ^ *buf++) & 0xff);
+    return CRC32C_SWAP(crc);
+}
+
+static uint32_t
+crc32_ccitt_bytewise(const uint8_t *buf, size_t len, uint32_t seed)
+{
+    uint32_t crc = seed;
+
+    while (len-- > 0)
+        crc = (crc >> 8) ^ crc32_ccitt_table_lookup((crc ^ *buf++) & 0xff);
+    return ~crc;
+}
+
+static uint32_t
+crc32_0x0AA725CF_bitwise(const uint8_t *buf, size_t len, uint32_t seed)
+{
+    uint32_t crc = seed;
+    int bit;
+
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xF3A4E550 : 0);
+    }
+    return crc;
+}
+
+static uint16_t
+ones_complement_sum_wordwise(const uint8_t *buf, size_t len)
+{
+    uint32_t sum = 0;
+    uint16_t word;
+    size_t i;
+
+    for (i = 0; i + 1 < len; i += 2) {
+        memcpy(&word, buf + i, 2);
+        sum += word;
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)sum;
+}
+
+#define CHECKSUM_TEST_DATA_LEN 70000
+
+static uint8_t *
+checksum_test_data(void)
+{
+    GRand *rand = g_rand_new_with_seed(0x5eed);
+    uint8_t *data = g_malloc(CHECKSUM_TEST_DATA_LEN);
+    size_t i;
+
+    for (i = 0; i < CHECKSUM_TEST_DATA_LEN; i++)
+        data[i] = (uint8_t)g_rand_int(rand);
+    g_rand_free(rand);
+    return data;
+}
+
+/* All lengths up to a few vectors, then some larger ones, at every
+ * alignment within a 64-bit word. */
+#define FOR_EACH_CHECKSUM_TEST_CASE(offset, len) \
+    for (offset = 0; offset < 8; offset++) \
+        for (len = 0; len < 65536; len = (len < 320) ? len + 1 : len * 3 + 7)
+
+static void test_crc32c(void)
+{
+    uint8_t *data = checksum_test_data();
+    size_t offset, len;
+
+    FOR_EACH_CHECKSUM_TEST_CASE(offset, len) {
+        g_assert_cmphex(crc32c_calculate(data + offset, (int)len, CRC32C_PRELOAD), ==,
+                crc32c_bytewise(data + offset, len, CRC32C_PRELOAD));
+        g_assert_cmphex(crc32c_calculate_no_swap(data + offset, (int)len, 0x12345678), ==,
+                CRC32C_SWAP(crc32c_bytewise(data + offset, len, CRC32C_SWAP(0x12345678))));
+    }
+
+    /* RFC 3720 B.4: 32 bytes of zeroes */
+    memset(data, 0, 32);
+    g_assert_cmphex(CRC32C_SWAP(~crc32c_calculate(data, 32, CRC32C_PRELOAD)), ==, 0x8A9136AA);
+
+    g_free(data);
+}
+
+static void test_crc32_ccitt(void)
+{
+    uint8_t *data = checksum_test_data();
+    size_t offset, len;
+
+    FOR_EACH_CHECKSUM_TEST_CASE(offset, len) {
+        g_assert_cmphex(crc32_ccitt_seed(data + offset, (unsigned)len, 0x12345678), ==,
+                crc32_ccitt_bytewise(data + offset, len, 0x12345678));
+    }
+    g_assert_cmphex(crc32_ccitt((const uint8_t *)"123456789", 9), ==, 0xCBF43926);
+
+    g_free(data);
+}
+
+static void test_crc32_0x0AA725CF(void)
+{
+    uint8_t *data = checksum_test_data();
+    size_t offset, len;
+
+    FOR_EACH_CHECKSUM_TEST_CASE(offset, len) {
+        g_assert_cmphex(crc32_0x0AA725CF_seed(data + offset, (unsigned)len, 0x12345678), ==,
+                crc32_0x0AA725CF_bitwise(data + offset, len, 0x12345678));
+    }
+
+    g_free(data);
+}
+
+static void test_ones_complement_sum(void)
+{
+    uint8_t *data = checksum_test_data();
+    size_t offset, len;
+
+    FOR_EACH_CHECKSUM_TEST_CASE(offset, len) {
+        if (len % 2)
+            continue;
+        g_assert_cmphex(ws_ones_complement_sum(data + offset, len), ==,
+                ones_complement_sum_wordwise(data + offset, len));
+    }
+
+    /* A sum of 0xffff words stays 0xffff; only all zeroes sum to 0. */
+    memset(data, 0xff, CHECKSUM_TEST_DATA_LEN);
+    g_assert_cmphex(ws_ones_complement_sum(data, 65536), ==, 0xffff);
+    memset(data, 0, CHECKSUM_TEST_DATA_LEN);
+    g_assert_cmphex(ws_ones_complement_sum(data, 65536), ==, 0);
+
+    g_free(data);
+}
+
+static void test_checksum_perf(void)
+{
+#define CHECKSUM_LOOP_COUNT 10000
+#define CHECKSUM_PERF_LEN 1500
+    uint8_t *data = checksum_test_data();
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double vector_ms;
+    volatile uint32_t result = 0;
+    int i;
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += crc32c_calculate(data + (i & 7), CHECKSUM_PERF_LEN, CRC32C_PRELOAD);
+    RESOURCE_USAGE_END;
+    vector_ms = utime_ms + stime_ms;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += crc32c_bytewise(data + (i & 7), CHECKSUM_PERF_LEN, CRC32C_PRELOAD);
+    RESOURCE_USAGE_END;
+    g_test_message("crc32c_calculate(): %.3f ms, byte at a time: %.3f ms",
+        vector_ms, utime_ms + stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += crc32_ccitt(data + (i & 7), CHECKSUM_PERF_LEN);
+    RESOURCE_USAGE_END;
+    vector_ms = utime_ms + stime_ms;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += crc32_ccitt_bytewise(data + (i & 7), CHECKSUM_PERF_LEN, CRC32_CCITT_SEED);
+    RESOURCE_USAGE_END;
+    g_test_message("crc32_ccitt(): %.3f ms, byte at a time: %.3f ms",
+        vector_ms, utime_ms + stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += ws_ones_complement_sum(data + (i & 7), CHECKSUM_PERF_LEN);
+    RESOURCE_USAGE_END;
+    vector_ms = utime_ms + stime_ms;
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CHECKSUM_LOOP_COUNT; i++)
+        result += ones_complement_sum_wordwise(data + (i & 7), CHECKSUM_PERF_LEN);
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(vector_ms,
+        "ws_ones_complement_sum(): %.3f ms, 16 bits at a time: %.3f ms",
+        vector_ms, utime_ms + stime_ms);
+
+    g_free(data);
+}
+
+/* Build a value_string array of n entries with the given values. The
+ * strings are distinct, so the tests below can tell which entry of a
+ * duplicated value a lookup found. */
+static value_string *
+make_value_string(const uint32_t *values, unsigned n)
+{
+    value_string *vs = g_new0(value_string, n + 1);
+
+    for (unsigned i = 0; i < n; i++) {
+        vs[i].value = values[i];
+        vs[i].strptr = g_strdup_printf("entry %u", i);
+    }
+    return vs;
+}
+
+static void
+free_value_string(value_string *vs)
+{
+    for (unsigned i = 0; vs[i].strptr != NULL; i++) {
+        g_free((char *)vs[i].strptr);
+    }
+    g_free(vs);
+}
+
+/* Every value in the array and its neighbours, plus the extremes, must
+ * give the same entry (not just an equal string) as try_val_to_str(). */
+static void
+check_value_string_index(const uint32_t *values, unsigned n)
+{
+    value_string *vs = make_value_string(values, n);
+    value_string_index *vsi = value_string_index_new(NULL, vs);
+
+    g_assert_nonnull(vsi);
+    g_assert_true(value_string_index_get_vs(vsi) == vs);
+
+    for (unsigned i = 0; i < n; i++) {
+        for (uint32_t val = values[i] - 1; val != values[i] + 2; val++) {
+            g_assert_true(try_val_to_str_indexed(val, vsi) == try_val_to_str(val, vs));
+        }
+    }
+    g_assert_true(try_val_to_str_indexed(0, vsi) == try_val_to_str(0, vs));
+    g_assert_true(try_val_to_str_indexed(G_MAXUINT32, vsi) == try_val_to_str(G_MAXUINT32, vs));
+    g_assert_true(try_val_to_str_indexed(G_MAXINT32, vsi) == try_val_to_str(G_MAXINT32, vs));
+    g_assert_true(try_val_to_str_indexed(0x80000000, vsi) == try_val_to_str(0x80000000, vs));
+
+    value_string_index_free(vsi);
+    free_value_string(vs);
+}
+
+#define VS_TEST_ENTRIES 64
+
+static void test_value_string_index_small(void)
+{
+    uint32_t values[VALUE_STRING_INDEX_MIN_ENTRIES - 1];
+    value_string *vs;
+
+    for (unsigned i = 0; i < G_N_ELEMENTS(values); i++) {
+        values[i] = i;
+    }
+    vs = make_value_string(values, G_N_ELEMENTS(values));
+    g_assert_null(value_string_index_new(NULL, vs));
+    free_value_string(vs);
+
+    g_assert_null(value_string_index_new(NULL, NULL));
+}
+
+static void test_value_string_index_dense(void)
+{
+    uint32_t values[VS_TEST_ENTRIES];
+
+    /* In order, starting at 0. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = i;
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* Every other value, not starting at 0. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = 1000 + 2 * i;
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+}
+
+static void test_value_string_index_unsorted(void)
+{
+    uint32_t values[VS_TEST_ENTRIES];
+
+    /* 37 is coprime with the number of entries, so this is a permutation. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = 10 + (i * 37) % VS_TEST_ENTRIES;
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* The same order, but sparse. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = 100000 * ((i * 37) % VS_TEST_ENTRIES);
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+}
+
+static void test_value_string_index_duplicates(void)
+{
+    uint32_t values[VS_TEST_ENTRIES];
+
+    /* Each value twice, the second time in the other half of the array,
+     * so that sorting can't keep the first one first by accident. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = (VS_TEST_ENTRIES - 1 - i) % (VS_TEST_ENTRIES / 2);
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = 7777 * ((VS_TEST_ENTRIES - 1 - i) % (VS_TEST_ENTRIES / 2));
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* All the same. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = 42;
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+}
+
+static void test_value_string_index_sparse(void)
+{
+    uint32_t values[VS_TEST_ENTRIES];
+
+    /* Powers of two, with one huge gap at the end. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES - 1; i++) {
+        values[i] = i < 32 ? UINT32_C(1) << i : 3 * i;
+    }
+    values[VS_TEST_ENTRIES - 1] = G_MAXUINT32;
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* Just too sparse to get a table. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = i;
+    }
+    values[VS_TEST_ENTRIES - 1] = 2 * VS_TEST_ENTRIES;
+    check_value_string_index(values, VS_TEST_ENTRIES);
+}
+
+static void test_value_string_index_signed(void)
+{
+    uint32_t values[VS_TEST_ENTRIES];
+
+    /* Negative values of signed fields are stored as their two's
+     * complement, so -32..31 spans the whole unsigned range. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = (uint32_t)((int32_t)i - VS_TEST_ENTRIES / 2);
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* Only negative values: dense, with the high bit set. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = (uint32_t)(-1 - (int32_t)i);
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+
+    /* Around the sign bit. */
+    for (unsigned i = 0; i < VS_TEST_ENTRIES; i++) {
+        values[i] = UINT32_C(0x80000000) - VS_TEST_ENTRIES / 2 + i;
+    }
+    check_value_string_index(values, VS_TEST_ENTRIES);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -1329,6 +1691,22 @@ int main(int argc, char **argv)
     g_test_add_func("/sap_lzclzh_decompress", test_sap_lzclzh_decompress);
     g_test_add_func("/sap_lzclzh_decompress/errors", test_sap_lzclzh_decompress_errors);
 
+    g_test_add_func("/value_string/index_small", test_value_string_index_small);
+    g_test_add_func("/value_string/index_dense", test_value_string_index_dense);
+    g_test_add_func("/value_string/index_unsorted", test_value_string_index_unsorted);
+    g_test_add_func("/value_string/index_duplicates", test_value_string_index_duplicates);
+    g_test_add_func("/value_string/index_sparse", test_value_string_index_sparse);
+    g_test_add_func("/value_string/index_signed", test_value_string_index_signed);
+
+    g_test_add_func("/checksum/crc32c", test_crc32c);
+    g_test_add_func("/checksum/crc32_ccitt", test_crc32_ccitt);
+    g_test_add_func("/checksum/crc32_0x0AA725CF", test_crc32_0x0AA725CF);
+    g_test_add_func("/checksum/ones_complement_sum", test_ones_complement_sum);
+
+    if (g_test_perf()) {
+        g_test_add_func("/checksum/perf", test_checksum_perf);
+    }
+
     ret = g_test_run();
 
     return ret;
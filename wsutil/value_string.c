@@ -12,6 +12,7 @@
 #define WS_LOG_DOMAIN LOG_DOMAIN_WSUTIL
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "to_str.h"
@@ -489,6 +490,137 @@ _try_val_to_str_ext_init(const uint32_t val, value_string_ext *vse)
     return vse->_vs_match2(val, vse);
 }
 
+/* INDEXED VALUE STRING */
+
+/* An index of a plain value_string array. Dense arrays get a table of
+ * strings indexed by value - first_value, where values that aren't in the
+ * array have NULL. Sparse arrays get a copy of their entries sorted by value,
+ * without the later duplicates of a value, so a binary search finds the
+ * same entry as the linear search of try_val_to_str(). */
+struct _value_string_index {
+    const value_string  *vs;
+    wmem_allocator_t    *scope;
+    uint32_t             first_value;
+    unsigned             num_entries;   /* of strings[] or sorted[] */
+    const char         **strings;       /* dense arrays */
+    value_string        *sorted;        /* sparse arrays */
+};
+
+/* Order entries by value, and entries with the same value by their
+ * position in the array. */
+static int
+value_string_entry_compar(const void *a, const void *b)
+{
+    const value_string *ea = *(const value_string * const *)a;
+    const value_string *eb = *(const value_string * const *)b;
+
+    if (ea->value != eb->value)
+        return ea->value > eb->value ? 1 : -1;
+    return ea > eb ? 1 : (ea < eb ? -1 : 0);
+}
+
+value_string_index *
+value_string_index_new(wmem_allocator_t *scope, const value_string *vs)
+{
+    value_string_index *vsi;
+    unsigned            num_entries = 0;
+    uint32_t            min_value;
+    uint32_t            max_value;
+    unsigned            i;
+
+    if (vs == NULL)
+        return NULL;
+
+    while (vs[num_entries].strptr != NULL)
+        num_entries++;
+    if (num_entries < VALUE_STRING_INDEX_MIN_ENTRIES)
+        return NULL;
+
+    min_value = max_value = vs[0].value;
+    for (i = 1; i < num_entries; i++) {
+        if (vs[i].value < min_value)
+            min_value = vs[i].value;
+        if (vs[i].value > max_value)
+            max_value = vs[i].value;
+    }
+
+    vsi = wmem_new0(scope, value_string_index);
+    vsi->vs          = vs;
+    vsi->scope       = scope;
+    vsi->first_value = min_value;
+
+    if (max_value - min_value < 2 * num_entries) {
+        /* Dense: at most one unused slot per entry. Fill it backwards,
+         * so the first entry for a value wins. */
+        vsi->num_entries = max_value - min_value + 1;
+        vsi->strings     = wmem_alloc0_array(scope, const char *, vsi->num_entries);
+        for (i = num_entries; i-- > 0; ) {
+            vsi->strings[vs[i].value - min_value] = vs[i].strptr;
+        }
+    } else {
+        const value_string **entries;
+
+        entries = wmem_alloc_array(NULL, const value_string *, num_entries);
+        for (i = 0; i < num_entries; i++) {
+            entries[i] = &vs[i];
+        }
+        qsort(entries, num_entries, sizeof entries[0], value_string_entry_compar);
+
+        vsi->sorted = wmem_alloc_array(scope, value_string, num_entries);
+        for (i = 0; i < num_entries; i++) {
+            if (vsi->num_entries > 0 &&
+                    vsi->sorted[vsi->num_entries - 1].value == entries[i]->value)
+                continue;
+            vsi->sorted[vsi->num_entries++] = *entries[i];
+        }
+        wmem_free(NULL, entries);
+    }
+
+    return vsi;
+}
+
+void
+value_string_index_free(value_string_index *vsi)
+{
+    if (vsi == NULL)
+        return;
+
+    wmem_free(vsi->scope, vsi->strings);
+    wmem_free(vsi->scope, vsi->sorted);
+    wmem_free(vsi->scope, vsi);
+}
+
+const value_string *
+value_string_index_get_vs(const value_string_index *vsi)
+{
+    return vsi->vs;
+}
+
+const char *
+try_val_to_str_indexed(const uint32_t val, const value_string_index *vsi)
+{
+    if (vsi->strings) {
+        uint32_t i = val - vsi->first_value;
+
+        return i < vsi->num_entries ? vsi->strings[i] : NULL;
+    } else {
+        unsigned lo = 0;
+        unsigned hi = vsi->num_entries;
+
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+
+            if (vsi->sorted[mid].value < val)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < vsi->num_entries && vsi->sorted[lo].value == val)
+            return vsi->sorted[lo].strptr;
+        return NULL;
+    }
+}
+
 /* EXTENDED 64-BIT VALUE STRING */
 
 /* Extended value strings allow fast(er) val64_string array lookups by
@@ -460,6 +460,72 @@ WS_DLL_PUBLIC
 const char *
 try_val_to_str_idx_ext(const uint32_t val, value_string_ext *vse, int *idx);
 
+/* INDEXED VALUE TO STRING MATCHING */
+
+/**
+ * @brief Lookup index for a plain value_string array.
+ *
+ * Unlike a value_string_ext, an index can be made for any value_string
+ * array, whether or not it is sorted, and it finds the same string as
+ * try_val_to_str(), i.e. the first one for a value that is in the array
+ * more than once. It is meant for code that looks up values in arrays that
+ * it didn't define itself, such as the value strings of registered fields.
+ */
+typedef struct _value_string_index value_string_index;
+
+/**
+ * @brief Arrays with fewer entries than this are scanned faster than they
+ * are looked up in an index, so value_string_index_new() makes none for them.
+ */
+#define VALUE_STRING_INDEX_MIN_ENTRIES 32
+
+/**
+ * @brief Create a lookup index for a value_string array.
+ *
+ * If the values are dense, the index is a table indexed by value, so lookups
+ * take constant time. Otherwise it is a copy of the array sorted by value,
+ * which is searched in log(n) time. The array must not be changed while the
+ * index is in use.
+ *
+ * @param scope Memory allocator scope for the index.
+ * @param vs    The value_string array, terminated by {0, NULL}.
+ * @return The index, or NULL if the array has fewer than
+ *         VALUE_STRING_INDEX_MIN_ENTRIES entries.
+ */
+WS_DLL_PUBLIC
+value_string_index *
+value_string_index_new(wmem_allocator_t *scope, const value_string *vs);
+
+/**
+ * @brief Free a value_string index.
+ *
+ * @param vsi The index to free.
+ */
+WS_DLL_PUBLIC
+void
+value_string_index_free(value_string_index *vsi);
+
+/**
+ * @brief Get the value_string array an index was made for.
+ *
+ * @param vsi The index.
+ * @return The array passed to value_string_index_new().
+ */
+WS_DLL_PUBLIC
+const value_string *
+value_string_index_get_vs(const value_string_index *vsi);
+
+/**
+ * @brief Like try_val_to_str(), but uses an index of the value_string array.
+ *
+ * @param val The value to look up.
+ * @param vsi The index of the value_string array.
+ * @return The string for the value, or NULL if it isn't in the array.
+ */
+WS_DLL_PUBLIC
+const char *
+try_val_to_str_indexed(const uint32_t val, const value_string_index *vsi);
+
 /* EXTENDED 64-BIT VALUE TO STRING MATCHING */
 
 typedef struct _val64_string_ext val64_string_ext;
@@ -45,6 +45,9 @@ struct _wmem_allocator_t {
     /* Callback List */
     struct _wmem_user_cb_container_t *callbacks; /**< Optional user-defined callbacks for lifecycle events. */
 
+    /* Accounting */
+    uint64_t *counter; /**< Optional counter to which the size of each allocation is added. */
+
     /* Implementation details */
     void *private_data; /**< Allocator-specific internal state. */
     enum _wmem_allocator_type_t type; /**< Allocator type (e.g., scope, file-backed, slab). */
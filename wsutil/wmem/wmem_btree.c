@@ -0,0 +1,525 @@
+/* wmem_btree.c
+ * Wireshark Memory Manager B+Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "wmem-int.h"
+#include "wmem_core.h"
+#include "wmem_btree.h"
+#include "wmem_user_cb.h"
+
+/* Maximum number of keys in a leaf and of children of an inner node */
+#define WMEM_BTREE_ORDER         64
+/* Initial number of keys of the root leaf; most trees stay small */
+#define WMEM_BTREE_ROOT_CAPACITY 4
+/* Inner nodes are at least half full, except on the rightmost path */
+#define WMEM_BTREE_MAX_DEPTH     16
+
+typedef struct _wmem_btree_node_t wmem_btree_node_t;
+
+/*
+ * Leaves hold keys[i] -> values[i]. Inner nodes hold children in values[],
+ * and keys[i] (i > 0) is the smallest key which is routed to values[i].
+ * Both arrays are in the same allocation as the node.
+ */
+struct _wmem_btree_node_t {
+    wmem_btree_node_t *prev;    /* leaves only */
+    wmem_btree_node_t *next;    /* leaves only */
+    unsigned  count;
+    unsigned  capacity;
+    bool      is_leaf;
+    uint32_t *keys;
+    void    **values;
+};
+
+struct _wmem_btree_t {
+    wmem_allocator_t  *metadata_allocator;
+    wmem_allocator_t  *data_allocator;
+    wmem_btree_node_t *root;
+    wmem_btree_node_t *first_leaf;
+    wmem_btree_node_t *last_leaf;
+    unsigned           count;
+
+    unsigned           metadata_scope_cb_id;
+    unsigned           data_scope_cb_id;
+};
+
+static wmem_btree_node_t *
+btree_node_new(wmem_allocator_t *allocator, bool is_leaf, unsigned capacity)
+{
+    wmem_btree_node_t *node;
+
+    node = (wmem_btree_node_t *)wmem_alloc(allocator,
+            sizeof(wmem_btree_node_t) + capacity * (sizeof(void *) + sizeof(uint32_t)));
+    node->prev     = NULL;
+    node->next     = NULL;
+    node->count    = 0;
+    node->capacity = capacity;
+    node->is_leaf  = is_leaf;
+    node->values   = (void **)(node + 1);
+    node->keys     = (uint32_t *)(node->values + capacity);
+
+    return node;
+}
+
+static void
+btree_node_insert_at(wmem_btree_node_t *node, unsigned idx, uint32_t key, void *value)
+{
+    memmove(&node->keys[idx + 1], &node->keys[idx], (node->count - idx) * sizeof(uint32_t));
+    memmove(&node->values[idx + 1], &node->values[idx], (node->count - idx) * sizeof(void *));
+    node->keys[idx] = key;
+    node->values[idx] = value;
+    node->count++;
+}
+
+/* Index of the first key in [lo, hi) which is >= key, or hi */
+static inline unsigned
+btree_lower_bound(const uint32_t *keys, unsigned lo, unsigned hi, uint32_t key)
+{
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Index of the first key in [lo, hi) which is > key, or hi */
+static inline unsigned
+btree_upper_bound(const uint32_t *keys, unsigned lo, unsigned hi, uint32_t key)
+{
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (keys[mid] <= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static inline unsigned
+btree_child_index(const wmem_btree_node_t *node, uint32_t key)
+{
+    return btree_upper_bound(node->keys, 1, node->count, key) - 1;
+}
+
+/* Find the leaf to which key is routed. */
+static wmem_btree_node_t *
+btree_find_leaf(const wmem_btree_t *tree, uint32_t key)
+{
+    wmem_btree_node_t *node;
+
+    if (!tree || !tree->root) {
+        return NULL;
+    }
+
+    /* Keys at or after the start of the last leaf are always routed to it. */
+    node = tree->last_leaf;
+    if (node->count > 0 && key >= node->keys[0]) {
+        return node;
+    }
+
+    node = tree->root;
+    while (!node->is_leaf) {
+        node = (wmem_btree_node_t *)node->values[btree_child_index(node, key)];
+    }
+    return node;
+}
+
+wmem_btree_t *
+wmem_btree_new(wmem_allocator_t *allocator)
+{
+    wmem_btree_t *tree;
+
+    tree = wmem_new0(allocator, wmem_btree_t);
+    tree->metadata_allocator = allocator;
+    tree->data_allocator = allocator;
+
+    return tree;
+}
+
+static bool
+wmem_btree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
+        void *user_data)
+{
+    wmem_btree_t *tree = (wmem_btree_t *)user_data;
+
+    tree->root = NULL;
+    tree->first_leaf = NULL;
+    tree->last_leaf = NULL;
+    tree->count = 0;
+
+    if (event == WMEM_CB_DESTROY_EVENT) {
+        wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
+        wmem_free(tree->metadata_allocator, tree);
+    }
+
+    return true;
+}
+
+static bool
+wmem_btree_destroy_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event _U_,
+        void *user_data)
+{
+    wmem_btree_t *tree = (wmem_btree_t *)user_data;
+
+    wmem_unregister_callback(tree->data_allocator, tree->data_scope_cb_id);
+
+    return false;
+}
+
+wmem_btree_t *
+wmem_btree_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_scope)
+{
+    wmem_btree_t *tree;
+
+    tree = wmem_new0(metadata_scope, wmem_btree_t);
+    tree->metadata_allocator = metadata_scope;
+    tree->data_allocator = data_scope;
+
+    tree->metadata_scope_cb_id = wmem_register_callback(metadata_scope, wmem_btree_destroy_cb,
+            tree);
+    tree->data_scope_cb_id  = wmem_register_callback(data_scope, wmem_btree_reset_cb,
+            tree);
+
+    return tree;
+}
+
+static void
+free_btree_node(wmem_allocator_t *allocator, wmem_btree_node_t *node, bool free_values)
+{
+    for (unsigned i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            free_btree_node(allocator, (wmem_btree_node_t *)node->values[i], free_values);
+        } else if (free_values) {
+            wmem_free(allocator, node->values[i]);
+        }
+    }
+    wmem_free(allocator, node);
+}
+
+void
+wmem_btree_destroy(wmem_btree_t *tree, bool free_values)
+{
+    if (tree->root) {
+        free_btree_node(tree->data_allocator, tree->root, free_values);
+    }
+    if (tree->metadata_allocator) {
+        wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
+    }
+    if (tree->data_allocator) {
+        wmem_unregister_callback(tree->data_allocator, tree->data_scope_cb_id);
+    }
+    wmem_free(tree->metadata_allocator, tree);
+}
+
+bool
+wmem_btree_is_empty(const wmem_btree_t *tree)
+{
+    return tree->count == 0;
+}
+
+unsigned
+wmem_btree_count(const wmem_btree_t *tree)
+{
+    return tree->count;
+}
+
+/*
+ * Insert the child which was split off path[depth - 1]'s child, and split
+ * the inner nodes on the path as needed. If append is set, the split is
+ * on the rightmost path of the tree and the nodes are split at the end,
+ * which keeps them full when keys are inserted in increasing order.
+ */
+static void
+btree_insert_child(wmem_btree_t *tree, wmem_btree_node_t **path, unsigned *path_idx,
+        unsigned depth, uint32_t key, wmem_btree_node_t *child, bool append)
+{
+    while (depth > 0) {
+        wmem_btree_node_t *parent, *right;
+        unsigned pos, split;
+
+        depth--;
+        parent = path[depth];
+        pos = path_idx[depth] + 1;
+
+        if (parent->count < parent->capacity) {
+            btree_node_insert_at(parent, pos, key, child);
+            return;
+        }
+
+        right = btree_node_new(tree->data_allocator, false, WMEM_BTREE_ORDER);
+        split = append ? parent->count : parent->count / 2;
+        right->count = parent->count - split;
+        memcpy(right->keys, &parent->keys[split], right->count * sizeof(uint32_t));
+        memcpy(right->values, &parent->values[split], right->count * sizeof(void *));
+        parent->count = split;
+
+        if (pos >= split) {
+            btree_node_insert_at(right, pos - split, key, child);
+        } else {
+            btree_node_insert_at(parent, pos, key, child);
+        }
+
+        /* The first key of the new node now separates it from its sibling. */
+        key = right->keys[0];
+        child = right;
+    }
+
+    /* The root was split; grow the tree by one level. */
+    wmem_btree_node_t *root = btree_node_new(tree->data_allocator, false, WMEM_BTREE_ORDER);
+    root->values[0] = tree->root;
+    root->keys[0] = 0;
+    root->values[1] = child;
+    root->keys[1] = key;
+    root->count = 2;
+    tree->root = root;
+}
+
+void
+wmem_btree_insert32(wmem_btree_t *tree, uint32_t key, void *data)
+{
+    wmem_btree_node_t *path[WMEM_BTREE_MAX_DEPTH];
+    unsigned           path_idx[WMEM_BTREE_MAX_DEPTH];
+    unsigned           depth = 0;
+    wmem_btree_node_t *leaf;
+    unsigned           idx;
+
+    if (!tree->root) {
+        leaf = btree_node_new(tree->data_allocator, true, WMEM_BTREE_ROOT_CAPACITY);
+        tree->root = tree->first_leaf = tree->last_leaf = leaf;
+    }
+
+    /* Appending a key to the last leaf, which is the common case. */
+    leaf = tree->last_leaf;
+    if (leaf->count > 0 && leaf->count < leaf->capacity && key > leaf->keys[leaf->count - 1]) {
+        leaf->keys[leaf->count] = key;
+        leaf->values[leaf->count] = data;
+        leaf->count++;
+        tree->count++;
+        return;
+    }
+
+    leaf = tree->root;
+    while (!leaf->is_leaf) {
+        ws_assert(depth < WMEM_BTREE_MAX_DEPTH);
+        path[depth] = leaf;
+        path_idx[depth] = btree_child_index(leaf, key);
+        leaf = (wmem_btree_node_t *)leaf->values[path_idx[depth]];
+        depth++;
+    }
+
+    idx = btree_lower_bound(leaf->keys, 0, leaf->count, key);
+    if (idx < leaf->count && leaf->keys[idx] == key) {
+        leaf->values[idx] = data;
+        return;
+    }
+
+    if (leaf->count == leaf->capacity && leaf->capacity < WMEM_BTREE_ORDER) {
+        /* Only the root leaf starts out small. */
+        wmem_btree_node_t *grown;
+
+        ws_assert(leaf == tree->root);
+        grown = btree_node_new(tree->data_allocator, true, MIN(leaf->capacity * 2, WMEM_BTREE_ORDER));
+        grown->count = leaf->count;
+        memcpy(grown->keys, leaf->keys, leaf->count * sizeof(uint32_t));
+        memcpy(grown->values, leaf->values, leaf->count * sizeof(void *));
+        wmem_free(tree->data_allocator, leaf);
+        tree->root = tree->first_leaf = tree->last_leaf = leaf = grown;
+    } else if (leaf->count == leaf->capacity) {
+        wmem_btree_node_t *right;
+        bool append = (leaf == tree->last_leaf && idx == leaf->count);
+        unsigned split = append ? leaf->count : leaf->count / 2;
+
+        right = btree_node_new(tree->data_allocator, true, WMEM_BTREE_ORDER);
+        right->count = leaf->count - split;
+        memcpy(right->keys, &leaf->keys[split], right->count * sizeof(uint32_t));
+        memcpy(right->values, &leaf->values[split], right->count * sizeof(void *));
+        leaf->count = split;
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) {
+            leaf->next->prev = right;
+        } else {
+            tree->last_leaf = right;
+        }
+        leaf->next = right;
+
+        if (idx >= split) {
+            btree_node_insert_at(right, idx - split, key, data);
+        } else {
+            btree_node_insert_at(leaf, idx, key, data);
+        }
+        tree->count++;
+
+        btree_insert_child(tree, path, path_idx, depth, right->keys[0], right, append);
+        return;
+    }
+
+    btree_node_insert_at(leaf, idx, key, data);
+    tree->count++;
+}
+
+bool
+wmem_btree_contains32(const wmem_btree_t *tree, uint32_t key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    unsigned idx;
+
+    if (!leaf) {
+        return false;
+    }
+
+    idx = btree_lower_bound(leaf->keys, 0, leaf->count, key);
+    return idx < leaf->count && leaf->keys[idx] == key;
+}
+
+void *
+wmem_btree_lookup32(const wmem_btree_t *tree, uint32_t key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    unsigned idx;
+
+    if (!leaf) {
+        return NULL;
+    }
+
+    idx = btree_lower_bound(leaf->keys, 0, leaf->count, key);
+    if (idx < leaf->count && leaf->keys[idx] == key) {
+        return leaf->values[idx];
+    }
+    return NULL;
+}
+
+void *
+wmem_btree_lookup32_le_full(const wmem_btree_t *tree, uint32_t key, uint32_t *orig_key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    unsigned idx;
+
+    if (!leaf) {
+        return NULL;
+    }
+
+    idx = btree_upper_bound(leaf->keys, 0, leaf->count, key);
+    /* All smaller keys are in the previous leaves, some of which may be empty. */
+    while (idx == 0) {
+        leaf = leaf->prev;
+        if (!leaf) {
+            return NULL;
+        }
+        idx = leaf->count;
+    }
+
+    *orig_key = leaf->keys[idx - 1];
+    return leaf->values[idx - 1];
+}
+
+void *
+wmem_btree_lookup32_le(const wmem_btree_t *tree, uint32_t key)
+{
+    uint32_t orig_key;
+
+    return wmem_btree_lookup32_le_full(tree, key, &orig_key);
+}
+
+void *
+wmem_btree_lookup32_ge_full(const wmem_btree_t *tree, uint32_t key, uint32_t *orig_key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    unsigned idx;
+
+    if (!leaf) {
+        return NULL;
+    }
+
+    idx = btree_lower_bound(leaf->keys, 0, leaf->count, key);
+    while (idx == leaf->count) {
+        leaf = leaf->next;
+        if (!leaf) {
+            return NULL;
+        }
+        idx = 0;
+    }
+
+    *orig_key = leaf->keys[idx];
+    return leaf->values[idx];
+}
+
+void *
+wmem_btree_lookup32_ge(const wmem_btree_t *tree, uint32_t key)
+{
+    uint32_t orig_key;
+
+    return wmem_btree_lookup32_ge_full(tree, key, &orig_key);
+}
+
+void *
+wmem_btree_remove32(wmem_btree_t *tree, uint32_t key)
+{
+    wmem_btree_node_t *leaf = btree_find_leaf(tree, key);
+    unsigned idx;
+    void *data;
+
+    if (!leaf) {
+        return NULL;
+    }
+
+    idx = btree_lower_bound(leaf->keys, 0, leaf->count, key);
+    if (idx == leaf->count || leaf->keys[idx] != key) {
+        return NULL;
+    }
+
+    /* The leaf may become empty; the separators in the inner nodes stay valid. */
+    data = leaf->values[idx];
+    leaf->count--;
+    memmove(&leaf->keys[idx], &leaf->keys[idx + 1], (leaf->count - idx) * sizeof(uint32_t));
+    memmove(&leaf->values[idx], &leaf->values[idx + 1], (leaf->count - idx) * sizeof(void *));
+    tree->count--;
+
+    return data;
+}
+
+bool
+wmem_btree_foreach(const wmem_btree_t *tree, wmem_foreach_func callback,
+        void *user_data)
+{
+    for (wmem_btree_node_t *leaf = tree->first_leaf; leaf; leaf = leaf->next) {
+        for (unsigned i = 0; i < leaf->count; i++) {
+            if (callback(GUINT_TO_POINTER(leaf->keys[i]), leaf->values[i], user_data)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,239 @@
+/** @file
+ * Definitions for the Wireshark Memory Manager B+Tree
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_BTREE_H__
+#define __WMEM_BTREE_H__
+
+#include "wmem_core.h"
+#include "wmem_tree.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-btree B+Tree
+ *
+ *    A B+tree indexed by 32-bit integers, with the same interface as the
+ *    32-bit key functions of the red/black tree (wmem_tree_insert32(),
+ *    wmem_tree_lookup32_le() etc.).
+ *
+ *    Keys are stored in sorted arrays of up to 64 entries instead of one
+ *    node per key, so lookups touch far fewer cache lines. The tree is
+ *    tuned for keys that are mostly inserted in increasing order, such as
+ *    frame numbers: appending a key and looking up a key at or after the
+ *    start of the last leaf doesn't walk down the tree at all, and leaves
+ *    filled that way are kept full.
+ *
+ *    Removing keys doesn't rebalance the tree, so it is best suited to
+ *    trees from which keys are seldom removed.
+ *
+ *    @{
+ */
+
+/**
+ * @typedef wmem_btree_t
+ * @brief Opaque type representing a B+tree with 32-bit keys in the wmem system.
+ */
+typedef struct _wmem_btree_t wmem_btree_t;
+
+/**
+ * @brief Creates a B+tree with the given allocator scope. When the scope is
+ * emptied, the tree is fully destroyed.
+ *
+ * @param allocator Allocator used for the tree.
+ * @return A pointer to the newly created tree.
+ */
+WS_DLL_PUBLIC
+wmem_btree_t *
+wmem_btree_new(wmem_allocator_t *allocator);
+
+/**
+ * @brief Creates a B+tree with two allocator scopes, like wmem_tree_new_autoreset().
+ *
+ * The base structure lives in the metadata scope, and the tree data lives
+ * in the data scope. Every time free_all occurs in the data scope the tree
+ * is transparently emptied without affecting the location of the base
+ * structure.
+ *
+ * @param metadata_scope Allocator scope for the tree's base structure.
+ * @param data_scope Allocator scope for the tree's data (keys and values).
+ * @return A pointer to the newly created tree.
+ */
+WS_DLL_PUBLIC
+wmem_btree_t *
+wmem_btree_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_scope);
+
+/**
+ * @brief Cleanup memory used by the tree. Intended for NULL scope allocator.
+ *
+ * @param tree Pointer to the tree to be destroyed.
+ * @param free_values If true, frees the memory associated with the values.
+ */
+WS_DLL_PUBLIC
+void
+wmem_btree_destroy(wmem_btree_t *tree, bool free_values);
+
+/**
+ * @brief Check if the tree is empty.
+ *
+ * @param tree Pointer to the tree to check.
+ * @return True if the tree is empty, false otherwise.
+ */
+WS_DLL_PUBLIC
+bool
+wmem_btree_is_empty(const wmem_btree_t *tree);
+
+/**
+ * @brief Get the number of keys in the tree.
+ *
+ * @param tree Pointer to the tree.
+ * @return The number of keys in the tree.
+ */
+WS_DLL_PUBLIC
+unsigned
+wmem_btree_count(const wmem_btree_t *tree);
+
+/**
+ * @brief Insert a value indexed by a uint32_t integer value.
+ *
+ * If the key already exists in the tree its value is overwritten,
+ * as with wmem_tree_insert32().
+ *
+ * @param tree Pointer to the tree where the value will be inserted.
+ * @param key The uint32_t key used to index the value.
+ * @param data Pointer to the data to associate with the key.
+ */
+WS_DLL_PUBLIC
+void
+wmem_btree_insert32(wmem_btree_t *tree, uint32_t key, void *data);
+
+/**
+ * @brief Check whether the tree has a value indexed by a uint32_t integer value.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key to look up.
+ * @return True if the key exists, false otherwise.
+ */
+WS_DLL_PUBLIC
+bool
+wmem_btree_contains32(const wmem_btree_t *tree, uint32_t key);
+
+/**
+ * @brief Look up a value indexed by a uint32_t integer value.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key to look up.
+ * @return Pointer to the data associated with the key, or NULL if not found.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32(const wmem_btree_t *tree, uint32_t key);
+
+/**
+ * @brief Look up the value with the largest key that is less than or equal
+ * to the search key.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key used as the upper bound for the lookup.
+ * @return Pointer to the data associated with the closest matching key, or NULL if none found.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_le(const wmem_btree_t *tree, uint32_t key);
+
+/**
+ * @brief Look up the value with the largest key that is less than or equal
+ * to the search key, and return that key too.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key used as the upper bound for the lookup.
+ * @param orig_key Pointer to store the greatest lower bound key, if found.
+ * @return Pointer to the data associated with the closest matching key, or NULL if none found.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_le_full(const wmem_btree_t *tree, uint32_t key, uint32_t *orig_key);
+
+/**
+ * @brief Look up the value with the smallest key that is greater than or
+ * equal to the search key.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key used as the lower bound for the lookup.
+ * @return Pointer to the data associated with the closest matching key, or NULL if none found.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_ge(const wmem_btree_t *tree, uint32_t key);
+
+/**
+ * @brief Look up the value with the smallest key that is greater than or
+ * equal to the search key, and return that key too.
+ *
+ * @param tree Pointer to the tree to search.
+ * @param key The uint32_t key used as the lower bound for the lookup.
+ * @param orig_key Pointer to store the least upper bound key, if found.
+ * @return Pointer to the data associated with the closest matching key, or NULL if none found.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_lookup32_ge_full(const wmem_btree_t *tree, uint32_t key, uint32_t *orig_key);
+
+/**
+ * @brief Remove the value indexed by a uint32_t integer value.
+ *
+ * @param tree Pointer to the tree from which the value will be removed.
+ * @param key The uint32_t key identifying the value to remove.
+ * @return Pointer to the data that was stored at the key, or NULL if no such key exists.
+ */
+WS_DLL_PUBLIC
+void *
+wmem_btree_remove32(wmem_btree_t *tree, uint32_t key);
+
+/**
+ * @brief Traverse the tree in increasing key order.
+ *
+ * The key passed to the callback is the uint32_t key cast with
+ * GUINT_TO_POINTER(), as with wmem_tree_foreach() on a tree with 32-bit keys.
+ * Traversal stops early if the callback returns true.
+ *
+ * @param tree Pointer to the tree to traverse.
+ * @param callback Function to call for each value.
+ * @param user_data Pointer to user-defined data passed to the callback.
+ * @return True if traversal was ended prematurely by the callback, false otherwise.
+ */
+WS_DLL_PUBLIC
+bool
+wmem_btree_foreach(const wmem_btree_t *tree, wmem_foreach_func callback,
+        void *user_data);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_BTREE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
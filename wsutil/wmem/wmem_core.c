@@ -41,6 +41,10 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    if (allocator->counter) {
+        *allocator->counter += size;
+    }
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -93,6 +97,10 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     ws_assert(allocator->in_scope);
 
+    if (allocator->counter) {
+        *allocator->counter += size;
+    }
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -116,6 +124,16 @@ wmem_gc(wmem_allocator_t *allocator)
     allocator->gc(allocator->private_data);
 }
 
+uint64_t *
+wmem_set_allocation_counter(wmem_allocator_t *allocator, uint64_t *counter)
+{
+    uint64_t *previous = allocator->counter;
+
+    allocator->counter = counter;
+
+    return previous;
+}
+
 void
 wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
@@ -141,6 +159,7 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator = wmem_new(NULL, wmem_allocator_t);
     allocator->type      = real_type;
     allocator->callbacks = NULL;
+    allocator->counter   = NULL;
     allocator->in_scope  = true;
 
     switch (real_type) {
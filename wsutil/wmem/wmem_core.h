@@ -208,6 +208,26 @@ WS_DLL_PUBLIC
 void
 wmem_gc(wmem_allocator_t *allocator);
 
+/**
+ * @brief Counts the memory requested from an allocator.
+ *
+ * After this call the size of every allocation and reallocation made in the
+ * pool is added to *counter, until the counter is replaced by another call.
+ * Pointing the pool at a different counter whenever a different consumer
+ * starts using it attributes the memory in a shared pool to its consumers.
+ *
+ * The counter is a running total of requested sizes, not of the memory
+ * currently in use: freeing memory doesn't subtract from it, and the growth
+ * of a reallocated block is counted as the full new size.
+ *
+ * @param allocator The allocator to count.
+ * @param counter The counter to add to, or NULL to stop counting.
+ * @return The previous counter, or NULL if the pool wasn't being counted.
+ */
+WS_DLL_PUBLIC
+uint64_t *
+wmem_set_allocation_counter(wmem_allocator_t *allocator, uint64_t *counter);
+
 /**
  * @brief Destroy the given allocator, freeing all memory allocated in it.
  *
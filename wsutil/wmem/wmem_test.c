@@ -194,6 +194,37 @@ wmem_test_allocator_callbacks(void)
     g_assert_true(cb_called_count == 3);
 }
 
+static void
+wmem_test_allocator_counter(void)
+{
+    wmem_allocator_t *allocator;
+    uint64_t counter_a = 0;
+    uint64_t counter_b = 0;
+    void *ptr;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    wmem_alloc(allocator, 8);
+    g_assert_null(wmem_set_allocation_counter(allocator, &counter_a));
+
+    ptr = wmem_alloc(allocator, 16);
+    wmem_alloc0(allocator, 32);
+    g_assert_cmpuint(counter_a, ==, 48);
+
+    g_assert_true(wmem_set_allocation_counter(allocator, &counter_b) == &counter_a);
+    ptr = wmem_realloc(allocator, ptr, 64);
+    wmem_free(allocator, ptr);
+    g_assert_cmpuint(counter_a, ==, 48);
+    g_assert_cmpuint(counter_b, ==, 64);
+
+    g_assert_true(wmem_set_allocation_counter(allocator, NULL) == &counter_b);
+    wmem_alloc(allocator, 128);
+    g_assert_cmpuint(counter_a, ==, 48);
+    g_assert_cmpuint(counter_b, ==, 64);
+
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         unsigned len)
@@ -1353,6 +1384,219 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_btree(void)
+{
+    wmem_allocator_t   *allocator, *extra_allocator;
+    wmem_btree_t       *btree;
+    wmem_tree_t        *tree;
+    uint32_t            i;
+    uint32_t            rand_int;
+    uint32_t            int_key, tree_key;
+    int                 seen_values = 0;
+
+    allocator       = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    btree = wmem_btree_new(allocator);
+    g_assert_true(btree);
+    g_assert_true(wmem_btree_is_empty(btree));
+    g_assert_true(wmem_btree_lookup32_le(btree, 0) == NULL);
+
+    /* test basic 32-bit key operations */
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_btree_lookup32(btree, i) == NULL);
+        if (i > 0) {
+            g_assert_true(wmem_btree_lookup32_le_full(btree, i, &int_key) == GINT_TO_POINTER(i-1));
+            g_assert_true(int_key == i - 1);
+        }
+        wmem_btree_insert32(btree, i, GINT_TO_POINTER(i));
+        g_assert_true(wmem_btree_lookup32(btree, i) == GINT_TO_POINTER(i));
+        g_assert_true(wmem_btree_contains32(btree, i));
+        g_assert_true(!wmem_btree_is_empty(btree));
+    }
+    g_assert_true(wmem_btree_count(btree) == CONTAINER_ITERS);
+
+    /* overwriting a value doesn't add a key */
+    wmem_btree_insert32(btree, 0, GINT_TO_POINTER(-1));
+    g_assert_true(wmem_btree_lookup32(btree, 0) == GINT_TO_POINTER(-1));
+    g_assert_true(wmem_btree_count(btree) == CONTAINER_ITERS);
+
+    rand_int = ((uint32_t)g_test_rand_int()) % CONTAINER_ITERS;
+    g_assert_true(wmem_btree_remove32(btree, rand_int) == (rand_int ? GINT_TO_POINTER(rand_int) : GINT_TO_POINTER(-1)));
+    g_assert_true(wmem_btree_lookup32(btree, rand_int) == NULL);
+    g_assert_true(!wmem_btree_contains32(btree, rand_int));
+    if (rand_int > 0) {
+        g_assert_true(wmem_btree_lookup32_le(btree, rand_int) == GINT_TO_POINTER(rand_int - 1));
+    }
+    if (rand_int + 1 < CONTAINER_ITERS) {
+        g_assert_true(wmem_btree_lookup32_ge(btree, rand_int) == GINT_TO_POINTER(rand_int + 1));
+    }
+    g_assert_true(wmem_btree_count(btree) == CONTAINER_ITERS - 1);
+    wmem_free_all(allocator);
+
+    /* compare random insertions and removals with the red/black tree */
+    btree = wmem_btree_new(allocator);
+    tree = wmem_tree_new(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        rand_int = ((uint32_t)g_test_rand_int()) % (CONTAINER_ITERS * 4);
+        wmem_btree_insert32(btree, rand_int, GINT_TO_POINTER(i));
+        wmem_tree_insert32(tree, rand_int, GINT_TO_POINTER(i));
+        if (i % 4 == 0) {
+            rand_int = ((uint32_t)g_test_rand_int()) % (CONTAINER_ITERS * 4);
+            g_assert_true(wmem_btree_remove32(btree, rand_int) == wmem_tree_remove32(tree, rand_int));
+        }
+    }
+    g_assert_true(wmem_btree_count(btree) == wmem_tree_count(tree));
+    for (i=0; i<CONTAINER_ITERS * 4 + 1; i++) {
+        g_assert_true(wmem_btree_lookup32(btree, i) == wmem_tree_lookup32(tree, i));
+        int_key = tree_key = 0;
+        g_assert_true(wmem_btree_lookup32_le_full(btree, i, &int_key) == wmem_tree_lookup32_le_full(tree, i, &tree_key));
+        g_assert_true(int_key == tree_key);
+        int_key = tree_key = 0;
+        g_assert_true(wmem_btree_lookup32_ge_full(btree, i, &int_key) == wmem_tree_lookup32_ge_full(tree, i, &tree_key));
+        g_assert_true(int_key == tree_key);
+    }
+    wmem_free_all(allocator);
+
+    /* test auto-reset functionality */
+    btree = wmem_btree_new_autoreset(allocator, extra_allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_btree_lookup32(btree, i) == NULL);
+        wmem_btree_insert32(btree, i, GINT_TO_POINTER(i));
+        g_assert_true(wmem_btree_lookup32(btree, i) == GINT_TO_POINTER(i));
+    }
+    g_assert_true(wmem_btree_count(btree) == CONTAINER_ITERS);
+    wmem_free_all(extra_allocator);
+    g_assert_true(wmem_btree_count(btree) == 0);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_btree_lookup32(btree, i) == NULL);
+        g_assert_true(wmem_btree_lookup32_le(btree, i) == NULL);
+    }
+    wmem_free_all(allocator);
+
+    /* test for-each functionality */
+    btree = wmem_btree_new(allocator);
+    expected_user_data = GINT_TO_POINTER(g_test_rand_int());
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        uint32_t tmp;
+        do {
+            tmp = g_test_rand_int();
+        } while (wmem_btree_contains32(btree, tmp));
+        value_seen[i] = false;
+        wmem_btree_insert32(btree, tmp, GINT_TO_POINTER(i));
+    }
+
+    cb_called_count    = 0;
+    cb_continue_count  = CONTAINER_ITERS;
+    wmem_btree_foreach(btree, wmem_test_foreach_cb, expected_user_data);
+    g_assert_true(cb_called_count   == CONTAINER_ITERS);
+    g_assert_true(cb_continue_count == 0);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert_true(value_seen[i]);
+        value_seen[i] = false;
+    }
+
+    cb_called_count    = 0;
+    cb_continue_count  = 10;
+    wmem_btree_foreach(btree, wmem_test_foreach_cb, expected_user_data);
+    g_assert_true(cb_called_count   == 10);
+    g_assert_true(cb_continue_count == 0);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        if (value_seen[i]) {
+            seen_values++;
+        }
+    }
+    g_assert_true(seen_values == 10);
+
+    wmem_destroy_allocator(extra_allocator);
+    wmem_destroy_allocator(allocator);
+}
+
+/* NOTE: You have to run "wmem_test -m perf" to run the performance tests. */
+static void
+wmem_test_btreeperf(void)
+{
+#define BTREE_KEY_COUNT (10 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *tree;
+    wmem_btree_t       *btree;
+    uint32_t            i;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* Frame numbers, as in the dissector trees: increasing keys, and
+     * lookups of keys a bit before the last one. */
+
+    tree = wmem_tree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_tree_insert32(tree, i * 2, GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32 increasing keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        g_assert_true(wmem_tree_lookup32_le(tree, i * 2 + 1) == GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_le: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    wmem_free_all(allocator);
+
+    btree = wmem_btree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_btree_insert32(btree, i * 2, GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_insert32 increasing keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        g_assert_true(wmem_btree_lookup32_le(btree, i * 2 + 1) == GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree_lookup32_le: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    wmem_free_all(allocator);
+
+    /* Random keys */
+
+    tree = wmem_tree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_tree_insert32(tree, g_test_rand_int(), GUINT_TO_POINTER(i + 1));
+    }
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_tree_lookup32_le(tree, g_test_rand_int());
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree random keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    wmem_free_all(allocator);
+
+    btree = wmem_btree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_btree_insert32(btree, g_test_rand_int(), GUINT_TO_POINTER(i + 1));
+    }
+    for (i = 0; i < BTREE_KEY_COUNT; i++) {
+        wmem_btree_lookup32_le(btree, g_test_rand_int());
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_btree random keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    wmem_destroy_allocator(allocator);
+}
+
 
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
@@ -1470,6 +1714,7 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/counter",   wmem_test_allocator_counter);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
@@ -1486,6 +1731,10 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/strbuf/validate", wmem_test_strbuf_validate);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    g_test_add_func("/wmem/datastruct/btree",  wmem_test_btree);
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/btreeperf", wmem_test_btreeperf);
+    }
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
     ret = g_test_run();
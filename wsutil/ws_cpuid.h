@@ -35,6 +35,10 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /**
  * @def ws_cpuid
  * @brief Execute the x86 CPUID instruction with the given selector.
@@ -179,7 +183,7 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
  *
  * @return 1 if SSE4.2 is supported, otherwise returns 0.
  */
-static int
+static inline int
 ws_cpuid_sse42(void)
 {
 	uint32_t CPUInfo[4];
@@ -190,3 +194,65 @@ ws_cpuid_sse42(void)
 	/* in ECX bit 20 toggled on */
 	return (CPUInfo[2] & (1 << 20));
 }
+
+/**
+ * @brief Checks if the CPU supports the PCLMULQDQ (carry-less multiplication)
+ * instruction.
+ *
+ * @return true if PCLMULQDQ is supported, otherwise false.
+ */
+static inline bool
+ws_cpuid_pclmulqdq(void)
+{
+	uint32_t CPUInfo[4];
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return false;
+
+	/* in ECX bit 1 toggled on */
+	return (CPUInfo[2] & (1 << 1)) != 0;
+}
+
+/**
+ * @brief Checks if the CPU supports the AVX2 instruction set and the OS
+ * saves the AVX registers on context switches.
+ *
+ * @return true if AVX2 can be used, otherwise false.
+ */
+static inline bool
+ws_cpuid_avx2(void)
+{
+	uint32_t CPUInfo[4];
+	uint32_t xcr0;
+
+	if (!ws_cpuid(CPUInfo, 0) || CPUInfo[0] < 7)
+		return false;
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return false;
+
+	/* OSXSAVE (ECX bit 27) and AVX (ECX bit 28) toggled on */
+	if ((CPUInfo[2] & (1 << 27)) == 0 || (CPUInfo[2] & (1 << 28)) == 0)
+		return false;
+
+	/* The OS must save the SSE and AVX state (XCR0 bits 1 and 2) */
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	xcr0 = (uint32_t)_xgetbv(0);
+#elif defined(__GNUC__) && defined(__x86_64__)
+	{
+		uint32_t edx;
+
+		__asm__ __volatile__("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+	}
+#else
+	xcr0 = 0;
+#endif
+	if ((xcr0 & 0x6) != 0x6)
+		return false;
+
+	if (!ws_cpuid(CPUInfo, 7))
+		return false;
+
+	/* in EBX bit 5 toggled on */
+	return (CPUInfo[1] & (1 << 5)) != 0;
+}